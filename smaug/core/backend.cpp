@@ -1,4 +1,5 @@
 #include "smaug/core/backend.h"
+#include "smaug/operators/batch_mat_mul_op.h"
 #include "smaug/operators/batch_norm_op.h"
 #include "smaug/operators/convolution_op.h"
 #include "smaug/operators/data_op.h"
@@ -10,6 +11,7 @@
 #include "smaug/operators/control_flow_ops.h"
 #include "smaug/operators/elu_op.h"
 #include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/lstm_op.h"
 #include "smaug/operators/pooling_op.h"
 #include "smaug/operators/relu_op.h"
 #include "smaug/operators/reorder_op.h"
@@ -21,6 +23,7 @@
 #include "smaug/operators/softmax_op.h"
 #include "smaug/operators/tanh_op.h"
 #include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_op.h"
 #include "smaug/operators/smv/smv_inner_product_op.h"
 #include "smaug/operators/smv/smv_pooling_op.h"
 #include "smaug/operators/smv/smv_batch_norm_op.h"
@@ -33,6 +36,8 @@
 #include "smaug/operators/smv/smv_eltwise_mul_op.h"
 #include "smaug/operators/smv/smv_less_op.h"
 #include "smaug/operators/smv/smv_greater_op.h"
+#include "smaug/operators/smv/smv_lstm_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_op.h"
 
 namespace smaug {
 
@@ -73,6 +78,8 @@ DEF_CREATE_OP(GreaterOp, ReferenceBackend)
 DEF_CREATE_OP(GreaterEqualOp, ReferenceBackend)
 DEF_CREATE_OP(SwitchOp, ReferenceBackend)
 DEF_CREATE_OP(MergeOp, ReferenceBackend)
+DEF_CREATE_OP(LstmOp, ReferenceBackend)
+DEF_CREATE_OP(BatchMatMulOp, ReferenceBackend)
 DEF_CREATE_OP(ReluOp, ReferenceBackend)
 DEF_CREATE_OP(SigmoidOp, ReferenceBackend)
 DEF_CREATE_OP(EluOp, ReferenceBackend)
@@ -81,6 +88,7 @@ DEF_CREATE_OP(TanhOp, ReferenceBackend)
 DEF_CREATE_OP(HardTanhOp, ReferenceBackend)
 
 DEF_CREATE_SMV_OP(ConvolutionOp)
+DEF_CREATE_SMV_OP(DepthwiseConvolutionOp)
 DEF_CREATE_SMV_OP(InnerProductOp)
 DEF_CREATE_SMV_OP(MaxPoolingOp)
 DEF_CREATE_SMV_OP(AvgPoolingOp)
@@ -98,8 +106,9 @@ DEF_CREATE_SMV_OP(LessOp)
 DEF_CREATE_SMV_OP(LessEqualOp)
 DEF_CREATE_SMV_OP(GreaterOp)
 DEF_CREATE_SMV_OP(GreaterEqualOp)
+DEF_CREATE_SMV_OP(LstmOp)
+DEF_CREATE_SMV_OP(BatchMatMulOp)
 DEF_CREATE_OP(DataOp, SmvBackend)
-DEF_CREATE_OP(DepthwiseConvolutionOp, SmvBackend)
 DEF_CREATE_OP(ReorderOp, SmvBackend)
 DEF_CREATE_OP(ConcatOp, SmvBackend)
 DEF_CREATE_OP(SplitOp, SmvBackend)
@@ -135,9 +144,10 @@ const unsigned kPoolingHw = 0x0003;
 // The systolic array is implemented in gem5 instead of Aladdin, so it needs to
 // have a different accelerator id.
 const unsigned kSystolicArrayHw = 0x0004;
-float* spad0;
-float* spad1;
-float* spad2;
+thread_local float* spad0;
+thread_local float* spad1;
+thread_local float* spad2;
+thread_local AccelSpads accelSpads[maxNumAccelerators];
 }  // namespace smv
 
 
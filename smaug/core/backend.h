@@ -4,6 +4,7 @@
 #include <string>
 
 #include "smaug/core/datatypes.h"
+#include "smaug/core/globals.h"
 #include "smaug/utility/utils.h"
 
 // These are compile-time switches that selectively build a copy of SMAUG with
@@ -52,6 +53,8 @@ template <typename Backend> class GreaterOp;
 template <typename Backend> class GreaterEqualOp;
 template <typename Backend> class SwitchOp;
 template <typename Backend> class MergeOp;
+template <typename Backend> class LstmOp;
+template <typename Backend> class BatchMatMulOp;
 template <typename Backend> class ReluOp;
 template <typename Backend> class SigmoidOp;
 template <typename Backend> class EluOp;
@@ -117,6 +120,8 @@ class ReferenceBackend {
     DECL_CREATE_OP(GreaterEqualOp);
     DECL_CREATE_OP(SwitchOp);
     DECL_CREATE_OP(MergeOp);
+    DECL_CREATE_OP(LstmOp);
+    DECL_CREATE_OP(BatchMatMulOp);
     DECL_CREATE_OP(ReluOp);
     DECL_CREATE_OP(SigmoidOp);
     DECL_CREATE_OP(EluOp);
@@ -139,15 +144,27 @@ extern const unsigned kEltwiseOpHw;
 extern const unsigned kBatchNormHw;
 extern const unsigned kPoolingHw;
 extern const unsigned kSystolicArrayHw;
+/** The local scratchpads of a single SMV accelerator. */
+struct AccelSpads {
+    float* spad0;
+    float* spad1;
+    float* spad2;
+};
 // Note that these naked pointers are never to be used except when invoking the
-// kernels themselves.
-extern float* spad0;
-extern float* spad1;
-extern float* spad2;
+// kernels themselves. Every host thread that invokes SMV kernels owns its own
+// set of scratchpads, allocated by SmvBackend::initScratchpads(). Operators
+// that distribute tiles over an SmvAcceleratorPool pass accelSpads[accelIdx]
+// to the kernels, so that every accelerator keeps its own local data; spad0,
+// spad1 and spad2 alias the scratchpads of accelerator 0.
+extern thread_local float* spad0;
+extern thread_local float* spad1;
+extern thread_local float* spad2;
+extern thread_local AccelSpads accelSpads[maxNumAccelerators];
 }  // namespace smv
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 class SmvConvolutionOp;
+class SmvDepthwiseConvolutionOp;
 class SmvInnerProductOp;
 class SmvMaxPoolingOp;
 class SmvAvgPoolingOp;
@@ -165,6 +182,8 @@ class SmvLessOp;
 class SmvLessEqualOp;
 class SmvGreaterOp;
 class SmvGreaterEqualOp;
+class SmvLstmOp;
+class SmvBatchMatMulOp;
 #endif
 
 /**
@@ -196,21 +215,38 @@ class SmvBackend {
     static void initGlobals() {
         // kSpadSize is in terms of float16 data.
         smv::kSpadSize = 32 * 1024;
+        initScratchpads();
+    }
+    static void freeGlobals() { freeScratchpads(); }
+    /** Allocates the scratchpads used by the calling thread. */
+    static void initScratchpads() {
         // In SMV, all tensors store float16 data, but due to the modelling
         // restriction of Aladdin, we actually store float32 data in the
         // scratchpads. This why the allocated memory size here is double
         // kSpadSize.
-        smv::spad0 = (float*)malloc_aligned(smv::kSpadSize * 2);
-        smv::spad1 = (float*)malloc_aligned(smv::kSpadSize * 2);
-        smv::spad2 = (float*)malloc_aligned(smv::kSpadSize * 2);
+        for (int i = 0; i < maxNumAccelerators; i++) {
+            smv::accelSpads[i].spad0 =
+                    (float*)malloc_aligned(smv::kSpadSize * 2);
+            smv::accelSpads[i].spad1 =
+                    (float*)malloc_aligned(smv::kSpadSize * 2);
+            smv::accelSpads[i].spad2 =
+                    (float*)malloc_aligned(smv::kSpadSize * 2);
+        }
+        smv::spad0 = smv::accelSpads[0].spad0;
+        smv::spad1 = smv::accelSpads[0].spad1;
+        smv::spad2 = smv::accelSpads[0].spad2;
     }
-    static void freeGlobals() {
-        free(smv::spad0);
-        free(smv::spad1);
-        free(smv::spad2);
+    /** Frees the scratchpads used by the calling thread. */
+    static void freeScratchpads() {
+        for (int i = 0; i < maxNumAccelerators; i++) {
+            free(smv::accelSpads[i].spad0);
+            free(smv::accelSpads[i].spad1);
+            free(smv::accelSpads[i].spad2);
+        }
     }
 
     DECL_CREATE_SMV_OP(ConvolutionOp);
+    DECL_CREATE_SMV_OP(DepthwiseConvolutionOp);
     DECL_CREATE_SMV_OP(InnerProductOp);
     DECL_CREATE_SMV_OP(MaxPoolingOp);
     DECL_CREATE_SMV_OP(AvgPoolingOp);
@@ -228,8 +264,9 @@ class SmvBackend {
     DECL_CREATE_SMV_OP(LessEqualOp);
     DECL_CREATE_SMV_OP(GreaterOp);
     DECL_CREATE_SMV_OP(GreaterEqualOp);
+    DECL_CREATE_SMV_OP(LstmOp);
+    DECL_CREATE_SMV_OP(BatchMatMulOp);
     DECL_CREATE_OP(DataOp);
-    DECL_CREATE_OP(DepthwiseConvolutionOp);
     DECL_CREATE_OP(ReorderOp);
     DECL_CREATE_OP(ConcatOp);
     DECL_CREATE_OP(SplitOp);
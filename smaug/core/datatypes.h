@@ -83,6 +83,26 @@ struct FromDataType<Bool> {
     typedef bool type;
 };
 
+/** Returns the size in bytes of an element of the DataType, or 0 if unknown. */
+inline int getDataTypeSize(DataType dataType) {
+    switch (dataType) {
+        case Float16:
+            return sizeof(float16);
+        case Int32:
+            return sizeof(int32_t);
+        case Float32:
+            return sizeof(float);
+        case Int64:
+            return sizeof(int64_t);
+        case Float64:
+            return sizeof(double);
+        case Bool:
+            return sizeof(bool);
+        default:
+            return 0;
+    }
+}
+
 }  // namespace smaug
 
 #endif
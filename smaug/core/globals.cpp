@@ -6,4 +6,5 @@ bool fastForwardMode = true;
 int numAcceleratorsAvailable;
 ThreadPool* threadPool = nullptr;
 bool useSystolicArrayWhenAvailable;
+bool pipelineTiles = false;
 }  // namespace smaug
@@ -40,6 +40,13 @@ extern ThreadPool* threadPool;
  */
 extern bool useSystolicArrayWhenAvailable;
 
+/**
+ * If true, SMV operators copy data into and out of their tiles on the thread
+ * pool while their kernels run, instead of before and after all of them. See
+ * SmvTilePipeline.
+ */
+extern bool pipelineTiles;
+
 }  // namespace smaug
 
 #endif
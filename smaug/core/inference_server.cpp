@@ -0,0 +1,355 @@
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "smaug/core/inference_server.h"
+#include "smaug/core/tensor_utils.h"
+
+namespace smaug {
+
+// Returns true if N is the outermost dimension of the layout.
+static bool isBatchMajor(DataLayout layout) {
+    return layout == NCHW || layout == NHWC || layout == NC || layout == NCT ||
+           layout == NTC || layout == N;
+}
+
+// Reads exactly size bytes. Returns false if the stream ends first.
+static bool readFully(int fd, void* buffer, size_t size) {
+    char* ptr = reinterpret_cast<char*>(buffer);
+    while (size > 0) {
+        ssize_t numRead = read(fd, ptr, size);
+        if (numRead <= 0)
+            return false;
+        ptr += numRead;
+        size -= numRead;
+    }
+    return true;
+}
+
+static bool writeFully(int fd, const void* buffer, size_t size) {
+    const char* ptr = reinterpret_cast<const char*>(buffer);
+    while (size > 0) {
+        ssize_t numWritten = write(fd, ptr, size);
+        if (numWritten <= 0)
+            return false;
+        ptr += numWritten;
+        size -= numWritten;
+    }
+    return true;
+}
+
+// Sends a reply with its size prefix. Returns false if the client is gone.
+static bool writeReply(int fd, const std::string& buffer, uint32_t flags = 0) {
+    uint32_t size = buffer.size() | flags;
+    return writeFully(fd, &size, sizeof(size)) &&
+           writeFully(fd, buffer.data(), buffer.size());
+}
+
+// Returns the number of elements in the data field of the given type.
+static int getNumElements(const TensorData& data, DataType dataType) {
+    if (!data.raw_data().empty())
+        return data.raw_data().size() / getDataTypeSize(dataType);
+    switch (dataType) {
+        case Float16:
+            // Two float16 elements are packed into each int32.
+            return data.half_data_size() * 2;
+        case Float32:
+            return data.float_data_size();
+        case Float64:
+            return data.double_data_size();
+        case Int32:
+            return data.int_data_size();
+        case Int64:
+            return data.int64_data_size();
+        case Bool:
+            return data.bool_data_size();
+        default:
+            return 0;
+    }
+}
+
+// Returns an upper bound on the serialized size of a valid request for the
+// input Tensor, so the size prefix of a request can be checked before any
+// memory is allocated for it.
+static size_t getMaxRequestSize(const Tensor* input) {
+    // The most bytes an element takes in the data field of its type. Integers
+    // are varints of up to 10 bytes, and each int32 holds two float16s.
+    size_t elementSize;
+    switch (input->getDataType()) {
+        case Float16:
+            elementSize = 5;
+            break;
+        case Float32:
+            elementSize = 4;
+            break;
+        case Float64:
+            elementSize = 8;
+            break;
+        case Bool:
+            elementSize = 1;
+            break;
+        default:
+            elementSize = 10;
+            break;
+    }
+    // The name, the shape and the field headers take well under this.
+    const size_t kMaxMetadataSize = 4096;
+    return input->getShape().storageSize() * elementSize + kMaxMetadataSize;
+}
+
+InferenceServer::Connection::~Connection() {
+    if (!ownsFds)
+        return;
+    close(inFd);
+    if (outFd != inFd)
+        close(outFd);
+}
+
+InferenceServer::InferenceServer(Network* _network,
+                                 Scheduler* _scheduler,
+                                 Tensor* _input,
+                                 int _maxBatchDelayUs)
+        : network(_network), scheduler(_scheduler), input(_input),
+          maxBatchDelayUs(_maxBatchDelayUs),
+          maxRequestSize(getMaxRequestSize(_input)), numRuns(0),
+          numReaders(0), acceptingConnections(false) {
+    // The Network is run once per batch, so there is no point in announcing
+    // it every time.
+    scheduler->setPrintBanner(false);
+    // The output of the Network is an output of one of the Operators without
+    // children, so all of them must keep the batch dimension.
+    const Graph& graph = network->getGraph();
+    canBatch = isBatchMajor(input->getShape().getLayout());
+    for (auto nameOp : network->getOperators()) {
+        Operator* op = nameOp.second;
+        if (boost::out_degree(op->getVertex(), graph) > 0)
+            continue;
+        for (auto output : op->getOutputs()) {
+            canBatch &= isBatchMajor(output->getShape().getLayout()) &&
+                        output->dim(0) == input->dim(0);
+        }
+    }
+}
+
+std::string InferenceServer::validateRequest(const TensorProto& request) const {
+    const TensorShape& inputShape = input->getShape();
+    TensorShape shape(request.shape());
+    if (request.data_type() != input->getDataType())
+        return "the data type doesn't match the input tensor";
+    if (shape.ndims() != inputShape.ndims())
+        return "the shape doesn't match the input tensor";
+    for (int i = 1; i < shape.ndims(); i++) {
+        if (shape[i] != inputShape[i] ||
+            shape.getStorageDim(i) != inputShape.getStorageDim(i))
+            return "the shape doesn't match the input tensor";
+    }
+    if (canBatch ? (shape[0] < 1 || shape[0] > inputShape[0])
+                 : shape[0] != inputShape[0])
+        return "the batch size doesn't match the input tensor";
+    std::string rawDataError = Tensor::validateRawData(request, request.data());
+    if (!rawDataError.empty())
+        return rawDataError;
+    int numElements = getNumElements(request.data(), request.data_type());
+    // Packed float16 data may end with a zero to fill its last int32.
+    int numPacked = request.data_type() == Float16 &&
+                                    request.data().raw_data().empty()
+                            ? 2
+                            : 1;
+    if (numElements != (int)next_multiple(shape.storageSize(), numPacked))
+        return "the size of the data doesn't match its shape";
+    return "";
+}
+
+void InferenceServer::readRequests(std::shared_ptr<Connection> conn) {
+    while (true) {
+        uint32_t size;
+        if (!readFully(conn->inFd, &size, sizeof(size)))
+            break;
+        Request request;
+        request.conn = conn;
+        request.batchSize = 0;
+        // The size comes from the client, so it is checked before the buffer
+        // is allocated. Requests must also fit in the size prefix of the
+        // replies.
+        if ((size & kErrorReply) || size > maxRequestSize) {
+            request.error = "the request is too large";
+        } else {
+            std::string buffer(size, '\0');
+            if (!readFully(conn->inFd, &buffer[0], size) ||
+                !request.tensor.ParseFromString(buffer)) {
+                request.error = "failed to read the request";
+            } else {
+                request.error = validateRequest(request.tensor);
+            }
+        }
+        if (request.error.empty())
+            request.batchSize = request.tensor.shape().dims(0);
+        else
+            std::cerr << "Invalid request: " << request.error << ".\n";
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pendingRequests.push_back(std::move(request));
+        queueCond.notify_all();
+        // The rest of the stream can't be trusted after a malformed request.
+        if (!pendingRequests.back().error.empty())
+            break;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    numReaders--;
+    queueCond.notify_all();
+}
+
+bool InferenceServer::getNextBatch(std::vector<Request>& batch) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    auto noMoreRequests = [this]() {
+        return numReaders == 0 && !acceptingConnections;
+    };
+    queueCond.wait(lock, [&]() {
+        return !pendingRequests.empty() || noMoreRequests();
+    });
+    if (pendingRequests.empty())
+        return false;
+
+    int maxRows = input->dim(0);
+    int numRows = 0;
+    bool timedOut = maxBatchDelayUs == 0;
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(maxBatchDelayUs);
+    while (true) {
+        while (!pendingRequests.empty() &&
+               numRows + pendingRequests.front().batchSize <= maxRows) {
+            numRows += pendingRequests.front().batchSize;
+            batch.push_back(std::move(pendingRequests.front()));
+            pendingRequests.pop_front();
+        }
+        // Stop once the batch is full, the next request doesn't fit, or no
+        // more requests can arrive in time.
+        if (numRows == maxRows || !pendingRequests.empty() || timedOut ||
+            noMoreRequests())
+            break;
+        timedOut = queueCond.wait_until(lock, deadline) ==
+                   std::cv_status::timeout;
+    }
+    return true;
+}
+
+void InferenceServer::runBatch(const std::vector<Request>& batch) {
+    int inputRowSize = input->getShape().storageSize() / input->dim(0);
+    int row = 0;
+    for (const Request& request : batch) {
+        if (!request.error.empty())
+            continue;
+        Tensor tensor(request.tensor, request.tensor.data());
+        copyRawTensorData(input, &tensor, row * inputRowSize, 0,
+                          request.batchSize * inputRowSize);
+        row += request.batchSize;
+    }
+    // A batch of only malformed requests just gets the error replies.
+    Tensor* output = nullptr;
+    if (row > 0) {
+        input->bumpDataVersion();
+        output = scheduler->runNetwork();
+        numRuns++;
+    }
+
+    row = 0;
+    for (const Request& request : batch) {
+        if (!request.error.empty()) {
+            if (!writeReply(request.conn->outFd, request.error, kErrorReply))
+                std::cerr << "Failed to send an error reply!\n";
+            continue;
+        }
+        const TensorShape& outputShape = output->getShape();
+        int outputRowSize = outputShape.storageSize() / output->dim(0);
+        TensorProto* response;
+        if (canBatch) {
+            std::vector<int> dims = outputShape.dims();
+            dims[0] = request.batchSize;
+            Tensor rows(output->getName(),
+                        TensorShape(dims, outputShape.getLayout(),
+                                    outputShape.getAlignment()));
+            rows.allocateStorage(output->getDataType());
+            copyRawTensorData(&rows, output, 0, row * outputRowSize,
+                              request.batchSize * outputRowSize);
+            response = rows.asTensorProto();
+        } else {
+            response = output->asTensorProto();
+        }
+        row += request.batchSize;
+        std::string buffer;
+        response->SerializeToString(&buffer);
+        delete response;
+        if (!writeReply(request.conn->outFd, buffer))
+            std::cerr << "Failed to send a response!\n";
+    }
+}
+
+void InferenceServer::serveStream(int inFd, int outFd) {
+    auto conn = std::make_shared<Connection>(inFd, outFd, false);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        numReaders++;
+    }
+    std::thread reader(&InferenceServer::readRequests, this, conn);
+    conn.reset();
+    std::vector<Request> batch;
+    while (getNextBatch(batch)) {
+        runBatch(batch);
+        batch.clear();
+    }
+    reader.join();
+}
+
+void InferenceServer::serveSocket(const std::string& path) {
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (listenFd < 0 || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Failed to create the socket " << path << "!\n";
+        return;
+    }
+    path.copy(addr.sun_path, path.size());
+    unlink(path.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "Failed to listen on the socket " << path << "!\n";
+        close(listenFd);
+        return;
+    }
+    // A client that disconnects early must not kill the server.
+    signal(SIGPIPE, SIG_IGN);
+    acceptingConnections = true;
+    std::thread acceptor([this, listenFd]() {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0 && errno == EINTR)
+                continue;
+            if (fd < 0) {
+                std::cerr << "Failed to accept a connection!\n";
+                std::lock_guard<std::mutex> lock(queueMutex);
+                acceptingConnections = false;
+                queueCond.notify_all();
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                numReaders++;
+            }
+            auto conn = std::make_shared<Connection>(fd, fd, true);
+            std::thread(&InferenceServer::readRequests, this, conn).detach();
+        }
+    });
+    acceptor.detach();
+    std::cout << "Serving requests on " << path << ".\n";
+    std::vector<Request> batch;
+    while (getNextBatch(batch)) {
+        runBatch(batch);
+        batch.clear();
+    }
+}
+
+}  // namespace smaug
@@ -0,0 +1,140 @@
+#ifndef _CORE_INFERENCE_SERVER_H_
+#define _CORE_INFERENCE_SERVER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "smaug/core/network.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor.pb.h"
+
+namespace smaug {
+
+/**
+ * InferenceServer runs a Network that is loaded and tiled once on a stream of
+ * inputs.
+ *
+ * Each request is a serialized TensorProto with its data set, prefixed by its
+ * size in bytes as a uint32_t in host byte order. It has the shape of the
+ * input Tensor, except that the outermost (batch) dimension can be smaller.
+ * The response is the matching rows of the output Tensor of the Network, in
+ * the same framing. Responses are sent in the order of the requests on each
+ * connection.
+ *
+ * If a request can't be read, is larger than any valid request for the
+ * input Tensor could be, or is invalid, the server stops reading from
+ * the connection. Once the earlier requests are answered, it sends an error
+ * reply and closes the connection. The size prefix of an error reply has the
+ * kErrorReply bit set, and its other bits give the size of the error message
+ * that follows.
+ *
+ * If both the input and the output Tensors are batch-major (N is their
+ * outermost dimension), requests are batched dynamically: the rows of as many
+ * pending requests as fit into the batch dimension of the input Tensor are
+ * run together. After the first request of a batch arrives, the server waits
+ * for up to maxBatchDelayUs microseconds for more requests to fill the batch.
+ */
+class InferenceServer {
+   public:
+    /** Set in the size prefix of an error reply. */
+    static constexpr uint32_t kErrorReply = 0x80000000;
+
+    /**
+     * @param _network The Network to run.
+     * @param _scheduler The Scheduler used to run the Network.
+     * @param _input The Tensor the requests are written to, typically the
+     * output of a Data Operator.
+     * @param _maxBatchDelayUs How long to wait for more requests to fill a
+     * batch.
+     */
+    InferenceServer(Network* _network,
+                    Scheduler* _scheduler,
+                    Tensor* _input,
+                    int _maxBatchDelayUs = 0);
+
+    /**
+     * Serves requests read from inFd, writing the responses to outFd, until
+     * the input ends and every request has been answered.
+     */
+    void serveStream(int inFd, int outFd);
+
+    /**
+     * Serves the clients of a Unix domain socket bound to the given path.
+     * Each client sends its requests and receives its responses on its own
+     * connection. This only returns if the socket can't be set up.
+     */
+    void serveSocket(const std::string& path);
+
+    /** Number of times the Network has been run. */
+    int getNumRuns() const { return numRuns; }
+
+   protected:
+    /** A client stream, whose file descriptors are closed when released. */
+    struct Connection {
+        Connection(int _inFd, int _outFd, bool _ownsFds)
+                : inFd(_inFd), outFd(_outFd), ownsFds(_ownsFds) {}
+        ~Connection();
+        int inFd;
+        int outFd;
+        bool ownsFds;
+    };
+
+    struct Request {
+        std::shared_ptr<Connection> conn;
+        TensorProto tensor;
+        /** Number of rows of the batch dimension in the request. */
+        int batchSize;
+        /**
+         * If not empty, the request was malformed and this error is sent back
+         * instead of a response. The request then has no rows.
+         */
+        std::string error;
+    };
+
+    /** Reads the requests of a connection until it ends. */
+    void readRequests(std::shared_ptr<Connection> conn);
+
+    /** Returns the error in a request, or an empty string if it is valid. */
+    std::string validateRequest(const TensorProto& request) const;
+
+    /**
+     * Waits for the next batch of requests. Returns false once no more
+     * requests can arrive.
+     */
+    bool getNextBatch(std::vector<Request>& batch);
+
+    /** Runs the Network on a batch of requests and sends the responses. */
+    void runBatch(const std::vector<Request>& batch);
+
+    Network* network;
+    Scheduler* scheduler;
+    Tensor* input;
+    /** If true, requests can be batched along the N dimension. */
+    bool canBatch;
+    int maxBatchDelayUs;
+    /**
+     * Largest size of a valid serialized request. Requests with a larger size
+     * prefix are rejected without being read.
+     */
+    size_t maxRequestSize;
+    int numRuns;
+
+    /** Protects the fields below. */
+    std::mutex queueMutex;
+    /** Signaled when a request arrives or a connection ends. */
+    std::condition_variable queueCond;
+    std::deque<Request> pendingRequests;
+    /** Number of connections still being read. */
+    int numReaders;
+    /** If true, new connections can still be made. */
+    bool acceptingConnections;
+};
+
+}  // namespace smaug
+
+#endif
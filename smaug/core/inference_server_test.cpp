@@ -0,0 +1,150 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/inference_server.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/relu_op.h"
+
+using namespace smaug;
+
+// Builds a network that applies a ReLU to an input of [2, 8] shape.
+Tensor* buildReluNetwork(Network* network, Workspace* workspace) {
+    TensorShape shape({ 2, 8 }, DataLayout::NC);
+    Tensor* input = new Tensor("input", shape);
+    input->allocateStorage<float>();
+    workspace->addTensor(input);
+    auto dataOp = new DataOp<ReferenceBackend>("input", workspace);
+    dataOp->setData(input);
+    network->addOperator(dataOp);
+
+    auto relu = new ReluOp<ReferenceBackend>("relu", workspace);
+    relu->setInput(input, 0);
+    relu->createAllTensors();
+    relu->getOutput(0)->allocateStorage<float>();
+    network->addOperator(relu);
+    network->addEdge(dataOp, relu, { 0, 0 });
+    return input;
+}
+
+// Sends a request of the given number of rows, whose values start at first.
+void sendRequest(int fd, int batchSize, float first) {
+    Tensor request("request", TensorShape({ batchSize, 8 }, DataLayout::NC));
+    request.allocateStorage<float>();
+    std::vector<float> values;
+    for (int i = 0; i < request.getShape().size(); i++)
+        values.push_back(first + i);
+    request.fillData(values.data(), values.size());
+    TensorProto* proto = request.asTensorProto();
+    std::string buffer;
+    proto->SerializeToString(&buffer);
+    delete proto;
+    uint32_t size = buffer.size();
+    REQUIRE(write(fd, &size, sizeof(size)) == sizeof(size));
+    REQUIRE(write(fd, buffer.data(), size) == size);
+}
+
+// Receives a response and checks it against the ReLU of the request values.
+void verifyResponse(SmaugTest* test, int fd, int batchSize, float first) {
+    uint32_t size;
+    REQUIRE(read(fd, &size, sizeof(size)) == sizeof(size));
+    std::string buffer(size, '\0');
+    REQUIRE(read(fd, &buffer[0], size) == size);
+    TensorProto proto;
+    REQUIRE(proto.ParseFromString(buffer));
+    Tensor response(proto, proto.data());
+    REQUIRE(response.getShape().dims() == std::vector<int>{ batchSize, 8 });
+    std::vector<float> expectedValues;
+    for (int i = 0; i < batchSize * 8; i++)
+        expectedValues.push_back(std::max(first + i, 0.0f));
+    test->verifyOutputs(&response, expectedValues);
+}
+
+// Receives an error reply and returns its message.
+std::string readErrorReply(int fd) {
+    uint32_t size;
+    REQUIRE(read(fd, &size, sizeof(size)) == sizeof(size));
+    REQUIRE((size & InferenceServer::kErrorReply) != 0);
+    std::string error(size & ~InferenceServer::kErrorReply, '\0');
+    REQUIRE(read(fd, &error[0], error.size()) == error.size());
+    return error;
+}
+
+TEST_CASE_METHOD(SmaugTest, "Inference server", "[server]") {
+    Tensor* input = buildReluNetwork(network(), workspace());
+    Scheduler scheduler(network(), workspace());
+    scheduler.prepareNetwork();
+    // Wait long enough that only full batches and the last request are run
+    // without waiting for the deadline.
+    InferenceServer server(network(), &scheduler, input, 10000000);
+
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    // The first two requests are batched together, the third one fills a
+    // batch on its own, and the last one runs once the input ends.
+    sendRequest(fds[0], 1, -4);
+    sendRequest(fds[0], 1, 10);
+    sendRequest(fds[0], 2, -20);
+    sendRequest(fds[0], 1, -3);
+    shutdown(fds[0], SHUT_WR);
+    server.serveStream(fds[1], fds[1]);
+    REQUIRE(server.getNumRuns() == 3);
+
+    verifyResponse(this, fds[0], 1, -4);
+    verifyResponse(this, fds[0], 1, 10);
+    verifyResponse(this, fds[0], 2, -20);
+    verifyResponse(this, fds[0], 1, -3);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Malformed inference requests", "[server]") {
+    Tensor* input = buildReluNetwork(network(), workspace());
+    Scheduler scheduler(network(), workspace());
+    scheduler.prepareNetwork();
+    InferenceServer server(network(), &scheduler, input);
+
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    // The valid request is still answered before the error reply, and the
+    // request after the malformed one is never read.
+    sendRequest(fds[0], 1, -4);
+    std::string garbage = "not a tensor";
+    uint32_t size = garbage.size();
+    REQUIRE(write(fds[0], &size, sizeof(size)) == sizeof(size));
+    REQUIRE(write(fds[0], garbage.data(), size) == size);
+    sendRequest(fds[0], 1, 10);
+    shutdown(fds[0], SHUT_WR);
+    server.serveStream(fds[1], fds[1]);
+    REQUIRE(server.getNumRuns() == 1);
+
+    verifyResponse(this, fds[0], 1, -4);
+    REQUIRE(readErrorReply(fds[0]) == "failed to read the request");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Oversized inference requests", "[server]") {
+    Tensor* input = buildReluNetwork(network(), workspace());
+    Scheduler scheduler(network(), workspace());
+    scheduler.prepareNetwork();
+    InferenceServer server(network(), &scheduler, input);
+
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    // A size prefix far larger than any request for a [2, 8] input is
+    // rejected without the server waiting for, or allocating, its data.
+    uint32_t size = 1 << 30;
+    REQUIRE(write(fds[0], &size, sizeof(size)) == sizeof(size));
+    shutdown(fds[0], SHUT_WR);
+    server.serveStream(fds[1], fds[1]);
+    REQUIRE(server.getNumRuns() == 0);
+
+    REQUIRE(readErrorReply(fds[0]) == "the request is too large");
+    close(fds[0]);
+    close(fds[1]);
+}
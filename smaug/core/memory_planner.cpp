@@ -0,0 +1,144 @@
+#include <algorithm>
+
+#include "smaug/core/memory_planner.h"
+#include "smaug/operators/common.h"
+#include "smaug/utility/debug_stream.h"
+#include "smaug/utility/utils.h"
+
+namespace smaug {
+
+void MemoryPlanner::addTensor(Tensor* tensor,
+                              Operator* producer,
+                              int outputIdx) {
+    assert(!tensor->containsData() && "The Tensor already has storage!");
+    assert(producer->getOutput(outputIdx) == tensor &&
+           "The Tensor is not the output of the producer!");
+    const Graph& graph = network->getGraph();
+    Buffer buffer;
+    buffer.tensor = tensor;
+    buffer.size = next_multiple(
+            tensor->getShape().storageSize() * tensor->getDataTypeSize(),
+            CACHELINE_SIZE);
+    buffer.offset = 0;
+    buffer.producer = producer->getVertex();
+    out_edge_iter edgeIt, edgeEnd;
+    for (boost::tie(edgeIt, edgeEnd) = out_edges(buffer.producer, graph);
+         edgeIt != edgeEnd;
+         ++edgeIt) {
+        if (get(boost::edge_name, graph, *edgeIt).srcIdx == outputIdx)
+            buffer.consumers.push_back(target(*edgeIt, graph));
+    }
+    buffers.push_back(buffer);
+}
+
+void MemoryPlanner::computeOrder() {
+    const Graph& graph = network->getGraph();
+    int numVertices = boost::num_vertices(graph);
+    position.assign(numVertices, 0);
+    numLeadingAncestors.assign(numVertices, 0);
+    // The visited Operators that none of the other visited ones read from.
+    std::vector<bool> isSink(numVertices, false);
+    int numSinks = 0;
+    std::vector<Operator*> order = network->getTopologicalOrder();
+    for (int i = 0; i < order.size(); i++) {
+        Vertex v = order[i]->getVertex();
+        position[v] = i;
+        int numSinkParents = 0;
+        int numAncestors = 0;
+        in_edge_iter edgeIt, edgeEnd;
+        for (boost::tie(edgeIt, edgeEnd) = in_edges(v, graph);
+             edgeIt != edgeEnd;
+             ++edgeIt) {
+            Vertex parent = source(*edgeIt, graph);
+            // The parent extends its own leading ancestors if it directly
+            // follows them.
+            int parentAncestors = numLeadingAncestors[parent];
+            if (parentAncestors == position[parent])
+                parentAncestors++;
+            numAncestors = std::max(numAncestors, parentAncestors);
+            if (isSink[parent]) {
+                isSink[parent] = false;
+                numSinkParents++;
+            }
+        }
+        // Every visited Operator leads to one of the sinks, so if this one
+        // reads all of them, it comes after everything before it.
+        if (numSinkParents == numSinks)
+            numAncestors = i;
+        numLeadingAncestors[v] = numAncestors;
+        numSinks += 1 - numSinkParents;
+        isSink[v] = true;
+    }
+}
+
+bool MemoryPlanner::isAncestor(Vertex u, Vertex v) const {
+    return position[u] < numLeadingAncestors[v] ||
+           boost::edge(u, v, network->getGraph()).second;
+}
+
+bool MemoryPlanner::canReuse(const Buffer& first, const Buffer& second) const {
+    // A Tensor without readers must be kept until the end.
+    if (first.consumers.empty())
+        return false;
+    for (auto consumer : first.consumers) {
+        if (!isAncestor(consumer, second.producer))
+            return false;
+    }
+    return true;
+}
+
+void MemoryPlanner::allocate() {
+    computeOrder();
+    std::vector<Buffer*> order;
+    for (auto& buffer : buffers)
+        order.push_back(&buffer);
+    std::stable_sort(order.begin(), order.end(), [](Buffer* a, Buffer* b) {
+        return a->size > b->size;
+    });
+
+    arenaSize = 0;
+    naiveSize = 0;
+    std::vector<Buffer*> placed;
+    for (Buffer* buffer : order) {
+        // Collect the placed buffers that are live at the same time as this
+        // one, in increasing order of offsets.
+        std::vector<Buffer*> conflicts;
+        for (Buffer* other : placed) {
+            if (!canReuse(*buffer, *other) && !canReuse(*other, *buffer))
+                conflicts.push_back(other);
+        }
+        std::sort(conflicts.begin(), conflicts.end(), [](Buffer* a, Buffer* b) {
+            return a->offset < b->offset;
+        });
+        // Take the first gap between the conflicting buffers that fits.
+        size_t offset = 0;
+        for (Buffer* other : conflicts) {
+            if (other->offset >= offset + buffer->size)
+                break;
+            offset = std::max(offset, other->offset + other->size);
+        }
+        buffer->offset = offset;
+        placed.push_back(buffer);
+        arenaSize = std::max(arenaSize, offset + buffer->size);
+        naiveSize += buffer->size;
+    }
+
+    if (arenaSize == 0)
+        return;
+    arena = std::shared_ptr<void>(malloc_aligned(arenaSize, false), free);
+    for (auto& buffer : buffers) {
+        char* ptr = reinterpret_cast<char*>(arena.get()) + buffer.offset;
+        // The Tensor shares the ownership of the whole arena.
+        buffer.tensor->setStorage(std::shared_ptr<void>(arena, ptr));
+        dout(1) << "Placed " << buffer.tensor->getName() << " at offset "
+                << buffer.offset << " (" << buffer.size << " bytes).\n";
+    }
+}
+
+void MemoryPlanner::printSummary(std::ostream& out) const {
+    out << "Activation memory: " << arenaSize << " bytes for "
+        << buffers.size() << " tensors (" << naiveSize
+        << " bytes without reuse).\n";
+}
+
+}  // namespace smaug
@@ -0,0 +1,102 @@
+#ifndef _CORE_MEMORY_PLANNER_H_
+#define _CORE_MEMORY_PLANNER_H_
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "smaug/core/network.h"
+#include "smaug/core/tensor.h"
+
+namespace smaug {
+
+/**
+ * MemoryPlanner packs the output Tensors of the Operators in a Network into a
+ * single arena, reusing the memory of Tensors that are no longer needed.
+ *
+ * Two Tensors may share memory if every Operator that reads one of them must
+ * finish before the Operator that writes the other one can start. This only
+ * depends on the edges of the Graph, so the plan is valid for any order the
+ * Operators are scheduled in, including concurrent execution by the
+ * ParallelScheduler. Tensors without any readers in the Graph, like the
+ * output of the Network, are never reused.
+ *
+ * Rather than computing all the ancestors of every Operator, the planner
+ * walks the Graph once in topological order and only finds the ancestors
+ * that are cheap to prove: the parents of an Operator, and the Operators
+ * before the last point in the order where everything before it has been
+ * joined into a single path. This is exact for chains and for branches that
+ * join again, and conservatively keeps memory apart inside branches that run
+ * alongside each other.
+ *
+ * Tensors are placed in decreasing order of size, each at the lowest offset
+ * that doesn't overlap with any Tensor it conflicts with (greedy-by-size).
+ */
+class MemoryPlanner {
+   public:
+    MemoryPlanner(Network* _network)
+            : network(_network), arenaSize(0), naiveSize(0) {}
+
+    /**
+     * Adds a Tensor to the plan. The Tensor must be the output at outputIdx
+     * of the producer, have its data type set, and not have any storage yet.
+     */
+    void addTensor(Tensor* tensor, Operator* producer, int outputIdx);
+
+    /**
+     * Computes the placement of all the added Tensors, and then allocates the
+     * arena and backs every Tensor with its region of it.
+     */
+    void allocate();
+
+    /** Returns the number of bytes in the arena. */
+    size_t getArenaSize() const { return arenaSize; }
+
+    /** Returns the number of bytes needed if no memory were reused. */
+    size_t getNaiveSize() const { return naiveSize; }
+
+    /** Prints the memory usage of the plan. */
+    void printSummary(std::ostream& out) const;
+
+   protected:
+    /** The lifetime and placement of a Tensor in the arena. */
+    struct Buffer {
+        Tensor* tensor;
+        size_t size;
+        size_t offset;
+        /** The Operator writing the Tensor. */
+        Vertex producer;
+        /** The Operators reading the Tensor. */
+        std::vector<Vertex> consumers;
+    };
+
+    /**
+     * Returns true if the memory of the first Buffer can be reused by the
+     * second one, i.e. if all the readers of the first Buffer are ancestors
+     * of the writer of the second one.
+     */
+    bool canReuse(const Buffer& first, const Buffer& second) const;
+
+    /** Returns true if there is a path from u to v in the Graph. */
+    bool isAncestor(Vertex u, Vertex v) const;
+
+    /** Numbers the Operators in topological order. */
+    void computeOrder();
+
+    Network* network;
+    std::vector<Buffer> buffers;
+    /** The position of every Operator in the topological order. */
+    std::vector<int> position;
+    /**
+     * numLeadingAncestors[v] is the number of Operators at the start of the
+     * topological order that are all ancestors of v.
+     */
+    std::vector<int> numLeadingAncestors;
+    std::shared_ptr<void> arena;
+    size_t arenaSize;
+    size_t naiveSize;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,106 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/memory_planner.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/relu_op.h"
+
+using namespace smaug;
+
+class MemoryPlannerTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    // Creates the input of the network, with values from -8 to 7.
+    Operator* addInput() {
+        TensorShape shape({ 1, 16 }, DataLayout::NC);
+        Tensor* input = new Tensor("input", shape);
+        input->allocateStorage<float>();
+        std::vector<float> inputValues;
+        for (int i = 0; i < shape.size(); i++)
+            inputValues.push_back(i - 8);
+        input->fillData(inputValues.data(), inputValues.size());
+        return addDataOp(input);
+    }
+
+    void planMemory() {
+        for (auto nameOp : network()->getOperators()) {
+            Tensor* output = nameOp.second->getOutput(0);
+            if (!output->containsData())
+                planner.addTensor(output, nameOp.second, 0);
+        }
+        planner.allocate();
+    }
+
+    MemoryPlanner planner{ network() };
+};
+
+TEST_CASE_METHOD(MemoryPlannerTest, "Memory planning", "[planner]") {
+    // Every tensor has 16 floats.
+    const size_t tensorSize = 16 * sizeof(float);
+
+    SECTION("A chain of operators") {
+        // input -> relu0 -> relu1 -> relu2 -> relu3. Only the input and the
+        // output of each operator are live at the same time.
+        Operator* last = addInput();
+        for (int i = 0; i < 4; i++) {
+            last = addOp(new ReluOp<ReferenceBackend>(
+                                 "relu" + std::to_string(i), workspace()),
+                         { last });
+        }
+        planMemory();
+        REQUIRE(planner.getNaiveSize() == 4 * tensorSize);
+        REQUIRE(planner.getArenaSize() == 2 * tensorSize);
+
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "relu3");
+        std::vector<float> expectedValues;
+        for (int i = 0; i < 16; i++)
+            expectedValues.push_back(std::max(i - 8, 0));
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("Independent branches running in parallel") {
+        //           input
+        //        /  |   |  \
+        //    relu0 relu1 relu2 relu3
+        //        \  /     \  /
+        //        add0     add1
+        //           \     /
+        //            add2
+        // The four branches and the two first additions may all run at the
+        // same time, so only the output of the last addition can reuse
+        // memory.
+        Operator* input = addInput();
+        std::vector<Operator*> relus;
+        for (int i = 0; i < 4; i++) {
+            relus.push_back(addOp(new ReluOp<ReferenceBackend>(
+                                          "relu" + std::to_string(i),
+                                          workspace()),
+                                  { input }));
+        }
+        auto add0 =
+                addOp(new EltwiseAddOp<ReferenceBackend>("add0", workspace()),
+                      { relus[0], relus[1] });
+        auto add1 =
+                addOp(new EltwiseAddOp<ReferenceBackend>("add1", workspace()),
+                      { relus[2], relus[3] });
+        addOp(new EltwiseAddOp<ReferenceBackend>("add2", workspace()),
+              { add0, add1 });
+        planMemory();
+        REQUIRE(planner.getNaiveSize() == 7 * tensorSize);
+        REQUIRE(planner.getArenaSize() == 6 * tensorSize);
+
+        ParallelScheduler scheduler(network(), workspace(), 4);
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add2");
+        std::vector<float> expectedValues;
+        for (int i = 0; i < 16; i++)
+            expectedValues.push_back(4 * std::max(i - 8, 0));
+        verifyOutputs(output, expectedValues);
+    }
+}
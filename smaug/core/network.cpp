@@ -21,6 +21,53 @@ void Network::addEdge(Operator* src, Operator* dest, TensorIndices indices) {
     add_edge(src->getVertex(), dest->getVertex(), EdgeProperty(indices), graph);
 }
 
+void Network::removeOperator(Operator* op) {
+    Vertex v = op->getVertex();
+    clear_vertex(v, graph);
+    remove_vertex(v, graph);
+    operators.erase(op->getName());
+    delete op;
+    // Removing a vertex renumbers all the vertices after it.
+    vertex_iter vertexIt, vertexEnd;
+    for (boost::tie(vertexIt, vertexEnd) = vertices(graph);
+         vertexIt != vertexEnd;
+         ++vertexIt) {
+        get(boost::vertex_op, graph, *vertexIt)->setVertex(*vertexIt);
+    }
+}
+
+void Network::replaceOperator(Operator* op, Operator* producer, int srcIdx) {
+    ConsumerList consumers = getConsumers(op);
+    removeOperator(op);
+    for (auto& consumer : consumers) {
+        int destIdx = consumer.second.destIdx;
+        consumer.first->setInput(producer->getOutput(srcIdx), destIdx);
+        addEdge(producer, consumer.first, { srcIdx, destIdx });
+    }
+}
+
+Network::ConsumerList Network::getConsumers(Operator* op) const {
+    ConsumerList consumers;
+    out_edge_iter outEdgeIt, outEdgeEnd;
+    for (boost::tie(outEdgeIt, outEdgeEnd) = out_edges(op->getVertex(), graph);
+         outEdgeIt != outEdgeEnd;
+         ++outEdgeIt) {
+        consumers.push_back(
+                { get(boost::vertex_op, graph, target(*outEdgeIt, graph)),
+                  get(boost::edge_name, graph, *outEdgeIt) });
+    }
+    return consumers;
+}
+
+std::vector<Operator*> Network::getTopologicalOrder() const {
+    std::list<Vertex> vertices;
+    boost::topological_sort(graph, std::front_inserter(vertices));
+    std::vector<Operator*> ops;
+    for (auto v : vertices)
+        ops.push_back(get(boost::vertex_op, graph, v));
+    return ops;
+}
+
 void Network::dumpDataflowGraph() const {
     std::ofstream out(name + "_dataflow_graph.dot", std::ofstream::out);
     write_graphviz(out, graph, DataflowGraphWriter(graph));
@@ -41,6 +41,9 @@ class Network {
     typedef std::map<std::string, Operator*> OperatorMap;
 
    public:
+    /** The Operators reading the outputs of an Operator, with their edges. */
+    typedef std::vector<std::pair<Operator*, TensorIndices>> ConsumerList;
+
     Network(std::string _name) : name(_name) {}
     ~Network() {
         for (auto& op : operators)
@@ -49,6 +52,26 @@ class Network {
 
     void addOperator(Operator* op);
     void addEdge(Operator* src, Operator* dest, TensorIndices indices);
+    /**
+     * Removes the Operator and all of its edges from the Network, and deletes
+     * it. Its output tensors are left in the Workspace.
+     */
+    void removeOperator(Operator* op);
+    /**
+     * Moves the consumers of the Operator's outputs to the given output of
+     * the producer, and removes the Operator from the Network.
+     */
+    void replaceOperator(Operator* op, Operator* producer, int srcIdx);
+    /**
+     * Returns the Operators reading the outputs of the Operator, along with
+     * the indices of the tensors they read.
+     */
+    ConsumerList getConsumers(Operator* op) const;
+    /**
+     * Returns the Operators in topological order. Graph passes save this
+     * before they start removing Operators.
+     */
+    std::vector<Operator*> getTopologicalOrder() const;
     const OperatorMap& getOperators() const { return operators; }
     Operator* getOperator(const std::string& name) {
         return operators.at(name);
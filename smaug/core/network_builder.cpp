@@ -1,20 +1,26 @@
 #include <iostream>
 #include <fstream>
 #include <fcntl.h>
+#include <unordered_map>
 
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
+#include "smaug/core/memory_planner.h"
 #include "smaug/core/network.h"
 #include "smaug/core/network_builder.h"
+#include "smaug/core/operator_fusion.h"
+#include "smaug/core/param_archive.h"
+#include "smaug/core/reorder_elimination.h"
 #include "smaug/core/workspace.h"
 #include "smaug/core/graph.pb.h"
 #include "smaug/core/node.pb.h"
 #include "smaug/core/tensor.pb.h"
 #include "smaug/core/types.pb.h"
 #include "smaug/operators/common.h"
+#include "smaug/operators/batch_mat_mul_op.h"
 #include "smaug/operators/batch_norm_op.h"
 #include "smaug/operators/convolution_op.h"
 #include "smaug/operators/data_op.h"
@@ -26,6 +32,7 @@
 #include "smaug/operators/control_flow_ops.h"
 #include "smaug/operators/elu_op.h"
 #include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/lstm_op.h"
 #include "smaug/operators/pooling_op.h"
 #include "smaug/operators/relu_op.h"
 #include "smaug/operators/reorder_op.h"
@@ -37,6 +44,7 @@
 #include "smaug/operators/softmax_op.h"
 #include "smaug/operators/tanh_op.h"
 #include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_op.h"
 #include "smaug/operators/smv/smv_inner_product_op.h"
 #include "smaug/operators/smv/smv_pooling_op.h"
 #include "smaug/operators/smv/smv_batch_norm_op.h"
@@ -49,6 +57,8 @@
 #include "smaug/operators/smv/smv_eltwise_mul_op.h"
 #include "smaug/operators/smv/smv_less_op.h"
 #include "smaug/operators/smv/smv_greater_op.h"
+#include "smaug/operators/smv/smv_lstm_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_op.h"
 #include "smaug/utility/utils.h"
 #include "smaug/utility/debug_stream.h"
 
@@ -94,11 +104,88 @@ ActivationInfo getActivationInfo(const ActivationParams& params) {
     return actInfo;
 }
 
+// The values of the tensors of a model, read from either a TensorDataArray
+// protobuf or a memory-mapped ParamArchive.
+class ModelParams {
+   public:
+    // Reads the parameters file, exiting if it can't be read.
+    ModelParams(const std::string& modelParams) {
+        if (ParamArchive::isParamArchive(modelParams)) {
+            archive = std::make_shared<ParamArchive>();
+            if (!archive->open(modelParams)) {
+                cout << "Failed to map the network parameters archive.\n";
+                exit(1);
+            }
+            return;
+        }
+        fstream modelParamsFile(modelParams, ios::in | ios::binary);
+        if (!modelParamsFile) {
+            cout << modelParams << ": network parameters file not found."
+                 << endl;
+            exit(1);
+        } else if (!tensorDataArray.ParseFromIstream(&modelParamsFile)) {
+            cout << "Failed to parse the network parameters file.\n";
+            exit(1);
+        }
+        for (int i = 0; i < tensorDataArray.data_array_size(); i++) {
+            const TensorData& tensorData = tensorDataArray.data_array(i);
+            tensorDataIndex.emplace(tensorData.name(), &tensorData);
+        }
+    }
+
+    // Creates the tensor described by the proto, filled with its values. A
+    // tensor from an archive uses the mapped data in place. A tensor without
+    // any parameters is created the same way from either kind of file; the
+    // converter leaves such tensors out of archives.
+    Tensor* createTensor(const TensorProto& tensorProto) {
+        if (!archive) {
+            auto it = tensorDataIndex.find(tensorProto.name());
+            if (it == tensorDataIndex.end())
+                return new Tensor(tensorProto, TensorData());
+            std::string error =
+                    Tensor::validateRawData(tensorProto, *it->second);
+            if (!error.empty()) {
+                cout << "Invalid parameters of " << tensorProto.name() << ": "
+                     << error << ".\n";
+                exit(1);
+            }
+            return new Tensor(tensorProto, *it->second);
+        }
+        DataType dataType;
+        size_t size;
+        void* data = archive->getData(tensorProto.name(), &dataType, &size);
+        if (!data)
+            return new Tensor(tensorProto, TensorData());
+        Tensor* tensor = new Tensor(tensorProto.name(), tensorProto.shape());
+        tensor->setDataType(tensorProto.data_type());
+        if (dataType != tensorProto.data_type()) {
+            cout << "The archived data of " << tensorProto.name()
+                 << " is " << DataType_Name(dataType) << ", but the tensor is "
+                 << DataType_Name(tensorProto.data_type()) << ".\n";
+            exit(1);
+        }
+        if (size < tensor->getShape().storageSize() *
+                           tensor->getDataTypeSize()) {
+            cout << "The archived data of " << tensorProto.name()
+                 << " is smaller than the tensor.\n";
+            exit(1);
+        }
+        // The tensor keeps the whole mapping alive.
+        tensor->setStorage(std::shared_ptr<void>(archive, data));
+        return tensor;
+    }
+
+   protected:
+    std::shared_ptr<ParamArchive> archive;
+    TensorDataArray tensorDataArray;
+    std::unordered_map<std::string, const TensorData*> tensorDataIndex;
+};
+
 // Create an operator by deserializing a node in the graph, and add it to the
 // network.
 template <typename Backend>
 static void createAndAddOperator(const NodeProto& node,
-                                 const TensorDataArray& tensorDataArray,
+                                 ModelParams& modelParams,
                                  HostMemoryAccessPolicy memPolicy,
                                  Network* network,
                                  Workspace* workspace) {
@@ -108,17 +195,8 @@ static void createAndAddOperator(const NodeProto& node,
     dout(0) << "Adding " << name << " (" << OpType_Name(type) << ").\n";
 
     if (type == OpType::Data) {
-        // Find the tensor data from the tensor data array.
-        TensorData tensorData;
-        for (int i = 0; i < tensorDataArray.data_array_size(); i++) {
-            if (tensorDataArray.data_array(i).name() ==
-                node.input_tensors(0).name()) {
-                tensorData = tensorDataArray.data_array(i);
-                break;
-            }
-        }
         auto inputTensor = workspace->addTensor(
-                new Tensor(node.input_tensors(0), tensorData));
+                modelParams.createTensor(node.input_tensors(0)));
         auto inputTensorOp = Backend::createDataOp(name, workspace);
         inputTensorOp->setData(inputTensor);
         network->addOperator(inputTensorOp);
@@ -240,6 +318,20 @@ static void createAndAddOperator(const NodeProto& node,
         auto op = Backend::createMergeOp(name, workspace);
         op->setNumInputs(node.input_tensors_size());
         network->addOperator(op);
+    } else if (type == OpType::Lstm) {
+        auto op = Backend::createLstmOp(name, workspace);
+        if (node.params().has_act_params())
+            op->setActivation(getActivationInfo(node.params().act_params()));
+        // The outputs of all the timesteps are only produced if the graph
+        // uses them.
+        op->setReturnSequences(node.output_tensors_size() == 3);
+        op->setGoBackwards(node.params().lstm_params().go_backwards());
+        network->addOperator(op);
+    } else if (type == OpType::BatchMatMul) {
+        auto op = Backend::createBatchMatMulOp(name, workspace);
+        op->setTransposeB(
+                node.params().batch_mat_mul_params().transpose_b());
+        network->addOperator(op);
     } else if (type == OpType::ReLU) {
         auto op = Backend::createReluOp(name, workspace);
         network->addOperator(op);
@@ -295,17 +387,14 @@ static void createAndAddOperator(const NodeProto& node,
         assert(false && "Invalid host memory access policy!");
     }
 
-    // Create the output tensors and allocate storage for them.
-    // TODO: The tensor storage allocation can be deferred until scheduling
-    // time, which can benefit future control flow operators because the untaken
-    // branch of the control flow will not have that memory allocated and
-    // filled.
+    // Create the output tensors. Their storage is allocated by the
+    // MemoryPlanner once the whole graph is known.
     for (int i = 0; i < op->getOutputs().size(); i++) {
         if (!op->getOutput(i)) {
             const TensorProto& tensorProto = node.output_tensors(i);
             Tensor* output = workspace->addTensor(
                     new Tensor(tensorProto.name(), tensorProto.shape()));
-            output->allocateStorage(tensorProto.data_type());
+            output->setDataType(tensorProto.data_type());
             op->setOutput(output, i);
         }
     }
@@ -315,7 +404,7 @@ static void createAndAddOperator(const NodeProto& node,
 // protobuf model.
 template <typename Backend>
 static Network* createNetworkFromProto(const GraphProto& graphProto,
-                                       const TensorDataArray& tensorDataArray,
+                                       ModelParams& modelParams,
                                        SamplingInfo& sampling,
                                        Workspace* workspace) {
     Network* network = new Network(graphProto.name());
@@ -323,7 +412,7 @@ static Network* createNetworkFromProto(const GraphProto& graphProto,
     for (int i = 0; i < graphProto.nodes_size(); i++) {
         const NodeProto& node = graphProto.nodes(i);
         createAndAddOperator<Backend>(node,
-                                      tensorDataArray,
+                                      modelParams,
                                       graphProto.mem_policy(),
                                       network,
                                       workspace);
@@ -363,6 +452,33 @@ static Network* createNetworkFromProto(const GraphProto& graphProto,
         }
     }
 
+    // Remove the layout reorders the network doesn't need. This goes first,
+    // since it can place activations right after their producers.
+    int numReorders = eliminateReorders<Backend>(network);
+    if (numReorders > 0)
+        dout(0) << "Eliminated " << numReorders << " reorder operators.\n";
+
+    // Fold batch norms and standalone activation functions into the
+    // operators producing their inputs, before their outputs are given any
+    // memory.
+    int numFused = fuseOperators<Backend>(network);
+    if (numFused > 0)
+        dout(0) << "Fused " << numFused << " operators into their producers.\n";
+
+    // Allocate all the output tensors from a shared arena, reusing the memory
+    // of tensors that are no longer needed.
+    MemoryPlanner planner(network);
+    for (auto nameOp : network->getOperators()) {
+        Operator* op = nameOp.second;
+        for (int i = 0; i < op->getOutputs().size(); i++) {
+            Tensor* tensor = op->getOutput(i);
+            if (tensor && !tensor->containsData())
+                planner.addTensor(tensor, op, i);
+        }
+    }
+    planner.allocate();
+    planner.printSummary(cout);
+
     return network;
 }
 
@@ -382,16 +498,9 @@ Network* smaug::buildNetwork(const std::string& modelTopo,
         cout << "Failed to parse the network topology file!" << endl;
         exit(1);
     }
-    // Parse the network parameters from the protobuf binary file.
-    TensorDataArray tensorDataArray;
-    fstream modelParamsFile(modelParams, ios::in | ios::binary);
-    if (!modelParamsFile) {
-        cout << modelParams << ": network parameters file not found." << endl;
-        exit(1);
-    } else if (!tensorDataArray.ParseFromIstream(&modelParamsFile)) {
-        cout << "Failed to parse the network parameters file.\n";
-        exit(1);
-    }
+    // Read the network parameters from the protobuf binary file or map them
+    // from a parameter archive.
+    ModelParams params(modelParams);
 
     cout << "======================================================\n";
     cout << "      Loading the network model...\n";
@@ -399,10 +508,10 @@ Network* smaug::buildNetwork(const std::string& modelTopo,
     Network* network = nullptr;
     if (graph.backend() == ReferenceBackend::Name) {
         network = createNetworkFromProto<ReferenceBackend>(
-                graph, tensorDataArray, sampling, workspace);
+                graph, params, sampling, workspace);
     } else if (graph.backend() == SmvBackend::Name) {
         network = createNetworkFromProto<SmvBackend>(
-                graph, tensorDataArray, sampling, workspace);
+                graph, params, sampling, workspace);
     } else {
         assert(false && "Unknown backend!");
     }
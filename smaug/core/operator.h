@@ -1,6 +1,7 @@
 #ifndef _CORE_OPERATOR_H_
 #define _CORE_OPERATOR_H_
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
@@ -90,6 +91,23 @@ class Operator {
     virtual bool isSamplingSupported() const { return false; }
     virtual void setSamplingInfo(const SamplingInfo& sampling) {}
 
+    /**
+     * Returns the TiledTensor that tiles the specified input Tensor into
+     * rectangular regions, or nullptr if this Operator doesn't tile it this
+     * way. This is only valid after tile() has been called.
+     *
+     * Operators that override this and getTiledOutput() can have their tiles
+     * passed directly to each other by fuseTiledOperators().
+     */
+    virtual TiledTensor* getTiledInput(int index) { return nullptr; }
+
+    /**
+     * Returns the TiledTensor that tiles the specified output Tensor into
+     * rectangular regions, or nullptr if this Operator doesn't tile it this
+     * way.
+     */
+    virtual TiledTensor* getTiledOutput(int index) { return nullptr; }
+
     void printSummary(std::ostream& out) const;
     void setInput(TensorBase* op, int index) { inputs[index] = op; }
     void setOutput(TensorBase* op, int index) { outputs[index] = op; }
@@ -100,7 +118,11 @@ class Operator {
      * */
     void setNumPendingInputs(int num) { numPendingInputs = num; }
     int getNumPendingInputs() const { return numPendingInputs; }
-    void decrNumPendingInputs() { numPendingInputs--; }
+    /**
+     * Atomically decrements the number of pending inputs and returns the
+     * remaining count, so that exactly one caller observes it reach zero.
+     */
+    int decrNumPendingInputs() { return --numPendingInputs; }
     const std::string& getName() const { return name; }
     Vertex getVertex() const { return vertex; }
     void setVertex(Vertex v) { vertex = v; }
@@ -147,7 +169,7 @@ class Operator {
     Workspace* workspace;
     /** The number of tensors that this operator is waiting on before it can be
      * scheduled. */
-    int numPendingInputs;
+    std::atomic<int> numPendingInputs;
     /** The memory interface over which input activations are expected to arrive. */
     MemoryType inputsMemType;
     /** The memory interface over which weights are expected to arrive. */
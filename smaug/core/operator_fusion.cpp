@@ -0,0 +1,311 @@
+#include <type_traits>
+#include <vector>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/operator_fusion.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/core/workspace.h"
+#include "smaug/operators/batch_norm_op.h"
+#include "smaug/operators/convolution_op.h"
+#include "smaug/operators/elu_op.h"
+#include "smaug/operators/fused_activation_op.h"
+#include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/relu_op.h"
+#include "smaug/operators/tanh_op.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+// Returns the activation function computed by the operator, or NO_ACTIVATION
+// if it is not an activation operator that can be fused.
+template <typename Backend>
+static ActivationInfo getFusableActivation(Operator* op) {
+    ActivationInfo actInfo;
+    switch (op->getOpType()) {
+        case OpType::ReLU: {
+            auto reluOp = dynamic_cast<ReluOp<Backend>*>(op);
+            actInfo.params.slope = reluOp->getSlope();
+            actInfo.function = actInfo.params.slope > 0
+                                       ? activation_type::LRELU
+                                       : activation_type::RELU;
+            break;
+        }
+        case OpType::ELU:
+            actInfo.function = activation_type::ELU;
+            actInfo.params.alpha =
+                    dynamic_cast<EluOp<Backend>*>(op)->getAlpha();
+            break;
+        case OpType::SELU: {
+            auto seluOp = dynamic_cast<SeluOp<Backend>*>(op);
+            actInfo.function = activation_type::SELU;
+            actInfo.params.alpha = seluOp->getAlpha();
+            actInfo.params.lambda = seluOp->getLambda();
+            break;
+        }
+        case OpType::Tanh:
+            actInfo.function = activation_type::TANH;
+            break;
+        case OpType::HardTanh: {
+            auto hardTanhOp = dynamic_cast<HardTanhOp<Backend>*>(op);
+            actInfo.function = activation_type::HARD_TANH;
+            actInfo.params.min = hardTanhOp->getMin();
+            actInfo.params.max = hardTanhOp->getMax();
+            break;
+        }
+        case OpType::Sigmoid:
+            actInfo.function = activation_type::SIGMOID;
+            break;
+        default:
+            break;
+    }
+    return actInfo;
+}
+
+// Returns the operator if all its backend implementations apply a fused
+// activation function, or nullptr otherwise.
+static FusedActivationOp* getActivationFusionTarget(Operator* op) {
+    switch (op->getOpType()) {
+        case OpType::Convolution3d:
+        case OpType::InnerProduct:
+        case OpType::BatchNorm:
+        case OpType::EltwiseAdd:
+            return dynamic_cast<FusedActivationOp*>(op);
+        default:
+            return nullptr;
+    }
+}
+
+// Returns the Data operator that provides the given input of the operator, if
+// it has data and the operator is its only consumer. Otherwise, returns
+// nullptr.
+static Operator* getPrivateDataInput(const Graph& graph,
+                                     Operator* op,
+                                     int destIdx) {
+    in_edge_iter inEdgeIt, inEdgeEnd;
+    for (boost::tie(inEdgeIt, inEdgeEnd) = in_edges(op->getVertex(), graph);
+         inEdgeIt != inEdgeEnd;
+         ++inEdgeIt) {
+        if (get(boost::edge_name, graph, *inEdgeIt).destIdx != destIdx)
+            continue;
+        Vertex source = boost::source(*inEdgeIt, graph);
+        Operator* dataOp = get(boost::vertex_op, graph, source);
+        if (dataOp->getOpType() != OpType::Data ||
+            boost::out_degree(source, graph) != 1 ||
+            !dataOp->getOutput(0)->containsData())
+            return nullptr;
+        return dataOp;
+    }
+    return nullptr;
+}
+
+// Folds the batch norm into the weights, where channel c of the weights is
+// made of `rows` runs of `cols` elements, `channelStride` elements apart from
+// those of channel c + 1 and `rowStride` elements apart from each other.
+// The weights are scaled by gamma / sqrt(var + eps) per channel, and the bias
+// gets the rest of the batch norm: beta - mean * gamma / sqrt(var + eps).
+template <typename DType>
+static void foldBatchNormParams(Tensor* weights,
+                                Tensor* mean,
+                                Tensor* recipSqrtVar,
+                                Tensor* gamma,
+                                Tensor* beta,
+                                Tensor* bias,
+                                int numChannels,
+                                int channelStride,
+                                int rows,
+                                int rowStride,
+                                int cols) {
+    DType* weightData = weights->data<DType>();
+    DType* biasData = bias->allocateStorage<DType>();
+    const DType* meanData = mean->data<DType>();
+    const DType* varData = recipSqrtVar->data<DType>();
+    const DType* gammaData = gamma->data<DType>();
+    const DType* betaData = beta->data<DType>();
+    for (int i = 0; i < bias->getShape().storageSize(); i++)
+        biasData[i] = fromFloat<DType>(0);
+    for (int c = 0; c < numChannels; c++) {
+        float scale = toFloat(varData[c]) * toFloat(gammaData[c]);
+        biasData[c] = fromFloat<DType>(toFloat(betaData[c]) -
+                                       toFloat(meanData[c]) * scale);
+        for (int i = 0; i < rows; i++) {
+            DType* row = weightData + c * channelStride + i * rowStride;
+            for (int j = 0; j < cols; j++)
+                row[j] = fromFloat<DType>(toFloat(row[j]) * scale);
+        }
+    }
+    weights->bumpDataVersion();
+}
+
+// Folds a batch norm into the convolution or inner product that produces its
+// input, if the producer's weights are constant and nothing else reads its
+// output. Returns true if the batch norm was removed.
+template <typename Backend>
+static bool foldBatchNorm(Network* network, Operator* bnOp) {
+    typedef BatchNormOp<Backend> BN;
+    const Graph& graph = network->getGraph();
+    Vertex bnVertex = bnOp->getVertex();
+    Operator* producer = nullptr;
+    int srcIdx = 0;
+    in_edge_iter inEdgeIt, inEdgeEnd;
+    for (boost::tie(inEdgeIt, inEdgeEnd) = in_edges(bnVertex, graph);
+         inEdgeIt != inEdgeEnd;
+         ++inEdgeIt) {
+        const TensorIndices& indices = get(boost::edge_name, graph, *inEdgeIt);
+        if (indices.destIdx == BN::Inputs) {
+            producer = get(boost::vertex_op, graph, source(*inEdgeIt, graph));
+            srcIdx = indices.srcIdx;
+        }
+    }
+    if (!producer || boost::out_degree(producer->getVertex(), graph) != 1)
+        return false;
+
+    auto convOp = dynamic_cast<ConvolutionOp<Backend>*>(producer);
+    auto fcOp = dynamic_cast<InnerProductOp<Backend>*>(producer);
+    // Depthwise convolutions are ConvolutionOps too, but their kernels don't
+    // add a bias. Neither does the systolic array.
+    if (producer->getOpType() == OpType::Convolution3d) {
+        if (std::is_same<Backend, SmvBackend>::value &&
+            useSystolicArrayWhenAvailable)
+            return false;
+    } else if (producer->getOpType() != OpType::InnerProduct) {
+        return false;
+    }
+    FusedActivationOp* fusedOp = dynamic_cast<FusedActivationOp*>(producer);
+    if (fusedOp->getActivation().function != activation_type::NO_ACTIVATION ||
+        (convOp && convOp->getBias()) || (fcOp && fcOp->getBias()))
+        return false;
+
+    int weightsIdx = convOp ? (int)ConvolutionOp<Backend>::Kernels
+                            : (int)InnerProductOp<Backend>::Weights;
+    Operator* weightsOp = getPrivateDataInput(graph, producer, weightsIdx);
+    if (!weightsOp)
+        return false;
+    std::vector<Operator*> paramOps;
+    std::vector<Tensor*> params;
+    for (int i = BN::Mean; i <= BN::Beta; i++) {
+        Operator* paramOp = getPrivateDataInput(graph, bnOp, i);
+        if (!paramOp)
+            return false;
+        paramOps.push_back(paramOp);
+        params.push_back(paramOp->getOutput(0));
+    }
+    Tensor* weights = weightsOp->getOutput(0);
+    DataType dataType = weights->getDataType();
+    for (Tensor* param : params) {
+        if (param->getDataType() != dataType)
+            return false;
+    }
+    if (dataType != DataType::Float32 && dataType != DataType::Float16)
+        return false;
+
+    // Find how the channels are laid out in the weights.
+    const TensorShape& shape = weights->getShape();
+    int numChannels, channelStride, rows, rowStride, cols;
+    if (convOp) {
+        // The kernels are in NCHW or NHWC, with the output channels outermost.
+        numChannels = convOp->getNumOfmaps();
+        channelStride = shape.storageSize() / shape[0];
+        rows = 1;
+        rowStride = channelStride;
+        cols = channelStride;
+    } else if (shape.getLayout() == DataLayout::NC) {
+        // Transposed weights: one row per neuron.
+        numChannels = fcOp->getNumOutputs();
+        channelStride = shape.getStorageDim(1);
+        rows = 1;
+        rowStride = channelStride;
+        cols = shape[1];
+    } else {
+        // One column per neuron.
+        numChannels = fcOp->getNumOutputs();
+        channelStride = 1;
+        rows = shape[0];
+        rowStride = shape.getStorageDim(1);
+        cols = 1;
+    }
+    for (Tensor* param : params) {
+        if (param->getShape().size() != numChannels)
+            return false;
+    }
+
+    Tensor* bias = new Tensor(
+            producer->getName() + "/bias",
+            TensorShape({ 1, numChannels }, DataLayout::NC, Backend::Alignment));
+    if (dataType == DataType::Float32) {
+        foldBatchNormParams<float>(weights, params[0], params[1], params[2],
+                                   params[3], bias, numChannels, channelStride,
+                                   rows, rowStride, cols);
+    } else {
+        foldBatchNormParams<float16>(weights, params[0], params[1], params[2],
+                                     params[3], bias, numChannels,
+                                     channelStride, rows, rowStride, cols);
+    }
+    producer->getWorkspace()->addTensor(bias);
+    if (convOp)
+        convOp->setBias(bias);
+    else
+        fcOp->setBias(bias);
+    fusedOp->setActivation(
+            dynamic_cast<FusedActivationOp*>(bnOp)->getActivation());
+
+    dout(1) << "Folded " << bnOp->getName() << " into "
+            << producer->getName() << ".\n";
+    // Remove the batch norm and the Data operators of its parameters, which
+    // nothing reads anymore.
+    network->replaceOperator(bnOp, producer, srcIdx);
+    for (Operator* paramOp : paramOps)
+        network->removeOperator(paramOp);
+    return true;
+}
+
+template <typename Backend>
+int fuseOperators(Network* network) {
+    const Graph& graph = network->getGraph();
+    int numFused = 0;
+    // Batch norms go first, so that the activation functions that follow them
+    // can then be fused into the folded operators. The parameters of a batch
+    // norm come before it in the order, so removing them doesn't affect the
+    // operators left to visit.
+    for (Operator* op : network->getTopologicalOrder()) {
+        if (op->getOpType() == OpType::BatchNorm &&
+            foldBatchNorm<Backend>(network, op))
+            numFused++;
+    }
+
+    // Chains are fused from their heads.
+    for (Operator* actOp : network->getTopologicalOrder()) {
+        ActivationInfo actInfo = getFusableActivation<Backend>(actOp);
+        if (actInfo.function == activation_type::NO_ACTIVATION)
+            continue;
+        Vertex actVertex = actOp->getVertex();
+        if (boost::in_degree(actVertex, graph) != 1)
+            continue;
+        in_edge_iter inEdgeIt, inEdgeEnd;
+        boost::tie(inEdgeIt, inEdgeEnd) = in_edges(actVertex, graph);
+        Operator* producer =
+                get(boost::vertex_op, graph, source(*inEdgeIt, graph));
+        int srcIdx = get(boost::edge_name, graph, *inEdgeIt).srcIdx;
+        FusedActivationOp* fusedOp = getActivationFusionTarget(producer);
+        // The output of the producer must not be seen by anyone else before
+        // the activation is applied.
+        if (!fusedOp ||
+            fusedOp->getActivation().function !=
+                    activation_type::NO_ACTIVATION ||
+            boost::out_degree(producer->getVertex(), graph) != 1)
+            continue;
+
+        dout(1) << "Fused the activation function of " << actOp->getName()
+                << " into " << producer->getName() << ".\n";
+        fusedOp->setActivation(actInfo);
+        // Redirect the consumers of the activation to the producer.
+        network->replaceOperator(actOp, producer, srcIdx);
+        numFused++;
+    }
+    return numFused;
+}
+
+template int fuseOperators<ReferenceBackend>(Network* network);
+template int fuseOperators<SmvBackend>(Network* network);
+
+}  // namespace smaug
@@ -0,0 +1,45 @@
+#ifndef _CORE_OPERATOR_FUSION_H_
+#define _CORE_OPERATOR_FUSION_H_
+
+#include "smaug/core/network.h"
+
+namespace smaug {
+
+/**
+ * fuseOperators folds batch norms and standalone activation Operators into the
+ * Operators that produce their inputs, which saves one pass over the whole
+ * tensor per folded Operator.
+ *
+ * A batch norm is folded into a convolution or inner product that produces its
+ * input: the weights are scaled by gamma / sqrt(var + eps) per output channel,
+ * and the producer adds the remaining shift as a per-channel bias before its
+ * activation function. The producer also takes over the activation function
+ * of the batch norm. This needs constant weights and batch norm parameters
+ * (Data Operators that nothing else reads), a producer with no activation or
+ * bias of its own, and the batch norm as the only reader of its output.
+ * Depthwise convolutions and the SMV systolic array are not supported.
+ *
+ * Activation Operators (ReLU, ELU, SELU, Tanh, HardTanh and Sigmoid) are then
+ * fused into their producers, which apply the activation function to their
+ * results before writing them out (see FusedActivationOp). An activation is
+ * fused only if its producer is a convolution, inner product, batch norm or
+ * elementwise addition with no activation of its own, and the activation is
+ * the only reader of the producer's output. Together, this turns conv->BN->ReLU
+ * and FC->BN->activation into a single Operator, and residual
+ * eltwise-add->ReLU into one.
+ *
+ * The consumers of a folded Operator read the producer's output instead, and
+ * the folded Operator is removed from the Network.
+ *
+ * This must be called after the inputs of all the Operators are connected,
+ * and before their output tensors are allocated or tiled.
+ *
+ * @tparam Backend The Backend of the Operators in the Network.
+ * @return The number of folded batch norm and activation Operators.
+ */
+template <typename Backend>
+int fuseOperators(Network* network);
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,259 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/operator_fusion.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/batch_norm_op.h"
+#include "smaug/operators/convolution_op.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/elu_op.h"
+#include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/relu_op.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class OperatorFusionTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+    using SmaugTest::addDataOp;
+
+    Operator* addDataOp(const std::string& name, float offset) {
+        std::vector<float> values;
+        for (int i = 0; i < 16; i++)
+            values.push_back(i + offset);
+        return addDataOp(name, TensorShape({ 1, 16 }, DataLayout::NC), values);
+    }
+
+    Operator* addDataOp(const std::string& name,
+                        const TensorShape& shape,
+                        std::vector<float> values) {
+        Tensor* tensor = new Tensor(name, shape);
+        tensor->allocateStorage<float>();
+        tensor->fillData(values.data(), values.size());
+        return addDataOp(tensor);
+    }
+
+    // Adds the mean, 1/sqrt(var + eps), gamma and beta of a batch norm over
+    // the given number of channels, and the batch norm itself.
+    BatchNormOp<ReferenceBackend>* addBatchNormOp(Operator* input,
+                                                  int numChannels) {
+        TensorShape shape({ 1, numChannels }, DataLayout::NC);
+        std::vector<float> mean, recipSqrtVar, gamma, beta;
+        for (int c = 0; c < numChannels; c++) {
+            mean.push_back(0.1 * c - 0.3);
+            recipSqrtVar.push_back(0.5 + 0.1 * c);
+            gamma.push_back(1 - 0.05 * c);
+            beta.push_back(0.2 - 0.03 * c);
+        }
+        return addOp(new BatchNormOp<ReferenceBackend>("bn", workspace()),
+                     { input, addDataOp("mean", shape, mean),
+                       addDataOp("variance", shape, recipSqrtVar),
+                       addDataOp("gamma", shape, gamma),
+                       addDataOp("beta", shape, beta) });
+    }
+
+    // Returns the values of the network's output, in the order of its index
+    // iterator.
+    std::vector<float> runNetwork(const std::string& outputName) {
+        allocateOutputs<float>();
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == outputName);
+        std::vector<float> values;
+        float* data = output->data<float>();
+        for (auto idx = output->startIndex(); !idx.end(); ++idx)
+            values.push_back(data[idx]);
+        return values;
+    }
+
+    // Returns values from -1 to 1 that don't repeat too often.
+    static std::vector<float> getTestValues(int size, int step) {
+        std::vector<float> values;
+        for (int i = 0; i < size; i++)
+            values.push_back(((i * step) % 21 - 10) * 0.1);
+        return values;
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(OperatorFusionTest,
+                 "Fuse activation operators",
+                 "[fusion]") {
+    auto input0 = addDataOp("input0", -8);
+    auto input1 = addDataOp("input1", -4);
+    auto add = addOp(new EltwiseAddOp<ReferenceBackend>("add", workspace()),
+                     { input0, input1 });
+
+    SECTION("Residual addition followed by ReLU") {
+        auto relu =
+                addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { add });
+        auto add2 = addOp(
+                new EltwiseAddOp<ReferenceBackend>("add2", workspace()),
+                { relu, input0 });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 1);
+        REQUIRE(!hasOperator("relu"));
+        REQUIRE(add->getActivation().function == activation_type::RELU);
+        REQUIRE(add2->getInput(0) == add->getOutput(0));
+        Vertex addVertex = add->getVertex();
+        REQUIRE(boost::out_degree(addVertex, network()->getGraph()) == 1);
+        REQUIRE(boost::in_degree(add2->getVertex(), network()->getGraph()) ==
+                2);
+
+        // add2 = relu(input0 + input1) + input0.
+        std::vector<float> expectedValues;
+        for (int i = 0; i < 16; i++)
+            expectedValues.push_back(std::max(2 * i - 12, 0) + i - 8);
+        allocateOutputs<float>();
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add2");
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("Activation parameters are kept") {
+        addOp(new ReluOp<ReferenceBackend>("lrelu", workspace(), 0.1),
+              { add });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 1);
+        REQUIRE(add->getActivation().function == activation_type::LRELU);
+        REQUIRE(add->getActivation().params.slope == Approx(0.1));
+
+        std::vector<float> expectedValues;
+        for (int i = 0; i < 16; i++) {
+            float value = 2 * i - 12;
+            expectedValues.push_back(value > 0 ? value : 0.1 * value);
+        }
+        allocateOutputs<float>();
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add");
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("Producer output read by other operators") {
+        addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { add });
+        addOp(new EltwiseAddOp<ReferenceBackend>("add2", workspace()),
+              { add, input0 });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 0);
+        REQUIRE(hasOperator("relu"));
+        REQUIRE(add->getActivation().function ==
+                activation_type::NO_ACTIVATION);
+    }
+
+    SECTION("Producer with an activation function") {
+        add->setActivation(ActivationInfo(activation_type::ELU));
+        addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { add });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 0);
+        REQUIRE(hasOperator("relu"));
+        REQUIRE(add->getActivation().function == activation_type::ELU);
+    }
+
+    SECTION("Chain of activation functions") {
+        auto relu =
+                addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { add });
+        addOp(new EluOp<ReferenceBackend>("elu", workspace()), { relu });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 1);
+        REQUIRE(!hasOperator("relu"));
+        REQUIRE(hasOperator("elu"));
+        REQUIRE(network()->getOperator("elu")->getInput(0) ==
+                add->getOutput(0));
+    }
+
+    SECTION("Producer without activation function support") {
+        addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { input0 });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 0);
+        REQUIRE(hasOperator("relu"));
+    }
+}
+
+TEST_CASE_METHOD(OperatorFusionTest, "Fold batch norms", "[fusion]") {
+    SECTION("Convolution, batch norm and ReLU") {
+        TensorShape inputShape({ 1, 4, 4, 8 }, DataLayout::NHWC);
+        TensorShape kernelShape({ 8, 3, 3, 8 }, DataLayout::NHWC);
+        auto input = addDataOp("input", inputShape, getTestValues(128, 7));
+        auto kernels =
+                addDataOp("kernels", kernelShape, getTestValues(576, 5));
+        auto conv = new ConvolutionOp<ReferenceBackend>("conv", workspace());
+        conv->setWeightDims(3, 3, 8);
+        conv->setStride(1, 1);
+        conv->setPadding(SamePadding);
+        addOp(conv, { input, kernels });
+        auto bn = addBatchNormOp(conv, 8);
+        addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { bn });
+        std::vector<float> expectedValues = runNetwork("relu");
+
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 2);
+        REQUIRE(!hasOperator("bn"));
+        REQUIRE(!hasOperator("relu"));
+        REQUIRE(!hasOperator("mean"));
+        REQUIRE(!hasOperator("beta"));
+        REQUIRE(hasOperator("kernels"));
+        REQUIRE(conv->getBias() != nullptr);
+        REQUIRE(conv->getActivation().function == activation_type::RELU);
+        REQUIRE(boost::out_degree(conv->getVertex(), network()->getGraph()) ==
+                0);
+        std::vector<float> outputValues = runNetwork("conv");
+        REQUIRE(outputValues.size() == expectedValues.size());
+        for (int i = 0; i < expectedValues.size(); i++)
+            REQUIRE(outputValues[i] == Approx(expectedValues[i]).margin(1e-5));
+    }
+
+    SECTION("Inner product and batch norm with an activation function") {
+        TensorShape inputShape({ 2, 16 }, DataLayout::NC);
+        TensorShape weightShape({ 16, 8 }, DataLayout::CN);
+        auto input = addDataOp("input", inputShape, getTestValues(32, 3));
+        auto weights =
+                addDataOp("weights", weightShape, getTestValues(128, 11));
+        auto fc = new InnerProductOp<ReferenceBackend>("fc", workspace());
+        fc->setNumOutputs(8);
+        addOp(fc, { input, weights });
+        auto bn = addBatchNormOp(fc, 8);
+        bn->setActivation(ActivationInfo(activation_type::ELU));
+        std::vector<float> expectedValues = runNetwork("bn");
+
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 1);
+        REQUIRE(!hasOperator("bn"));
+        REQUIRE(fc->getBias() != nullptr);
+        REQUIRE(fc->getActivation().function == activation_type::ELU);
+        std::vector<float> outputValues = runNetwork("fc");
+        REQUIRE(outputValues.size() == expectedValues.size());
+        for (int i = 0; i < expectedValues.size(); i++)
+            REQUIRE(outputValues[i] == Approx(expectedValues[i]).margin(1e-5));
+    }
+
+    SECTION("Producer output read by other operators") {
+        TensorShape inputShape({ 1, 16 }, DataLayout::NC);
+        TensorShape weightShape({ 16, 16 }, DataLayout::CN);
+        auto input = addDataOp("input", inputShape, getTestValues(16, 3));
+        auto weights =
+                addDataOp("weights", weightShape, getTestValues(256, 11));
+        auto fc = new InnerProductOp<ReferenceBackend>("fc", workspace());
+        fc->setNumOutputs(16);
+        addOp(fc, { input, weights });
+        auto bn = addBatchNormOp(fc, 16);
+        addOp(new EltwiseAddOp<ReferenceBackend>("add", workspace()),
+              { fc, bn });
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 0);
+        REQUIRE(hasOperator("bn"));
+        REQUIRE(fc->getBias() == nullptr);
+    }
+
+    SECTION("Producer with an activation function") {
+        TensorShape inputShape({ 1, 16 }, DataLayout::NC);
+        TensorShape weightShape({ 16, 16 }, DataLayout::CN);
+        auto input = addDataOp("input", inputShape, getTestValues(16, 3));
+        auto weights =
+                addDataOp("weights", weightShape, getTestValues(256, 11));
+        auto fc = new InnerProductOp<ReferenceBackend>("fc", workspace());
+        fc->setNumOutputs(16);
+        fc->setActivation(ActivationInfo(activation_type::RELU));
+        addOp(fc, { input, weights });
+        addBatchNormOp(fc, 16);
+        REQUIRE(fuseOperators<ReferenceBackend>(network()) == 0);
+        REQUIRE(hasOperator("bn"));
+    }
+}
@@ -0,0 +1,92 @@
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "smaug/core/param_archive.h"
+#include "smaug/operators/common.h"
+
+namespace smaug {
+
+static_assert(sizeof(ParamArchiveHeader) == 24,
+              "The archive header must have no implicit padding!");
+static_assert(sizeof(ParamArchiveEntry) == 32,
+              "Archive entries must have no implicit padding!");
+
+ParamArchive::~ParamArchive() {
+    if (mapping)
+        munmap(mapping, mappingSize);
+}
+
+bool ParamArchive::isParamArchive(const std::string& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    char fileMagic[sizeof(ParamArchiveHeader::magic)];
+    if (!file.read(fileMagic, sizeof(fileMagic)))
+        return false;
+    return memcmp(fileMagic, magic, sizeof(fileMagic)) == 0;
+}
+
+bool ParamArchive::open(const std::string& path) {
+    assert(!mapping && "The archive is already open!");
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0 ||
+        fileStat.st_size < (off_t)sizeof(ParamArchiveHeader)) {
+        close(fd);
+        return false;
+    }
+    mappingSize = fileStat.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                   fd, 0);
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        return false;
+    }
+
+    const char* base = reinterpret_cast<const char*>(mapping);
+    auto header = reinterpret_cast<const ParamArchiveHeader*>(base);
+    if (memcmp(header->magic, magic, sizeof(header->magic)) != 0 ||
+        header->version != version || header->alignment == 0 ||
+        header->alignment % CACHELINE_SIZE != 0)
+        return false;
+    // The offsets and sizes come from the file, so the bounds are checked in a
+    // way that can't overflow.
+    size_t entriesSize = mappingSize - sizeof(ParamArchiveHeader);
+    if (header->numEntries > entriesSize / sizeof(ParamArchiveEntry))
+        return false;
+    auto entries =
+            reinterpret_cast<const ParamArchiveEntry*>(base + sizeof(*header));
+    auto inBounds = [this](uint64_t offset, uint64_t length) {
+        return offset <= mappingSize && length <= mappingSize - offset;
+    };
+    for (int i = 0; i < header->numEntries; i++) {
+        const ParamArchiveEntry& entry = entries[i];
+        if (!inBounds(entry.nameOffset, entry.nameLength) ||
+            !inBounds(entry.dataOffset, entry.dataSize) ||
+            entry.dataOffset % header->alignment != 0 ||
+            !DataType_IsValid(entry.dataType))
+            return false;
+        index[std::string(base + entry.nameOffset, entry.nameLength)] = &entry;
+    }
+    return true;
+}
+
+void* ParamArchive::getData(const std::string& name,
+                            DataType* dataType,
+                            size_t* size) const {
+    auto it = index.find(name);
+    if (it == index.end())
+        return nullptr;
+    const ParamArchiveEntry* entry = it->second;
+    *dataType = static_cast<DataType>(entry->dataType);
+    *size = entry->dataSize;
+    return reinterpret_cast<char*>(mapping) + entry->dataOffset;
+}
+
+}  // namespace smaug
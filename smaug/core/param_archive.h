@@ -0,0 +1,99 @@
+#ifndef _CORE_PARAM_ARCHIVE_H_
+#define _CORE_PARAM_ARCHIVE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "smaug/core/types.pb.h"
+
+namespace smaug {
+
+/**
+ * The header at the start of a parameter archive.
+ *
+ * A parameter archive is a flat binary alternative to the TensorDataArray
+ * protobuf. It is laid out as:
+ *
+ * 1. A ParamArchiveHeader.
+ * 2. ParamArchiveHeader::numEntries ParamArchiveEntry records.
+ * 3. The names of all the tensors, back to back, without terminators.
+ * 4. The data of every tensor, each starting at a multiple of
+ *    ParamArchiveHeader::alignment bytes from the start of the file.
+ *
+ * The data of a tensor is the raw contents of its storage, padding included,
+ * in the byte order of the host. Use smaug/python/convert_params.py to
+ * convert a TensorDataArray protobuf to an archive.
+ */
+struct ParamArchiveHeader {
+    /** Always "SMAUGPRM". */
+    char magic[8];
+    uint32_t version;
+    uint32_t numEntries;
+    uint32_t alignment;
+    uint32_t reserved;
+};
+
+/** The location of the data of one tensor in a parameter archive. */
+struct ParamArchiveEntry {
+    /** Offset of the name of the tensor from the start of the file. */
+    uint64_t nameOffset;
+    /** Offset of the data of the tensor from the start of the file. */
+    uint64_t dataOffset;
+    /** Size of the data of the tensor in bytes. */
+    uint64_t dataSize;
+    uint32_t nameLength;
+    /** The DataType of the tensor. */
+    int32_t dataType;
+};
+
+/**
+ * ParamArchive maps a parameter archive into memory, so that the data of the
+ * parameter tensors can be used in place instead of copied out of a parsed
+ * protobuf.
+ *
+ * The mapping is private and writable, so writes to the data go to
+ * copy-on-write pages and never reach the file.
+ */
+class ParamArchive {
+   public:
+    ParamArchive() : mapping(nullptr), mappingSize(0) {}
+    ~ParamArchive();
+
+    /** Returns true if the file at path starts with the archive header. */
+    static bool isParamArchive(const std::string& path);
+
+    /**
+     * Maps the archive at path into memory and indexes its tensors.
+     *
+     * @return False if the file can't be mapped or is not a valid archive.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Returns the data of the named tensor, or nullptr if the archive has no
+     * such tensor. The data is aligned to at least a cacheline.
+     *
+     * @param dataType Set to the DataType of the tensor.
+     * @param size Set to the size of the data in bytes.
+     */
+    void* getData(const std::string& name,
+                  DataType* dataType,
+                  size_t* size) const;
+
+    /** Number of tensors in the archive. */
+    int size() const { return index.size(); }
+
+    static constexpr const char* magic = "SMAUGPRM";
+    static constexpr uint32_t version = 1;
+
+   protected:
+    void* mapping;
+    size_t mappingSize;
+    /** The entry of each tensor, by name. */
+    std::unordered_map<std::string, const ParamArchiveEntry*> index;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <vector>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/reorder_elimination.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/reorder_op.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+// Returns the producer of the only input of the operator, and sets srcIdx to
+// the index of the output it reads.
+static Operator* getProducer(const Graph& graph, Operator* op, int* srcIdx) {
+    in_edge_iter inEdgeIt, inEdgeEnd;
+    boost::tie(inEdgeIt, inEdgeEnd) = in_edges(op->getVertex(), graph);
+    *srcIdx = get(boost::edge_name, graph, *inEdgeIt).srcIdx;
+    return get(boost::vertex_op, graph, source(*inEdgeIt, graph));
+}
+
+// Returns true if the operator computes every output element from the input
+// element at the same position in storage, so it can run in any layout.
+static bool isLayoutAgnostic(Operator* op) {
+    switch (op->getOpType()) {
+        case OpType::ReLU:
+        case OpType::ELU:
+        case OpType::SELU:
+        case OpType::Tanh:
+        case OpType::HardTanh:
+        case OpType::Sigmoid:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Returns true if the operator is a Reorder that permutes the dimensions of
+// its input without flattening it.
+static bool isTranspose(Operator* op) {
+    return op->getOpType() == OpType::Reorder &&
+           op->getInput(0)->ndims() == op->getOutput(0)->ndims();
+}
+
+// Returns true if the second Reorder restores the input of the first one.
+static bool isInverse(Operator* first, Operator* second) {
+    const TensorShape& input = first->getInput(0)->getShape();
+    const TensorShape& output = second->getOutput(0)->getShape();
+    return isTranspose(first) && isTranspose(second) &&
+           input.getLayout() == output.getLayout() &&
+           input.dims() == output.dims() &&
+           first->getOutput(0)->getShape().getLayout() ==
+                   second->getInput(0)->getShape().getLayout();
+}
+
+// Replaces a Reorder of a constant weight tensor with a Data operator holding
+// the reordered weights. Returns true if the Reorder was removed.
+template <typename Backend>
+static bool foldWeightReorder(Network* network, Operator* reorder) {
+    const Graph& graph = network->getGraph();
+    if (boost::in_degree(reorder->getVertex(), graph) != 1)
+        return false;
+    int srcIdx;
+    Operator* dataOp = getProducer(graph, reorder, &srcIdx);
+    if (dataOp->getOpType() != OpType::Data ||
+        !dataOp->getOutput(srcIdx)->containsData())
+        return false;
+    Network::ConsumerList consumers = network->getConsumers(reorder);
+    if (consumers.empty())
+        return false;
+    // Only weights are folded: any other Data operator may be an input that
+    // is refilled for every inference.
+    Tensor* output = dynamic_cast<Tensor*>(reorder->getOutput(0));
+    for (auto& consumer : consumers) {
+        auto params = consumer.first->getParameterizableInputs();
+        if (std::find(params.begin(), params.end(), output) == params.end())
+            return false;
+    }
+
+    output->allocateStorage(output->getDataType());
+    dynamic_cast<ReorderOp<Backend>*>(reorder)->reorder();
+    dout(1) << "Reordered " << dataOp->getName() << " into "
+            << reorder->getName() << " at load time.\n";
+    std::string name = reorder->getName();
+    Workspace* workspace = reorder->getWorkspace();
+    network->removeOperator(reorder);
+    auto weightsOp = Backend::createDataOp(name, workspace);
+    weightsOp->setData(output);
+    network->addOperator(weightsOp);
+    for (auto& consumer : consumers)
+        network->addEdge(weightsOp, consumer.first,
+                         { 0, consumer.second.destIdx });
+    if (boost::out_degree(dataOp->getVertex(), graph) == 0)
+        network->removeOperator(dataOp);
+    return true;
+}
+
+// Removes the Reorder and the inverse Reorder before it, with only
+// layout-agnostic operators in between. Returns the number of removed
+// Reorders.
+static int cancelInverseReorders(Network* network, Operator* second) {
+    const Graph& graph = network->getGraph();
+    if (!isTranspose(second) ||
+        boost::in_degree(second->getVertex(), graph) != 1 ||
+        boost::out_degree(second->getVertex(), graph) == 0)
+        return 0;
+    // The operators in between are run in the other layout, so nothing else
+    // may read their outputs.
+    std::vector<Operator*> chain;
+    int srcIdx;
+    Operator* first = getProducer(graph, second, &srcIdx);
+    while (isLayoutAgnostic(first) &&
+           boost::in_degree(first->getVertex(), graph) == 1 &&
+           boost::out_degree(first->getVertex(), graph) == 1) {
+        chain.push_back(first);
+        first = getProducer(graph, first, &srcIdx);
+    }
+    std::reverse(chain.begin(), chain.end());
+    if (!isInverse(first, second) ||
+        boost::in_degree(first->getVertex(), graph) != 1 ||
+        (!chain.empty() &&
+         boost::out_degree(first->getVertex(), graph) != 1))
+        return 0;
+
+    int sourceIdx;
+    Operator* source = getProducer(graph, first, &sourceIdx);
+    TensorBase* input = source->getOutput(sourceIdx);
+    dout(1) << "Cancelled " << second->getName() << " against "
+            << first->getName() << ".\n";
+    // The consumers of the second Reorder read the end of the chain, or the
+    // input of the first Reorder if there is no chain.
+    if (chain.empty())
+        network->replaceOperator(second, source, sourceIdx);
+    else
+        network->replaceOperator(second, chain.back(), 0);
+    int numRemoved = 1;
+    // Without a chain in between, other operators may still read the first
+    // Reorder.
+    if (!chain.empty() ||
+        boost::out_degree(first->getVertex(), graph) == 0) {
+        network->removeOperator(first);
+        numRemoved++;
+    }
+    if (!chain.empty()) {
+        chain.front()->setInput(input, 0);
+        network->addEdge(source, chain.front(), { sourceIdx, 0 });
+        for (Operator* op : chain)
+            op->getOutput(0)->setShape(input->getShape());
+    }
+    return numRemoved;
+}
+
+template <typename Backend>
+int eliminateReorders(Network* network) {
+    // Visit the operators in topological order. Only the current operator
+    // and the ones before it are removed, so the saved order stays valid for
+    // the rest.
+    int numRemoved = 0;
+    for (Operator* op : network->getTopologicalOrder()) {
+        if (op->getOpType() != OpType::Reorder)
+            continue;
+        if (foldWeightReorder<Backend>(network, op))
+            numRemoved++;
+        else
+            numRemoved += cancelInverseReorders(network, op);
+    }
+    return numRemoved;
+}
+
+template int eliminateReorders<ReferenceBackend>(Network* network);
+template int eliminateReorders<SmvBackend>(Network* network);
+
+}  // namespace smaug
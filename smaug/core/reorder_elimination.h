@@ -0,0 +1,36 @@
+#ifndef _CORE_REORDER_ELIMINATION_H_
+#define _CORE_REORDER_ELIMINATION_H_
+
+#include "smaug/core/network.h"
+
+namespace smaug {
+
+/**
+ * eliminateReorders removes the Reorder Operators that the Python graph
+ * inserts at layout boundaries when the Network does not need them, each of
+ * which would otherwise read and write a whole tensor on every inference.
+ *
+ * Two kinds of Reorder Operators are removed:
+ *
+ * 1. Reorders of weights. A Reorder whose input comes from a Data Operator
+ *    and whose output is only read as a parameterizable input (see
+ *    Operator::getParameterizableInputs()) is run once here, and replaced by
+ *    a Data Operator holding its result. The original Data Operator is
+ *    removed if nothing else reads it.
+ * 2. Pairs of inverse Reorders, like NCHW->NHWC followed by NHWC->NCHW,
+ *    optionally with a chain of layout-agnostic activation Operators between
+ *    them. The activations are switched to the layout of the first Reorder's
+ *    input, and the consumers of the second Reorder read the result directly.
+ *
+ * This must be called after the inputs of all the Operators are connected,
+ * and before their output tensors are allocated or tiled.
+ *
+ * @tparam Backend The Backend of the Operators in the Network.
+ * @return The number of removed Reorder Operators.
+ */
+template <typename Backend>
+int eliminateReorders(Network* network);
+
+}  // namespace smaug
+
+#endif
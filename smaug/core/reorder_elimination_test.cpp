@@ -0,0 +1,129 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/reorder_elimination.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/convolution_op.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/relu_op.h"
+#include "smaug/operators/reorder_op.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class ReorderEliminationTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+    using SmaugTest::addDataOp;
+
+    Operator* addDataOp(const std::string& name,
+                        const std::vector<int>& dims,
+                        DataLayout layout,
+                        float offset = 0) {
+        TensorShape shape(dims, layout);
+        Tensor* tensor = new Tensor(name, shape);
+        tensor->allocateStorage<float>();
+        std::vector<float> values;
+        for (int i = 0; i < shape.size(); i++)
+            values.push_back(i + offset);
+        tensor->fillData(values.data(), values.size());
+        return addDataOp(tensor);
+    }
+
+    Operator* addReorder(const std::string& name,
+                         DataLayout layout,
+                         Operator* input) {
+        return addOp(new ReorderOp<ReferenceBackend>(name, layout, workspace()),
+                     { input });
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(ReorderEliminationTest,
+                 "Eliminate reorder operators",
+                 "[fusion]") {
+    auto input = addDataOp("input", { 1, 4, 2, 8 }, DataLayout::NCHW, -32);
+
+    SECTION("Inverse reorders around an activation") {
+        auto toNhwc = addReorder("to_nhwc", DataLayout::NHWC, input);
+        auto relu = addOp(new ReluOp<ReferenceBackend>("relu", workspace()),
+                          { toNhwc });
+        auto toNchw = addReorder("to_nchw", DataLayout::NCHW, relu);
+        auto add = addOp(new EltwiseAddOp<ReferenceBackend>("add", workspace()),
+                         { toNchw, input });
+        REQUIRE(eliminateReorders<ReferenceBackend>(network()) == 2);
+        REQUIRE(!hasOperator("to_nhwc"));
+        REQUIRE(!hasOperator("to_nchw"));
+        REQUIRE(relu->getInput(0) == input->getOutput(0));
+        REQUIRE(relu->getOutput(0)->getShape().getLayout() ==
+                DataLayout::NCHW);
+        REQUIRE(add->getInput(0) == relu->getOutput(0));
+        REQUIRE(boost::in_degree(add->getVertex(), network()->getGraph()) ==
+                2);
+
+        // add = relu(input) + input.
+        allocateOutputs<float>();
+        std::vector<float> expectedValues;
+        for (int i = 0; i < 64; i++)
+            expectedValues.push_back(std::max(i - 32, 0) + i - 32);
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add");
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("First reorder read by other operators") {
+        auto toNhwc = addReorder("to_nhwc", DataLayout::NHWC, input);
+        auto toNchw = addReorder("to_nchw", DataLayout::NCHW, toNhwc);
+        auto add = addOp(new EltwiseAddOp<ReferenceBackend>("add", workspace()),
+                         { toNchw, input });
+        addOp(new ReluOp<ReferenceBackend>("relu", workspace()), { toNhwc });
+        REQUIRE(eliminateReorders<ReferenceBackend>(network()) == 1);
+        REQUIRE(hasOperator("to_nhwc"));
+        REQUIRE(!hasOperator("to_nchw"));
+        REQUIRE(add->getInput(0) == input->getOutput(0));
+    }
+
+    SECTION("Activation read by other operators") {
+        auto toNhwc = addReorder("to_nhwc", DataLayout::NHWC, input);
+        auto relu = addOp(new ReluOp<ReferenceBackend>("relu", workspace()),
+                          { toNhwc });
+        addReorder("to_nchw", DataLayout::NCHW, relu);
+        addOp(new ReluOp<ReferenceBackend>("relu2", workspace()), { relu });
+        REQUIRE(eliminateReorders<ReferenceBackend>(network()) == 0);
+    }
+
+    SECTION("Weights are reordered at load time") {
+        auto weights = addDataOp("weights", { 8, 8, 3, 3 }, DataLayout::NCHW);
+        auto inputNhwc = addReorder("input_nhwc", DataLayout::NHWC, input);
+        auto weightsNhwc = addReorder("weights_nhwc", DataLayout::NHWC, weights);
+        auto conv = new ConvolutionOp<ReferenceBackend>("conv", workspace());
+        conv->setWeightDims(3, 3, 8);
+        conv->setStride(1, 1);
+        conv->setPadding(SamePadding);
+        addOp(conv, { inputNhwc, weightsNhwc });
+        REQUIRE(eliminateReorders<ReferenceBackend>(network()) == 1);
+        // The input may be refilled for every inference, so its reorder stays.
+        REQUIRE(hasOperator("input_nhwc"));
+        REQUIRE(!hasOperator("weights"));
+        REQUIRE(network()->getOperator("weights_nhwc")->getOpType() ==
+                OpType::Data);
+        Tensor* reordered = dynamic_cast<Tensor*>(conv->getInput(1));
+        REQUIRE(reordered->getName() == "weights_nhwc");
+        REQUIRE(reordered->containsData());
+        REQUIRE(boost::in_degree(conv->getVertex(), network()->getGraph()) ==
+                2);
+        auto idx = reordered->startIndex();
+        float* data = reordered->data<float>();
+        for (int k = 0; k < 8; k++)
+            for (int c = 0; c < 8; c++)
+                for (int h = 0; h < 3; h++)
+                    for (int w = 0; w < 3; w++)
+                        REQUIRE(data[idx(k, h, w, c)] ==
+                                ((k * 8 + c) * 3 + h) * 3 + w);
+    }
+}
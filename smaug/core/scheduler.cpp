@@ -1,16 +1,23 @@
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "smaug/utility/debug_stream.h"
 #include "smaug/utility/thread_pool.h"
+#include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/types.pb.h"
 #include "smaug/core/scheduler.h"
+#include "smaug/core/tile_fusion.h"
 
 namespace smaug {
 
-Tensor* Scheduler::runNetwork() {
+void Scheduler::tileNetwork() {
+    if (tiled)
+        return;
+    tiled = true;
     std::cout << "======================================================\n";
     std::cout << "      Tiling operators of the network...\n";
     std::cout << "======================================================\n";
@@ -20,6 +27,16 @@ Tensor* Scheduler::runNetwork() {
                 << OpType_Name(op->getOpType()) << ").\n";
         op->tile();
     }
+    int numFused = fuseTiledOperators(network);
+    if (numFused > 0)
+        dout(0) << "Fused the tiles of " << numFused << " operator pairs.\n";
+}
+
+void Scheduler::prepareNetwork() {
+    if (prepared)
+        return;
+    prepared = true;
+    tileNetwork();
 
     // We have finished loading the model and building the network, as well as
     // the tiling of all the operators. Now we can stop fast forwarding.
@@ -33,14 +50,26 @@ Tensor* Scheduler::runNetwork() {
     // incorrect.
     if (threadPool)
         threadPool->initThreadPool();
+}
 
-    std::cout << "======================================================\n";
-    std::cout << "      Scheduling operators of the network...\n";
-    std::cout << "======================================================\n";
+Tensor* Scheduler::runNetwork() {
+    prepareNetwork();
+
+    if (printBanner) {
+        std::cout << "======================================================\n";
+        std::cout << "      Scheduling operators of the network...\n";
+        std::cout << "======================================================\n";
+    }
     // Initialize number of pending inputs for every operator and put Data
-    // operators into the ready queue.
+    // operators into the ready queue. Outputs marked dead by a previous run
+    // are revived, since the control flow may differ this time.
+    readyQueue.clear();
     for (auto nameOp : network->getOperators()) {
         Operator* op = nameOp.second;
+        if (op->getOpType() != OpType::Data) {
+            for (auto output : op->getOutputs())
+                output->setDead(false);
+        }
         Vertex vertex = op->getVertex();
         int numPendingInputs = boost::in_degree(vertex, network->getGraph());
         op->setNumPendingInputs(numPendingInputs);
@@ -72,6 +101,13 @@ Tensor* Scheduler::scheduleReady() {
 void Scheduler::maybeRunOperator(Operator* op) {
     if (!op->isDead()) {
         op->run();
+        // Copies of the previous contents of the outputs, like the input tiles
+        // of the consumers, are now stale. The tensors of Data operators are
+        // only ever written outside of the Network.
+        if (op->getOpType() != OpType::Data) {
+            for (auto output : op->getOutputs())
+                output->bumpDataVersion();
+        }
     } else {
         for (auto output : op->getOutputs())
             output->setDead();
@@ -88,11 +124,114 @@ void Scheduler::updateChildren(Operator* op) {
         Vertex childVertex = target(*outEdgeIt, graph);
         Operator* child = get(boost::vertex_op, graph, childVertex);
         if (child->getNumPendingInputs() > 0) {
-            child->decrNumPendingInputs();
-            if (child->getNumPendingInputs() == 0)
+            if (child->decrNumPendingInputs() == 0)
                 readyQueue.push_back(child);
         }
     }
 }
 
+ParallelScheduler::~ParallelScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCond.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+Tensor* ParallelScheduler::scheduleReady() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    // The workers are started once, so that their scratchpads are only set up
+    // the first time the Network is run.
+    if (workers.empty()) {
+        for (int i = 0; i < numWorkers; i++)
+            workers.emplace_back(&ParallelScheduler::workerLoop, this);
+    }
+    numPendingOps = network->getOperators().size();
+    running = true;
+    queueCond.notify_all();
+    queueCond.wait(lock, [this]() { return numPendingOps == 0; });
+    running = false;
+    assert(readyQueue.empty() && "Not all operators were scheduled!");
+    lock.unlock();
+    return findLastScheduledOp()->getOutput(0);
+}
+
+Operator* ParallelScheduler::findLastScheduledOp() const {
+    // Replays the order in which the Scheduler runs the operators, without
+    // running them. The Data operators are the initial ready queue.
+    const Graph& graph = network->getGraph();
+    std::map<Operator*, int> numPendingInputs;
+    std::list<Operator*> queue;
+    for (auto nameOp : network->getOperators()) {
+        Operator* op = nameOp.second;
+        int numInputs = boost::in_degree(op->getVertex(), graph);
+        numPendingInputs[op] = numInputs;
+        if (numInputs == 0)
+            queue.push_back(op);
+    }
+    Operator* lastOp = nullptr;
+    for (auto op : queue) {
+        lastOp = op;
+        out_edge_iter outEdgeIt, outEdgeEnd;
+        for (boost::tie(outEdgeIt, outEdgeEnd) =
+                     out_edges(op->getVertex(), graph);
+             outEdgeIt != outEdgeEnd;
+             ++outEdgeIt) {
+            Operator* child =
+                    get(boost::vertex_op, graph, target(*outEdgeIt, graph));
+            if (--numPendingInputs[child] == 0)
+                queue.push_back(child);
+        }
+    }
+    return lastOp;
+}
+
+void ParallelScheduler::workerLoop() {
+    SmvBackend::initScratchpads();
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCond.wait(lock, [this]() {
+            return stopping || (running && !readyQueue.empty());
+        });
+        if (stopping)
+            break;
+        Operator* op = readyQueue.front();
+        readyQueue.pop_front();
+        // Logged with the lock held, so the lines of the workers don't
+        // interleave.
+        dout(0) << "Scheduling " << op->getName() << " ("
+                << OpType_Name(op->getOpType()) << ").\n";
+        lock.unlock();
+        maybeRunOperator(op);
+        updateChildren(op);
+        lock.lock();
+        numPendingOps--;
+        // Wake up the other workers and the scheduler: either new operators
+        // are ready, or all of the operators have finished.
+        queueCond.notify_all();
+    }
+    lock.unlock();
+    SmvBackend::freeScratchpads();
+}
+
+void ParallelScheduler::updateChildren(Operator* op) {
+    const Graph& graph = network->getGraph();
+    Vertex vertex = op->getVertex();
+    out_edge_iter outEdgeIt, outEdgeEnd;
+    for (boost::tie(outEdgeIt, outEdgeEnd) = out_edges(vertex, graph);
+         outEdgeIt != outEdgeEnd;
+         ++outEdgeIt) {
+        Vertex childVertex = target(*outEdgeIt, graph);
+        Operator* child = get(boost::vertex_op, graph, childVertex);
+        // Only the worker that finishes the child's last input observes the
+        // count dropping to zero, so the child is enqueued exactly once.
+        if (child->decrNumPendingInputs() == 0) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            readyQueue.push_back(child);
+        }
+    }
+}
+
 }  // namespace smaug
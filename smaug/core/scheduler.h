@@ -1,4 +1,11 @@
+#ifndef _CORE_SCHEDULER_H_
+#define _CORE_SCHEDULER_H_
+
+#include <condition_variable>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "smaug/core/network.h"
 #include "smaug/core/workspace.h"
@@ -12,17 +19,45 @@ namespace smaug {
 class Scheduler {
    public:
     Scheduler(Network* _network, Workspace* _workspace)
-            : network(_network), workspace(_workspace) {}
+            : network(_network), workspace(_workspace), tiled(false),
+              prepared(false), printBanner(true) {}
     virtual ~Scheduler(){};
-    /** Runs the Network to completion. The final output tensor is returned. */
+
+    /**
+     * Tiles all the Operators, while still fast-forwarding. This is done only
+     * once, no matter how many times it is called.
+     */
+    void tileNetwork();
+
+    /**
+     * Tiles all the Operators if that isn't done yet, and finishes the
+     * fast-forwarding. This is done only once, no matter how many times the
+     * Network is run.
+     */
+    void prepareNetwork();
+
+    /**
+     * Runs the Network to completion, preparing it first if needed. The final
+     * output tensor is returned.
+     *
+     * This can be called repeatedly, for example after new data is written to
+     * the input tensors, whose data versions must then be bumped (see
+     * TensorBase::bumpDataVersion()).
+     */
     Tensor* runNetwork();
 
+    /**
+     * Sets whether runNetwork() prints a banner. Servers that run the Network
+     * once per request turn it off.
+     */
+    void setPrintBanner(bool _printBanner) { printBanner = _printBanner; }
+
    protected:
     /**
      * Runs the operators in the ready queue. This may add new operators to
      * the ready queue by calling updateChildren().
      */
-    Tensor* scheduleReady();
+    virtual Tensor* scheduleReady();
 
     /**
      * If none of the inputs to the current Operator are dead, then this will
@@ -37,13 +72,91 @@ class Scheduler {
      * all its children. Any child Operator with no more pending inputs is then
      * added to the ready queue.
      */
-    void updateChildren(Operator* op);
+    virtual void updateChildren(Operator* op);
 
     Network* network;
     Workspace* workspace;
 
+    /** True once tileNetwork() has been called. */
+    bool tiled;
+
+    /** True once prepareNetwork() has been called. */
+    bool prepared;
+
+    /** If true, runNetwork() prints a banner before scheduling. */
+    bool printBanner;
+
     /** The queue of all Operators ready to be executed. */
     std::list<Operator*> readyQueue;
 };
 
+/**
+ * ParallelScheduler runs independent Operators of the Network concurrently.
+ *
+ * Every Operator whose inputs are all available is dispatched to a pool of
+ * worker threads, so independent branches of the graph (e.g. the towers of an
+ * Inception block or the two arms of a residual block) execute at the same
+ * time. As each Operator finishes, the pending input counts of its children
+ * are atomically decremented, and any child that drops to zero is pushed onto
+ * the shared ready queue.
+ *
+ * Each worker thread owns its own set of SMV scratchpads, so that Operators
+ * of the SMV backend running on different workers do not clobber each other's
+ * local data. The workers are started by the first run and kept, along with
+ * their scratchpads, until the scheduler is destroyed. This scheduler is only
+ * supported in native execution; in gem5 simulation, the Scheduler must be
+ * used instead.
+ */
+class ParallelScheduler : public Scheduler {
+   public:
+    ParallelScheduler(Network* _network,
+                      Workspace* _workspace,
+                      int _numWorkers)
+            : Scheduler(_network, _workspace), numWorkers(_numWorkers),
+              numPendingOps(0), running(false), stopping(false) {}
+    /** Stops the worker threads. */
+    ~ParallelScheduler() override;
+
+   protected:
+    Tensor* scheduleReady() override;
+    void updateChildren(Operator* op) override;
+
+    /** The main loop executed by every worker thread. */
+    void workerLoop();
+
+    /**
+     * Returns the Operator that the Scheduler would run last. Its output is
+     * the output of the Network, so that it doesn't depend on which worker
+     * finishes last when the Network has several sinks.
+     */
+    Operator* findLastScheduledOp() const;
+
+    /** Number of worker threads used to run Operators. */
+    int numWorkers;
+    /** The worker threads, started by the first run. */
+    std::vector<std::thread> workers;
+
+    /**
+     * Protects the ready queue and all the fields below. The ready queue of
+     * the base class is used as the shared work queue.
+     */
+    std::mutex queueMutex;
+    /**
+     * Signaled when an Operator is ready, all Operators have finished, or the
+     * workers must stop.
+     */
+    std::condition_variable queueCond;
+    /** Number of Operators that have not finished running yet. */
+    int numPendingOps;
+    /**
+     * True while the Network is being run. The ready queue is only shared
+     * with the workers in the meantime.
+     */
+    bool running;
+    /** Set when the workers must exit. */
+    bool stopping;
+};
+
 }  // namespace smaug
+
+#endif
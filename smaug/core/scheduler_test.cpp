@@ -0,0 +1,114 @@
+#include <type_traits>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/relu_op.h"
+#include "smaug/operators/smv/smv_eltwise_add_op.h"
+#include "smaug/operators/smv/smv_relu_op.h"
+
+using namespace smaug;
+
+class SchedulerTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    // Builds a network with four independent ReLU branches fanning out from
+    // the same input and reduces them with a tree of elementwise additions:
+    //
+    //           input
+    //        /  |   |  \
+    //    relu0 relu1 relu2 relu3
+    //        \  /     \  /
+    //        add0     add1
+    //           \     /
+    //            add2
+    template <typename Backend, typename DType>
+    void buildBranchyNetwork() {
+        TensorShape shape({ 1, 16 }, DataLayout::NC, Backend::Alignment);
+        Tensor* input = new Tensor("input", shape);
+        input->allocateStorage<DType>();
+        DType* inputData = input->data<DType>();
+        for (int i = 0; i < shape.size(); i++) {
+            if (std::is_same<DType, float16>::value)
+                inputData[i] = fp16(i - 8);
+            else
+                inputData[i] = i - 8;
+        }
+        Operator* dataOp = addDataOp<Backend>(input);
+
+        std::vector<Operator*> relus;
+        for (int i = 0; i < 4; i++) {
+            relus.push_back(addOp(Backend::createReluOp(
+                                          "relu" + std::to_string(i),
+                                          workspace()),
+                                  { dataOp }));
+        }
+        auto add0 = addOp(Backend::createEltwiseAddOp("add0", workspace()),
+                          { relus[0], relus[1] });
+        auto add1 = addOp(Backend::createEltwiseAddOp("add1", workspace()),
+                          { relus[2], relus[3] });
+        addOp(Backend::createEltwiseAddOp("add2", workspace()), { add0, add1 });
+        allocateOutputs<DType>();
+    }
+};
+
+TEST_CASE_METHOD(SchedulerTest, "Operator scheduling", "[scheduler]") {
+    // Every branch computes relu(x), so the final output is 4 * relu(x).
+    std::vector<float> expectedValues;
+    for (int i = 0; i < 16; i++)
+        expectedValues.push_back(4 * std::max(i - 8, 0));
+
+    SECTION("Serial scheduler") {
+        buildBranchyNetwork<ReferenceBackend, float>();
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add2");
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("Parallel scheduler") {
+        buildBranchyNetwork<ReferenceBackend, float>();
+        ParallelScheduler scheduler(network(), workspace(), 4);
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add2");
+        verifyOutputs(output, expectedValues);
+    }
+}
+
+TEST_CASE_METHOD(SchedulerTest, "Output of a network with several sinks",
+                 "[scheduler]") {
+    // Add a second sink to the network. Whichever worker finishes last, the
+    // parallel scheduler must return the output the serial scheduler picks.
+    buildBranchyNetwork<ReferenceBackend, float>();
+    addOp(new ReluOp<ReferenceBackend>("relu_sink", workspace()),
+          { network()->getOperator("relu3") });
+    allocateOutputs<float>();
+
+    Scheduler serialScheduler(network(), workspace());
+    std::string serialOutput = serialScheduler.runNetwork()->getName();
+    ParallelScheduler scheduler(network(), workspace(), 4);
+    for (int i = 0; i < 10; i++)
+        REQUIRE(scheduler.runNetwork()->getName() == serialOutput);
+}
+
+TEST_CASE_METHOD(SchedulerTest, "Parallel scheduling of SMV operators",
+                 "[scheduler]") {
+    // The SMV kernels run on the workers, each of which has its own
+    // scratchpads. The workers, and their scratchpads, are reused across runs.
+    std::vector<float> expectedValues;
+    for (int i = 0; i < 16; i++)
+        expectedValues.push_back(4 * std::max(i - 8, 0));
+    buildBranchyNetwork<SmvBackend, float16>();
+    ParallelScheduler scheduler(network(), workspace(), 4);
+    for (int i = 0; i < 5; i++) {
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add2");
+        verifyOutputs(convertFp16ToFp32Tensor(output, workspace()),
+                      expectedValues);
+    }
+}
@@ -10,6 +10,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/workspace.h"
+#include "smaug/operators/data_op.h"
 
 namespace smaug {
 
@@ -135,6 +136,65 @@ class SmaugTest {
         }
     }
 
+    /**
+     * Adds a Data Operator holding the Tensor to the Network, and the Tensor
+     * to the Workspace.
+     *
+     * @tparam Backend The Backend of the Data Operator.
+     * @param tensor The Tensor, named after the Operator.
+     */
+    template <typename Backend = ReferenceBackend>
+    Operator* addDataOp(Tensor* tensor) {
+        workspace_->addTensor(tensor);
+        auto dataOp = Backend::createDataOp(tensor->getName(), workspace_);
+        dataOp->setData(tensor);
+        network_->addOperator(dataOp);
+        return dataOp;
+    }
+
+    /**
+     * Adds an Operator to the Network, reading the first output of each of
+     * the input Operators in order. Its other Tensors are created, and the
+     * outputs get the data type of the first input but no storage, so tests
+     * can allocate them with allocateOutputs() once the graph is final.
+     */
+    template <typename OpType>
+    OpType* addOp(OpType* op, const std::vector<Operator*>& inputs) {
+        for (int i = 0; i < inputs.size(); i++)
+            op->setInput(inputs[i]->getOutput(0), i);
+        op->createAllTensors();
+        if (!inputs.empty()) {
+            DataType dataType = inputs[0]->getOutput(0)->getDataType();
+            for (auto output : op->getOutputs())
+                output->setDataType(dataType);
+        }
+        network_->addOperator(op);
+        for (int i = 0; i < inputs.size(); i++)
+            network_->addEdge(inputs[i], op, { 0, i });
+        return op;
+    }
+
+    /**
+     * Allocates storage for the outputs of all the Operators in the Network
+     * that don't have any yet.
+     *
+     * @tparam T The data element type.
+     */
+    template <typename T>
+    void allocateOutputs() {
+        for (auto& nameOp : network_->getOperators()) {
+            for (auto output : nameOp.second->getOutputs()) {
+                if (!output->containsData())
+                    dynamic_cast<Tensor*>(output)->allocateStorage<T>();
+            }
+        }
+    }
+
+    /** Returns true if the Network has an Operator with the name. */
+    bool hasOperator(const std::string& name) const {
+        return network_->getOperators().count(name) > 0;
+    }
+
     Network* buildNetwork(const std::string& modelTopo,
                           const std::string& modelParams);
     Tensor* buildAndRunNetwork(const std::string& modelTopo,
@@ -167,6 +227,14 @@ class SmaugTest {
     Workspace* workspace_;
 };
 
+/**
+ * float16 Tensors are compared as float32 values, not as their raw bits. This
+ * must be declared here, or tests would silently instantiate the generic
+ * version instead.
+ */
+template <>
+void SmaugTest::verifyOutputs<float16>(Tensor* output, Tensor* expected);
+
 /** This converts a float32 into a float16. */
 float16 fp16(float fp32_data);
 
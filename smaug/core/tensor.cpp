@@ -80,65 +80,117 @@ void TiledTensor::setTile(int index,
         copyDataToTile(tile);
 }
 
-void* TiledTensor::tileCopyWorker(void* _args) {
-    auto args = reinterpret_cast<CopyTilesArgs*>(_args);
-    TiledTensor* tiledTensor = args->tiledTensor;
-    int start = args->start;
-    int numTiles = args->numTiles;
-    TileDataOperation op = args->op;
-    for (int i = start; i < start + numTiles; i++) {
-        Tile* tile = tiledTensor->getTile(i);
-        if (op == Scatter)
-            tiledTensor->copyDataToTile(tile);
-        else if (op == Gather)
-            tiledTensor->gatherDataFromTile(tile);
+Tensor* TiledTensor::setTileView(int index,
+                                 const std::vector<int>& origin,
+                                 const TensorShape& shape) {
+    if (!origTensor->containsData())
+        return nullptr;
+    int offset = getContiguousOffset(origin, shape);
+    if (offset < 0)
+        return nullptr;
+    Tensor* view = new Tensor("", shape);
+    view->setStorageView(origTensor, offset);
+    Tile* tile = &tiles[index];
+    tile->tensor = view;
+    tile->origin = origin;
+    tile->hasOrigin = true;
+    tile->isView = true;
+    return view;
+}
+
+int TiledTensor::getContiguousOffset(const std::vector<int>& origin,
+                                     const TensorShape& shape) const {
+    // The accelerators transfer whole cachelines, so a tile that doesn't
+    // start on a cacheline or doesn't span a whole number of them would
+    // overrun into the data of the neighbouring tiles, or past the end of the
+    // original tensor.
+    int offset = getRegionOffset(origin, shape);
+    int elemSize = origTensor->getDataTypeSize();
+    if (offset < 0 || !isCachelineMultiple(offset * elemSize) ||
+        !isCachelineMultiple(shape.storageSize() * elemSize))
+        return -1;
+    return offset;
+}
+
+int TiledTensor::getRegionOffset(const std::vector<int>& origin,
+                                 const TensorShape& shape) const {
+    const TensorShape& origShape = origTensor->getShape();
+    if (useRawTensor) {
+        // Raw tiles are linear ranges of the original storage. Any padding
+        // would overlap with the data of the next tile.
+        return shape.storageSize() == shape.size() ? origin[0] : -1;
     }
-    delete args;
-    return nullptr;
+    int ndims = origShape.ndims();
+    if (shape.ndims() != ndims || shape.getLayout() != origShape.getLayout())
+        return -1;
+    // The region is contiguous if it spans the whole tensor in every
+    // dimension inner to the outermost one it has more than one element in.
+    int lastPartial = 0;
+    for (int i = 0; i < ndims; i++) {
+        if (shape[i] != origShape[i])
+            lastPartial = i;
+    }
+    for (int i = 0; i < lastPartial; i++) {
+        if (shape[i] != 1)
+            return -1;
+    }
+    // The innermost dimension must be padded the same way as in the original
+    // tensor, and a partial one must not be padded at all.
+    int innerDim = lastPartial < ndims - 1 ? origShape.getStorageDim(ndims - 1)
+                                           : shape[ndims - 1];
+    if (shape.getStorageDim(ndims - 1) != innerDim)
+        return -1;
+    int offset = 0;
+    for (int i = 0; i < ndims; i++)
+        offset = offset * origShape.getStorageDim(i) + origin[i];
+    return offset;
 }
 
 void TiledTensor::parallelCopyTileData(TileDataOperation op) {
-    int totalNumTiles = tiles.size();
-    int numTilesPerThread = std::ceil(totalNumTiles * 1.0 / threadPool->size());
-    int remainingTiles = totalNumTiles;
-    while (remainingTiles > 0) {
-        int numTiles = std::min(numTilesPerThread, remainingTiles);
-        auto args = new CopyTilesArgs(
-                this, totalNumTiles - remainingTiles, numTiles, op);
-        int cpuid =
-                threadPool->dispatchThread(tileCopyWorker, (void*)args);
-        assert(cpuid != -1 && "Failed to dispatch thread!");
-        remainingTiles -= numTiles;
-    }
-    threadPool->joinThreadPool();
+    // Each tile is a unit of work; the thread pool decides how to group them.
+    threadPool->parallelFor(0, tiles.size(), 1, [this, op](int start, int end) {
+        for (int i = start; i < end; i++) {
+            Tile* tile = getTile(i);
+            if (op == Scatter)
+                copyDataToTile(tile);
+            else if (op == Gather)
+                gatherDataFromTile(tile);
+        }
+    });
 }
 
 void TiledTensor::copyDataToAllTiles() {
-    // Don't copy if all the tiles have data filled.
-    if (dataFilled)
-        return;
-
     assert(origTensor != nullptr &&
            "TiledTensor must have the original tensor to copy data from!");
+    // Don't copy if all the tiles have the current data filled.
+    if (filledVersion == origTensor->getDataVersion())
+        return;
+
     if (fastForwardMode || !threadPool || tiles.size() == 1) {
         for (auto index = startIndex(); !index.end(); ++index)
             copyDataToTile(&tiles[index]);
     } else {
         parallelCopyTileData(Scatter);
     }
-    dataFilled = true;
+    filledVersion = origTensor->getDataVersion();
 }
 
 void TiledTensor::copyDataToTile(Tile* tile) {
-    // Don't copy if the tile already has data,  or if the tile is the original
-    // tensor (we have only one tile).
-    if (tile->hasData || tile->tensor == origTensor)
+    // Don't copy if the tile already has the current data, if the tile is a
+    // view or shares a source tile, or if the tile is the original tensor (we
+    // have only one tile).
+    if (tile->isView || tile->isShared || tile->tensor == origTensor)
+        return;
+    int version = origTensor->getDataVersion();
+    if (tile->dataVersion == version)
         return;
 
     // Perform the data copy.
     assert(tile->hasOrigin &&
            "Must set the tile's origin in the original tensor!");
-    if (useRawTensor) {
+    if (sourceTiles) {
+        copyDataFromSourceTiles(tile);
+    } else if (useRawTensor) {
         // Use the raw tensor copy function for the unary tile.
         copyRawTensorData(tile->tensor, origTensor, 0, tile->origin[0],
                           tile->tensor->getShape().storageSize());
@@ -147,7 +199,7 @@ void TiledTensor::copyDataToTile(Tile* tile) {
         copyTensorRegion(tile->tensor, origTensor, dstOrigin, tile->origin,
                          tile->tensor->getShape().dims());
     }
-    tile->hasData = true;
+    tile->dataVersion = version;
 }
 
 void TiledTensor::untile() {
@@ -155,8 +207,9 @@ void TiledTensor::untile() {
            "TiledTensor must have the original tensor to copy data to!");
     const TensorShape& tensorShape = origTensor->getShape();
     int ndims = tensorShape.ndims();
-    if (tiles.size() == 1) {
-        // No need to copy data if the tile is the original tensor.
+    if (tiles.size() == 1 || skipUntile) {
+        // No need to copy data if the tile is the original tensor, or if the
+        // readers of the original tensor use the tiles directly.
         return;
     }
 
@@ -168,7 +221,18 @@ void TiledTensor::untile() {
     }
 }
 
+void TiledTensor::untile(int index) {
+    assert(origTensor != nullptr &&
+           "TiledTensor must have the original tensor to copy data to!");
+    if (tiles.size() == 1 || skipUntile)
+        return;
+    gatherDataFromTile(&tiles[index]);
+}
+
 void TiledTensor::gatherDataFromTile(Tile* tile) {
+    // A view already writes to the original tensor.
+    if (tile->isView)
+        return;
     // Perform the data copy.
     assert(tile->hasOrigin &&
            "Must set the tile's origin in the original tensor!");
@@ -186,4 +250,50 @@ void TiledTensor::gatherDataFromTile(Tile* tile) {
     }
 }
 
+std::vector<Tensor*> TiledTensor::setSourceTiles(TiledTensor* source) {
+    assert(!useRawTensor && !source->useRawTensor &&
+           "Source tiles are only supported for tiles of regions!");
+    assert(source->origTensor == origTensor &&
+           "Source tiles must tile the same tensor!");
+    sourceTiles = source;
+    std::vector<Tensor*> replaced;
+    for (auto& tile : tiles) {
+        for (auto& srcTile : source->tiles) {
+            if (srcTile.origin == tile.origin &&
+                srcTile.tensor->getShape() == tile.tensor->getShape()) {
+                // The source tile will be filled with exactly the data this
+                // tile needs before this tile is read.
+                replaced.push_back(tile.tensor);
+                tile.tensor = srcTile.tensor;
+                tile.isShared = true;
+                break;
+            }
+        }
+    }
+    return replaced;
+}
+
+void TiledTensor::copyDataFromSourceTiles(Tile* tile) {
+    const TensorShape& shape = tile->tensor->getShape();
+    int ndims = shape.ndims();
+    std::vector<int> destOrigin(ndims), srcOrigin(ndims), regionSize(ndims);
+    for (auto& srcTile : sourceTiles->tiles) {
+        const TensorShape& srcShape = srcTile.tensor->getShape();
+        bool overlaps = true;
+        for (int i = 0; i < ndims && overlaps; i++) {
+            int start = std::max(tile->origin[i], srcTile.origin[i]);
+            int end = std::min(tile->origin[i] + shape[i],
+                               srcTile.origin[i] + srcShape[i]);
+            overlaps = start < end;
+            destOrigin[i] = start - tile->origin[i];
+            srcOrigin[i] = start - srcTile.origin[i];
+            regionSize[i] = end - start;
+        }
+        if (overlaps) {
+            copyTensorRegion(tile->tensor, srcTile.tensor, destOrigin,
+                             srcOrigin, regionSize);
+        }
+    }
+}
+
 }  // namespace smaug
@@ -1,12 +1,15 @@
 #ifndef _CORE_TENSOR_H_
 #define _CORE_TENSOR_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cmath>
+#include <cstdlib>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <google/protobuf/repeated_field.h>
@@ -101,6 +104,9 @@ class TensorShape {
     int alignment;
 };
 
+/** The maximum number of dimensions a TensorIndexIterator can iterate over. */
+constexpr const int maxTensorDims = 6;
+
 /**
  * An iterator over a multidimensional tensor's indices, accounting for data
  * alignment padding.
@@ -124,24 +130,48 @@ class TensorShape {
  *   data[iter(3,4,0,0)] = 3.4;
  *
  * The iterator skips over data alignment padding areas, if any exist.
+ *
+ * All the state lives in fixed-size arrays, and the strides and the linear
+ * index are kept up to date as the iterator advances, so converting the
+ * iterator to an index is free.
  */
 class TensorIndexIterator {
    public:
     TensorIndexIterator(const TensorShape& shape, bool _atEnd = false)
-            : dims(shape.dims()), padding(shape.padding()), atEnd(_atEnd),
-              advanceOne(std::vector<int>(dims.size(), 1)) {
-        state.resize(dims.size(), 0);
+            : ndims(shape.ndims()), linearIndex(0), atEnd(_atEnd) {
+        assert(ndims <= maxTensorDims && "Too many dimensions to iterate!");
+        int stride = 1;
+        for (int i = ndims - 1; i >= 0; i--) {
+            dims[i] = shape[i];
+            padding[i] = shape.getPadding(i);
+            strides[i] = stride;
+            stride *= dims[i] + padding[i];
+            state[i] = 0;
+            origin[i] = 0;
+            limit[i] = dims[i];
+        }
     }
 
-    operator int() const { return getIndex(state); }
+    operator int() const { return linearIndex; }
 
     bool end() const { return atEnd; }
 
-    void operator++() { advanceRegion(advanceOne); }
+    void operator++() {
+        for (int i = ndims - 1; i >= 0; i--) {
+            if (state[i] + 1 < limit[i]) {
+                state[i]++;
+                linearIndex += strides[i];
+                return;
+            }
+            linearIndex += (origin[i] - state[i]) * strides[i];
+            state[i] = origin[i];
+        }
+        atEnd = true;
+    }
 
     void operator+=(const std::vector<int>& region) {
-        assert(region.size() == state.size());
-        advanceRegion(region);
+        assert(region.size() == ndims);
+        advanceRegion(region.data());
     }
 
     template <typename... Args>
@@ -151,8 +181,11 @@ class TensorIndexIterator {
     }
 
     bool operator==(const TensorIndexIterator& other) const {
-        return (state == other.state && dims == other.dims &&
-                padding == other.padding && atEnd == other.atEnd);
+        return (ndims == other.ndims &&
+                std::equal(state, state + ndims, other.state) &&
+                std::equal(dims, dims + ndims, other.dims) &&
+                std::equal(padding, padding + ndims, other.padding) &&
+                atEnd == other.atEnd);
     }
 
     bool operator!=(const TensorIndexIterator& other) const {
@@ -171,45 +204,53 @@ class TensorIndexIterator {
      * the specified coordinates.
      */
     template <typename Container>
-    int getIndex(Container indices) const {
-        int linearIndex = 0, stride = 1;
-        for (int i = (int)indices.size() - 1; i >= 0; i--) {
-            linearIndex += indices[i] * stride;
-            stride *= (dims.at(i) + padding.at(i));
-        }
-        return linearIndex;
+    int getIndex(const Container& indices) const {
+        assert(indices.size() == ndims);
+        int index = 0;
+        for (int i = 0; i < ndims; i++)
+            index += indices[i] * strides[i];
+        return index;
     }
 
     /*
      * Advance the current iterator position by the given region size.
      *
-     * @param region An N-dim vector indicating how far to increment in each
+     * @param region An N-dim array indicating how far to increment in each
      * dimension, if the previous dimension overflowed and caused a carry-over
      * into the next dimension.
      */
-    virtual void advanceRegion(const std::vector<int>& region) {
+    void advanceRegion(const int* region) {
         bool carry = true;
-        for (int i = (int)state.size() - 1; i >= 0 && carry; i--) {
+        for (int i = ndims - 1; i >= 0 && carry; i--) {
             int currValue = state[i] + region[i];
-            carry = (currValue >= dims[i]);
+            carry = (currValue >= limit[i]);
             if (carry)
-                currValue = 0;
+                currValue = origin[i];
+            linearIndex += (currValue - state[i]) * strides[i];
             state[i] = currValue;
         }
         if (carry)
             atEnd = true;
     }
 
+    /** The number of dimensions of this iterator's Tensor. */
+    int ndims;
     /** The current location of the iterator. */
-    std::vector<int> state;
+    int state[maxTensorDims];
     /** The dimensions of this iterator's Tensor. */
-    std::vector<int> dims;
+    int dims[maxTensorDims];
     /** Alignment padding of the Tensor. */
-    std::vector<int> padding;
+    int padding[maxTensorDims];
+    /** The distance between two consecutive indices of each dimension. */
+    int strides[maxTensorDims];
+    /** The coordinate each dimension wraps around to. */
+    int origin[maxTensorDims];
+    /** The coordinate past the last one visited in each dimension. */
+    int limit[maxTensorDims];
+    /** The linear index of the current location. */
+    int linearIndex;
     /** If true, we've reached the end of the Tensor. */
     bool atEnd;
-    /** A vector of all ones, used to implement operator++. */
-    const std::vector<int> advanceOne;
 };
 
 /**
@@ -233,29 +274,14 @@ class TensorRegionIndexIterator : public TensorIndexIterator {
     TensorRegionIndexIterator(const TensorShape& shape,
                               const std::vector<int>& _origin,
                               const std::vector<int>& _regionSize)
-            : TensorIndexIterator(shape, false), origin(_origin),
-              regionSize(_regionSize) {
-        state = origin;
-    }
-
-   protected:
-    /** Advance the tensor region index with the specified region size. */
-    virtual void advanceRegion(const std::vector<int>& advanceRegionSize) {
-        bool carry = true;
-        for (int i = (int)state.size() - 1; i >= 0 && carry; i--) {
-            int currValue = state[i] + advanceRegionSize[i];
-            carry = (currValue >= dims[i] ||
-                     currValue >= origin[i] + regionSize[i]);
-            if (carry)
-                currValue = origin[i];
-            state[i] = currValue;
+            : TensorIndexIterator(shape, false) {
+        for (int i = 0; i < ndims; i++) {
+            origin[i] = _origin[i];
+            limit[i] = std::min(dims[i], _origin[i] + _regionSize[i]);
+            state[i] = origin[i];
         }
-        if (carry)
-            atEnd = true;
+        linearIndex = getIndex(_origin);
     }
-
-    std::vector<int> origin;
-    std::vector<int> regionSize;
 };
 
 /**
@@ -268,50 +294,59 @@ class TensorRegionIndexIterator : public TensorIndexIterator {
  */
 class TensorBase {
    public:
-    TensorBase() : name(""), dataFormat(UnknownStorageFormat), dead(false) {}
+    TensorBase()
+            : name(""), dataFormat(UnknownStorageFormat), dead(false),
+              dataVersion(0) {}
     virtual ~TensorBase() {}
 
     TensorBase(const std::string& _name, const TensorShape& _shape)
             : name(_name), shape(_shape), dataFormat(Uncompressed),
-              dataType(UnknownDataType), dead(false) {}
+              dataType(UnknownDataType), dead(false), dataVersion(0) {}
 
     TensorBase(const TensorProto& tensorProto)
             : name(tensorProto.name()), shape(tensorProto.shape()),
               dataFormat(tensorProto.data_format()),
-              dataType(tensorProto.data_type()), dead(false) {}
+              dataType(tensorProto.data_type()), dead(false),
+              dataVersion(0) {}
 
     // TODO: Do we need a copy constructor?
 
     std::string getName() const { return name; }
     const TensorShape& getShape() const { return shape; }
+    /**
+     * Changes the shape of the Tensor. This is only allowed before its
+     * storage is allocated.
+     */
+    void setShape(const TensorShape& _shape) {
+        assert(!containsData() && "Cannot reshape an allocated Tensor!");
+        shape = _shape;
+    }
     int ndims() const { return shape.ndims(); }
     int dim(int index) const { return shape[index]; }
     int getTotalDim(int index) const { return shape.getStorageDim(index); }
     int getDataStorageFormat() const { return dataFormat; }
     DataType getDataType() const { return dataType; }
+    void setDataType(DataType _dataType) { dataType = _dataType; }
     int getDataTypeSize() const {
-        switch (dataType) {
-            case Float16:
-                return sizeof(float16);
-            case Int32:
-                return sizeof(int32_t);
-            case Float32:
-                return sizeof(float);
-            case Int64:
-                return sizeof(int64_t);
-            case Float64:
-                return sizeof(double);
-            case Bool:
-                return sizeof(bool);
-            default:
-                assert(false && "UnknownDataType has no size!");
-                return 0;
-        }
+        int size = smaug::getDataTypeSize(dataType);
+        assert(size > 0 && "UnknownDataType has no size!");
+        return size;
     }
     bool isDead() const { return dead; }
     void setDead(bool _dead = true) { dead = _dead; }
     virtual bool containsData() const = 0;
 
+    /**
+     * Returns the version of the contents of the Tensor. Copies of the data,
+     * like tiles, are stale once the version changes.
+     */
+    int getDataVersion() const { return dataVersion; }
+    /**
+     * Marks that the contents of the Tensor have been rewritten, for example
+     * by running the Operator producing it again.
+     */
+    void bumpDataVersion() { dataVersion++; }
+
    protected:
     /** Name of of the Tensor. This should be a unique in the Workspace. */
     std::string name;
@@ -329,6 +364,8 @@ class TensorBase {
      * marked dead (except for MergeOp).
      */
     bool dead;
+    /** Incremented every time the contents of the Tensor are rewritten. */
+    int dataVersion;
 };
 
 /**
@@ -359,6 +396,18 @@ class Tensor : public TensorBase {
     Tensor(const TensorProto& tensorProto, const TensorData& tensorData)
             : TensorBase(tensorProto), tensorData(NULL) {
         DataType dataType = tensorProto.data_type();
+        if (!tensorData.raw_data().empty()) {
+            // Callers handling external data should have checked it already
+            // with validateRawData(); this only catches the ones that didn't.
+            std::string error = validateRawData(tensorProto, tensorData);
+            if (!error.empty()) {
+                std::cerr << "Invalid data for tensor " << name << ": "
+                          << error << ".\n";
+                abort();
+            }
+            fillRawData(tensorData.raw_data());
+            return;
+        }
         switch (dataType) {
             case Float16:
                 fillHalfData(tensorData.half_data());
@@ -464,6 +513,37 @@ class Tensor : public TensorBase {
 #endif
     }
 
+    /**
+     * Fills the Tensor with the raw bytes of a TensorData, which hold the
+     * data of its whole storage in the Tensor's data type.
+     */
+    void fillRawData(const std::string& rawData) {
+        allocateStorage(dataType);
+        size_t size = shape.storageSize() * getDataTypeSize();
+        assert(rawData.size() == size &&
+               "The raw data doesn't match the size of the tensor!");
+        memcpy(tensorData.get(), rawData.data(), size);
+    }
+
+    /**
+     * Checks that the raw bytes of a TensorData, if it has any, can be used
+     * as the data of the Tensor described by the TensorProto. Returns the
+     * error, or an empty string if the data is valid.
+     */
+    static std::string validateRawData(const TensorProto& tensorProto,
+                                       const TensorData& tensorData) {
+        if (tensorData.raw_data().empty())
+            return "";
+        if (tensorData.data_type() != tensorProto.data_type())
+            return "the data type of the raw data doesn't match the tensor";
+        TensorShape shape(tensorProto.shape());
+        size_t size = (size_t)shape.storageSize() *
+                      smaug::getDataTypeSize(tensorProto.data_type());
+        if (tensorData.raw_data().size() != size)
+            return "the size of the raw data doesn't match the tensor";
+        return "";
+    }
+
     /**
      * Allocates memory to store Tensor data.
      *
@@ -511,6 +591,28 @@ class Tensor : public TensorBase {
         }
     }
 
+    /**
+     * Backs the Tensor with memory owned elsewhere, like a region of an arena
+     * shared by many Tensors. The data type must already be set.
+     */
+    void setStorage(std::shared_ptr<void> storage) {
+        assert(tensorData == NULL && "The Tensor already has storage!");
+        assert(dataType != UnknownDataType && "The data type is not set!");
+        tensorData = storage;
+    }
+
+    /**
+     * Makes this Tensor a view of the storage of another Tensor, starting at
+     * the given offset in elements. The view keeps the storage alive.
+     */
+    void setStorageView(Tensor* parent, int offset) {
+        assert(tensorData == NULL && "The Tensor already has storage!");
+        dataType = parent->dataType;
+        char* ptr = reinterpret_cast<char*>(parent->tensorData.get()) +
+                    offset * parent->getDataTypeSize();
+        tensorData = std::shared_ptr<void>(parent->tensorData, ptr);
+    }
+
     /** Serializes this Tensor to a TensorProto. */
     TensorProto* asTensorProto();
 
@@ -553,7 +655,7 @@ class TiledTensor : public TensorBase {
   public:
    TiledTensor(Tensor* _origTensor = nullptr, bool _useRawTensor = false)
            : TensorBase(), origTensor(_origTensor), useRawTensor(_useRawTensor),
-             dataFilled(false) {}
+             filledVersion(-1), sourceTiles(nullptr), skipUntile(false) {}
    /**
     * Construct a TiledTensor.
     *
@@ -568,7 +670,8 @@ class TiledTensor : public TensorBase {
                Tensor* _origTensor = nullptr,
                bool _useRawTensor = false)
            : TensorBase("", shape), origTensor(_origTensor),
-             useRawTensor(_useRawTensor), dataFilled(false) {
+             useRawTensor(_useRawTensor), filledVersion(-1),
+             sourceTiles(nullptr), skipUntile(false) {
        tiles.resize(shape.size());
    }
 
@@ -612,7 +715,36 @@ class TiledTensor : public TensorBase {
                 Tensor* tensor,
                 bool copyData);
 
-   /** Copies data (if needed) to all the tiles from the original Tensor. */
+   /**
+    * Sets the specified tile to a view of the original Tensor, if the region
+    * of the tile with the given origin and shape is contiguous in the
+    * original Tensor, like a tile spanning all but the outermost tiled
+    * dimension. A view shares the storage of the original Tensor, so no data
+    * is ever copied into or out of it.
+    *
+    * @return The view, or nullptr if the region is not contiguous.
+    */
+   Tensor* setTileView(int index,
+                       const std::vector<int>& origin,
+                       const TensorShape& shape);
+
+   /** Returns true if the specified tile is a view of the original Tensor. */
+   bool isTileView(int index) const { return tiles.at(index).isView; }
+
+   /** Returns true if any tile is a view of the original Tensor. */
+   bool hasTileViews() const {
+       for (const auto& tile : tiles) {
+           if (tile.isView)
+               return true;
+       }
+       return false;
+   }
+
+   /**
+    * Copies data (if needed) to all the tiles from the original Tensor. The
+    * data is copied again whenever the data version of the original Tensor
+    * changes.
+    */
    void copyDataToAllTiles();
 
    /**
@@ -621,7 +753,41 @@ class TiledTensor : public TensorBase {
     */
    void untile();
 
-   static void* tileCopyWorker(void* _args);
+   /**
+    * Copies the data of the tile at the specified index into the original
+    * Tensor. This does untile() for just one tile, so that finished tiles can
+    * be copied while the others are still being computed.
+    */
+   void untile(int index);
+
+   /** Returns the Tensor that was tiled into this TiledTensor. */
+   Tensor* getOrigTensor() const { return origTensor; }
+
+   /** Returns true if the original Tensor itself is the only tile. */
+   bool isOrigTensorTile() const {
+       return tiles.size() == 1 && tiles[0].tensor == origTensor;
+   }
+
+   /**
+    * Fills the tiles from the tiles of another TiledTensor of the same
+    * original Tensor, like the output tiles of the Operator producing it,
+    * instead of from the original Tensor.
+    *
+    * A tile with the same shape and origin as a source tile shares the
+    * source tile's Tensor, so it needs no copy at all. Any other tile copies
+    * the regions it overlaps with from the source tiles, which includes the
+    * halo rows shared by neighboring tiles.
+    *
+    * Returns the Tensors of the tiles that now share a source tile. They are
+    * no longer used, so the caller should free them.
+    */
+   std::vector<Tensor*> setSourceTiles(TiledTensor* source);
+
+   /**
+    * If set, untile() leaves the original Tensor untouched, because all its
+    * readers take the data from the tiles directly.
+    */
+   void setSkipUntile(bool skip) { skipUntile = skip; }
 
   protected:
    /**
@@ -634,15 +800,24 @@ class TiledTensor : public TensorBase {
        std::vector<int> origin;
        /** True if the tile has its origin set. */
        bool hasOrigin;
-       /** True if we have copied data to this tile. */
-       bool hasData;
+       /**
+        * The data version of the original tensor when data was last copied
+        * to this tile, or -1 if it never was.
+        */
+       int dataVersion;
+       /** True if the tile shares the storage of the original tensor. */
+       bool isView;
+       /** True if the tile is the Tensor of a source tile. */
+       bool isShared;
 
        /**
         * Construct a new blank Tile.
         *
         * Set the properties of this Tile using TiledTensor::setTile
         */
-       Tile() : tensor(nullptr), origin(), hasOrigin(false), hasData(false) {}
+       Tile()
+               : tensor(nullptr), origin(), hasOrigin(false), dataVersion(-1),
+                 isView(false), isShared(false) {}
    };
 
    /**
@@ -655,20 +830,6 @@ class TiledTensor : public TensorBase {
      Gather
    };
 
-   struct CopyTilesArgs {
-       TiledTensor* tiledTensor;
-       int start;
-       int numTiles;
-       TileDataOperation op;
-
-       CopyTilesArgs(TiledTensor* _tiledTensor,
-                     int _start,
-                     int _numTiles,
-                     TileDataOperation _op)
-               : tiledTensor(_tiledTensor), start(_start), numTiles(_numTiles),
-                 op(_op) {}
-   };
-
    Tile* getTile(int index) { return &tiles[index]; }
 
    /** Copy data (if needed) to this tile from the original Tensor. */
@@ -677,6 +838,24 @@ class TiledTensor : public TensorBase {
    /** Copy data from this tile to the original Tensor. */
    void gatherDataFromTile(Tile* tile);
 
+   /** Copy data to this tile from the overlapping source tiles. */
+   void copyDataFromSourceTiles(Tile* tile);
+
+   /**
+    * Returns the offset in elements of a tile region in the storage of the
+    * original Tensor, or -1 if the region is not contiguous there, doesn't
+    * start on a cacheline or doesn't span a whole number of cachelines.
+    */
+   int getContiguousOffset(const std::vector<int>& origin,
+                           const TensorShape& shape) const;
+
+   /**
+    * Returns the offset in elements of a tile region in the storage of the
+    * original Tensor, or -1 if the region is not contiguous there.
+    */
+   int getRegionOffset(const std::vector<int>& origin,
+                       const TensorShape& shape) const;
+
    /** Split the work (data filling or gathering) across multiple threads. */
    void parallelCopyTileData(TileDataOperation op);
 
@@ -686,8 +865,17 @@ class TiledTensor : public TensorBase {
    /** The original Tensor that was tiled into this TiledTensor. */
    Tensor* origTensor;
 
-   /** True if all the tiles have data filled. */
-   bool dataFilled;
+   /**
+    * The data version of the original Tensor when all the tiles were last
+    * filled, or -1 if they never were.
+    */
+   int filledVersion;
+
+   /** If not null, the tiles are filled from these tiles. */
+   TiledTensor* sourceTiles;
+
+   /** If true, untile() is a no-op. */
+   bool skipUntile;
 
    /** The list of Tiles, indexed using a TensorIndexIterator. */
    std::vector<Tile> tiles;
@@ -1,8 +1,16 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
 #include "catch.hpp"
 #include "smaug/core/backend.h"
+#include "smaug/core/param_archive.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor_utils.h"
 #include "smaug/operators/data_op.h"
+#include "smaug/operators/relu_op.h"
 
 using namespace smaug;
 
@@ -37,6 +45,19 @@ TEST_CASE_METHOD(SmaugTest, "Unpacking of float16 tensor data", "[fp16]") {
         verifyOutputs(inputTensor, expectedValues);
     }
 
+    SECTION("Mapping tensor of [4, 3] shape from a parameter archive") {
+        Network* network = buildNetwork(modelPath + "fp16_odd_topo.txt",
+                                        modelPath + "fp16_odd_params.bin");
+        auto dataOp = network->getOperator("input");
+        auto inputTensor = dataOp->getInput(0);
+        std::vector<float16> expectedValues{
+            fp16(1.1), fp16(2.2),  fp16(3.3),   fp16(4.4),
+            fp16(5.5), fp16(6.6),  fp16(7.7),   fp16(8.8),
+            fp16(9.9), fp16(10.1), fp16(11.11), fp16(12.12)
+        };
+        verifyOutputs(inputTensor, expectedValues);
+    }
+
     SECTION("Unpacking tensor of [3, 3] shape") {
         Network* network = buildNetwork(modelPath + "fp16_odd_odd_topo.txt",
                                         modelPath + "fp16_odd_odd_params.pb");
@@ -52,3 +73,242 @@ TEST_CASE_METHOD(SmaugTest, "Unpacking of float16 tensor data", "[fp16]") {
     }
 }
 
+
+TEST_CASE("Parameter archives with bad entries", "[tensor]") {
+    // An archive with a single entry, whose data range wraps around.
+    struct {
+        ParamArchiveHeader header;
+        ParamArchiveEntry entry;
+        char name[8];
+    } archiveData = {};
+    memcpy(archiveData.header.magic, ParamArchive::magic,
+           sizeof(archiveData.header.magic));
+    archiveData.header.version = ParamArchive::version;
+    archiveData.header.numEntries = 1;
+    archiveData.header.alignment = 64;
+    archiveData.entry.nameOffset = offsetof(decltype(archiveData), name);
+    archiveData.entry.nameLength = 4;
+    archiveData.entry.dataOffset = UINT64_MAX - 63;
+    archiveData.entry.dataSize = 128;
+    archiveData.entry.dataType = Float32;
+    std::string path = "bad_param_archive.bin";
+    auto writeArchive = [&]() {
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        file.write(reinterpret_cast<char*>(&archiveData), sizeof(archiveData));
+    };
+
+    writeArchive();
+    REQUIRE(ParamArchive::isParamArchive(path));
+    REQUIRE(!ParamArchive().open(path));
+
+    // Too many entries for the size of the file.
+    archiveData.entry.dataOffset = 0;
+    archiveData.entry.dataSize = 0;
+    archiveData.header.numEntries = UINT32_MAX;
+    writeArchive();
+    REQUIRE(!ParamArchive().open(path));
+
+    // An alignment of zero.
+    archiveData.header.numEntries = 1;
+    archiveData.header.alignment = 0;
+    writeArchive();
+    REQUIRE(!ParamArchive().open(path));
+
+    // A data type that doesn't exist.
+    archiveData.header.alignment = 64;
+    archiveData.entry.dataType = 12345;
+    writeArchive();
+    REQUIRE(!ParamArchive().open(path));
+
+    // The same entry with a valid data type is accepted.
+    archiveData.entry.dataType = Float32;
+    writeArchive();
+    REQUIRE(ParamArchive().open(path));
+    remove(path.c_str());
+}
+
+TEST_CASE_METHOD(SmaugTest, "Tensor data from raw bytes", "[tensor]") {
+    TensorProto tensorProto;
+    tensorProto.set_name("raw");
+    TensorShapeProto* shapeProto = tensorProto.mutable_shape();
+    shapeProto->add_dims(3);
+    shapeProto->add_dims(3);
+    shapeProto->set_layout(NC);
+    TensorData tensorData;
+    tensorData.set_name("raw");
+
+    SECTION("Float16 data is not packed") {
+        tensorProto.set_data_type(Float16);
+        std::vector<float16> values;
+        for (int i = 0; i < 9; i++)
+            values.push_back(fp16(i * 1.1));
+        tensorData.set_data_type(Float16);
+        tensorData.set_raw_data(values.data(), values.size() * sizeof(float16));
+        Tensor tensor(tensorProto, tensorData);
+        verifyOutputs(&tensor, values);
+    }
+
+    SECTION("Padded float32 data") {
+        tensorProto.set_data_type(Float32);
+        shapeProto->set_alignment(8);
+        std::vector<float> values;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 8; j++)
+                values.push_back(j < 3 ? i * 3 + j : 0);
+        }
+        tensorData.set_data_type(Float32);
+        tensorData.set_raw_data(values.data(), values.size() * sizeof(float));
+        Tensor tensor(tensorProto, tensorData);
+        verifyOutputs(&tensor,
+                      std::vector<float>{ 0, 1, 2, 3, 4, 5, 6, 7, 8 });
+    }
+
+    SECTION("Mismatched raw data is rejected") {
+        tensorProto.set_data_type(Float32);
+        std::vector<float> values(9, 1);
+        tensorData.set_data_type(Float32);
+        tensorData.set_raw_data(values.data(), values.size() * sizeof(float));
+        REQUIRE(Tensor::validateRawData(tensorProto, tensorData).empty());
+        // The same bytes would be 18 float16 elements.
+        tensorData.set_data_type(Float16);
+        REQUIRE(!Tensor::validateRawData(tensorProto, tensorData).empty());
+        tensorData.set_data_type(Float32);
+        tensorData.set_raw_data(values.data(), 8 * sizeof(float));
+        REQUIRE(!Tensor::validateRawData(tensorProto, tensorData).empty());
+    }
+}
+
+TEST_CASE_METHOD(SmaugTest, "Tiles as views of the original tensor", "[tiling]") {
+    auto op = new ReluOp<ReferenceBackend>("relu", workspace());
+    auto createTensor = [&](const TensorShape& shape) {
+        Tensor* tensor = new Tensor("tensor", shape);
+        tensor->allocateStorage<float>();
+        float* data = tensor->data<float>();
+        for (int i = 0; i < shape.storageSize(); i++)
+            data[i] = i;
+        workspace()->addTensor(tensor);
+        return tensor;
+    };
+    // Checks that every tile holds the data of its region, where tile t
+    // starts at t * tileStep in the original tensor.
+    auto verifyTiles = [&](TiledTensor& tiledTensor,
+                           Tensor* tensor,
+                           std::vector<int> tileStep) {
+        tiledTensor.copyDataToAllTiles();
+        for (int t = 0; t < tiledTensor.size(); t++) {
+            Tensor* tile = tiledTensor[t];
+            for (auto idx = tile->startIndex(); !idx.end(); ++idx) {
+                auto tensorIdx = tensor->startIndex();
+                int index = tensorIdx(idx.currentIndex(0) + t * tileStep[0],
+                                      idx.currentIndex(1) + t * tileStep[1],
+                                      idx.currentIndex(2) + t * tileStep[2],
+                                      idx.currentIndex(3) + t * tileStep[3]);
+                REQUIRE(tile->data<float>()[idx] ==
+                        tensor->data<float>()[index]);
+            }
+        }
+    };
+
+    SECTION("Rowwise tiles are views") {
+        Tensor* tensor = createTensor(TensorShape({ 1, 8, 4, 16 }, NHWC));
+        TiledTensor tiledTensor = generateTiledTensor(
+                tensor, TensorShape({ 1, 2, 4, 16 }, NHWC), op);
+        REQUIRE(tiledTensor.size() == 4);
+        for (int t = 0; t < tiledTensor.size(); t++)
+            REQUIRE(tiledTensor.isTileView(t));
+        verifyTiles(tiledTensor, tensor, { 0, 2, 0, 0 });
+        // Writes to a view go straight to the original tensor.
+        tiledTensor[3]->data<float>()[0] = -1;
+        tiledTensor.untile();
+        REQUIRE(tensor->data<float>()[6 * 4 * 16] == -1);
+    }
+
+    SECTION("Channelwise tiles are copies") {
+        Tensor* tensor = createTensor(TensorShape({ 1, 2, 4, 16 }, NHWC));
+        TiledTensor tiledTensor = generateTiledTensor(
+                tensor, TensorShape({ 1, 2, 4, 8 }, NHWC), op);
+        REQUIRE(tiledTensor.size() == 2);
+        REQUIRE(!tiledTensor.hasTileViews());
+        verifyTiles(tiledTensor, tensor, { 0, 0, 0, 8 });
+    }
+
+    SECTION("Tiles that don't span whole cachelines are copies") {
+        // Each tile is 4 floats, which is less than a cacheline, so a kernel
+        // writing whole cachelines to a view would overrun into the next one.
+        Tensor* tensor = createTensor(TensorShape({ 1, 6, 1, 4 }, NHWC));
+        TiledTensor tiledTensor = generateTiledTensor(
+                tensor, TensorShape({ 1, 1, 1, 4 }, NHWC), op);
+        REQUIRE(tiledTensor.size() == 6);
+        REQUIRE(!tiledTensor.hasTileViews());
+        verifyTiles(tiledTensor, tensor, { 0, 1, 0, 0 });
+    }
+
+    SECTION("Tiles that don't start on a cacheline are copies") {
+        // The tiles of the second batch span two cachelines but start 48
+        // bytes into the tensor, after the 4-float edge tile of the first.
+        Tensor* tensor = createTensor(TensorShape({ 2, 3, 1, 4 }, NHWC));
+        TiledTensor tiledTensor = generateTiledTensor(
+                tensor, TensorShape({ 1, 2, 1, 4 }, NHWC), op);
+        REQUIRE(tiledTensor.size() == 4);
+        REQUIRE(tiledTensor.isTileView(0));
+        REQUIRE(!tiledTensor.isTileView(1));
+        REQUIRE(!tiledTensor.isTileView(2));
+        REQUIRE(!tiledTensor.isTileView(3));
+        tiledTensor.copyDataToAllTiles();
+        Tensor* tile = tiledTensor[2];
+        for (int i = 0; i < 8; i++)
+            REQUIRE(tile->data<float>()[i] == tensor->data<float>()[12 + i]);
+    }
+
+    SECTION("Raw tiles are views unless they need padding") {
+        Tensor* tensor = createTensor(TensorShape({ 1, 20 }, NC));
+        TiledTensor tiledTensor = generateTiledTensorPerBatchNC(
+                tensor, TensorShape({ 1, 16 }, NC, 8), op);
+        REQUIRE(tiledTensor.size() == 2);
+        REQUIRE(tiledTensor.isTileView(0));
+        // The padding of the last tile would run past the original tensor.
+        REQUIRE(!tiledTensor.isTileView(1));
+    }
+}
+
+TEST_CASE("Tensor index iterators", "[iterator]") {
+    // 3x5 tensor whose innermost dimension is padded to 8.
+    TensorShape shape({ 3, 5 }, NC, 8);
+
+    SECTION("Iterating over the whole tensor skips the padding") {
+        auto iter = TensorIndexIterator(shape);
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 5; j++) {
+                REQUIRE(!iter.end());
+                REQUIRE((int)iter == i * 8 + j);
+                REQUIRE(iter(i, j) == i * 8 + j);
+                REQUIRE(iter.currentIndex(0) == i);
+                REQUIRE(iter.currentIndex(1) == j);
+                ++iter;
+            }
+        }
+        REQUIRE(iter.end());
+    }
+
+    SECTION("Iterating over a region") {
+        auto iter = TensorRegionIndexIterator(shape, { 1, 2 }, { 2, 2 });
+        std::vector<int> expected{ 10, 11, 18, 19 };
+        for (int index : expected) {
+            REQUIRE(!iter.end());
+            REQUIRE((int)iter == index);
+            ++iter;
+        }
+        REQUIRE(iter.end());
+    }
+
+    SECTION("Advancing by a region") {
+        auto iter = TensorRegionIndexIterator(shape, { 0, 1 }, { 3, 4 });
+        std::vector<int> expected{ 1, 3, 9, 11, 17, 19 };
+        for (int index : expected) {
+            REQUIRE(!iter.end());
+            REQUIRE((int)iter == index);
+            iter += { 1, 2 };
+        }
+        REQUIRE(iter.end());
+    }
+}
@@ -3,6 +3,7 @@
 #include "fp16.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/tensor_utils.h"
+#include "smaug/core/tile_pool.h"
 #include "smaug/core/workspace.h"
 #include "smaug/utility/debug_stream.h"
 
@@ -28,7 +29,7 @@ std::ostream& operator<<(std::ostream& os, const TensorShape& shape) {
 
 std::ostream& operator<<(std::ostream& os, const TensorIndexIterator& iter) {
     os << "( ";
-    for (int i = 0; i < iter.dims.size(); ++i) {
+    for (int i = 0; i < iter.ndims; ++i) {
         os << iter.state[i] << " ";
     }
     os << ")";
@@ -196,6 +197,25 @@ int computePaddedTileDim(int maxTileDim,
 }
 }  // namespace internal
 
+Tensor* createTile(Tensor* tensor, const TensorShape& tileShape) {
+    Tensor* tile = new Tensor("", tileShape);
+    tile->setDataType(tensor->getDataType());
+    tile->setStorage(TileBufferPool::get()->allocate(
+            tileShape.storageSize() * tile->getDataTypeSize()));
+    return tile;
+}
+
+void setTileRegion(TiledTensor& tiledTensor,
+                   int index,
+                   const std::vector<int>& origin,
+                   const TensorShape& tileShape,
+                   bool copyData) {
+    if (tiledTensor.setTileView(index, origin, tileShape))
+        return;
+    Tensor* tile = createTile(tiledTensor.getOrigTensor(), tileShape);
+    tiledTensor.setTile(index, origin, tile, copyData);
+}
+
 TiledTensor generateTiledTensorPerBatchNC(Tensor* tensor,
                                           const TensorShape& tileShape,
                                           Operator* op,
@@ -214,11 +234,8 @@ TiledTensor generateTiledTensorPerBatchNC(Tensor* tensor,
         TensorShape currentShape({ 1, currentTileSize },
                                  DataLayout::NC,
                                  tileShape.getAlignment());
-        std::string tileName = op->getName() + ":" + tensor->getName() +
-                               "/tile:" + std::to_string((int)tileIndex);
-        Tensor* tile = new Tensor(tileName, currentShape);
-        tile->allocateStorage(tensor->getDataType());
-        tiledTensor.setTile(tileIndex, { srcOffset }, tile, copyData);
+        setTileRegion(
+                tiledTensor, tileIndex, { srcOffset }, currentShape, copyData);
         srcOffset += currentTileSize;
         remainingSize -= currentTileSize;
     }
@@ -305,11 +322,8 @@ TiledTensor generateTiledTensorWithStrideAndPadding(
             TensorShape currentShape(currentTileShape,
                                      tileShape.getLayout(),
                                      tileShape.getAlignment());
-            std::string tileName = op->getName() + ":" + tensor->getName() +
-                                   "/tile:" + std::to_string((int)tileIndex);
-            Tensor* tile = new Tensor(tileName, currentShape);
-            tile->allocateStorage(tensor->getDataType());
-            tiledTensor.setTile(tileIndex, currentOrigin, tile, false);
+            setTileRegion(
+                    tiledTensor, tileIndex, currentOrigin, currentShape, false);
             for (int i = ndims - 1; i >= 0; i--) {
                 currentOrigin[i] += currentShape[i];
                 if (currentOrigin[i] >= inputShape[i]) {
@@ -348,8 +362,13 @@ void flattenTiledTensor(TiledTensor& tiledTensor, Tensor* destTensor) {
          ++tileIndex) {
         Tensor* tile = tiledTensor[tileIndex];
         const TensorShape& tileShape = tile->getShape();
-        copyRawTensorData(
-                destTensor, tile, destOffset, 0, tileShape.storageSize());
+        // A view of the destination already has its data in place.
+        bool inPlace = tiledTensor.isTileView(tileIndex) &&
+                       tiledTensor.getOrigTensor() == destTensor;
+        if (!inPlace) {
+            copyRawTensorData(
+                    destTensor, tile, destOffset, 0, tileShape.storageSize());
+        }
         destOffset += tileShape.storageSize();
     }
 }
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <vector>
 
+#include "fp16.h"
 #include "smaug/core/tensor.h"
 
 namespace smaug {
@@ -31,6 +32,20 @@ void printTensorElement<float16>(std::ostream& os,
                                  const float16* data,
                                  int index);
 
+/**
+ * Converts a data element to float32. Operators that compute in float32
+ * whatever the data type of their Tensors read them with this.
+ */
+inline float toFloat(float value) { return value; }
+inline float toFloat(float16 value) { return fp16_ieee_to_fp32_value(value); }
+
+/** Converts a float32 value to the given data type. */
+template <typename DType> DType fromFloat(float value);
+template <> inline float fromFloat<float>(float value) { return value; }
+template <> inline float16 fromFloat<float16>(float value) {
+    return fp16_ieee_from_fp32_value(value);
+}
+
 /**
  * Pretty-print a Tensor's name, shape, and contents to the provided ostream.
  */
@@ -196,6 +211,24 @@ void copyTensorData(Tensor* dest,
 void copyRawTensorData(
         Tensor* dest, Tensor* src, int destOffset, int srcOffset, int copySize);
 
+/**
+ * Creates a tile with the given shape for a region of the Tensor. The storage
+ * of the tile is taken from the TileBufferPool, and the tile has no name.
+ */
+Tensor* createTile(Tensor* tensor, const TensorShape& tileShape);
+
+/**
+ * Sets a tile of the TiledTensor to the region of its original Tensor with
+ * the given origin and shape. If the region is contiguous in the original
+ * Tensor, the tile is a view of it; otherwise, it is a new tile from
+ * createTile(), optionally filled with the data of the region.
+ */
+void setTileRegion(TiledTensor& tiledTensor,
+                   int index,
+                   const std::vector<int>& origin,
+                   const TensorShape& tileShape,
+                   bool copyData);
+
 /**
  * Tile the provided NC Tensor per batch.
  *
@@ -0,0 +1,45 @@
+#include "smaug/core/tile_fusion.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+int fuseTiledOperators(Network* network) {
+    const Graph& graph = network->getGraph();
+    int numFused = 0;
+    for (auto nameOp : network->getOperators()) {
+        Operator* producer = nameOp.second;
+        TiledTensor* outputTiles = producer->getTiledOutput(0);
+        // Output tiles that are views already write the original tensor.
+        if (!outputTiles || outputTiles->isOrigTensorTile() ||
+            outputTiles->hasTileViews())
+            continue;
+        // The original tensor is never filled once the tiles are fused, so
+        // the consumer must be its only reader.
+        Vertex vertex = producer->getVertex();
+        if (boost::out_degree(vertex, graph) != 1)
+            continue;
+        out_edge_iter edgeIt, edgeEnd;
+        boost::tie(edgeIt, edgeEnd) = out_edges(vertex, graph);
+        Operator* consumer =
+                get(boost::vertex_op, graph, target(*edgeIt, graph));
+        TensorIndices indices = get(boost::edge_name, graph, *edgeIt);
+        TiledTensor* inputTiles = consumer->getTiledInput(indices.destIdx);
+        if (!inputTiles || inputTiles->isOrigTensorTile() ||
+            inputTiles->hasTileViews() ||
+            inputTiles->getOrigTensor() != outputTiles->getOrigTensor())
+            continue;
+        // The consumer tiles that share a producer tile are no longer used.
+        consumer->getWorkspace()->deleteTiles(
+                inputTiles->setSourceTiles(outputTiles));
+        outputTiles->setSkipUntile(true);
+        dout(1) << "Fused the output tiles of " << producer->getName()
+                << " with the input tiles of " << consumer->getName()
+                << ".\n";
+        numFused++;
+    }
+    return numFused;
+}
+
+}  // namespace smaug
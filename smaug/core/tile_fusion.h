@@ -0,0 +1,28 @@
+#ifndef _CORE_TILE_FUSION_H_
+#define _CORE_TILE_FUSION_H_
+
+#include "smaug/core/network.h"
+
+namespace smaug {
+
+/**
+ * fuseTiledOperators connects back-to-back tiled Operators of the Network, so
+ * that the output tiles of a producer are fed directly to the input tiles of
+ * its consumer. The intermediate Tensor is then neither gathered from the
+ * producer's output tiles nor scattered again into the consumer's input
+ * tiles.
+ *
+ * A pair of Operators is fused only if the output Tensor of the producer is
+ * read by no other Operator, and both Operators tile it into more than one
+ * tile (see Operator::getTiledInput() and Operator::getTiledOutput()), none
+ * of which is a view of the Tensor.
+ *
+ * This must be called after all the Operators are tiled.
+ *
+ * @return The number of fused Operator pairs.
+ */
+int fuseTiledOperators(Network* network);
+
+}  // namespace smaug
+
+#endif
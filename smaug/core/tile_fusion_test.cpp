@@ -0,0 +1,88 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tile_fusion.h"
+#include "smaug/operators/smv/smv_test_common.h"
+#include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_pooling_op.h"
+
+using namespace smaug;
+
+class TileFusionTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    // Builds a chain of conv -> conv -> max pooling on SMV, where every
+    // tensor in between is tiled channelwise, so the tiles can't be views of
+    // the tensors.
+    std::vector<Operator*> buildConvChain() {
+        TensorShape inputShape(
+                { 1, 16, 16, 256 }, NHWC, SmvBackend::Alignment);
+        Tensor* input = new Tensor("input", inputShape);
+        input->allocateStorage<float16>();
+        fillTensorWithRandomData(input);
+        Operator* last = addDataOp<SmvBackend>(input);
+
+        std::vector<Operator*> ops;
+        auto addToChain = [&](Operator* op) {
+            addOp(op, { last });
+            for (int i = 1; i < op->getInputs().size(); i++) {
+                Tensor* tensor = op->getInput(i);
+                tensor->allocateStorage<float16>();
+                fillTensorWithRandomData(tensor);
+            }
+            last = op;
+            ops.push_back(op);
+        };
+        for (int i = 0; i < 2; i++) {
+            auto convOp = new SmvConvolutionOp(
+                    "conv" + std::to_string(i), workspace());
+            convOp->setStride(1, 1);
+            convOp->setPadding(SamePadding);
+            convOp->setWeightDims(3, 3, 256);
+            addToChain(convOp);
+        }
+        auto poolOp = new SmvMaxPoolingOp("pool", workspace());
+        poolOp->setPoolingSize(2, 2);
+        poolOp->setPoolingStride(2, 2);
+        addToChain(poolOp);
+        allocateOutputs<float16>();
+        return ops;
+    }
+};
+
+TEST_CASE_METHOD(TileFusionTest, "Fusing the tiles of SMV operators", "[fusion]") {
+    std::vector<Operator*> ops = buildConvChain();
+    // Run the chain without fusion to get the expected output.
+    for (auto op : ops) {
+        op->tile();
+        op->run();
+    }
+    Tensor* expected = convertFp16ToFp32Tensor(
+            ops.back()->getOutput(0), workspace());
+
+    // Clear the intermediate tensors, so the fused operators can only get
+    // their inputs from the tiles of the previous operators.
+    for (auto op : ops) {
+        Tensor* output = op->getOutput(0);
+        float16* data = output->data<float16>();
+        std::fill(data, data + output->getShape().storageSize(), 0);
+        op->tile();
+    }
+    int numTiles = workspace()->getNumTiles();
+    REQUIRE(fuseTiledOperators(network()) == 2);
+    // The consumer tiles that share a producer tile are freed.
+    REQUIRE(workspace()->getNumTiles() < numTiles);
+    for (auto op : ops)
+        op->run();
+    Tensor* output = convertFp16ToFp32Tensor(
+            ops.back()->getOutput(0), workspace());
+    verifyOutputs<float>(output, expected);
+
+    // The fused intermediate tensors are never filled.
+    Tensor* intermediate = ops[0]->getOutput(0);
+    float16* data = intermediate->data<float16>();
+    for (auto idx = intermediate->startIndex(); !idx.end(); ++idx)
+        REQUIRE(data[idx] == 0);
+}
@@ -0,0 +1,62 @@
+#include <cstdlib>
+
+#include "smaug/core/tile_pool.h"
+#include "smaug/operators/common.h"
+#include "smaug/utility/utils.h"
+
+namespace smaug {
+
+TileBufferPool::~TileBufferPool() {
+    for (auto& sizeBuffers : freeBuffers) {
+        for (void* buffer : sizeBuffers.second)
+            free(buffer);
+    }
+}
+
+TileBufferPool* TileBufferPool::get() {
+    // Never destroyed, as tiles can outlive any static object.
+    static TileBufferPool* pool = new TileBufferPool();
+    return pool;
+}
+
+size_t TileBufferPool::getSizeClass(size_t size) {
+    size_t step = CACHELINE_SIZE;
+    while (size > step * 16)
+        step *= 2;
+    return next_multiple(std::max<size_t>(size, 1), step);
+}
+
+std::shared_ptr<void> TileBufferPool::allocate(size_t size) {
+    size_t sizeClass = getSizeClass(size);
+    void* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<void*>& buffers = freeBuffers[sizeClass];
+        if (!buffers.empty()) {
+            buffer = buffers.back();
+            buffers.pop_back();
+            numReused++;
+        } else {
+            numAllocated++;
+        }
+    }
+    if (!buffer)
+        buffer = malloc_aligned(sizeClass, false);
+    return std::shared_ptr<void>(buffer, [this, sizeClass](void* buffer) {
+        release(sizeClass, buffer);
+    });
+}
+
+void TileBufferPool::release(size_t sizeClass, void* buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<void*>& buffers = freeBuffers[sizeClass];
+        if ((int)buffers.size() < maxFreePerClass) {
+            buffers.push_back(buffer);
+            return;
+        }
+    }
+    free(buffer);
+}
+
+}  // namespace smaug
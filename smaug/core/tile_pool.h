@@ -0,0 +1,71 @@
+#ifndef _CORE_TILE_POOL_H_
+#define _CORE_TILE_POOL_H_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace smaug {
+
+/**
+ * TileBufferPool hands out the storage of Tensor tiles.
+ *
+ * Requests are rounded up to a size class, and a buffer that is no longer
+ * referenced goes back to the free list of its size class instead of the
+ * heap, so that it can be handed out again for any tile of the same class.
+ * Up to 16 cachelines, size classes are multiples of the cacheline size.
+ * Beyond that, they are spaced by a sixteenth of the next power of two, so
+ * less than 1/8th of a buffer is wasted on rounding.
+ *
+ * Tiles are created by the thousands when large Tensors are tiled, so this
+ * saves one heap allocation per tile, except the first time each buffer is
+ * needed.
+ *
+ * Only up to maxFreePerClass free buffers are kept per size class, and any
+ * buffer released beyond that goes back to the heap. Otherwise a Network with
+ * many different tile shapes would hold on to its peak tile memory for the
+ * life of the process.
+ */
+class TileBufferPool {
+   public:
+    /** The default number of free buffers kept per size class. */
+    static constexpr int kDefaultMaxFreePerClass = 64;
+
+    TileBufferPool(int _maxFreePerClass = kDefaultMaxFreePerClass)
+            : maxFreePerClass(_maxFreePerClass), numAllocated(0),
+              numReused(0) {}
+    ~TileBufferPool();
+
+    /** Returns the process-wide pool. */
+    static TileBufferPool* get();
+
+    /**
+     * Returns a cacheline-aligned buffer of at least size bytes. The buffer
+     * returns to the pool when the last reference to it is dropped.
+     */
+    std::shared_ptr<void> allocate(size_t size);
+
+    /** Returns the size class of a request of size bytes. */
+    static size_t getSizeClass(size_t size);
+
+    /** Number of buffers allocated from the heap. */
+    int getNumAllocated() const { return numAllocated; }
+    /** Number of requests served by a recycled buffer. */
+    int getNumReused() const { return numReused; }
+
+   protected:
+    void release(size_t sizeClass, void* buffer);
+
+    std::mutex mutex;
+    /** Free buffers, indexed by size class. */
+    std::unordered_map<size_t, std::vector<void*>> freeBuffers;
+    /** The most free buffers kept per size class. */
+    int maxFreePerClass;
+    int numAllocated;
+    int numReused;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,63 @@
+#include <cstdint>
+
+#include "catch.hpp"
+#include "smaug/core/tile_pool.h"
+#include "smaug/operators/common.h"
+
+using namespace smaug;
+
+TEST_CASE("Tile buffer pool", "[tilepool]") {
+    TileBufferPool pool;
+
+    SECTION("Size classes") {
+        REQUIRE(TileBufferPool::getSizeClass(1) == CACHELINE_SIZE);
+        REQUIRE(TileBufferPool::getSizeClass(CACHELINE_SIZE) ==
+                CACHELINE_SIZE);
+        REQUIRE(TileBufferPool::getSizeClass(CACHELINE_SIZE + 1) ==
+                2 * CACHELINE_SIZE);
+        for (size_t size = 1; size < 1000000; size += 997) {
+            size_t sizeClass = TileBufferPool::getSizeClass(size);
+            REQUIRE(sizeClass >= size);
+            REQUIRE(sizeClass % CACHELINE_SIZE == 0);
+            REQUIRE(sizeClass - size < std::max<size_t>(size / 8, 64));
+        }
+    }
+
+    SECTION("Buffers are recycled by size class") {
+        void* first = nullptr;
+        {
+            auto buffer = pool.allocate(1000);
+            first = buffer.get();
+            REQUIRE(reinterpret_cast<uintptr_t>(first) % CACHELINE_SIZE == 0);
+            // A live buffer is never handed out twice.
+            auto other = pool.allocate(1000);
+            REQUIRE(other.get() != first);
+        }
+        REQUIRE(pool.getNumAllocated() == 2);
+        // Both buffers are free again, and a request of the same size class
+        // gets one of them back.
+        auto buffer = pool.allocate(TileBufferPool::getSizeClass(1000));
+        REQUIRE(pool.getNumAllocated() == 2);
+        REQUIRE(pool.getNumReused() == 1);
+        // A larger request needs a new buffer.
+        auto larger = pool.allocate(100000);
+        REQUIRE(pool.getNumAllocated() == 3);
+    }
+
+    SECTION("Only a limited number of free buffers are kept") {
+        TileBufferPool smallPool(2);
+        {
+            std::vector<std::shared_ptr<void>> buffers;
+            for (int i = 0; i < 3; i++)
+                buffers.push_back(smallPool.allocate(1000));
+        }
+        REQUIRE(smallPool.getNumAllocated() == 3);
+        // Only two of the three buffers were kept, so the third request goes
+        // to the heap again.
+        std::vector<std::shared_ptr<void>> buffers;
+        for (int i = 0; i < 3; i++)
+            buffers.push_back(smallPool.allocate(1000));
+        REQUIRE(smallPool.getNumReused() == 2);
+        REQUIRE(smallPool.getNumAllocated() == 4);
+    }
+}
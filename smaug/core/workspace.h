@@ -1,8 +1,11 @@
 #ifndef _CORE_WORKSPACE_H_
 #define _CORE_WORKSPACE_H_
 
+#include <algorithm>
 #include <map>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "smaug/core/tensor.h"
 #include "smaug/core/operator.h"
@@ -20,6 +23,8 @@ class Workspace {
     ~Workspace() {
         for (auto& tensor : tensors)
             delete tensor.second;
+        for (auto tile : tiles)
+            delete tile;
     }
 
     Tensor* addTensor(Tensor* tensor) {
@@ -27,13 +32,32 @@ class Workspace {
         return tensor;
     }
 
+    /**
+     * Takes the ownership of the tiles of a TiledTensor. Tiles are never
+     * looked up by name, so they are kept out of the name map.
+     */
     void addTiledTensor(TiledTensor& tiledTensor) {
         for (auto i = tiledTensor.startIndex(); !i.end(); ++i) {
-            Tensor* tensor = tiledTensor[i];
-            tensors[tensor->getName()] = static_cast<TensorBase*>(tensor);
+            Tensor* tile = tiledTensor[i];
+            if (tile != tiledTensor.getOrigTensor())
+                tiles.push_back(tile);
         }
     }
 
+    /** Frees the tiles in unused that are owned by this Workspace. */
+    void deleteTiles(const std::vector<Tensor*>& unused) {
+        std::unordered_set<Tensor*> unusedSet(unused.begin(), unused.end());
+        auto it = std::stable_partition(
+                tiles.begin(), tiles.end(),
+                [&](Tensor* tile) { return unusedSet.count(tile) == 0; });
+        for (auto i = it; i != tiles.end(); ++i)
+            delete *i;
+        tiles.erase(it, tiles.end());
+    }
+
+    /** Returns the number of tiles owned by this Workspace. */
+    int getNumTiles() const { return tiles.size(); }
+
     Tensor* getTensor(const std::string& name) const {
         if (tensors.find(name) == tensors.end())
             return nullptr;
@@ -46,6 +70,7 @@ class Workspace {
 
    protected:
     std::map<std::string, TensorBase*> tensors;
+    std::vector<Tensor*> tiles;
 };
 
 }
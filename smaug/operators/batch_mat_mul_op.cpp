@@ -0,0 +1,75 @@
+#include <vector>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/batch_mat_mul_op.h"
+#include "smaug/operators/ref/ref_gemm.h"
+
+namespace smaug {
+
+namespace {
+
+// The GEMM is computed in float32. Float32 tensors are used in place, and
+// float16 ones are converted to and from float32 buffers.
+const float* loadFloats(Tensor* tensor, std::vector<float>& buffer) {
+    if (tensor->getDataType() == DataType::Float32)
+        return tensor->data<float>();
+    const float16* data = tensor->data<float16>();
+    buffer.resize(tensor->getShape().storageSize());
+    for (int i = 0; i < buffer.size(); i++)
+        buffer[i] = toFloat(data[i]);
+    return buffer.data();
+}
+
+float* outputFloats(Tensor* tensor, std::vector<float>& buffer) {
+    if (tensor->getDataType() == DataType::Float32)
+        return tensor->data<float>();
+    buffer.assign(tensor->getShape().storageSize(), 0);
+    return buffer.data();
+}
+
+void storeFloats(const std::vector<float>& buffer, Tensor* tensor) {
+    if (tensor->getDataType() == DataType::Float32)
+        return;
+    float16* data = tensor->data<float16>();
+    for (int i = 0; i < buffer.size(); i++)
+        data[i] = fromFloat<float16>(buffer[i]);
+}
+
+void runBatchMatMul(Tensor* a, Tensor* b, Tensor* c, bool transposeB) {
+    const TensorShape& aShape = a->getShape();
+    const TensorShape& bShape = b->getShape();
+    const TensorShape& cShape = c->getShape();
+    int batch = aShape[0];
+    int m = aShape[1];
+    int k = aShape[2];
+    int n = cShape[2];
+    int lda = aShape.getStorageDim(2);
+    int ldb = bShape.getStorageDim(2);
+    int ldc = cShape.getStorageDim(2);
+    std::vector<float> aBuffer, bBuffer, cBuffer;
+    const float* aData = loadFloats(a, aBuffer);
+    const float* bData = loadFloats(b, bBuffer);
+    float* cData = outputFloats(c, cBuffer);
+    for (int i = 0; i < batch; i++) {
+        ref::gemm(aData + i * m * lda, lda, bData + i * bShape[1] * ldb, ldb,
+                  transposeB, cData + i * m * ldc, ldc, m, n, k);
+    }
+    storeFloats(cBuffer, c);
+}
+
+}  // namespace
+
+template <>
+void BatchMatMulOp<ReferenceBackend>::run() {
+    runBatchMatMul(getInput(InputA), getInput(InputB), getOutput(Outputs),
+                   transposeB);
+}
+
+template <>
+void BatchMatMulOp<SmvBackend>::run() {
+    runBatchMatMul(getInput(InputA), getInput(InputB), getOutput(Outputs),
+                   transposeB);
+}
+
+}  // namespace smaug
@@ -0,0 +1,100 @@
+#ifndef _OPERATORS_BATCH_MAT_MUL_OP_H_
+#define _OPERATORS_BATCH_MAT_MUL_OP_H_
+
+#include "smaug/core/backend.h"
+#include "smaug/core/operator.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+#include "smaug/operators/common.h"
+
+namespace smaug {
+
+/** \ingroup Operators
+ *
+ * \brief Multiplies two batches of matrices, one pair of matrices per batch.
+ *
+ * This computes `C[i] = A[i] x B[i]` for every batch i in a single operator,
+ * instead of splitting the batches and issuing one inner product per batch.
+ * The matrices are the two inner dimensions of 3D tensors, whatever their
+ * layouts.
+ *
+ * @tparam Backend The Backend specialization of this Operator.
+ */
+template <typename Backend>
+class BatchMatMulOp : public Operator {
+   public:
+    enum {
+        /** The first operand, shaped [batch, m, k]. */
+        InputA,
+        /**
+         * The second operand, shaped [batch, k, n], or [batch, n, k] if
+         * setTransposeB(true) is called.
+         */
+        InputB,
+        kNumInputs
+    };
+    enum {
+        /** The results, shaped [batch, m, n] (NTC). */
+        Outputs,
+        kNumOutputs
+    };
+
+    BatchMatMulOp(const std::string& name, Workspace* workspace)
+            : Operator(name, OpType::BatchMatMul, workspace),
+              transposeB(false), sampling({ NoSampling, 1 }) {
+        inputs.resize(kNumInputs, nullptr);
+        outputs.resize(kNumOutputs, nullptr);
+    }
+
+    /** Sets whether the matrices of InputB are stored transposed. */
+    void setTransposeB(bool _transposeB) { transposeB = _transposeB; }
+    bool getTransposeB() const { return transposeB; }
+
+    int getBatchSize() const { return getInput(InputA)->getShape()[0]; }
+    /** Returns the number of rows of the results. */
+    int getNumRows() const { return getInput(InputA)->getShape()[1]; }
+    /** Returns the number of columns of the results. */
+    int getNumCols() const {
+        return getInput(InputB)->getShape()[transposeB ? 1 : 2];
+    }
+    /** Returns the size of the reduction dimension. */
+    int getReductionSize() const { return getInput(InputA)->getShape()[2]; }
+
+    bool validate() override {
+        const TensorShape& aShape = getInput(InputA)->getShape();
+        const TensorShape& bShape = getInput(InputB)->getShape();
+        if (aShape.ndims() != 3 || bShape.ndims() != 3) {
+            std::cerr << "[" << name << "]: Both operands must be 3D.\n";
+            return false;
+        }
+        if (aShape[0] != bShape[0] ||
+            aShape[2] != bShape[transposeB ? 2 : 1]) {
+            std::cerr << "[" << name << "]: The operands shaped "
+                      << aShape << " and " << bShape
+                      << " can't be multiplied.\n";
+            return false;
+        }
+        return Operator::validate();
+    }
+
+    void createAllTensors() override {
+        TensorShape shape({ getBatchSize(), getNumRows(), getNumCols() },
+                          DataLayout::NTC,
+                          Backend::Alignment);
+        outputs.at(Outputs) = workspace->addTensor(new Tensor(name, shape));
+    }
+
+    void run() override;
+
+    void setSamplingInfo(const SamplingInfo& _sampling) override {
+        sampling = _sampling;
+    }
+
+   protected:
+    bool transposeB;
+    SamplingInfo sampling;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/batch_mat_mul_op.h"
+#include "smaug/operators/smv/smv_test_common.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class BatchMatMulOpTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    template <typename Backend>
+    BatchMatMulOp<Backend>* createBatchMatMulOp(
+            int batch, int m, int k, int n, bool transposeB) {
+        auto op = new BatchMatMulOp<Backend>("bmm", workspace());
+        op->setTransposeB(transposeB);
+        Tensor* a = new Tensor(
+                "a", TensorShape({ batch, m, k }, DataLayout::NTC,
+                                 Backend::Alignment));
+        std::vector<int> bDims = transposeB ? std::vector<int>{ batch, n, k }
+                                            : std::vector<int>{ batch, k, n };
+        Tensor* b = new Tensor(
+                "b", TensorShape(bDims, DataLayout::NTC, Backend::Alignment));
+        workspace()->addTensor(a);
+        workspace()->addTensor(b);
+        op->setInput(a, 0);
+        op->setInput(b, 1);
+        return op;
+    }
+
+    /** Multiplies the matrices of every batch one element at a time. */
+    template <typename Backend>
+    std::vector<float> runNaiveBatchMatMul(BatchMatMulOp<Backend>* op) {
+        int batch = op->getBatchSize();
+        int m = op->getNumRows();
+        int n = op->getNumCols();
+        int k = op->getReductionSize();
+        bool transposeB = op->getTransposeB();
+        std::vector<float> a = toFloats(op->getInput(0));
+        std::vector<float> b = toFloats(op->getInput(1));
+        std::vector<float> c(batch * m * n, 0);
+        for (int i = 0; i < batch; i++) {
+            for (int row = 0; row < m; row++) {
+                for (int col = 0; col < n; col++) {
+                    float& sum = c[(i * m + row) * n + col];
+                    for (int j = 0; j < k; j++) {
+                        float bValue = transposeB
+                                               ? b[(i * n + col) * k + j]
+                                               : b[(i * k + j) * n + col];
+                        sum += a[(i * m + row) * k + j] * bValue;
+                    }
+                }
+            }
+        }
+        return c;
+    }
+
+   protected:
+    // Returns the values of the tensor as float32, without any padding.
+    std::vector<float> toFloats(Tensor* tensor) {
+        std::vector<float> values;
+        for (auto idx = tensor->startIndex(); !idx.end(); ++idx) {
+            if (tensor->getDataType() == DataType::Float16)
+                values.push_back(fp32(tensor->data<float16>()[idx]));
+            else
+                values.push_back(tensor->data<float>()[idx]);
+        }
+        return values;
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(BatchMatMulOpTest, "Batched matrix multiply", "[bmmop]") {
+    SECTION("Reference batched matrix multiply") {
+        auto op = createBatchMatMulOp<ReferenceBackend>(3, 4, 6, 5, false);
+        createAndFillTensorsWithData<float>(
+                op, fillFloatTensorWithRandomData);
+        REQUIRE(op->validate());
+        op->run();
+        const TensorShape& shape = op->getOutput(0)->getShape();
+        REQUIRE(shape.dims() == std::vector<int>{ 3, 4, 5 });
+        verifyOutputs(op->getOutput(0), runNaiveBatchMatMul(op));
+    }
+
+    SECTION("Reference batched matrix multiply with a transposed B") {
+        auto op = createBatchMatMulOp<ReferenceBackend>(2, 1, 17, 9, true);
+        createAndFillTensorsWithData<float>(
+                op, fillFloatTensorWithRandomData);
+        REQUIRE(op->validate());
+        op->run();
+        verifyOutputs(op->getOutput(0), runNaiveBatchMatMul(op));
+    }
+
+    SECTION("Mismatched reduction dimensions are rejected") {
+        auto op = createBatchMatMulOp<ReferenceBackend>(2, 3, 4, 5, false);
+        op->setTransposeB(true);
+        REQUIRE(!op->validate());
+    }
+
+    SECTION("SMV batched matrix multiply on padded float16 data") {
+        auto op = createBatchMatMulOp<SmvBackend>(3, 2, 12, 10, false);
+        createAndFillTensorsWithData<float16>(op, fillTensorWithRandomData);
+        op->run();
+        Tensor* outputs =
+                convertFp16ToFp32Tensor(op->getOutput(0), workspace());
+        verifyOutputs(outputs, runNaiveBatchMatMul(op));
+    }
+}
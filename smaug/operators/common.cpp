@@ -1,8 +1,113 @@
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "smaug/core/globals.h"
 #include "smaug/operators/common.h"
 
 namespace smaug {
 
+#ifndef TRACE_MODE
+namespace {
+
+/**
+ * A host thread that runs the kernel invocations sent to one accelerator, in
+ * the order they were submitted.
+ */
+class NativeAccelerator {
+   public:
+    NativeAccelerator()
+            : stopping(false), worker(&NativeAccelerator::workerLoop, this) {}
+
+    ~NativeAccelerator() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_one();
+        worker.join();
+    }
+
+    void submit(std::function<void()> work) {
+        std::packaged_task<void()> task(std::move(work));
+        // Only the host thread owning this accelerator submits and waits, so
+        // the futures don't need to be protected by the mutex.
+        futures.push_back(task.get_future());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        cond.notify_one();
+    }
+
+    void wait() {
+        while (!futures.empty()) {
+            futures.front().get();
+            futures.pop_front();
+        }
+    }
+
+   protected:
+    void workerLoop() {
+        while (true) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock,
+                          [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool stopping;
+    std::deque<std::packaged_task<void()>> tasks;
+    std::deque<std::future<void>> futures;
+    // This must be the last member so that the others are initialized before
+    // the worker starts running.
+    std::thread worker;
+};
+
+thread_local std::unique_ptr<NativeAccelerator>
+        nativeAccelerators[maxNumAccelerators];
+
+}  // namespace
+#endif
+
+bool useNativeAccelerators() {
+#ifdef TRACE_MODE
+    return false;
+#else
+    return !runningInSimulation && numAcceleratorsAvailable > 1;
+#endif
+}
+
+#ifndef TRACE_MODE
+void runOnNativeAccelerator(int accelIdx, std::function<void()> work) {
+    assert(accelIdx < maxNumAccelerators);
+    if (!nativeAccelerators[accelIdx])
+        nativeAccelerators[accelIdx] = std::make_unique<NativeAccelerator>();
+    nativeAccelerators[accelIdx]->submit(std::move(work));
+}
+#endif
+
+void waitForNativeAccelerator(int accelIdx) {
+#ifndef TRACE_MODE
+    if (nativeAccelerators[accelIdx])
+        nativeAccelerators[accelIdx]->wait();
+#endif
+}
+
 std::string getTraceName(int accelIdx) {
     std::string traceName =
             "dynamic_trace_acc" + std::to_string(accelIdx) + ".gz";
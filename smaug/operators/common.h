@@ -32,7 +32,12 @@ extern "C" {
 // These functions should be called from C++ files and not be included in C
 // files.
 
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <memory>
 #include "smaug/core/globals.h"
@@ -94,6 +99,72 @@ void invokeKernel(unsigned reqCode, const Kernel& kernel, Args&&... args) {
     invokeKernel(0, reqCode, kernel, std::forward<Args>(args)...);
 }
 
+/**
+ * Returns true if non-blocking kernel invocations are run asynchronously on
+ * native accelerator threads.
+ *
+ * This is the case in native execution when more than one accelerator is
+ * available. With LLVM-Tracer, kernels are always called synchronously, since
+ * the name of the dynamic trace is a process-wide setting.
+ */
+bool useNativeAccelerators();
+
+// The native accelerator threads are never used with LLVM-Tracer, which also
+// builds the sources as C++11.
+#ifndef TRACE_MODE
+/**
+ * Submits work to the host thread that models the specified accelerator.
+ *
+ * Every host thread that invokes kernels owns its own set of native
+ * accelerator threads, which are created on first use. Work submitted to the
+ * same accelerator runs in submission order, so data that an invocation leaves
+ * in the accelerator's scratchpads is visible to the following ones.
+ */
+void runOnNativeAccelerator(int accelIdx, std::function<void()> work);
+#endif
+
+/**
+ * Blocks until all the work submitted to the specified native accelerator of
+ * the calling thread has finished.
+ */
+void waitForNativeAccelerator(int accelIdx);
+
+#if !defined(DOXYGEN_SHOULD_SKIP_THIS) && !defined(TRACE_MODE)
+namespace internal {
+
+/**
+ * Stores a copy of a kernel argument until the kernel runs on a native
+ * accelerator thread.
+ */
+template <typename T, typename = void>
+struct NativeKernelArg {
+    using Stored = std::decay_t<T>;
+    static Stored store(const std::remove_reference_t<T>& arg) { return arg; }
+    static Stored& load(Stored& arg) { return arg; }
+};
+
+/**
+ * Arrays (e.g. tile dimensions) usually live on the stack of the caller, which
+ * may be gone by the time the kernel runs, so their contents are copied.
+ */
+template <typename T>
+struct NativeKernelArg<
+        T,
+        std::enable_if_t<std::is_array<std::remove_reference_t<T>>::value>> {
+    using Array = std::remove_reference_t<T>;
+    using Elem = std::remove_cv_t<std::remove_extent_t<Array>>;
+    using Stored = std::array<Elem, std::extent<Array>::value>;
+    static Stored store(const Array& arg) {
+        Stored stored;
+        std::copy(std::begin(arg), std::end(arg), stored.begin());
+        return stored;
+    }
+    static Elem* load(Stored& arg) { return arg.data(); }
+};
+
+}  // namespace internal
+#endif
+
 /**
  * A generic non-blocking interface to accelerated kernel functions.
  *
@@ -101,6 +172,11 @@ void invokeKernel(unsigned reqCode, const Kernel& kernel, Args&&... args) {
  * mode, the thread will start Aladdin and then return immediately. The calling
  * thread is responsible for checking the status of the accelerator and taking
  * action appropriately.
+ *
+ * In native execution with more than one accelerator, the kernel is run on
+ * the native accelerator thread accelIdx instead, and this returns
+ * immediately as well. SmvAcceleratorPool waits for the native accelerators
+ * when joining.
  */
 template <typename Kernel, typename... Args>
 std::unique_ptr<volatile int> invokeKernelNoBlock(int accelIdx,
@@ -110,13 +186,27 @@ std::unique_ptr<volatile int> invokeKernelNoBlock(int accelIdx,
     if (runningInSimulation) {
         return std::unique_ptr<volatile int>(
                 invokeAcceleratorAndReturn(reqCode));
-    } else {
+    }
 #ifdef TRACE_MODE
-        llvmtracer_set_trace_name(getTraceName(accelIdx).c_str());
-#endif
-        kernel(std::forward<Args>(args)...);
+    llvmtracer_set_trace_name(getTraceName(accelIdx).c_str());
+#else
+    if (useNativeAccelerators()) {
+        std::decay_t<Kernel> kernelFunc = kernel;
+        std::tuple<typename internal::NativeKernelArg<Args>::Stored...>
+                storedArgs(internal::NativeKernelArg<Args>::store(args)...);
+        runOnNativeAccelerator(accelIdx, [kernelFunc, storedArgs]() mutable {
+            std::apply(
+                    [&](auto&... stored) {
+                        kernelFunc(internal::NativeKernelArg<Args>::load(
+                                stored)...);
+                    },
+                    storedArgs);
+        });
         return nullptr;
     }
+#endif
+    kernel(std::forward<Args>(args)...);
+    return nullptr;
 }
 
 /**
@@ -542,6 +632,33 @@ typedef uint8_t v8bl_t
 
 #define MAYBE_UNUSED __attribute__((__unused__))
 
+/**
+ * Add HOST_SIMD_KERNEL before the definition of a kernel to also compile it
+ * for AVX2/FMA/F16C and AVX-512 hosts. The dynamic loader picks the version
+ * that the host CPU supports.
+ *
+ * This is only enabled in the host-native build (NATIVE_SIMD=1), since gem5
+ * doesn't support AVX and Aladdin traces must come from the baseline code.
+ */
+#if defined(SMAUG_NATIVE_SIMD) && !defined(TRACE_MODE)
+#define HOST_SIMD_KERNEL                                                       \
+    __attribute__((target_clones(                                              \
+            "arch=skylake-avx512", "arch=haswell", "default")))
+#else
+#define HOST_SIMD_KERNEL
+#endif
+
+/**
+ * Defined if kernels run their register-blocked host microkernels instead of
+ * the loop nests that Aladdin models. This is only the case in the
+ * host-native build (NATIVE_SIMD=1): the gem5 builds and the instrumented
+ * build run the modelled loops, since their timing and dynamic traces must
+ * come from them.
+ */
+#if defined(SMAUG_NATIVE_SIMD) && !defined(TRACE_MODE)
+#define HOST_MICROKERNELS
+#endif
+
 /**
  * @}
  */
@@ -27,7 +27,8 @@ class ConvolutionOp : public FusedActivationOp {
             : FusedActivationOp(name, OpType::Convolution3d, workspace),
               weightRows(0), weightCols(0), numOfmaps(0), rowStride(0),
               colStride(0), paddingType(UnknownPadding),
-              weightsName(name + "/kernels"), sampling({ NoSampling, 1 }) {
+              weightsName(name + "/kernels"), bias(nullptr),
+              sampling({ NoSampling, 1 }) {
         inputs.resize(kNumInputs, nullptr);
         outputs.resize(kNumOutputs, nullptr);
     }
@@ -120,10 +121,22 @@ class ConvolutionOp : public FusedActivationOp {
 
     int getNumOfmaps() const { return numOfmaps; }
 
+    /**
+     * Sets a per-output-channel bias, which is added to the results before
+     * the activation function. This is how a batch norm that has been folded
+     * into the kernels applies its shift. The bias is shaped {1, numOfmaps}
+     * in NC and has the data type of the kernels.
+     */
+    void setBias(Tensor* _bias) { bias = _bias; }
+    Tensor* getBias() const { return bias; }
+
     void run() override {}
 
     int getNumParameters() const override {
-        return inputs.at(Kernels)->getShape().size();
+        int numParameters = inputs.at(Kernels)->getShape().size();
+        if (bias)
+            numParameters += bias->getShape().size();
+        return numParameters;
     }
 
     std::vector<TensorBase*> getParameterizableInputs() override {
@@ -183,6 +196,7 @@ class ConvolutionOp : public FusedActivationOp {
     int colStride;
     PaddingType paddingType;
     std::string weightsName;
+    Tensor* bias;
     SamplingInfo sampling;
 };
 
@@ -4,6 +4,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/core/operator.h"
 #include "smaug/core/workspace.h"
+#include "smaug/operators/fused_activation_op.h"
 
 namespace smaug {
 
@@ -11,13 +12,16 @@ namespace smaug {
  *
  * \brief The base class of all elementwise operators.
  *
+ * Elementwise operators whose implementations support it can have an
+ * activation function fused on their outputs.
+ *
  * @tparam Backend The Backend specialization of this Operator.
  */
 template <typename Backend>
-class EltwiseOp : public Operator {
+class EltwiseOp : public FusedActivationOp {
    public:
     EltwiseOp(const std::string& name, OpType opType, Workspace* workspace)
-            : Operator(name, opType, workspace) {
+            : FusedActivationOp(name, opType, workspace) {
         inputs.resize(kNumInputs, nullptr);
         outputs.resize(kNumOutputs, nullptr);
     }
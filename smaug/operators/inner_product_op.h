@@ -23,7 +23,7 @@ class InnerProductOp : public FusedActivationOp {
             : FusedActivationOp(name, OpType::InnerProduct, workspace),
               numOutputs(0), weightsTensorsCreated(false),
               outputTensorsCreated(false), weightsName(name + "/weights"),
-              sampling({ NoSampling, 1 }) {
+              bias(nullptr), sampling({ NoSampling, 1 }) {
         inputs.resize(kNumInputs, nullptr);
         outputs.resize(kNumOutputs, nullptr);
     }
@@ -80,8 +80,20 @@ class InnerProductOp : public FusedActivationOp {
 
     int getNumOutputs() const { return numOutputs; }
 
+    /**
+     * Sets a per-neuron bias, which is added to the results before the
+     * activation function. This is how a batch norm that has been folded into
+     * the weights applies its shift. The bias is shaped {1, numOutputs} in NC
+     * and has the data type of the weights.
+     */
+    void setBias(Tensor* _bias) { bias = _bias; }
+    Tensor* getBias() const { return bias; }
+
     int getNumParameters() const override {
-        return inputs.at(Weights)->getShape().size();
+        int numParameters = inputs.at(Weights)->getShape().size();
+        if (bias)
+            numParameters += bias->getShape().size();
+        return numParameters;
     }
 
     std::vector<TensorBase*> getParameterizableInputs() override {
@@ -102,6 +114,7 @@ class InnerProductOp : public FusedActivationOp {
     bool weightsTensorsCreated;
     bool outputTensorsCreated;
     std::string weightsName;
+    Tensor* bias;
     SamplingInfo sampling;
 };
 
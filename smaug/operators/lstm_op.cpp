@@ -0,0 +1,145 @@
+#include <vector>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/lstm_op.h"
+#include "smaug/operators/ref/ref_activation_fun_op.h"
+#include "smaug/operators/ref/ref_gemm.h"
+
+namespace smaug {
+
+namespace {
+
+// Copies the rows of a [rows, cols] float32 matrix into a tensor whose rows
+// are `stride` elements apart.
+template <typename DType>
+void storeRows(const float* src, int srcStride, DType* dest, int stride,
+               int rows, int cols) {
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++)
+            dest[i * stride + j] = fromFloat<DType>(src[i * srcStride + j]);
+    }
+}
+
+template <typename DType>
+void runLstm(Tensor* inputs,
+             Tensor* kernel,
+             Tensor* recurrentKernel,
+             Tensor* initialOutputs,
+             Tensor* initialState,
+             Tensor* outputs,
+             Tensor* state,
+             Tensor* sequence,
+             ActivationInfo actInfo,
+             bool goBackwards) {
+    const TensorShape& inputShape = inputs->getShape();
+    int batch = inputShape[0];
+    int timesteps = inputShape[1];
+    int depth = inputShape[2];
+    int units = recurrentKernel->getShape()[1];
+    int gates = 4 * units;
+
+    // Every row of the cell inputs holds x_t followed by h_{t-1}, so a single
+    // GEMM against the packed [W | U] weights computes all the gates of a
+    // timestep. The weights are only packed once for all the timesteps.
+    int cellDepth = depth + units;
+    std::vector<float> weights(gates * cellDepth);
+    const DType* w = kernel->data<DType>();
+    const DType* u = recurrentKernel->data<DType>();
+    int wStride = kernel->getShape().getStorageDim(1);
+    int uStride = recurrentKernel->getShape().getStorageDim(1);
+    for (int g = 0; g < gates; g++) {
+        float* row = &weights[g * cellDepth];
+        for (int k = 0; k < depth; k++)
+            row[k] = toFloat(w[g * wStride + k]);
+        for (int k = 0; k < units; k++)
+            row[depth + k] = toFloat(u[g * uStride + k]);
+    }
+
+    std::vector<float> cellInputs(batch * cellDepth);
+    std::vector<float> z(batch * gates);
+    std::vector<float> c(batch * units);
+    const DType* h0 = initialOutputs->data<DType>();
+    const DType* c0 = initialState->data<DType>();
+    // An initial state with a batch of 1 is broadcast to every batch.
+    int h0Stride = initialOutputs->getShape()[0] == 1
+                           ? 0
+                           : initialOutputs->getShape().getStorageDim(1);
+    int c0Stride = initialState->getShape()[0] == 1
+                           ? 0
+                           : initialState->getShape().getStorageDim(1);
+    for (int n = 0; n < batch; n++) {
+        for (int k = 0; k < units; k++) {
+            cellInputs[n * cellDepth + depth + k] =
+                    toFloat(h0[n * h0Stride + k]);
+            c[n * units + k] = toFloat(c0[n * c0Stride + k]);
+        }
+    }
+    const DType* x = inputs->data<DType>();
+    int xStride = inputShape.getStorageDim(2);
+    DType* seq = sequence ? sequence->data<DType>() : nullptr;
+    int seqStride = sequence ? sequence->getShape().getStorageDim(2) : 0;
+    for (int i = 0; i < timesteps; i++) {
+        int t = goBackwards ? timesteps - 1 - i : i;
+        for (int n = 0; n < batch; n++) {
+            const DType* xRow = x + (n * timesteps + t) * xStride;
+            float* row = &cellInputs[n * cellDepth];
+            for (int k = 0; k < depth; k++)
+                row[k] = toFloat(xRow[k]);
+        }
+        ref::gemm(cellInputs.data(), cellDepth, weights.data(), cellDepth,
+                  true, z.data(), gates, batch, gates, cellDepth);
+        for (int n = 0; n < batch; n++) {
+            float* zi = &z[n * gates];
+            float* zf = zi + units;
+            float* zc = zf + units;
+            float* zo = zc + units;
+            float* cRow = &c[n * units];
+            // The new output goes where the next timestep reads h_{t-1}.
+            float* h = &cellInputs[n * cellDepth + depth];
+            sigmoid(zi, zi, units);
+            sigmoid(zf, zf, units);
+            sigmoid(zo, zo, units);
+            activation_fun(zc, zc, units, actInfo.function, actInfo.params);
+            for (int k = 0; k < units; k++) {
+                cRow[k] = zf[k] * cRow[k] + zi[k] * zc[k];
+                h[k] = cRow[k];
+            }
+            activation_fun(h, h, units, actInfo.function, actInfo.params);
+            for (int k = 0; k < units; k++)
+                h[k] *= zo[k];
+        }
+        if (seq) {
+            storeRows(&cellInputs[depth], cellDepth, seq + t * seqStride,
+                      timesteps * seqStride, batch, units);
+        }
+    }
+    storeRows(&cellInputs[depth], cellDepth, outputs->data<DType>(),
+              outputs->getShape().getStorageDim(1), batch, units);
+    storeRows(c.data(), units, state->data<DType>(),
+              state->getShape().getStorageDim(1), batch, units);
+}
+
+}  // namespace
+
+template <>
+void LstmOp<ReferenceBackend>::run() {
+    runLstm<float>(getInput(Inputs), getInput(Kernel),
+                   getInput(RecurrentKernel), getInput(InitialOutputs),
+                   getInput(InitialState), getOutput(Outputs),
+                   getOutput(State),
+                   getReturnSequences() ? getOutput(Sequence) : nullptr,
+                   actInfo, goBackwards);
+}
+
+template <>
+void LstmOp<SmvBackend>::run() {
+    runLstm<float16>(getInput(Inputs), getInput(Kernel),
+                     getInput(RecurrentKernel), getInput(InitialOutputs),
+                     getInput(InitialState), getOutput(Outputs),
+                     getOutput(State),
+                     getReturnSequences() ? getOutput(Sequence) : nullptr,
+                     actInfo, goBackwards);
+}
+
+}  // namespace smaug
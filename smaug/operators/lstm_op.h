@@ -0,0 +1,147 @@
+#ifndef _OPERATORS_LSTM_OP_H_
+#define _OPERATORS_LSTM_OP_H_
+
+#include "smaug/core/backend.h"
+#include "smaug/core/operator.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+#include "smaug/operators/common.h"
+
+namespace smaug {
+
+/** \ingroup Operators
+ *
+ * \brief Runs an LSTM layer over all the timesteps of its input.
+ *
+ * Instead of unrolling every timestep into its own matrix multiplications and
+ * elementwise operators, this loops over the timesteps natively: the weights
+ * are packed once per run, and the state of the cell is carried across
+ * timesteps in place. The memory this needs (beyond the sequence output, if
+ * requested) doesn't depend on the number of timesteps.
+ *
+ * The gates are computed as in Keras: `z = x_t * W^T + h_{t-1} * U^T` is
+ * split into the input, forget, cell and output gates, in this order.
+ *
+ * @tparam Backend The Backend specialization of this Operator.
+ */
+template <typename Backend>
+class LstmOp : public Operator {
+   public:
+    enum {
+        /** The input sequence, shaped [batch, time, depth] (NTC). */
+        Inputs,
+        /** The input kernel W, shaped [4 * units, depth] (NC). */
+        Kernel,
+        /** The recurrent kernel U, shaped [4 * units, units] (NC). */
+        RecurrentKernel,
+        /**
+         * The output before the first timestep, shaped [batch, units] (NC).
+         * A batch of 1 is broadcast to the whole batch.
+         */
+        InitialOutputs,
+        /** The cell state before the first timestep, like InitialOutputs. */
+        InitialState,
+        kNumInputs
+    };
+    enum {
+        /** The output of the last timestep, shaped [batch, units] (NC). */
+        Outputs,
+        /** The final cell state, shaped [batch, units] (NC). */
+        State,
+        /**
+         * The outputs of all the timesteps, shaped [batch, time, units]
+         * (NTC). This only exists if setReturnSequences(true) is called.
+         */
+        Sequence,
+        kNumOutputs
+    };
+
+    LstmOp(const std::string& name, Workspace* workspace)
+            : Operator(name, OpType::Lstm, workspace),
+              actInfo(activation_type::TANH), goBackwards(false) {
+        inputs.resize(kNumInputs, nullptr);
+        outputs.resize(Sequence, nullptr);
+    }
+
+    void setActivation(ActivationInfo _actInfo) { actInfo = _actInfo; }
+    ActivationInfo getActivation() const { return actInfo; }
+
+    /** Sets whether the outputs of all the timesteps are produced. */
+    void setReturnSequences(bool returnSequences) {
+        outputs.resize(returnSequences ? kNumOutputs : Sequence, nullptr);
+    }
+    bool getReturnSequences() const { return outputs.size() == kNumOutputs; }
+
+    /**
+     * Sets whether the timesteps are processed from the last to the first.
+     * The outputs in the Sequence stay aligned with the timesteps of the
+     * input, like the backward layer of a Keras Bidirectional.
+     */
+    void setGoBackwards(bool _goBackwards) { goBackwards = _goBackwards; }
+    bool getGoBackwards() const { return goBackwards; }
+
+    int getNumUnits() const {
+        return getInput(RecurrentKernel)->getShape()[1];
+    }
+
+    bool validate() override {
+        const TensorShape& inputShape = getInput(Inputs)->getShape();
+        const TensorShape& kernelShape = getInput(Kernel)->getShape();
+        const TensorShape& recurrentShape =
+                getInput(RecurrentKernel)->getShape();
+        if (inputShape.getLayout() != DataLayout::NTC ||
+            kernelShape.getLayout() != DataLayout::NC ||
+            recurrentShape.getLayout() != DataLayout::NC) {
+            std::cerr << "[" << name << "]: The inputs must be in NTC and the "
+                      << "kernels in NC layouts.\n";
+            return false;
+        }
+        int units = getNumUnits();
+        if (kernelShape[0] != 4 * units || recurrentShape[0] != 4 * units ||
+            kernelShape[1] != inputShape[2] ||
+            !isValidInitialState(getInput(InitialOutputs), inputShape[0]) ||
+            !isValidInitialState(getInput(InitialState), inputShape[0])) {
+            std::cerr << "[" << name << "]: The kernel and state shapes don't "
+                      << "match the inputs and " << units << " units.\n";
+            return false;
+        }
+        return Operator::validate();
+    }
+
+    void createAllTensors() override {
+        const TensorShape& inputShape = getInput(Inputs)->getShape();
+        int batch = inputShape[0];
+        int units = getNumUnits();
+        TensorShape shape(
+                { batch, units }, DataLayout::NC, Backend::Alignment);
+        outputs.at(Outputs) =
+                workspace->addTensor(new Tensor(name, shape));
+        outputs.at(State) =
+                workspace->addTensor(new Tensor(name + "/state", shape));
+        if (getReturnSequences()) {
+            TensorShape sequenceShape({ batch, inputShape[1], units },
+                                      DataLayout::NTC,
+                                      Backend::Alignment);
+            outputs.at(Sequence) = workspace->addTensor(
+                    new Tensor(name + "/sequence", sequenceShape));
+        }
+    }
+
+    void run() override;
+
+   protected:
+    bool isValidInitialState(Tensor* tensor, int batch) const {
+        const TensorShape& shape = tensor->getShape();
+        return shape.ndims() == 2 && (shape[0] == 1 || shape[0] == batch) &&
+               shape[1] == getNumUnits();
+    }
+
+    /** The activation function applied to the cell input and state. */
+    ActivationInfo actInfo;
+    /** If true, the timesteps are processed in reverse order. */
+    bool goBackwards;
+};
+
+}  // namespace smaug
+
+#endif
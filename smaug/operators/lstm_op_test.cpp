@@ -0,0 +1,205 @@
+#include <cmath>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/lstm_op.h"
+#include "smaug/operators/smv/smv_test_common.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class LstmOpTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    template <typename Backend>
+    LstmOp<Backend>* createLstmOp(int batch,
+                                  int timesteps,
+                                  int depth,
+                                  int units,
+                                  int stateBatch) {
+        auto op = new LstmOp<Backend>("lstm", workspace());
+        Tensor* inputs = new Tensor(
+                "inputs", TensorShape({ batch, timesteps, depth },
+                                      DataLayout::NTC, Backend::Alignment));
+        Tensor* kernel = new Tensor(
+                "kernel", TensorShape({ 4 * units, depth }, DataLayout::NC,
+                                      Backend::Alignment));
+        Tensor* recurrentKernel = new Tensor(
+                "recurrent_kernel", TensorShape({ 4 * units, units },
+                                                DataLayout::NC,
+                                                Backend::Alignment));
+        TensorShape stateShape(
+                { stateBatch, units }, DataLayout::NC, Backend::Alignment);
+        Tensor* initialOutputs = new Tensor("initial_outputs", stateShape);
+        Tensor* initialState = new Tensor("initial_state", stateShape);
+        int i = 0;
+        for (Tensor* input : { inputs, kernel, recurrentKernel, initialOutputs,
+                               initialState }) {
+            workspace()->addTensor(input);
+            op->setInput(input, i++);
+        }
+        return op;
+    }
+
+    /**
+     * Computes the expected outputs of all the timesteps, one row per batch
+     * and timestep, by running the cell one timestep at a time.
+     */
+    template <typename Backend>
+    std::vector<float> runUnrolledLstm(LstmOp<Backend>* op,
+                                       std::vector<float>* finalState) {
+        const TensorShape& shape = op->getInput(0)->getShape();
+        int batch = shape[0], timesteps = shape[1], depth = shape[2];
+        int units = op->getNumUnits();
+        std::vector<float> x = toFloats(op->getInput(0));
+        std::vector<float> w = toFloats(op->getInput(1));
+        std::vector<float> u = toFloats(op->getInput(2));
+        std::vector<float> h = toFloats(op->getInput(3));
+        std::vector<float> c = toFloats(op->getInput(4));
+        // Broadcast the initial state to the whole batch.
+        for (int n = h.size() / units; n < batch; n++) {
+            h.insert(h.end(), h.begin(), h.begin() + units);
+            c.insert(c.end(), c.begin(), c.begin() + units);
+        }
+        std::vector<float> outputs(batch * timesteps * units);
+        auto sigmoid = [](float v) { return 1 / (1 + std::exp(-v)); };
+        for (int i = 0; i < timesteps; i++) {
+            int t = op->getGoBackwards() ? timesteps - 1 - i : i;
+            std::vector<float> newH(batch * units);
+            for (int n = 0; n < batch; n++) {
+                for (int k = 0; k < units; k++) {
+                    float z[4];
+                    for (int g = 0; g < 4; g++) {
+                        int row = g * units + k;
+                        z[g] = 0;
+                        for (int d = 0; d < depth; d++) {
+                            z[g] += x[(n * timesteps + t) * depth + d] *
+                                    w[row * depth + d];
+                        }
+                        for (int j = 0; j < units; j++)
+                            z[g] += h[n * units + j] * u[row * units + j];
+                    }
+                    float& cell = c[n * units + k];
+                    cell = sigmoid(z[1]) * cell +
+                           sigmoid(z[0]) * std::tanh(z[2]);
+                    newH[n * units + k] = sigmoid(z[3]) * std::tanh(cell);
+                    outputs[(n * timesteps + t) * units + k] =
+                            newH[n * units + k];
+                }
+            }
+            h = newH;
+        }
+        *finalState = c;
+        return outputs;
+    }
+
+    /** Returns one timestep of a [batch, time, units] sequence. */
+    std::vector<float> getTimestep(const std::vector<float>& sequence,
+                                   int timestep,
+                                   int timesteps,
+                                   int units) {
+        std::vector<float> step;
+        int batch = sequence.size() / (timesteps * units);
+        for (int n = 0; n < batch; n++) {
+            auto begin =
+                    sequence.begin() + (n * timesteps + timestep) * units;
+            step.insert(step.end(), begin, begin + units);
+        }
+        return step;
+    }
+
+    /** Returns the last timestep of a [batch, time, units] sequence. */
+    std::vector<float> getLastTimestep(const std::vector<float>& sequence,
+                                       int timesteps,
+                                       int units) {
+        return getTimestep(sequence, timesteps - 1, timesteps, units);
+    }
+
+   protected:
+    // Returns the values of the tensor as float32, without any padding.
+    std::vector<float> toFloats(Tensor* tensor) {
+        std::vector<float> values;
+        for (auto idx = tensor->startIndex(); !idx.end(); ++idx) {
+            if (tensor->getDataType() == DataType::Float16)
+                values.push_back(fp32(tensor->data<float16>()[idx]));
+            else
+                values.push_back(tensor->data<float>()[idx]);
+        }
+        return values;
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(LstmOpTest, "LSTM operator", "[lstmop]") {
+    SECTION("Reference LSTM with all the timesteps") {
+        auto op = createLstmOp<ReferenceBackend>(2, 5, 8, 4, 2);
+        op->setReturnSequences(true);
+        createAndFillTensorsWithData<float>(
+                op, fillFloatTensorWithRandomData);
+        op->run();
+        std::vector<float> expectedState;
+        std::vector<float> expectedSequence =
+                runUnrolledLstm(op, &expectedState);
+        verifyOutputs(op->getOutput(2), expectedSequence);
+        verifyOutputs(op->getOutput(1), expectedState);
+        // The output is the last timestep of the sequence.
+        verifyOutputs(op->getOutput(0),
+                      getLastTimestep(expectedSequence, 5, 4));
+    }
+
+    SECTION("Broadcast initial state without the sequence output") {
+        auto op = createLstmOp<ReferenceBackend>(3, 3, 4, 4, 1);
+        createAndFillTensorsWithData<float>(
+                op, fillFloatTensorWithRandomData);
+        REQUIRE(op->getOutputs().size() == 2);
+        op->run();
+        std::vector<float> expectedState;
+        std::vector<float> expectedSequence =
+                runUnrolledLstm(op, &expectedState);
+        verifyOutputs(op->getOutput(0),
+                      getLastTimestep(expectedSequence, 3, 4));
+        verifyOutputs(op->getOutput(1), expectedState);
+    }
+
+    SECTION("Reference LSTM going backwards") {
+        auto op = createLstmOp<ReferenceBackend>(2, 5, 8, 4, 1);
+        op->setReturnSequences(true);
+        op->setGoBackwards(true);
+        createAndFillTensorsWithData<float>(
+                op, fillFloatTensorWithRandomData);
+        op->run();
+        std::vector<float> expectedState;
+        std::vector<float> expectedSequence =
+                runUnrolledLstm(op, &expectedState);
+        // The sequence stays aligned with the inputs, so the output is the
+        // first timestep.
+        verifyOutputs(op->getOutput(2), expectedSequence);
+        verifyOutputs(op->getOutput(1), expectedState);
+        verifyOutputs(op->getOutput(0),
+                      getTimestep(expectedSequence, 0, 5, 4));
+    }
+
+    SECTION("SMV LSTM on padded float16 data") {
+        auto op = createLstmOp<SmvBackend>(2, 4, 12, 4, 2);
+        op->setReturnSequences(true);
+        createAndFillTensorsWithData<float16>(op, fillTensorWithRandomData);
+        op->run();
+        std::vector<float> expectedState;
+        std::vector<float> expectedSequence =
+                runUnrolledLstm(op, &expectedState);
+        Tensor* sequence = convertFp16ToFp32Tensor(op->getOutput(2),
+                                                   workspace());
+        verifyOutputs(sequence, expectedSequence);
+        Tensor* state = convertFp16ToFp32Tensor(op->getOutput(1), workspace());
+        verifyOutputs(state, expectedState);
+        Tensor* outputs =
+                convertFp16ToFp32Tensor(op->getOutput(0), workspace());
+        verifyOutputs(outputs, getLastTimestep(expectedSequence, 4, 4));
+    }
+}
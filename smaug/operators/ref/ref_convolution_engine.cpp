@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "smaug/core/globals.h"
+#include "smaug/operators/ref/ref_convolution_engine.h"
+#include "smaug/operators/ref/ref_gemm.h"
+#include "smaug/utility/thread_pool.h"
+
+namespace smaug {
+namespace ref {
+
+namespace {
+
+// Layers with fewer multiply-accumulates than this go to the Aladdin kernel;
+// rearranging their data costs more than it saves.
+constexpr long kMinEngineMacs = 1 << 16;
+// Upper bounds, in floats, on the temporary buffers. Larger layers are
+// processed a band of output rows (im2col) or a chunk of tiles (Winograd) at a
+// time.
+constexpr long kMaxIm2colSize = 1 << 22;
+constexpr long kMaxWinogradSize = 1 << 23;
+
+// Element strides of the three tensors, so that the algorithms below don't
+// need to know the data layout.
+struct ConvStrides {
+    explicit ConvStrides(const ConvParams& p) {
+        if (p.isNCHW) {
+            inCol = 1;
+            inRow = p.imgCols + p.imgPad;
+            inChan = p.imgRows * inRow;
+            inImage = p.imgChans * inChan;
+            kCol = 1;
+            kRow = p.kCols + p.kPad;
+            kChan = p.kRows * kRow;
+            kernel = p.imgChans * kChan;
+            resCol = 1;
+            resRow = p.resCols + p.resPad;
+            resChan = p.resRows * resRow;
+            resImage = p.kNum * resChan;
+        } else {
+            inChan = 1;
+            inCol = p.imgChans + p.imgPad;
+            inRow = p.imgCols * inCol;
+            inImage = p.imgRows * inRow;
+            kChan = 1;
+            kCol = p.imgChans + p.kPad;
+            kRow = p.kCols * kCol;
+            kernel = p.kRows * kRow;
+            resChan = 1;
+            resCol = p.kNum + p.resPad;
+            resRow = p.resCols * resCol;
+            resImage = p.resRows * resRow;
+        }
+    }
+
+    long inImage, inChan, inRow, inCol;
+    long kernel, kChan, kRow, kCol;
+    long resImage, resChan, resRow, resCol;
+};
+
+// Runs func over [begin, end), split across the global thread pool if there is
+// one.
+template <typename Func>
+void parallelRange(int begin, int end, Func func) {
+    if (threadPool && !fastForwardMode && end - begin > 1)
+        threadPool->parallelFor(begin, end, 1, func);
+    else
+        func(begin, end);
+}
+
+// Packs the kernels into a kNum x (kRows * kCols * imgChans) matrix, in the
+// same (row, col, channel) order that im2col lowers the input patches in.
+std::vector<float> packKernels(const float* kernels,
+                               const ConvParams& p,
+                               const ConvStrides& s) {
+    std::vector<float> packed(
+            (long)p.kNum * p.kRows * p.kCols * p.imgChans);
+    float* dst = packed.data();
+    for (int k = 0; k < p.kNum; k++) {
+        for (int r = 0; r < p.kRows; r++) {
+            for (int c = 0; c < p.kCols; c++) {
+                const float* src = kernels + k * s.kernel + r * s.kRow +
+                                   c * s.kCol;
+                for (int ch = 0; ch < p.imgChans; ch++)
+                    *dst++ = src[ch * s.kChan];
+            }
+        }
+    }
+    return packed;
+}
+
+// Lowers the input patches of output rows [rowStart, rowEnd) of one image into
+// a (numRows * resCols) x (kRows * kCols * imgChans) matrix.
+void im2col(const float* image,
+            const ConvParams& p,
+            const ConvStrides& s,
+            int rowStart,
+            int rowEnd,
+            float* cols) {
+    int patchSize = p.kRows * p.kCols * p.imgChans;
+    parallelRange(rowStart, rowEnd, [&](int start, int end) {
+        for (int i = start; i < end; i++) {
+            float* dst = cols + (long)(i - rowStart) * p.resCols * patchSize;
+            for (int j = 0; j < p.resCols; j++) {
+                for (int r = 0; r < p.kRows; r++) {
+                    int row = i * p.rowStride - p.topPad + r;
+                    for (int c = 0; c < p.kCols; c++) {
+                        int col = j * p.colStride - p.leftPad + c;
+                        if (row < 0 || row >= p.imgRows || col < 0 ||
+                            col >= p.imgCols) {
+                            std::fill(dst, dst + p.imgChans, 0.0f);
+                        } else {
+                            const float* src =
+                                    image + row * s.inRow + col * s.inCol;
+                            for (int ch = 0; ch < p.imgChans; ch++)
+                                dst[ch] = src[ch * s.inChan];
+                        }
+                        dst += p.imgChans;
+                    }
+                }
+            }
+        }
+    });
+}
+
+void im2colConvolution(const float* input,
+                       const float* kernels,
+                       float* result,
+                       const ConvParams& p) {
+    ConvStrides s(p);
+    std::vector<float> packedKernels = packKernels(kernels, p, s);
+    int patchSize = p.kRows * p.kCols * p.imgChans;
+    int bandRows = std::max<long>(
+            1, kMaxIm2colSize / ((long)p.resCols * patchSize));
+    bandRows = std::min(bandRows, p.resRows);
+    std::vector<float> cols((long)bandRows * p.resCols * patchSize);
+    std::vector<float> scratch;
+    for (int img = 0; img < p.imgNum; img++) {
+        const float* image = input + img * s.inImage;
+        float* resImage = result + img * s.resImage;
+        for (int i = 0; i < p.resRows; i += bandRows) {
+            int numRows = std::min(bandRows, p.resRows - i);
+            int numPixels = numRows * p.resCols;
+            im2col(image, p, s, i, i + numRows, cols.data());
+            if (s.resChan == 1) {
+                // NHWC: the band is a numPixels x kNum matrix.
+                gemm(cols.data(), patchSize, packedKernels.data(), patchSize,
+                     true, resImage + i * s.resRow, s.resCol, numPixels,
+                     p.kNum, patchSize);
+            } else if (s.resRow == p.resCols) {
+                // NCHW: the band is a kNum x numPixels matrix.
+                gemm(packedKernels.data(), patchSize, cols.data(), patchSize,
+                     true, resImage + i * s.resRow, s.resChan, p.kNum,
+                     numPixels, patchSize);
+            } else {
+                // NCHW with padded rows: compute the band densely and scatter.
+                scratch.resize((long)p.kNum * numPixels);
+                gemm(packedKernels.data(), patchSize, cols.data(), patchSize,
+                     true, scratch.data(), numPixels, p.kNum, numPixels,
+                     patchSize);
+                for (int k = 0; k < p.kNum; k++) {
+                    for (int r = 0; r < numRows; r++) {
+                        const float* src =
+                                &scratch[(long)k * numPixels + r * p.resCols];
+                        std::copy(src, src + p.resCols,
+                                  resImage + k * s.resChan +
+                                          (i + r) * s.resRow);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// With 1x1 kernels and stride 1, every image already is a GEMM operand.
+void pointwiseConvolution(const float* input,
+                          const float* kernels,
+                          float* result,
+                          const ConvParams& p) {
+    ConvStrides s(p);
+    int numPixels = p.imgRows * p.imgCols;
+    for (int img = 0; img < p.imgNum; img++) {
+        const float* image = input + img * s.inImage;
+        float* resImage = result + img * s.resImage;
+        if (p.isNCHW) {
+            gemm(kernels, s.kernel, image, s.inChan, false, resImage,
+                 s.resChan, p.kNum, numPixels, p.imgChans);
+        } else {
+            gemm(image, s.inCol, kernels, s.kernel, true, resImage, s.resCol,
+                 numPixels, p.kNum, p.imgChans);
+        }
+    }
+}
+
+// The transform matrices of Lavin and Gray, "Fast Algorithms for
+// Convolutional Neural Networks". For F(m x m, 3x3), the input and kernel
+// tiles are transformed into alpha x alpha tiles (alpha = m + 2), multiplied
+// pointwise, and transformed back into m x m output tiles.
+struct WinogradTransform {
+    int m;
+    int alpha;
+    const float* bt;  // alpha x alpha
+    const float* g;   // alpha x 3
+    const float* at;  // m x alpha
+};
+
+const float kF2x2BT[] = { 1, 0,  -1, 0, 0, 1, 1, 0,
+                          0, -1, 1,  0, 0, 1, 0, -1 };
+const float kF2x2G[] = { 1, 0, 0, 0.5, 0.5, 0.5, 0.5, -0.5, 0.5, 0, 0, 1 };
+const float kF2x2AT[] = { 1, 1, 1, 0, 0, 1, -1, -1 };
+
+const float kF4x4BT[] = { 4, 0,  -5, 0,  1, 0, 0, -4, -4, 1,  1, 0,
+                          0, 4,  -4, -1, 1, 0, 0, -2, -1, 2,  1, 0,
+                          0, 2,  -1, -2, 1, 0, 0, 4,  0,  -5, 0, 1 };
+const float kF4x4G[] = { 1.0 / 4,  0,        0,       -1.0 / 6, -1.0 / 6,
+                         -1.0 / 6, -1.0 / 6, 1.0 / 6, -1.0 / 6, 1.0 / 24,
+                         1.0 / 12, 1.0 / 6,  1.0 / 24, -1.0 / 12, 1.0 / 6,
+                         0,        0,        1 };
+const float kF4x4AT[] = { 1, 1, 1,  1, 1,  0, 0, 1, -1, 2, -2, 0,
+                          0, 1, 1,  4, 4,  0, 0, 1, -1, 8, -8, 1 };
+
+const WinogradTransform kF2x2 = { 2, 4, kF2x2BT, kF2x2G, kF2x2AT };
+const WinogradTransform kF4x4 = { 4, 6, kF4x4BT, kF4x4G, kF4x4AT };
+constexpr int kMaxAlpha = 6;
+
+// Computes out = left x in x right_transpose, where left is rows x n, in is
+// n x n', and right is cols x n'.
+void transformTile(const float* left,
+                   const float* in,
+                   const float* right,
+                   int rows,
+                   int cols,
+                   int n,
+                   int nPrime,
+                   float* out) {
+    float tmp[kMaxAlpha][kMaxAlpha];
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < nPrime; j++) {
+            float sum = 0;
+            for (int k = 0; k < n; k++)
+                sum += left[i * n + k] * in[k * nPrime + j];
+            tmp[i][j] = sum;
+        }
+    }
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            float sum = 0;
+            for (int k = 0; k < nPrime; k++)
+                sum += tmp[i][k] * right[j * nPrime + k];
+            out[i * cols + j] = sum;
+        }
+    }
+}
+
+void winogradConvolution(const float* input,
+                         const float* kernels,
+                         float* result,
+                         const ConvParams& p,
+                         const WinogradTransform& t) {
+    ConvStrides s(p);
+    const int alpha = t.alpha;
+    const int alpha2 = alpha * alpha;
+    const int tileRows = (p.resRows + t.m - 1) / t.m;
+    const int tileCols = (p.resCols + t.m - 1) / t.m;
+    const int tilesPerImage = tileRows * tileCols;
+    const int numTiles = p.imgNum * tilesPerImage;
+    const int chans = p.imgChans;
+    const int kNum = p.kNum;
+
+    // Transformed kernels, stored as alpha^2 matrices of kNum x chans.
+    std::vector<float> u((long)alpha2 * kNum * chans);
+    parallelRange(0, kNum, [&](int start, int end) {
+        float g[9];
+        float tile[kMaxAlpha * kMaxAlpha];
+        for (int k = start; k < end; k++) {
+            for (int ch = 0; ch < chans; ch++) {
+                const float* src = kernels + k * s.kernel + ch * s.kChan;
+                for (int r = 0; r < 3; r++) {
+                    for (int c = 0; c < 3; c++)
+                        g[r * 3 + c] = src[r * s.kRow + c * s.kCol];
+                }
+                transformTile(t.g, g, t.g, alpha, alpha, 3, 3, tile);
+                for (int xy = 0; xy < alpha2; xy++)
+                    u[((long)xy * kNum + k) * chans + ch] = tile[xy];
+            }
+        }
+    });
+
+    // Transformed inputs and their products with the kernels, stored as
+    // alpha^2 matrices of chans x chunk and kNum x chunk.
+    int chunk = std::max<long>(
+            1, kMaxWinogradSize / ((long)alpha2 * (chans + kNum)));
+    chunk = std::min(chunk, numTiles);
+    std::vector<float> v((long)alpha2 * chans * chunk);
+    std::vector<float> m((long)alpha2 * kNum * chunk);
+    for (int tileStart = 0; tileStart < numTiles; tileStart += chunk) {
+        int numChunkTiles = std::min(chunk, numTiles - tileStart);
+        parallelRange(0, chans, [&](int start, int end) {
+            float d[kMaxAlpha * kMaxAlpha];
+            float tile[kMaxAlpha * kMaxAlpha];
+            for (int ch = start; ch < end; ch++) {
+                for (int n = 0; n < numChunkTiles; n++) {
+                    int tileIdx = tileStart + n;
+                    int img = tileIdx / tilesPerImage;
+                    int rowStart = (tileIdx % tilesPerImage) / tileCols * t.m -
+                                   p.topPad;
+                    int colStart = (tileIdx % tileCols) * t.m - p.leftPad;
+                    const float* src =
+                            input + img * s.inImage + ch * s.inChan;
+                    for (int r = 0; r < alpha; r++) {
+                        int row = rowStart + r;
+                        for (int c = 0; c < alpha; c++) {
+                            int col = colStart + c;
+                            bool inBounds = row >= 0 && row < p.imgRows &&
+                                            col >= 0 && col < p.imgCols;
+                            d[r * alpha + c] =
+                                    inBounds ? src[row * s.inRow +
+                                                   col * s.inCol]
+                                             : 0;
+                        }
+                    }
+                    transformTile(t.bt, d, t.bt, alpha, alpha, alpha, alpha,
+                                  tile);
+                    for (int xy = 0; xy < alpha2; xy++)
+                        v[((long)xy * chans + ch) * chunk + n] = tile[xy];
+                }
+            }
+        });
+        for (int xy = 0; xy < alpha2; xy++) {
+            gemm(&u[(long)xy * kNum * chans], chans,
+                 &v[(long)xy * chans * chunk], chunk, false,
+                 &m[(long)xy * kNum * chunk], chunk, kNum, numChunkTiles,
+                 chans);
+        }
+        parallelRange(0, kNum, [&](int start, int end) {
+            float tile[kMaxAlpha * kMaxAlpha];
+            float y[kMaxAlpha * kMaxAlpha];
+            for (int k = start; k < end; k++) {
+                for (int n = 0; n < numChunkTiles; n++) {
+                    for (int xy = 0; xy < alpha2; xy++)
+                        tile[xy] = m[((long)xy * kNum + k) * chunk + n];
+                    transformTile(t.at, tile, t.at, t.m, t.m, alpha, alpha, y);
+                    int tileIdx = tileStart + n;
+                    int img = tileIdx / tilesPerImage;
+                    int rowStart = (tileIdx % tilesPerImage) / tileCols * t.m;
+                    int colStart = (tileIdx % tileCols) * t.m;
+                    float* dst = result + img * s.resImage + k * s.resChan;
+                    int rows = std::min(t.m, p.resRows - rowStart);
+                    int cols = std::min(t.m, p.resCols - colStart);
+                    for (int r = 0; r < rows; r++) {
+                        for (int c = 0; c < cols; c++) {
+                            dst[(rowStart + r) * s.resRow +
+                                (colStart + c) * s.resCol] = y[r * t.m + c];
+                        }
+                    }
+                }
+            }
+        });
+    }
+}
+
+}  // namespace
+
+bool canUseConvAlgorithm(ConvAlgorithm algorithm, const ConvParams& params) {
+    bool unitStride = params.rowStride == 1 && params.colStride == 1;
+    switch (algorithm) {
+        case DirectConv:
+        case Im2colConv:
+            return true;
+        case PointwiseConv:
+            // NCHW tensors are only matrices without alignment padding.
+            return params.kRows == 1 && params.kCols == 1 && unitStride &&
+                   params.topPad == 0 && params.leftPad == 0 &&
+                   params.resRows == params.imgRows &&
+                   params.resCols == params.imgCols &&
+                   (!params.isNCHW || (params.imgPad == 0 &&
+                                       params.kPad == 0 &&
+                                       params.resPad == 0));
+        case Winograd2x2Conv:
+        case Winograd4x4Conv:
+            return params.kRows == 3 && params.kCols == 3 && unitStride;
+    }
+    return false;
+}
+
+ConvAlgorithm selectConvAlgorithm(const ConvParams& params) {
+    long macs = (long)params.imgNum * params.resRows * params.resCols *
+                params.kNum * params.imgChans * params.kRows * params.kCols;
+    if (macs < kMinEngineMacs)
+        return DirectConv;
+    if (canUseConvAlgorithm(PointwiseConv, params))
+        return PointwiseConv;
+    if (canUseConvAlgorithm(Winograd2x2Conv, params)) {
+        // F(4x4, 3x3) needs 4x fewer multiplies than a direct convolution
+        // instead of 2.25x, but its transforms are costlier and waste more
+        // work on partial tiles.
+        bool bigLayer = params.resRows >= 16 && params.resCols >= 16 &&
+                        params.imgChans >= 32 && params.kNum >= 32;
+        return bigLayer ? Winograd4x4Conv : Winograd2x2Conv;
+    }
+    return Im2colConv;
+}
+
+void convolution(const float* input,
+                 const float* kernels,
+                 float* result,
+                 const ConvParams& params,
+                 ConvAlgorithm algorithm) {
+    assert(canUseConvAlgorithm(algorithm, params));
+    switch (algorithm) {
+        case Im2colConv:
+            im2colConvolution(input, kernels, result, params);
+            break;
+        case PointwiseConv:
+            pointwiseConvolution(input, kernels, result, params);
+            break;
+        case Winograd2x2Conv:
+            winogradConvolution(input, kernels, result, params, kF2x2);
+            break;
+        case Winograd4x4Conv:
+            winogradConvolution(input, kernels, result, params, kF4x4);
+            break;
+        case DirectConv:
+            assert(false && "DirectConv runs the Aladdin kernel!");
+            break;
+    }
+}
+
+}  // namespace ref
+}  // namespace smaug
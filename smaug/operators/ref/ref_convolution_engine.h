@@ -0,0 +1,80 @@
+#ifndef _OPERATORS_REF_REF_CONVOLUTION_ENGINE_H_
+#define _OPERATORS_REF_REF_CONVOLUTION_ENGINE_H_
+
+namespace smaug {
+namespace ref {
+
+/**
+ * The algorithms that the host convolution engine can use for a layer.
+ */
+enum ConvAlgorithm {
+    /** Run the Aladdin kernel directly. Used for layers too small to benefit
+     * from rearranging their data. */
+    DirectConv,
+    /** Lower the input patches into a matrix and multiply by the kernels. */
+    Im2colConv,
+    /** 1x1 kernels with stride 1: the input already is the GEMM operand. */
+    PointwiseConv,
+    /** Winograd F(2x2, 3x3), for 3x3 kernels with stride 1. */
+    Winograd2x2Conv,
+    /** Winograd F(4x4, 3x3), for 3x3 kernels with stride 1. */
+    Winograd4x4Conv,
+};
+
+/**
+ * Describes a convolution layer the same way as the arguments of the
+ * reference Aladdin kernels: the *Pad fields are the alignment padding of the
+ * innermost dimension of each tensor, while topPad and leftPad are the zero
+ * padding around the input image.
+ */
+struct ConvParams {
+    bool isNCHW;
+    int imgNum;
+    int imgChans;
+    int imgRows;
+    int imgCols;
+    int imgPad;
+    int kNum;
+    int kRows;
+    int kCols;
+    int kPad;
+    int rowStride;
+    int colStride;
+    int resRows;
+    int resCols;
+    int resPad;
+    int topPad;
+    int leftPad;
+};
+
+/**
+ * Picks the algorithm for a layer from its shape. This is a fixed heuristic:
+ * 1x1 kernels use PointwiseConv, 3x3 stride 1 kernels use Winograd (with the
+ * larger tiles only on layers big enough to amortize their transforms), and
+ * everything else uses Im2colConv. Tiny layers use DirectConv.
+ */
+ConvAlgorithm selectConvAlgorithm(const ConvParams& params);
+
+/** Returns true if the given algorithm can compute this layer. */
+bool canUseConvAlgorithm(ConvAlgorithm algorithm, const ConvParams& params);
+
+/**
+ * Computes the convolution on the host with the given algorithm, which must
+ * not be DirectConv. The output is overwritten; activation functions are not
+ * applied. All the algorithms are built on ref::gemm, so they use the global
+ * thread pool if there is one.
+ *
+ * This is the host implementation of the reference convolution kernels for
+ * native execution. The Aladdin kernels are still used in simulation and in
+ * trace generation.
+ */
+void convolution(const float* input,
+                 const float* kernels,
+                 float* result,
+                 const ConvParams& params,
+                 ConvAlgorithm algorithm);
+
+}  // namespace ref
+}  // namespace smaug
+
+#endif
@@ -2,6 +2,7 @@
 #include "smaug/operators/common.h"
 #include "smaug/operators/convolution_op.h"
 #include "smaug/operators/ref/ref_activation_fun_op.h"
+#include "smaug/operators/ref/ref_convolution_engine.h"
 #include "smaug/utility/debug_stream.h"
 
 #ifdef __cplusplus
@@ -11,10 +12,12 @@ extern "C" {
 /** \ingroup AladdinKernels
  *
  * A Reference implementation of a 3D convolution on NCHW data with valid
- * padding.
+ * padding. If bias is not NULL, the results of each output channel start
+ * from its bias.
  */
 void ref_conv3d_nchw_valid_padding(float* input,
                                    float* kernels,
+                                   float* bias,
                                    float* result,
                                    int img_num,
                                    int img_chans,
@@ -37,6 +40,8 @@ void ref_conv3d_nchw_valid_padding(float* input,
     int result_size = img_num * k_num * res_rows * (res_cols + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     // Convolution borders.
     const int start_i = 0;
@@ -58,7 +63,7 @@ void ref_conv3d_nchw_valid_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
                     for (int d = 0; d < img_chans; d++) {
@@ -89,10 +94,12 @@ void ref_conv3d_nchw_valid_padding(float* input,
 /** \ingroup AladdinKernels
  *
  * A Reference implementation of a 3D convolution on NCHW data with same
- * padding.
+ * padding. If bias is not NULL, the results of each output channel start
+ * from its bias.
  */
 void ref_conv3d_nchw_same_padding(float* input,
                                   float* kernels,
+                                  float* bias,
                                   float* result,
                                   int img_num,
                                   int img_chans,
@@ -115,6 +122,8 @@ void ref_conv3d_nchw_same_padding(float* input,
     int result_size = img_num * k_num * res_rows * (res_cols + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     const int total_row_pad = k_rows - 1;
     const int total_col_pad = k_cols - 1;
@@ -143,7 +152,7 @@ void ref_conv3d_nchw_same_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
 
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
@@ -183,10 +192,12 @@ void ref_conv3d_nchw_same_padding(float* input,
 /** \ingroup AladdinKernels
  *
  * A Reference implementation of a 3D convolution on NHWC data with valid
- * padding.
+ * padding. If bias is not NULL, the results of each output channel start
+ * from its bias.
  */
 void ref_conv3d_nhwc_valid_padding(float* input,
                                    float* kernels,
+                                   float* bias,
                                    float* result,
                                    int img_num,
                                    int img_chans,
@@ -209,6 +220,8 @@ void ref_conv3d_nhwc_valid_padding(float* input,
     int result_size = img_num * res_rows * res_cols * (k_num + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     // Convolution borders.
     const int start_i = 0;
@@ -230,7 +243,7 @@ void ref_conv3d_nhwc_valid_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
                     for (int d = 0; d < img_chans; d++) {
@@ -261,10 +274,12 @@ void ref_conv3d_nhwc_valid_padding(float* input,
 /** \ingroup AladdinKernels
  *
  * A Reference implementation of a 3D convolution on NHWC data with same
- * padding.
+ * padding. If bias is not NULL, the results of each output channel start
+ * from its bias.
  */
 void ref_conv3d_nhwc_same_padding(float* input,
                                   float* kernels,
+                                  float* bias,
                                   float* result,
                                   int img_num,
                                   int img_chans,
@@ -287,6 +302,8 @@ void ref_conv3d_nhwc_same_padding(float* input,
     int result_size = img_num * res_rows * res_cols * (k_num + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     const int total_row_pad = k_rows - 1;
     const int total_col_pad = k_cols - 1;
@@ -315,7 +332,7 @@ void ref_conv3d_nhwc_same_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
 
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
@@ -358,6 +375,34 @@ void ref_conv3d_nhwc_same_padding(float* input,
 
 namespace smaug {
 
+#ifndef TRACE_MODE
+// Adds the bias of each output channel to the results of the host convolution
+// engine.
+static void addBias(float* outputs,
+                    const float* bias,
+                    const ref::ConvParams& params) {
+    if (params.isNCHW) {
+        int rowSize = params.resCols + params.resPad;
+        for (int img = 0; img < params.imgNum; img++) {
+            for (int k = 0; k < params.kNum; k++) {
+                int fmap = (img * params.kNum + k) * params.resRows;
+                for (int i = 0; i < params.resRows; i++) {
+                    for (int j = 0; j < params.resCols; j++)
+                        outputs[(fmap + i) * rowSize + j] += bias[k];
+                }
+            }
+        }
+    } else {
+        int pixelSize = params.kNum + params.resPad;
+        int numPixels = params.imgNum * params.resRows * params.resCols;
+        for (int p = 0; p < numPixels; p++) {
+            for (int k = 0; k < params.kNum; k++)
+                outputs[p * pixelSize + k] += bias[k];
+        }
+    }
+}
+#endif
+
 template <>
 void ConvolutionOp<ReferenceBackend>::run() {
     auto input = getInput(Inputs);
@@ -371,29 +416,75 @@ void ConvolutionOp<ReferenceBackend>::run() {
     float* inputData = input->data<float>();
     float* kernelData = kernels->data<float>();
     float* outputData = output->data<float>();
+    float* biasData = bias ? bias->data<float>() : nullptr;
     mapArrayToAccel(ref::kConvolutionHw, "input", inputData,
                     inputShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kConvolutionHw, "kernels", kernelData,
                     kernelShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kConvolutionHw, "result", outputData,
                     outputShape.storageSize() * sizeof(float));
+    if (biasData) {
+        mapArrayToAccel(ref::kConvolutionHw, "bias", biasData,
+                        bias->getShape().storageSize() * sizeof(float));
+    }
     bool isNCHW = input->getShape().getLayout() == NCHW;
+    int rowIdx = isNCHW ? 2 : 1;
+    int colIdx = isNCHW ? 3 : 2;
+    int chanIdx = isNCHW ? 1 : 3;
+#ifndef TRACE_MODE
+    // The Aladdin kernels are only needed to model the accelerator. In native
+    // execution, the host convolution engine picks a faster algorithm for the
+    // layer.
+    if (!runningInSimulation) {
+        ref::ConvParams params;
+        params.isNCHW = isNCHW;
+        params.imgNum = inputShape[0];
+        params.imgChans = inputShape[chanIdx];
+        params.imgRows = inputShape[rowIdx];
+        params.imgCols = inputShape[colIdx];
+        params.imgPad = inputShape.getPadding(3);
+        params.kNum = kernelShape[0];
+        params.kRows = kernelShape[rowIdx];
+        params.kCols = kernelShape[colIdx];
+        params.kPad = kernelShape.getPadding(3);
+        params.rowStride = getRowStride();
+        params.colStride = getColStride();
+        params.resRows = outputShape[rowIdx];
+        params.resCols = outputShape[colIdx];
+        params.resPad = outputShape.getPadding(3);
+        // Same as the Aladdin kernels with same padding.
+        bool samePadding = paddingType == SamePadding;
+        params.topPad = samePadding ? params.kCols / 2 : 0;
+        params.leftPad = samePadding ? params.kRows / 2 : 0;
+        ref::ConvAlgorithm algorithm = ref::selectConvAlgorithm(params);
+        if (algorithm != ref::DirectConv) {
+            ref::convolution(
+                    inputData, kernelData, outputData, params, algorithm);
+            if (biasData)
+                addBias(outputData, biasData, params);
+            if (actInfo.function != NO_ACTIVATION) {
+                activation_fun(outputData, outputData,
+                               outputShape.storageSize(), actInfo.function,
+                               actInfo.params);
+            }
+            return;
+        }
+    }
+#endif
     auto func = isNCHW ? (paddingType == ValidPadding
                                   ? ref_conv3d_nchw_valid_padding
                                   : ref_conv3d_nchw_same_padding)
                        : (paddingType == ValidPadding
                                   ? ref_conv3d_nhwc_valid_padding
                                   : ref_conv3d_nhwc_same_padding);
-    int rowIdx = isNCHW ? 2 : 1;
-    int colIdx = isNCHW ? 3 : 2;
-    int chanIdx = isNCHW ? 1 : 3;
-    invokeKernel(ref::kConvolutionHw, func, inputData, kernelData, outputData,
-                 inputShape[0], inputShape[chanIdx], inputShape[rowIdx],
-                 inputShape[colIdx], inputShape.getPadding(3), kernelShape[0],
-                 kernelShape[rowIdx], kernelShape[colIdx],
-                 kernelShape.getPadding(3), getRowStride(), getColStride(),
-                 outputShape[rowIdx], outputShape[colIdx],
-                 outputShape.getPadding(3), actInfo.function, actInfo.params);
+    invokeKernel(ref::kConvolutionHw, func, inputData, kernelData, biasData,
+                 outputData, inputShape[0], inputShape[chanIdx],
+                 inputShape[rowIdx], inputShape[colIdx],
+                 inputShape.getPadding(3), kernelShape[0], kernelShape[rowIdx],
+                 kernelShape[colIdx], kernelShape.getPadding(3),
+                 getRowStride(), getColStride(), outputShape[rowIdx],
+                 outputShape[colIdx], outputShape.getPadding(3),
+                 actInfo.function, actInfo.params);
 }
 
 }  // namespace smaug
@@ -3,6 +3,8 @@
 #include "smaug/core/tensor.h"
 #include "smaug/core/smaug_test.h"
 #include "smaug/operators/convolution_op.h"
+#include "smaug/operators/ref/ref_convolution_engine.h"
+#include "smaug/utility/thread_pool.h"
 
 using namespace smaug;
 
@@ -275,3 +277,152 @@ TEST_CASE_METHOD(SmaugTest, "Reference convolution operator", "[refop]") {
         }
     }
 }
+
+// Computes the expected output of a convolution with a plain loop, using the
+// same zero padding as the reference kernels.
+std::vector<float> naiveConvolution(Tensor* input,
+                                    Tensor* kernels,
+                                    Tensor* output,
+                                    int rowStride,
+                                    int colStride,
+                                    PaddingType padding) {
+    bool isNCHW = input->getShape().getLayout() == NCHW;
+    int rowIdx = isNCHW ? 2 : 1;
+    int colIdx = isNCHW ? 3 : 2;
+    int chanIdx = isNCHW ? 1 : 3;
+    const TensorShape& inputShape = input->getShape();
+    const TensorShape& kernelShape = kernels->getShape();
+    int kRows = kernelShape[rowIdx];
+    int kCols = kernelShape[colIdx];
+    int topPad = padding == SamePadding ? kCols / 2 : 0;
+    int leftPad = padding == SamePadding ? kRows / 2 : 0;
+    float* inputData = input->data<float>();
+    float* kernelData = kernels->data<float>();
+    TensorIndexIterator inputIdx = input->startIndex();
+    TensorIndexIterator kernelIdx = kernels->startIndex();
+    std::vector<float> expected;
+    for (auto outputIdx = output->startIndex(); !outputIdx.end();
+         ++outputIdx) {
+        int k = outputIdx.currentIndex(chanIdx);
+        int i = outputIdx.currentIndex(rowIdx);
+        int j = outputIdx.currentIndex(colIdx);
+        double result = 0;
+        for (int c = 0; c < inputShape[chanIdx]; c++) {
+            for (int r = 0; r < kRows; r++) {
+                for (int s = 0; s < kCols; s++) {
+                    int row = i * rowStride - topPad + r;
+                    int col = j * colStride - leftPad + s;
+                    if (row < 0 || row >= inputShape[rowIdx] || col < 0 ||
+                        col >= inputShape[colIdx])
+                        continue;
+                    float in = isNCHW ? inputData[inputIdx(0, c, row, col)]
+                                      : inputData[inputIdx(0, row, col, c)];
+                    float weight = isNCHW ? kernelData[kernelIdx(k, c, r, s)]
+                                          : kernelData[kernelIdx(k, r, s, c)];
+                    result += in * weight;
+                }
+            }
+        }
+        expected.push_back(result);
+    }
+    return expected;
+}
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Reference convolution with host algorithms",
+                 "[refop]") {
+    auto runAndVerify = [&](DataLayout layout,
+                            int chans,
+                            int rows,
+                            int cols,
+                            int kRows,
+                            int kCols,
+                            int kNum,
+                            int stride,
+                            PaddingType padding) {
+        auto convOp = new ConvolutionOp<ReferenceBackend>("conv", workspace());
+        TensorShape inputShape = layout == NCHW
+                                         ? TensorShape({ 1, chans, rows, cols },
+                                                       layout)
+                                         : TensorShape({ 1, rows, cols, chans },
+                                                       layout);
+        Tensor* input = new Tensor("input", inputShape);
+        input->allocateStorage<float>();
+        workspace()->addTensor(input);
+        convOp->setInput(input, 0);
+        convOp->setPadding(padding);
+        convOp->setWeightDims(kRows, kCols, kNum);
+        convOp->setStride(stride, stride);
+        convOp->createAllTensors();
+        allocateAllTensors<float>(convOp);
+        Tensor* kernels = convOp->getInput(1);
+        std::vector<float> inputValues, kernelValues;
+        for (int i = 0; i < inputShape.storageSize(); i++)
+            inputValues.push_back((i % 11) * 0.1 - 0.5);
+        for (int i = 0; i < kernels->getShape().storageSize(); i++)
+            kernelValues.push_back((i % 7) * 0.1 - 0.3);
+        input->fillData(inputValues.data(), inputValues.size());
+        kernels->fillData(kernelValues.data(), kernelValues.size());
+        convOp->run();
+        Tensor* output = convOp->getOutput(0);
+        verifyOutputs(output,
+                      naiveConvolution(
+                              input, kernels, output, stride, stride, padding));
+    };
+
+    SECTION("Winograd F(2x2, 3x3)") {
+        for (DataLayout layout : { NCHW, NHWC }) {
+            runAndVerify(layout, 16, 12, 13, 3, 3, 8, 1, SamePadding);
+            runAndVerify(layout, 16, 12, 13, 3, 3, 8, 1, ValidPadding);
+        }
+    }
+    SECTION("Winograd F(4x4, 3x3)") {
+        for (DataLayout layout : { NCHW, NHWC }) {
+            runAndVerify(layout, 32, 19, 18, 3, 3, 40, 1, SamePadding);
+            runAndVerify(layout, 32, 19, 18, 3, 3, 40, 1, ValidPadding);
+        }
+    }
+    SECTION("Pointwise") {
+        for (DataLayout layout : { NCHW, NHWC })
+            runAndVerify(layout, 32, 10, 11, 1, 1, 24, 1, SamePadding);
+    }
+    SECTION("im2col") {
+        for (DataLayout layout : { NCHW, NHWC }) {
+            runAndVerify(layout, 16, 15, 15, 3, 3, 16, 2, SamePadding);
+            runAndVerify(layout, 8, 14, 12, 5, 3, 12, 1, ValidPadding);
+        }
+    }
+    SECTION("Split across a thread pool") {
+        WorkStealingThreadPool pool(4);
+        pool.initThreadPool();
+        threadPool = &pool;
+        for (DataLayout layout : { NCHW, NHWC }) {
+            runAndVerify(layout, 32, 19, 18, 3, 3, 40, 1, SamePadding);
+            runAndVerify(layout, 16, 15, 15, 3, 3, 16, 2, SamePadding);
+        }
+        threadPool = nullptr;
+    }
+}
+
+TEST_CASE("Host convolution algorithm selection", "[refop]") {
+    ref::ConvParams params = { true, 1, 32, 16, 16, 0, 32, 3, 3, 0,
+                               1,    1, 16, 16, 0,  1, 1 };
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::Winograd4x4Conv);
+    params.imgChans = 16;
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::Winograd2x2Conv);
+    params.rowStride = params.colStride = 2;
+    params.resRows = params.resCols = 8;
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::Im2colConv);
+    params.kRows = params.kCols = 1;
+    params.rowStride = params.colStride = 1;
+    params.resRows = params.resCols = 16;
+    params.topPad = params.leftPad = 0;
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::PointwiseConv);
+    // Alignment padding keeps NCHW tensors from being GEMM operands.
+    params.imgPad = 4;
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::Im2colConv);
+    params.isNCHW = false;
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::PointwiseConv);
+    params.imgChans = params.kNum = 2;
+    REQUIRE(ref::selectConvAlgorithm(params) == ref::DirectConv);
+}
@@ -59,8 +59,8 @@ void ref_conv2d_nchw_valid_padding(float* input,
                     for (int k = 0; k < k_rows; k++) {
                         conv2d_kernel_cols:
                         for (int l = 0; l < k_cols; l++) {
-                            int img_val = _input[img][kern][i + k][j + l];
-                            int kern_val = _kernels[kern][k][l];
+                            float img_val = _input[img][kern][i + k][j + l];
+                            float kern_val = _kernels[kern][k][l];
                             partial_sum += img_val * kern_val;
                         }
                     }
@@ -1,6 +1,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/ref/ref_activation_fun_op.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,13 +14,18 @@ extern "C" {
 void ref_eltwise_add(float* input0,
                      float* input1,
                      float* results,
-                     int input_size) {
+                     int input_size,
+                     activation_type act_function,
+                     activation_param_t act_params) {
     dmaLoad(input0, input0, input_size * sizeof(float));
     dmaLoad(input1, input1, input_size * sizeof(float));
     eltwise_add_loop:
     for (int i = 0; i < input_size; i++) {
         results[i] = input0[i] + input1[i];
     }
+    if (act_function != NO_ACTIVATION) {
+        activation_fun(results, results, input_size, act_function, act_params);
+    }
     dmaStore(results, results, input_size * sizeof(float));
 }
 
@@ -49,7 +55,8 @@ void EltwiseAddOp<ReferenceBackend>::run() {
     mapArrayToAccel(ref::kEltwiseOpHw, "results", outputData,
                     outputShape.storageSize() * sizeof(float));
     invokeKernel(ref::kEltwiseOpHw, ref_eltwise_add, input0Data, input1Data,
-                 outputData, input0Shape.size());
+                 outputData, input0Shape.size(), actInfo.function,
+                 actInfo.params);
 }
 
 }  // namespace smaug
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <vector>
+
+#include "smaug/core/globals.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/ref/ref_gemm.h"
+#include "smaug/utility/thread_pool.h"
+
+namespace smaug {
+namespace ref {
+
+namespace {
+
+// The microkernel keeps a kMR x kNR tile of C in registers while it
+// accumulates over k: 8 SSE or 4 AVX registers.
+constexpr int kMR = 4;
+constexpr int kNR = 8;
+// A kKC x kNR sliver of packed B stays in L1, a kMC x kKC block of packed A in
+// L2, and a kKC x kNC panel of packed B in L3.
+constexpr int kMC = 64;
+constexpr int kKC = 256;
+constexpr int kNC = 512;
+
+// Packs an mc x kc block of A into slivers of kMR rows, each stored column by
+// column. Rows past mc are zero-filled.
+void packA(const float* a, int lda, int mc, int kc, float* packed) {
+    for (int i = 0; i < mc; i += kMR) {
+        int mr = std::min(kMR, mc - i);
+        for (int p = 0; p < kc; p++) {
+            for (int ii = 0; ii < kMR; ii++)
+                *packed++ = ii < mr ? a[(i + ii) * lda + p] : 0;
+        }
+    }
+}
+
+// Packs a kc x nc panel of B into slivers of kNR columns, each stored row by
+// row. Columns past nc are zero-filled. Packing is the only step that depends
+// on the layout of B.
+void packB(const float* b,
+           int ldb,
+           bool transposeB,
+           int kc,
+           int nc,
+           float* packed) {
+    for (int j = 0; j < nc; j += kNR) {
+        int nr = std::min(kNR, nc - j);
+        for (int p = 0; p < kc; p++) {
+            for (int jj = 0; jj < kNR; jj++) {
+                float value = 0;
+                if (jj < nr) {
+                    value = transposeB ? b[(j + jj) * ldb + p]
+                                       : b[p * ldb + j + jj];
+                }
+                *packed++ = value;
+            }
+        }
+    }
+}
+
+// Computes the mr x nr tile of C from a packed sliver of A and one of B.
+// Unless accumulate is set, the tile is overwritten.
+void microKernel(int kc,
+                 const float* a,
+                 const float* b,
+                 float* c,
+                 int ldc,
+                 int mr,
+                 int nr,
+                 bool accumulate) {
+    float acc[kMR][kNR] = {};
+    for (int p = 0; p < kc; p++) {
+        for (int i = 0; i < kMR; i++) {
+            for (int j = 0; j < kNR; j++)
+                acc[i][j] += a[i] * b[j];
+        }
+        a += kMR;
+        b += kNR;
+    }
+    for (int i = 0; i < mr; i++) {
+        for (int j = 0; j < nr; j++) {
+            float* result = &c[i * ldc + j];
+            *result = accumulate ? *result + acc[i][j] : acc[i][j];
+        }
+    }
+}
+
+// Computes an mc x nc block of C over the whole k dimension.
+void gemmBlock(const float* a,
+               int lda,
+               const float* b,
+               int ldb,
+               bool transposeB,
+               float* c,
+               int ldc,
+               int mc,
+               int nc,
+               int k) {
+    // Every thread packs into its own buffers, which are reused across calls.
+    thread_local std::vector<float> packedA;
+    thread_local std::vector<float> packedB;
+    packedA.resize(next_multiple(mc, kMR) * kKC);
+    packedB.resize(next_multiple(nc, kNR) * kKC);
+    for (int pc = 0; pc < k; pc += kKC) {
+        int kc = std::min(kKC, k - pc);
+        packA(a + pc, lda, mc, kc, packedA.data());
+        packB(transposeB ? b + pc : b + pc * ldb, ldb, transposeB, kc, nc,
+              packedB.data());
+        for (int jr = 0; jr < nc; jr += kNR) {
+            for (int ir = 0; ir < mc; ir += kMR) {
+                microKernel(kc, &packedA[ir * kc], &packedB[jr * kc],
+                            c + ir * ldc + jr, ldc, std::min(kMR, mc - ir),
+                            std::min(kNR, nc - jr), pc > 0);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void gemm(const float* a,
+          int lda,
+          const float* b,
+          int ldb,
+          bool transposeB,
+          float* c,
+          int ldc,
+          int m,
+          int n,
+          int k) {
+    if (m == 0 || n == 0)
+        return;
+    if (k == 0) {
+        for (int i = 0; i < m; i++)
+            std::fill(c + i * ldc, c + i * ldc + n, 0.0f);
+        return;
+    }
+    bool useThreadPool = threadPool && !fastForwardMode;
+    int numMBlocks = FRAC_CEIL(m, kMC);
+    // When there are few rows, like the batch of an LSTM step, use narrower
+    // panels of B, so that every thread gets a block of C.
+    int minNBlocks = useThreadPool
+                             ? FRAC_CEIL(threadPool->size(), numMBlocks)
+                             : 1;
+    int nc = std::min<int>(kNC, next_multiple(FRAC_CEIL(n, minNBlocks), kNR));
+    int numNBlocks = FRAC_CEIL(n, nc);
+    auto computeBlocks = [&](int start, int end) {
+        for (int block = start; block < end; block++) {
+            int ic = (block / numNBlocks) * kMC;
+            int jc = (block % numNBlocks) * nc;
+            gemmBlock(a + ic * lda, lda,
+                      transposeB ? b + jc * ldb : b + jc, ldb, transposeB,
+                      c + ic * ldc + jc, ldc, std::min(kMC, m - ic),
+                      std::min(nc, n - jc), k);
+        }
+    };
+    int numBlocks = numMBlocks * numNBlocks;
+    if (useThreadPool && numBlocks > 1)
+        threadPool->parallelFor(0, numBlocks, 1, computeBlocks);
+    else
+        computeBlocks(0, numBlocks);
+}
+
+}  // namespace ref
+}  // namespace smaug
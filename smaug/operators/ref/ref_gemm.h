@@ -0,0 +1,38 @@
+#ifndef _OPERATORS_REF_REF_GEMM_H_
+#define _OPERATORS_REF_REF_GEMM_H_
+
+namespace smaug {
+namespace ref {
+
+/**
+ * Computes `C = A x B` on the host, where A is m x k and C is m x n. If
+ * transposeB is false, B is stored as a k x n matrix; otherwise, it is stored
+ * as an n x k matrix (so this computes `C = A x B_transpose`).
+ *
+ * All matrices are row-major, and ld* are their row strides in elements,
+ * which include any alignment padding.
+ *
+ * This is a blocked GEMM in the style of Goto/BLIS: panels of B and blocks of
+ * A are packed into contiguous buffers sized for the caches, and a
+ * register-blocked microkernel computes the C tiles. Blocks of C are split
+ * across the global thread pool, if there is one.
+ *
+ * This is the host implementation of the reference inner product kernels for
+ * native execution. The Aladdin kernels are still used in simulation and in
+ * trace generation.
+ */
+void gemm(const float* a,
+          int lda,
+          const float* b,
+          int ldb,
+          bool transposeB,
+          float* c,
+          int ldc,
+          int m,
+          int n,
+          int k);
+
+}  // namespace ref
+}  // namespace smaug
+
+#endif
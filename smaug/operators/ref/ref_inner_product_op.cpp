@@ -2,6 +2,7 @@
 #include "smaug/operators/common.h"
 #include "smaug/operators/inner_product_op.h"
 #include "smaug/operators/ref/ref_activation_fun_op.h"
+#include "smaug/operators/ref/ref_gemm.h"
 #include "smaug/utility/debug_stream.h"
 
 #ifdef __cplusplus
@@ -14,6 +15,7 @@ extern "C" {
  *
  * @param a A matrix of dimensions a_height x a_width
  * @param b A matrix of dimensions a_width x b_width
+ * @param bias The bias of each column of C, or NULL if C has no bias.
  * @param c A matrix of dimensions a_height x b_width
  * @param a_height Number of rows in A
  * @param a_width Number of columns in A
@@ -27,6 +29,7 @@ extern "C" {
  */
 void ref_inner_product_ab_times_bc(float* a,
                                    float* b,
+                                   float* bias,
                                    float* c,
                                    int a_height,
                                    int a_width,
@@ -41,6 +44,8 @@ void ref_inner_product_ab_times_bc(float* a,
     int result_size = a_height * (b_width + c_pad);
     dmaLoad(a, a, input_size * sizeof(float));
     dmaLoad(b, b, weight_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, b_width * sizeof(float));
 
     ARRAY_2D(float, _a, a, a_width + a_pad);
     ARRAY_2D(float, _b, b, b_width + b_pad);
@@ -50,7 +55,7 @@ void ref_inner_product_ab_times_bc(float* a,
     for (int i = 0; i < a_height; i++) {
         matmul1:
         for (int j = 0; j < b_width; j++) {
-            float result = 0;
+            float result = bias ? bias[j] : 0;
             matmul2:
             for (int k = 0; k < a_width; k++) {
                 float a_val = _a[i][k];
@@ -73,6 +78,7 @@ void ref_inner_product_ab_times_bc(float* a,
  *
  * @param a A matrix of dimensions a_height x b_width
  * @param b A matrix of dimensions b_height x b_width
+ * @param bias The bias of each column of C, or NULL if C has no bias.
  * @param c A matrix of dimensions a_height x b_width
  * @param a_height Number of rows in A
  * @param b_width Number of columns in B
@@ -86,6 +92,7 @@ void ref_inner_product_ab_times_bc(float* a,
  */
 void ref_inner_product_ab_times_cb(float* a,
                                    float* b,
+                                   float* bias,
                                    float* c,
                                    int a_height,
                                    int b_width,
@@ -101,6 +108,8 @@ void ref_inner_product_ab_times_cb(float* a,
     int result_size = a_height * (b_height + c_pad);
     dmaLoad(a, a, input_size * sizeof(float));
     dmaLoad(b, b, weight_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, b_height * sizeof(float));
 
     ARRAY_2D(float, _a, a, a_width);
     ARRAY_2D(float, _b, b, b_width);
@@ -110,7 +119,7 @@ void ref_inner_product_ab_times_cb(float* a,
     for (int i = 0; i < a_height; i++) {
         matmul1:
         for (int j = 0; j < b_height; j++) {
-            float result = 0;
+            float result = bias ? bias[j] : 0;
             matmul2:
             for (int k = 0; k < a_width; k++) {
                 float a_val = _a[i][k];
@@ -149,21 +158,49 @@ void InnerProductOp<ReferenceBackend>::run() {
     float* inputData = input->data<float>();
     float* weightData = weights->data<float>();
     float* outputData = output->data<float>();
+    float* biasData = bias ? bias->data<float>() : nullptr;
+    bool weightsTransposed = weightShape.getLayout() == DataLayout::NC;
+    int actIdx = weightsTransposed ? 1 : 0;
+    int neuronIdx = weightsTransposed ? 0 : 1;
+#ifndef TRACE_MODE
+    // The Aladdin kernels are only needed to model the accelerator. In native
+    // execution, the blocked host GEMM computes the same result much faster.
+    if (!runningInSimulation) {
+        ref::gemm(inputData, inputShape.getStorageDim(1), weightData,
+                  weightShape.getStorageDim(1), weightsTransposed, outputData,
+                  outputShape.getStorageDim(1), inputShape[0],
+                  weightShape[neuronIdx], weightShape[actIdx]);
+        if (biasData) {
+            int outputCols = outputShape.getStorageDim(1);
+            for (int i = 0; i < outputShape[0]; i++) {
+                for (int j = 0; j < outputShape[1]; j++)
+                    outputData[i * outputCols + j] += biasData[j];
+            }
+        }
+        if (actInfo.function != NO_ACTIVATION) {
+            activation_fun(outputData, outputData, outputShape.storageSize(),
+                           actInfo.function, actInfo.params);
+        }
+        return;
+    }
+#endif
     mapArrayToAccel(ref::kInnerProductHw, "a", inputData,
                     inputShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kInnerProductHw, "b", weightData,
                     weightShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kInnerProductHw, "c", outputData,
                     outputShape.storageSize() * sizeof(float));
-    bool weightsTransposed = weightShape.getLayout() == DataLayout::NC;
+    if (biasData) {
+        mapArrayToAccel(ref::kInnerProductHw, "bias", biasData,
+                        bias->getShape().storageSize() * sizeof(float));
+    }
     auto func = weightsTransposed ? ref_inner_product_ab_times_cb
                                   : ref_inner_product_ab_times_bc;
-    int actIdx = weightsTransposed ? 1 : 0;
-    int neuronIdx = weightsTransposed ? 0 : 1;
-    invokeKernel(ref::kInnerProductHw, func, inputData, weightData, outputData,
-                 inputShape[0], weightShape[actIdx], weightShape[neuronIdx],
-                 inputShape.getPadding(1), weightShape.getPadding(1),
-                 outputShape.getPadding(1), actInfo.function, actInfo.params);
+    invokeKernel(ref::kInnerProductHw, func, inputData, weightData, biasData,
+                 outputData, inputShape[0], weightShape[actIdx],
+                 weightShape[neuronIdx], inputShape.getPadding(1),
+                 weightShape.getPadding(1), outputShape.getPadding(1),
+                 actInfo.function, actInfo.params);
 }
 
 }  // namespace smaug
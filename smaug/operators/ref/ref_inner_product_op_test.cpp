@@ -4,6 +4,7 @@
 #include "smaug/core/smaug_test.h"
 #include "smaug/operators/reorder_op.h"
 #include "smaug/operators/inner_product_op.h"
+#include "smaug/utility/thread_pool.h"
 
 using namespace smaug;
 
@@ -168,3 +169,58 @@ TEST_CASE_METHOD(SmaugTest, "Reference inner product operator", "[refop]") {
         }
     }
 }
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Reference inner product spanning multiple GEMM blocks",
+                 "[refop]") {
+    // None of the dimensions are multiples of the register or cache blocks,
+    // and each of them spans more than one cache block.
+    const int batch = 70, numInputs = 300, numOutputs = 530;
+    auto matMulOp = new InnerProductOp<ReferenceBackend>("matmul", workspace());
+    Tensor* input = new Tensor("input", TensorShape({ batch, numInputs }, NC));
+    input->allocateStorage<float>();
+    workspace()->addTensor(input);
+    matMulOp->setInput(input, 0);
+    matMulOp->setNumOutputs(numOutputs);
+    matMulOp->createAllTensors();
+    allocateAllTensors<float>(matMulOp);
+    Tensor* weights = matMulOp->getInput(1);
+    REQUIRE(weights->getShape().getLayout() == CN);
+
+    std::vector<float> inputValues, weightValues;
+    for (int i = 0; i < batch * numInputs; i++)
+        inputValues.push_back((i % 13) * 0.1 - 0.6);
+    for (int i = 0; i < numInputs * numOutputs; i++)
+        weightValues.push_back((i % 7) * 0.1 - 0.3);
+    input->fillData(inputValues.data(), inputValues.size());
+    weights->fillData(weightValues.data(), weightValues.size());
+    std::vector<float> expectedValues;
+    for (int i = 0; i < batch; i++) {
+        for (int j = 0; j < numOutputs; j++) {
+            double result = 0;
+            for (int k = 0; k < numInputs; k++) {
+                result += inputValues[i * numInputs + k] *
+                          weightValues[k * numOutputs + j];
+            }
+            expectedValues.push_back(result);
+        }
+    }
+
+    SECTION("Non-transposed weights") {
+        matMulOp->run();
+        verifyOutputs(matMulOp->getOutput(0), expectedValues);
+    }
+    SECTION("Transposed weights") {
+        matMulOp->setInput(transposeWeights(weights, workspace()), 1);
+        matMulOp->run();
+        verifyOutputs(matMulOp->getOutput(0), expectedValues);
+    }
+    SECTION("Blocks split across a thread pool") {
+        WorkStealingThreadPool pool(4);
+        pool.initThreadPool();
+        threadPool = &pool;
+        matMulOp->run();
+        threadPool = nullptr;
+        verifyOutputs(matMulOp->getOutput(0), expectedValues);
+    }
+}
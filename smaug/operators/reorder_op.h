@@ -35,6 +35,15 @@ class ReorderOp : public Operator {
     void run() override {
         auto stats = gem5::ScopedStats(
                 stats::kReorderingStart, stats::kReorderingEnd);
+        reorder();
+    }
+
+    /**
+     * Reorders the input into the output. Unlike run(), this does not mark a
+     * stats region, so it can be used to transform constant tensors while the
+     * network is loaded.
+     */
+    void reorder() {
         Tensor* input = getInput(Inputs);
         Tensor* output = getOutput(Outputs);
         DataLayout srcLayout = input->getShape().getLayout();
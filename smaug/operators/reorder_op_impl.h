@@ -1,104 +1,344 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "smaug/core/globals.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/tensor_utils.h"
+#include "smaug/operators/common.h"
+#include "smaug/utility/thread_pool.h"
 
 namespace smaug {
 
+/**
+ * The minimum number of elements a reordering task on the thread pool works
+ * on, so that small tensors are not split into tasks that cost more to
+ * schedule than to copy.
+ */
+constexpr const int kMinReorderTaskSize = 16384;
+
+/**
+ * The number of rows and columns of a block of a matrix that is transposed
+ * while it stays in the L1 cache.
+ */
+constexpr const int kReorderCacheBlock = 64;
+
+/**
+ * Runs func(start, end) over [0, numUnits) on the thread pool if there is one.
+ *
+ * @param numUnits The number of independent units of work.
+ * @param unitSize The number of elements copied by each unit.
+ * @param func The function run on every chunk of units.
+ */
+template <typename Func>
+void parallelReorder(int numUnits, int unitSize, Func func) {
+    if (threadPool && !fastForwardMode && numUnits > 1) {
+        int grain = std::max(1, kMinReorderTaskSize / std::max(unitSize, 1));
+        threadPool->parallelFor(0, numUnits, grain, func);
+    } else {
+        func(0, numUnits);
+    }
+}
+
+#ifdef __SSE2__
+/**
+ * Transposes a 4x4 tile of 32-bit elements in SSE2 registers. SSE2 is part of
+ * the x86-64 baseline, so this also builds for the gem5 targets.
+ */
+inline void transposeTile4x4Epi32(const void* in,
+                                  int ldIn,
+                                  void* out,
+                                  int ldOut) {
+    const int32_t* src = reinterpret_cast<const int32_t*>(in);
+    int32_t* dst = reinterpret_cast<int32_t*>(out);
+    __m128i r0 = _mm_loadu_si128((const __m128i*)(src));
+    __m128i r1 = _mm_loadu_si128((const __m128i*)(src + ldIn));
+    __m128i r2 = _mm_loadu_si128((const __m128i*)(src + 2 * ldIn));
+    __m128i r3 = _mm_loadu_si128((const __m128i*)(src + 3 * ldIn));
+    // Interleave pairs of rows, then pairs of those.
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    _mm_storeu_si128((__m128i*)(dst), _mm_unpacklo_epi64(t0, t2));
+    _mm_storeu_si128((__m128i*)(dst + ldOut), _mm_unpackhi_epi64(t0, t2));
+    _mm_storeu_si128((__m128i*)(dst + 2 * ldOut), _mm_unpacklo_epi64(t1, t3));
+    _mm_storeu_si128((__m128i*)(dst + 3 * ldOut), _mm_unpackhi_epi64(t1, t3));
+}
+
+/** Transposes an 8x8 tile of 16-bit elements in SSE2 registers. */
+inline void transposeTile8x8Epi16(const void* in,
+                                  int ldIn,
+                                  void* out,
+                                  int ldOut) {
+    const int16_t* src = reinterpret_cast<const int16_t*>(in);
+    int16_t* dst = reinterpret_cast<int16_t*>(out);
+    __m128i r[8];
+    for (int i = 0; i < 8; i++)
+        r[i] = _mm_loadu_si128((const __m128i*)(src + i * ldIn));
+    // After interleaving 16-bit, 32-bit and then 64-bit lanes of pairs of
+    // rows, each register holds one column.
+    __m128i t[8], u[8];
+    for (int i = 0; i < 4; i++) {
+        t[2 * i] = _mm_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+        t[2 * i + 1] = _mm_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
+    }
+    for (int i = 0; i < 2; i++) {
+        u[4 * i] = _mm_unpacklo_epi32(t[4 * i], t[4 * i + 2]);
+        u[4 * i + 1] = _mm_unpackhi_epi32(t[4 * i], t[4 * i + 2]);
+        u[4 * i + 2] = _mm_unpacklo_epi32(t[4 * i + 1], t[4 * i + 3]);
+        u[4 * i + 3] = _mm_unpackhi_epi32(t[4 * i + 1], t[4 * i + 3]);
+    }
+    for (int j = 0; j < 4; j++) {
+        _mm_storeu_si128((__m128i*)(dst + 2 * j * ldOut),
+                         _mm_unpacklo_epi64(u[j], u[j + 4]));
+        _mm_storeu_si128((__m128i*)(dst + (2 * j + 1) * ldOut),
+                         _mm_unpackhi_epi64(u[j], u[j + 4]));
+    }
+}
+#endif
+
+/**
+ * Transposes a square kBlock x kBlock tile of kElemSize-byte elements through a
+ * local buffer. The last argument selects the implementation by element size.
+ */
+template <typename DType, int kBlock, int kElemSize>
+inline void transposeTile(const DType* in,
+                          int ldIn,
+                          DType* out,
+                          int ldOut,
+                          std::integral_constant<int, kElemSize>) {
+    DType tile[kBlock][kBlock];
+    for (int i = 0; i < kBlock; i++) {
+        for (int j = 0; j < kBlock; j++)
+            tile[j][i] = in[i * ldIn + j];
+    }
+    for (int j = 0; j < kBlock; j++) {
+        for (int i = 0; i < kBlock; i++)
+            out[j * ldOut + i] = tile[j][i];
+    }
+}
+
+#ifdef __SSE2__
+/** Transposes a tile of 32-bit elements in SSE2 registers, 4x4 at a time. */
+template <typename DType, int kBlock>
+inline void transposeTile(const DType* in,
+                          int ldIn,
+                          DType* out,
+                          int ldOut,
+                          std::integral_constant<int, 4>) {
+    static_assert(kBlock % 4 == 0, "The tile must be made of 4x4 blocks!");
+    for (int i = 0; i < kBlock; i += 4) {
+        for (int j = 0; j < kBlock; j += 4) {
+            transposeTile4x4Epi32(
+                    in + i * ldIn + j, ldIn, out + j * ldOut + i, ldOut);
+        }
+    }
+}
+
+/** Transposes a tile of 16-bit elements in SSE2 registers, 8x8 at a time. */
+template <typename DType, int kBlock>
+inline void transposeTile(const DType* in,
+                          int ldIn,
+                          DType* out,
+                          int ldOut,
+                          std::integral_constant<int, 2>) {
+    static_assert(kBlock % 8 == 0, "The tile must be made of 8x8 blocks!");
+    for (int i = 0; i < kBlock; i += 8) {
+        for (int j = 0; j < kBlock; j += 8) {
+            transposeTile8x8Epi16(
+                    in + i * ldIn + j, ldIn, out + j * ldOut + i, ldOut);
+        }
+    }
+}
+#endif
+
+/**
+ * Transposes a square kBlock x kBlock tile. kBlock is chosen so that a row of
+ * the tile is 32 bytes, so the rows read from in and written to out are
+ * contiguous. The tiles of 32-bit and 16-bit types are transposed in SSE2
+ * registers; the others go through a local buffer.
+ */
+template <typename DType, int kBlock>
+inline void transposeTile(const DType* in, int ldIn, DType* out, int ldOut) {
+    transposeTile<DType, kBlock>(
+            in, ldIn, out, ldOut, std::integral_constant<int, sizeof(DType)>());
+}
+
+/**
+ * Transposes a rows x cols matrix, writing out[j * ldOut + i] =
+ * in[i * ldIn + j].
+ *
+ * The matrix is walked in cache blocks, each of which is transposed in
+ * 32-byte-wide tiles (8x8 for fp32, 16x16 for fp16) by transposeTile(). The
+ * ragged edges are copied one element at a time.
+ */
 template <typename DType>
-void convertNchwToNhwcImpl(Tensor* input, Tensor* output) {
-    TensorIndexIterator inputIdx = input->startIndex();
-    TensorIndexIterator outputIdx = output->startIndex();
-    const TensorShape& inputShape = input->getShape();
-    DType* inputData = input->template data<DType>();
-    DType* outputData = output->template data<DType>();
-    for (int n = 0; n < inputShape[0]; n++) {
-        for (int c = 0; c < inputShape[1]; c++) {
-            for (int h = 0; h < inputShape[2]; h++) {
-                for (int w = 0; w < inputShape[3]; w++) {
-                    outputData[outputIdx(n, h, w, c)] =
-                            inputData[inputIdx(n, c, h, w)];
+void transposeMatrix(const DType* in,
+                     int ldIn,
+                     DType* out,
+                     int ldOut,
+                     int rows,
+                     int cols) {
+    constexpr int kBlock = sizeof(DType) < 8 ? 32 / sizeof(DType) : 4;
+    for (int ib = 0; ib < rows; ib += kReorderCacheBlock) {
+        int iEnd = std::min(rows, ib + kReorderCacheBlock);
+        for (int jb = 0; jb < cols; jb += kReorderCacheBlock) {
+            int jEnd = std::min(cols, jb + kReorderCacheBlock);
+            int i = ib;
+            for (; i + kBlock <= iEnd; i += kBlock) {
+                int j = jb;
+                for (; j + kBlock <= jEnd; j += kBlock) {
+                    transposeTile<DType, kBlock>(
+                            in + i * ldIn + j, ldIn, out + j * ldOut + i,
+                            ldOut);
+                }
+                for (; j < jEnd; j++) {
+                    for (int ii = i; ii < i + kBlock; ii++)
+                        out[j * ldOut + ii] = in[ii * ldIn + j];
                 }
             }
+            for (; i < iEnd; i++) {
+                for (int j = jb; j < jEnd; j++)
+                    out[j * ldOut + i] = in[i * ldIn + j];
+            }
         }
     }
 }
 
+template <typename DType>
+void convertNchwToNhwcImpl(Tensor* input, Tensor* output) {
+    const TensorShape& inputShape = input->getShape();
+    const DType* inputData = input->template data<DType>();
+    DType* outputData = output->template data<DType>();
+    int batches = inputShape[0], chans = inputShape[1];
+    int rows = inputShape[2], cols = inputShape[3];
+    int inCols = inputShape.getStorageDim(3);
+    int outChans = output->getShape().getStorageDim(3);
+    // Each row of every image is a (chans x cols) matrix, with a stride of a
+    // whole channel between its rows, transposed into (cols x chans).
+    parallelReorder(batches * rows, chans * cols, [&](int start, int end) {
+        for (int unit = start; unit < end; unit++) {
+            int n = unit / rows, h = unit % rows;
+            transposeMatrix(inputData + ((long)n * chans * rows + h) * inCols,
+                            rows * inCols,
+                            outputData + ((long)n * rows + h) * cols * outChans,
+                            outChans, chans, cols);
+        }
+    });
+}
+
 template <typename DType>
 void convertNhwcToNchwImpl(Tensor* input, Tensor* output) {
-    TensorIndexIterator inputIdx = input->startIndex();
-    TensorIndexIterator outputIdx = output->startIndex();
     const TensorShape& inputShape = input->getShape();
-    DType* inputData = input->template data<DType>();
+    const DType* inputData = input->template data<DType>();
     DType* outputData = output->template data<DType>();
-    for (int n = 0; n < inputShape[0]; n++) {
-        for (int h = 0; h < inputShape[1]; h++) {
-            for (int w = 0; w < inputShape[2]; w++) {
-                for (int c = 0; c < inputShape[3]; c++) {
-                    outputData[outputIdx(n, c, h, w)] =
-                            inputData[inputIdx(n, h, w, c)];
-                }
-            }
+    int batches = inputShape[0], rows = inputShape[1];
+    int cols = inputShape[2], chans = inputShape[3];
+    int inChans = inputShape.getStorageDim(3);
+    int outCols = output->getShape().getStorageDim(3);
+    // The inverse of convertNchwToNhwcImpl: every (cols x chans) row of an
+    // image is transposed into a row of each of the output channels.
+    parallelReorder(batches * rows, chans * cols, [&](int start, int end) {
+        for (int unit = start; unit < end; unit++) {
+            int n = unit / rows, h = unit % rows;
+            transposeMatrix(inputData + ((long)n * rows + h) * cols * inChans,
+                            inChans,
+                            outputData + ((long)n * chans * rows + h) * outCols,
+                            rows * outCols, cols, chans);
         }
-    }
+    });
 }
 
 template <typename DType>
 void flattenImpl(Tensor* input, Tensor* output) {
-    TensorIndexIterator inputIdx = input->startIndex();
-    TensorIndexIterator outputIdx = output->startIndex();
     const TensorShape& inputShape = input->getShape();
     const TensorShape& outputShape = output->getShape();
-    DType* inputData = input->template data<DType>();
+    const DType* inputData = input->template data<DType>();
     DType* outputData = output->template data<DType>();
-    bool targetNC = outputShape.getLayout() == NC;
-    for (int n = 0; n < inputShape[0]; n++) {
-        int out_i = 0;
-        // At this point, it doesn't matter whether the layout is NCHW or NHWC.
-        // We just need to flatten the HWC part, which is dictated by the size
-        // of each dimension and not the logical meaning of each dim.
-        for (int i = 0; i < inputShape[1]; i++) {
-            for (int j = 0; j < inputShape[2]; j++) {
-                for (int k = 0; k < inputShape[3]; k++) {
-                    if (targetNC) {
-                        outputData[outputIdx(n, out_i++)] =
-                                inputData[inputIdx(n, i, j, k)];
-                    } else {
-                        outputData[outputIdx(out_i++, n)] =
-                                inputData[inputIdx(n, i, j, k)];
-                    }
+    // At this point, it doesn't matter whether the layout is NCHW or NHWC.
+    // We just need to flatten the HWC part, which is dictated by the size
+    // of each dimension and not the logical meaning of each dim.
+    int batches = inputShape[0], dim1 = inputShape[1];
+    int dim2 = inputShape[2], dim3 = inputShape[3];
+    int inDim3 = inputShape.getStorageDim(3);
+    int outCols = outputShape.getStorageDim(1);
+    if (outputShape.getLayout() == NC) {
+        // Every innermost row of the input is copied as a whole.
+        parallelReorder(batches * dim1, dim2 * dim3, [&](int start, int end) {
+            for (int unit = start; unit < end; unit++) {
+                int n = unit / dim1, i = unit % dim1;
+                for (int j = 0; j < dim2; j++) {
+                    memcpy(outputData + (long)n * outCols +
+                                   ((long)i * dim2 + j) * dim3,
+                           inputData + (((long)n * dim1 + i) * dim2 + j) *
+                                               inDim3,
+                           dim3 * sizeof(DType));
                 }
             }
-        }
+        });
+    } else {
+        // The same innermost row of all the batches forms a (batches x dim3)
+        // matrix, which is transposed into dim3 rows of the output.
+        int numRows = dim1 * dim2;
+        parallelReorder(numRows, batches * dim3, [&](int start, int end) {
+            for (int row = start; row < end; row++) {
+                transposeMatrix(inputData + (long)row * inDim3,
+                                numRows * inDim3,
+                                outputData + (long)row * dim3 * outCols,
+                                outCols, batches, dim3);
+            }
+        });
     }
 }
 
 template <typename DType>
 void transpose3DImpl(Tensor* input, Tensor* output) {
-    TensorIndexIterator inputIdx = input->startIndex();
-    TensorIndexIterator outputIdx = output->startIndex();
     const TensorShape& inputShape = input->getShape();
-    auto inputData = input->template data<DType>();
-    auto outputData = output->template data<DType>();
-    for (int i = 0; i < inputShape[0]; i++) {
-        for (int j = 0; j < inputShape[1]; j++) {
-            for (int k = 0; k < inputShape[2]; k++) {
-                outputData[outputIdx(i, k, j)] = inputData[inputIdx(i, j, k)];
-            }
+    const DType* inputData = input->template data<DType>();
+    DType* outputData = output->template data<DType>();
+    int batches = inputShape[0], rows = inputShape[1], cols = inputShape[2];
+    int inCols = inputShape.getStorageDim(2);
+    int outCols = output->getShape().getStorageDim(2);
+    // Split the rows of each matrix so that a single batch is still spread
+    // across the thread pool.
+    int rowBlocks = FRAC_CEIL(rows, kReorderCacheBlock);
+    auto transposeBlocks = [&](int start, int end) {
+        for (int unit = start; unit < end; unit++) {
+            int i = unit / rowBlocks;
+            int j = (unit % rowBlocks) * kReorderCacheBlock;
+            transposeMatrix(inputData + ((long)i * rows + j) * inCols, inCols,
+                            outputData + (long)i * cols * outCols + j, outCols,
+                            std::min(kReorderCacheBlock, rows - j), cols);
         }
-    }
+    };
+    parallelReorder(
+            batches * rowBlocks, kReorderCacheBlock * cols, transposeBlocks);
 }
 
 template <typename DType>
 void transpose2DImpl(Tensor* input, Tensor* output) {
-    TensorIndexIterator inputIdx = input->startIndex();
-    TensorIndexIterator outputIdx = output->startIndex();
     const TensorShape& inputShape = input->getShape();
-    auto inputData = input->template data<DType>();
-    auto outputData = output->template data<DType>();
-    for (int n = 0; n < inputShape[0]; n++) {
-        for (int c = 0; c < inputShape[1]; c++) {
-            outputData[outputIdx(c, n)] = inputData[inputIdx(n, c)];
+    const DType* inputData = input->template data<DType>();
+    DType* outputData = output->template data<DType>();
+    int rows = inputShape[0], cols = inputShape[1];
+    int inCols = inputShape.getStorageDim(1);
+    int outCols = output->getShape().getStorageDim(1);
+    int rowBlocks = FRAC_CEIL(rows, kReorderCacheBlock);
+    auto transposeBlocks = [&](int start, int end) {
+        for (int block = start; block < end; block++) {
+            int i = block * kReorderCacheBlock;
+            transposeMatrix(inputData + (long)i * inCols, inCols,
+                            outputData + i, outCols,
+                            std::min(kReorderCacheBlock, rows - i), cols);
         }
-    }
+    };
+    parallelReorder(rowBlocks, kReorderCacheBlock * cols, transposeBlocks);
 }
 
 void convertNchwToNhwc(Tensor* input, Tensor* output);
@@ -2,7 +2,9 @@
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/smaug_test.h"
+#include "smaug/core/globals.h"
 #include "smaug/operators/reorder_op.h"
+#include "smaug/utility/thread_pool.h"
 
 using namespace smaug;
 
@@ -93,3 +95,123 @@ TEST_CASE_METHOD(SmaugTest, "Reorder from NHWC", "[refop]") {
         verifyOutputs(outputsTensor, inputValues);
     }
 }
+
+TEST_CASE_METHOD(SmaugTest, "Blocked reorders", "[refop]") {
+    // The sizes are not multiples of the transpose tiles, and the innermost
+    // dimensions are padded, so every edge case of the blocking is hit.
+    WorkStealingThreadPool pool(4);
+    pool.initThreadPool();
+    threadPool = &pool;
+    fastForwardMode = false;
+    auto createInput = [&](const std::vector<int>& dims, DataLayout layout) {
+        TensorShape shape(dims, layout, 8);
+        Tensor* input = new Tensor("input", shape);
+        input->allocateStorage<float>();
+        float* data = input->data<float>();
+        for (int i = 0; i < shape.storageSize(); i++)
+            data[i] = i;
+        workspace()->addTensor(input);
+        return input;
+    };
+    auto runReorder = [&](Tensor* input, DataLayout targetLayout) {
+        auto reorderOp =
+                new ReorderOp<ReferenceBackend>("reorder", workspace());
+        reorderOp->setInput(input, 0);
+        reorderOp->setTargetLayout(targetLayout);
+        reorderOp->createAllTensors();
+        allocateAllTensors<float>(reorderOp);
+        reorderOp->run();
+        return reorderOp->getOutput(0);
+    };
+
+    SECTION("NCHW to NHWC") {
+        Tensor* input = createInput({ 2, 37, 5, 19 }, DataLayout::NCHW);
+        Tensor* output = runReorder(input, DataLayout::NHWC);
+        auto inIdx = input->startIndex();
+        auto outIdx = output->startIndex();
+        float* in = input->data<float>();
+        float* out = output->data<float>();
+        for (int n = 0; n < 2; n++)
+            for (int c = 0; c < 37; c++)
+                for (int h = 0; h < 5; h++)
+                    for (int w = 0; w < 19; w++)
+                        REQUIRE(out[outIdx(n, h, w, c)] ==
+                                in[inIdx(n, c, h, w)]);
+    }
+
+    SECTION("NHWC to NCHW") {
+        Tensor* input = createInput({ 2, 5, 19, 37 }, DataLayout::NHWC);
+        Tensor* output = runReorder(input, DataLayout::NCHW);
+        auto inIdx = input->startIndex();
+        auto outIdx = output->startIndex();
+        float* in = input->data<float>();
+        float* out = output->data<float>();
+        for (int n = 0; n < 2; n++)
+            for (int h = 0; h < 5; h++)
+                for (int w = 0; w < 19; w++)
+                    for (int c = 0; c < 37; c++)
+                        REQUIRE(out[outIdx(n, c, h, w)] ==
+                                in[inIdx(n, h, w, c)]);
+    }
+
+    SECTION("Flatten") {
+        Tensor* input = createInput({ 3, 5, 7, 9 }, DataLayout::NHWC);
+        Tensor* output = runReorder(input, DataLayout::NC);
+        auto inIdx = input->startIndex();
+        auto outIdx = output->startIndex();
+        float* in = input->data<float>();
+        float* out = output->data<float>();
+        for (int n = 0; n < 3; n++) {
+            int i = 0;
+            for (int h = 0; h < 5; h++)
+                for (int w = 0; w < 7; w++)
+                    for (int c = 0; c < 9; c++)
+                        REQUIRE(out[outIdx(n, i++)] == in[inIdx(n, h, w, c)]);
+        }
+    }
+
+    SECTION("3D transpose") {
+        Tensor* input = createInput({ 2, 131, 45 }, DataLayout::NTC);
+        Tensor* output = runReorder(input, DataLayout::NCT);
+        auto inIdx = input->startIndex();
+        auto outIdx = output->startIndex();
+        float* in = input->data<float>();
+        float* out = output->data<float>();
+        for (int i = 0; i < 2; i++)
+            for (int j = 0; j < 131; j++)
+                for (int k = 0; k < 45; k++)
+                    REQUIRE(out[outIdx(i, k, j)] == in[inIdx(i, j, k)]);
+    }
+
+    threadPool = nullptr;
+    fastForwardMode = true;
+}
+
+TEST_CASE("Transposing fp32 and fp16 matrices", "[refop]") {
+    // Both dimensions are partly covered by the 8x8 and 16x16 tiles and the
+    // leading dimensions are padded, so the tiles and the ragged edges are
+    // all hit for both data types.
+    auto verifyTranspose = [](auto dtype, int rows, int cols) {
+        typedef decltype(dtype) DType;
+        int ldIn = cols + 3, ldOut = rows + 5;
+        std::vector<DType> in(rows * ldIn), out(cols * ldOut, 0);
+        for (int i = 0; i < (int)in.size(); i++)
+            in[i] = i;
+        transposeMatrix(in.data(), ldIn, out.data(), ldOut, rows, cols);
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                REQUIRE(out[j * ldOut + i] == in[i * ldIn + j]);
+    };
+
+    SECTION("fp32") {
+        verifyTranspose(float(), 8, 8);
+        verifyTranspose(float(), 37, 53);
+        verifyTranspose(float(), 131, 70);
+    }
+
+    SECTION("fp16") {
+        verifyTranspose(float16(), 16, 16);
+        verifyTranspose(float16(), 37, 53);
+        verifyTranspose(float16(), 131, 70);
+    }
+}
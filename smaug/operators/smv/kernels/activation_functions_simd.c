@@ -10,6 +10,7 @@ extern "C" {
  *
  * Top level function entry for all unary SMV activation functions.
  */
+HOST_SIMD_KERNEL
 void smv_activation_fun_nc_vec_fxp(float16* host_inputs,
                                    float16* host_results,
                                    float* inputs,
@@ -28,6 +29,7 @@ void smv_activation_fun_nc_vec_fxp(float16* host_inputs,
  *
  * Top level function for softmax.
  */
+HOST_SIMD_KERNEL
 void smv_softmax_nc_vec_fxp(float16* host_inputs,
                             float16* host_results,
                             float* inputs,
@@ -38,6 +38,7 @@ v8fp_t batch_norm_simd_op(v8fp_t input,
  *
  * In this case, we have one pair of gamma/beta weights per activation.
  */
+HOST_SIMD_KERNEL
 void smv_batch_norm_post_fc_nc_vec_fxp(float16* host_inputs,
                                        float16* host_weights,
                                        float16* host_results,
@@ -97,6 +98,7 @@ void smv_batch_norm_post_fc_nc_vec_fxp(float16* host_inputs,
  * After conv/pooling, we only have a gamma/beta per output feature map, not
  * per activation.
  */
+HOST_SIMD_KERNEL
 void smv_batch_norm_post_conv_nchw_vec_fxp(float16* host_inputs,
                                            float16* host_weights,
                                            float16* host_results,
@@ -193,6 +195,7 @@ void smv_batch_norm_post_conv_nchw_vec_fxp(float16* host_inputs,
  * After conv/pooling, we only have a gamma/beta per output feature map, not
  * per activation.
  */
+HOST_SIMD_KERNEL
 void smv_batch_norm_post_conv_nhwc_vec_fxp(float16* host_inputs,
                                            float16* host_weights,
                                            float16* host_results,
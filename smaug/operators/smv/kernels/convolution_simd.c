@@ -10,6 +10,117 @@
 extern "C" {
 #endif
 
+#ifdef HOST_MICROKERNELS
+
+// The host microkernel computes CONV_BLOCK_COLS output pixels of a row at a
+// time for all the kernels of a PE block, keeping all their partial sums in
+// vector registers, so that every kernel vector is used for all the pixels of
+// the block.
+#define CONV_BLOCK_COLS 2
+
+// Accumulates the products of num_cols pixels of activations with num_pes
+// kernels into the results of the pixels. This is inlined with constant sizes
+// for the full blocks, so the accumulators stay in registers.
+static inline __attribute__((always_inline)) void
+conv3d_block(v8fp_t kernel_reg[NUM_PE_INSTS][NUM_MACC_INSTS],
+             int num_pes,
+             int num_ch_grps,
+             v8fp_t* act[CONV_BLOCK_COLS],
+             v8fp_t* out[CONV_BLOCK_COLS],
+             int num_cols,
+             bool start_from_zero) {
+    const v8fp_t zero = (v8fp_t){ 0, 0, 0, 0, 0, 0, 0, 0 };
+    v8fp_t acc[CONV_BLOCK_COLS][NUM_PE_INSTS];
+    for (int c = 0; c < num_cols; c++) {
+        for (int pe_id = 0; pe_id < num_pes; pe_id++)
+            acc[c][pe_id] = zero;
+    }
+    for (int macc_idx = 0; macc_idx < num_ch_grps; macc_idx++) {
+        for (int c = 0; c < num_cols; c++) {
+            v8fp_t act_vec = act[c][macc_idx];
+            for (int pe_id = 0; pe_id < num_pes; pe_id++)
+                acc[c][pe_id] += kernel_reg[pe_id][macc_idx] * act_vec;
+        }
+    }
+    for (int c = 0; c < num_cols; c++) {
+        v8fp_t results_buffer = start_from_zero ? zero : *out[c];
+        for (int pe_id = 0; pe_id < num_pes; pe_id++) {
+            float sum = 0;
+            for (int vec_i = 0; vec_i < VECTOR_SIZE; vec_i++)
+                sum += acc[c][pe_id][vec_i];
+            results_buffer[pe_id] += sum;
+        }
+        *out[c] = results_buffer;
+    }
+}
+
+// Computes the same results as the conv3d_row/conv3d_col loop nest of
+// smv_conv3d_nhwc_vec_fxp without sampling, for one kernel row and column, one
+// block of input channels and one block of kernels. The input pixel of output
+// (0, 0) is (in_row_start, in_col_start), and the channel strides and offsets
+// are in vectors.
+HOST_SIMD_KERNEL
+static void conv3d_host_rows(float* inputs,
+                             float* results,
+                             v8fp_t kernel_reg[NUM_PE_INSTS][NUM_MACC_INSTS],
+                             int num_pes,
+                             int num_ch_grps,
+                             int a_rows,
+                             int a_cols,
+                             int a_chan_vecs,
+                             int ifmap_offset,
+                             int result_cols,
+                             int result_chan_vecs,
+                             int ofmap_offset,
+                             int end_row,
+                             int end_col,
+                             int row_stride,
+                             int col_stride,
+                             int in_row_start,
+                             int in_col_start,
+                             bool start_from_zero) {
+    v8fp_t padding[NUM_MACC_INSTS] = { { 0 } };
+    v8fp_t* _inputs = (v8fp_t*)inputs;
+    v8fp_t* _results = (v8fp_t*)results;
+    int out_i = 0;
+    for (int out_row = 0; out_row < end_row; out_row += row_stride) {
+        int in_row = in_row_start + out_row;
+        bool in_padding_row = in_row < 0 || in_row >= a_rows;
+        int out_j = 0;
+        for (int out_col = 0; out_col < end_col;
+             out_col += CONV_BLOCK_COLS * col_stride) {
+            int num_cols = min2(CONV_BLOCK_COLS,
+                                FRAC_CEIL(end_col - out_col, col_stride));
+            v8fp_t* act[CONV_BLOCK_COLS];
+            v8fp_t* out[CONV_BLOCK_COLS];
+            for (int c = 0; c < num_cols; c++) {
+                int in_col = in_col_start + out_col + c * col_stride;
+                bool is_padding =
+                        in_padding_row || in_col < 0 || in_col >= a_cols;
+                act[c] = is_padding ? padding
+                                    : _inputs +
+                                              (in_row * a_cols + in_col) *
+                                                      a_chan_vecs +
+                                              ifmap_offset;
+                out[c] = _results +
+                         (out_i * result_cols + out_j + c) * result_chan_vecs +
+                         ofmap_offset;
+            }
+            if (num_cols == CONV_BLOCK_COLS && num_pes == NUM_PE_INSTS) {
+                conv3d_block(kernel_reg, NUM_PE_INSTS, num_ch_grps, act, out,
+                             CONV_BLOCK_COLS, start_from_zero);
+            } else {
+                conv3d_block(kernel_reg, num_pes, num_ch_grps, act, out,
+                             num_cols, start_from_zero);
+            }
+            out_j += num_cols;
+        }
+        out_i++;
+    }
+}
+
+#endif
+
 /** \ingroup AladdinKernels
  *
  * Perform a 3D convolution with one kernel on an image, with reduction in NHWC
@@ -18,6 +129,8 @@ extern "C" {
  * @param host_inputs Host inputs buffer in NHWC.
  * @param host_weights Host weights buffer in NHWC.
  * @param host_results Host results buffer in NHWC.
+ * @param host_bias Host buffer of the per-channel bias of the results, or NULL
+ *        if the results have no bias.
  * @param inputs Local inputs buffer in NHWC.
  * @param weights Local weights buffer in NHWC.
  * @param results Local results buffer in NHWC.
@@ -50,9 +163,11 @@ extern "C" {
  * @param act_params Parameters for the activation function.
  * @param sampling Simulation samplng settings.
  */
+HOST_SIMD_KERNEL
 void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              float16* host_weights,
                              float16* host_results,
+                             float16* host_bias,
                              float* inputs,
                              float* weights,
                              float* results,
@@ -223,6 +338,19 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                         }
                     }
 
+#ifdef HOST_MICROKERNELS
+                    if (sampling->level < VeryHigh) {
+                        conv3d_host_rows(
+                                inputs, results, kernel_reg, kEffNumPeInsts,
+                                max_ch_grp, a_rows, a_cols,
+                                (a_height + a_pad) / VECTOR_SIZE, ifmap_offset,
+                                result_cols,
+                                (result_height + results_pad) / VECTOR_SIZE,
+                                ofmap_iters, end_row, end_col, row_stride,
+                                col_stride, kern_row - top_pad,
+                                kern_col - left_pad, start_from_zero);
+                    } else
+#endif
                     conv3d_row:
                     for (int out_row = 0; out_row < output_row_sample;
                          out_row += row_stride) {
@@ -310,6 +438,13 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
             }
         }
     }
+    // The bias goes in once the results are finished, before the activation
+    // function.
+    if (host_bias && send_results) {
+        host_add_bias_fp16(results, host_bias,
+                           results_dims[0] * result_rows * result_cols,
+                           result_height + results_pad, result_height);
+    }
     // Only run activation functions when the results are finished.
     if (act_function != NO_ACTIVATION && send_results) {
         activation_fun_vec(
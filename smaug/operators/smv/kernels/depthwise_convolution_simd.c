@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/kernels/params.h"
+#include "smaug/operators/smv/kernels/load_store_fp16_data.h"
+#include "smaug/operators/smv/kernels/activation_functions_simd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \ingroup AladdinKernels
+ *
+ * Perform a depthwise convolution on an image in NHWC format. Every channel of
+ * the inputs is convolved with its own 2D filter, so there is no reduction
+ * across channels: each vector lane accumulates one channel. This is the
+ * vectorized implementation.
+ *
+ * @param host_inputs Host inputs buffer in NHWC.
+ * @param host_weights Host weights buffer in NHWC.
+ * @param host_results Host results buffer in NHWC.
+ * @param inputs Local inputs buffer in NHWC.
+ * @param weights Local weights buffer in NHWC.
+ * @param results Local results buffer in NHWC.
+ * @param inputs_dims Dimensions of the inputs.
+ * @param weights_dims Dimensions of the weights. The first dimension is
+ *        always 1, and the channels are the same as those of the inputs.
+ * @param results_dims Dimensions of the results.
+ * @param inputs_align_pad Alignment padding size on the channel dimension of
+ *        the inputs.
+ * @param weights_pad Alignment padding size on the channel dimension of the
+ *        weights.
+ * @param results_pad Alignment padding size on the channel dimension of the
+ *        results.
+ * @param inputs_halo_pad Padding sizes on top, bottom, left and right of the
+ * input 2D feature maps.
+ * @param row_stride Stride size on the row dimension.
+ * @param col_stride Stride size on the col dimension.
+ * @param read_inputs Load inputs from the host. Set to false if the input
+ *        activations can be reused from the last invocation.
+ * @param read_weights Load weights from the host. Set to false if the weights
+ *        can be reused from the last invocation.
+ * @param act_function Activation function the operator runs.
+ * @param act_params Parameters for the activation function.
+ * @param sampling Simulation samplng settings.
+ */
+HOST_SIMD_KERNEL
+void smv_depthwise_conv_nhwc_vec_fxp(float16* host_inputs,
+                                     float16* host_weights,
+                                     float16* host_results,
+                                     float* inputs,
+                                     float* weights,
+                                     float* results,
+                                     int inputs_dims[4],
+                                     int weights_dims[4],
+                                     int results_dims[4],
+                                     int inputs_align_pad,
+                                     int weights_pad,
+                                     int results_pad,
+                                     int inputs_halo_pad[4],
+                                     int row_stride,
+                                     int col_stride,
+                                     bool read_inputs,
+                                     bool read_weights,
+                                     activation_type act_function,
+                                     activation_param_t act_params,
+                                     SamplingInfo* sampling) {
+    int result_nums = results_dims[0];
+    int result_rows = results_dims[1];
+    int result_cols = results_dims[2];
+    int result_height = results_dims[3];
+    int results_size = result_nums * result_rows * result_cols *
+                       (result_height + results_pad);
+
+    int k_rows = weights_dims[1];
+    int k_cols = weights_dims[2];
+    int k_height = weights_dims[3];
+    int k_pad = weights_pad;
+    int weights_size = k_rows * k_cols * (k_height + k_pad);
+
+    int a_rows = inputs_dims[1];
+    int a_cols = inputs_dims[2];
+    int a_height = inputs_dims[3];
+    int a_pad = inputs_align_pad;
+    int inputs_size = inputs_dims[0] * a_rows * a_cols * (a_height + a_pad);
+
+    int top_pad = inputs_halo_pad[0];
+    int bottom_pad = inputs_halo_pad[1];
+    int left_pad = inputs_halo_pad[2];
+    int right_pad = inputs_halo_pad[3];
+    int end_row = a_rows + top_pad + bottom_pad - k_rows + 1;
+    int end_col = a_cols + left_pad + right_pad - k_cols + 1;
+
+    int valid_row_end = a_rows - 1;
+    int valid_col_end = a_cols - 1;
+
+    const v8fp_t zero = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    // Kernels, inputs and results are all in NHWC.
+    VEC_ARRAY_3D(v8fp_t, _kernels, weights, k_cols, k_height + k_pad);
+    VEC_ARRAY_4D(v8fp_t, _a, inputs, a_rows, a_cols, a_height + a_pad);
+    VEC_ARRAY_4D(v8fp_t,
+                 _result,
+                 results,
+                 result_rows,
+                 result_cols,
+                 result_height + results_pad);
+    int num_chan_blocks = FRAC_CEIL(result_height, VECTOR_SIZE);
+
+    // Load inputs and weights if needed.
+    if (read_inputs)
+        host_load_fp16(inputs, host_inputs, inputs_size, 0, 0);
+    if (read_weights)
+        host_load_fp16(weights, host_weights, weights_size, 0, 0);
+
+    // Set up the sample sizes and factors.
+    int chan_block_sample = num_chan_blocks;
+    int kern_row_sample = k_rows;
+    int kern_col_sample = k_cols;
+    int output_row_sample = end_row;
+    int output_col_sample = end_col;
+    int output_row_total_iters = FRAC_CEIL(end_row, row_stride);
+    int output_col_total_iters = FRAC_CEIL(end_col, col_stride);
+    int output_row_sample_iters = output_row_total_iters;
+    int output_col_sample_iters = output_col_total_iters;
+    int sample_num = sampling->num_sample_iterations;
+    if (sampling->level >= Low)
+        chan_block_sample = min2(chan_block_sample, sample_num);
+    if (sampling->level >= Medium) {
+        kern_row_sample = min2(kern_row_sample, sample_num);
+        kern_col_sample = min2(kern_col_sample, sample_num);
+    }
+    if (sampling->level >= VeryHigh) {
+        output_row_sample_iters = min2(output_row_sample_iters, sample_num);
+        output_row_sample = output_row_sample_iters * row_stride;
+        // Pipelined loops need at minimum 2 sampled iterations.
+        output_col_sample_iters =
+                min2(output_col_sample_iters, max2(2, sample_num));
+        output_col_sample = output_col_sample_iters * col_stride;
+    }
+    setSamplingFactor("dw_chan_block",
+                      num_chan_blocks * 1.0 / chan_block_sample);
+    setSamplingFactor("dw_k_row", k_rows * 1.0 / kern_row_sample);
+    setSamplingFactor("dw_k_col", k_cols * 1.0 / kern_col_sample);
+    setSamplingFactor("dw_conv2d_row",
+                      output_row_total_iters * 1.0 / output_row_sample_iters);
+    setSamplingFactor("dw_conv2d_col",
+                      output_col_total_iters * 1.0 / output_col_sample_iters);
+
+    dw_img:
+    for (int img = 0; img < result_nums; img++) {
+        dw_chan_block:
+        for (int chan_grp = 0; chan_grp < chan_block_sample; chan_grp++) {
+            int out_i = 0;  // The result row.
+            dw_conv2d_row:
+            for (int out_row = 0; out_row < output_row_sample;
+                 out_row += row_stride) {
+                int out_j = 0;  // The result col.
+                dw_conv2d_col:
+                for (int out_col = 0; out_col < output_col_sample;
+                     out_col += col_stride) {
+                    // One vector of partial sums holds eight channels.
+                    v8fp_t results_buffer = zero;
+                    dw_k_row:
+                    for (int kern_row = 0; kern_row < kern_row_sample;
+                         kern_row++) {
+                        int in_row = out_row - top_pad + kern_row;
+                        bool in_padding_row =
+                                in_row < 0 || in_row > valid_row_end;
+                        dw_k_col:
+                        for (int kern_col = 0; kern_col < kern_col_sample;
+                             kern_col++) {
+                            int in_col = out_col - left_pad + kern_col;
+                            bool in_padding_col =
+                                    in_col < 0 || in_col > valid_col_end;
+                            v8fp_t act_reg =
+                                    (in_padding_row || in_padding_col)
+                                            ? zero
+                                            : _a[img][in_row][in_col][chan_grp];
+                            results_buffer +=
+                                    act_reg *
+                                    _kernels[kern_row][kern_col][chan_grp];
+                        }
+                    }
+                    _result[img][out_i][out_j][chan_grp] = results_buffer;
+                    out_j++;
+                }
+                out_i++;
+            }
+        }
+    }
+    // Every channel is finished after a single invocation, so the activation
+    // function always runs.
+    if (act_function != NO_ACTIVATION) {
+        activation_fun_vec(
+                results, results, results_size, act_function, act_params);
+    }
+    host_store_fp16(results, host_results, results_size, 0, 0);
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -1,6 +1,7 @@
 #include "smaug/operators/common.h"
 #include "smaug/operators/smv/kernels/params.h"
 #include "smaug/operators/smv/kernels/load_store_fp16_data.h"
+#include "smaug/operators/smv/kernels/activation_functions_simd.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,13 +11,16 @@ extern "C" {
  *
  * SMV implementation of elementwise addition.
  */
+HOST_SIMD_KERNEL
 void smv_eltwise_add_nc_vec_fxp(float16* host_inputs0,
                                 float16* host_inputs1,
                                 float16* host_results,
                                 float* inputs0,
                                 float* inputs1,
                                 float* results,
-                                int inputs_size) {
+                                int inputs_size,
+                                activation_type act_function,
+                                activation_param_t act_params) {
     // Load inputs.
     host_load_fp16(inputs0, host_inputs0, inputs_size, 0, 0);
     host_load_fp16(inputs1, host_inputs1, inputs_size, 0, 0);
@@ -29,6 +33,10 @@ void smv_eltwise_add_nc_vec_fxp(float16* host_inputs0,
     for (int i = 0; i < inputs_size / VECTOR_SIZE; i++) {
         _results[i] = _inputs0[i] + _inputs1[i];
     }
+    if (act_function != NO_ACTIVATION) {
+        activation_fun_vec(
+                results, results, inputs_size, act_function, act_params);
+    }
 
     // Store results to the host memory.
     host_store_fp16(results, host_results, inputs_size, 0, 0);
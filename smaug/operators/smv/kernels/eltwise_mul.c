@@ -10,6 +10,7 @@ extern "C" {
  *
  * SMV implementation of elementwise multiplication.
  */
+HOST_SIMD_KERNEL
 void smv_eltwise_mul_nc_vec_fxp(float16* host_inputs0,
                                 float16* host_inputs1,
                                 float16* host_results,
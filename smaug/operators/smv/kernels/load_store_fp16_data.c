@@ -4,6 +4,49 @@
 extern "C" {
 #endif
 
+#ifdef SMAUG_NATIVE_SIMD
+
+// In the host-native build, the conversions use the F16C instructions if the
+// host CPU has them, instead of converting one element at a time in software.
+
+static int host_has_f16c;
+
+// The CPU features are checked once when the program is loaded, not on every
+// transferred page.
+__attribute__((constructor))
+static void detect_host_f16c() {
+    __builtin_cpu_init();
+    host_has_f16c =
+            __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+}
+
+// Both buffers are the same memory, so the conversions go through the
+// unaligned load/store intrinsics, which may alias any type. Loads are
+// converted in place from the back, like the loop in host_load_fp16.
+__attribute__((target("avx,f16c")))
+static void host_fp16_to_fp32_f16c(float* fp32_data,
+                                   float16* fp16_data,
+                                   int num_vectors) {
+    for (int v = num_vectors - 1; v >= 0; v--) {
+        __m128i fp16x8 = _mm_loadu_si128(
+                (const __m128i*)(fp16_data + v * VECTOR_SIZE));
+        _mm256_storeu_ps(fp32_data + v * VECTOR_SIZE, _mm256_cvtph_ps(fp16x8));
+    }
+}
+
+__attribute__((target("avx,f16c")))
+static void host_fp32_to_fp16_f16c(float* fp32_data,
+                                   float16* fp16_data,
+                                   int num_vectors) {
+    for (int v = 0; v < num_vectors; v++) {
+        __m256 fp32x8 = _mm256_loadu_ps(fp32_data + v * VECTOR_SIZE);
+        _mm_storeu_si128((__m128i*)(fp16_data + v * VECTOR_SIZE),
+                         _mm256_cvtps_ph(fp32x8, 0));
+    }
+}
+
+#endif
+
 void host_load_fp16(float* local_data,
                     float16* remote_data,
                     int num_elems,
@@ -32,6 +75,12 @@ void host_load_fp16(float* local_data,
         int num_vectors =
                 FRAC_CEIL(transfer_size * 2, VECTOR_SIZE * sizeof(float));
         int page_offset_vec = (local_offset + curr_offset) / VECTOR_SIZE;
+#ifdef SMAUG_NATIVE_SIMD
+        if (host_has_f16c) {
+            float* page = local_data + page_offset_vec * VECTOR_SIZE;
+            host_fp16_to_fp32_f16c(page, (float16*)page, num_vectors);
+        } else
+#endif
         vector_fp16_to_fp32:
         for (int v = num_vectors - 1; v >= 0; v--) {
             v8ph_t fp16_data = _local_data_hp[page_offset_vec * 2 + v];
@@ -65,6 +114,12 @@ void host_store_fp16(float* local_data,
         int num_vectors =
                 FRAC_CEIL(eff_transfer_size, VECTOR_SIZE * sizeof(float));
         int page_offset_vec = (local_offset + curr_offset) / VECTOR_SIZE;
+#ifdef SMAUG_NATIVE_SIMD
+        if (host_has_f16c) {
+            float* page = local_data + page_offset_vec * VECTOR_SIZE;
+            host_fp32_to_fp16_f16c(page, (float16*)page, num_vectors);
+        } else
+#endif
         vector_fp32_to_fp16:
         for (int v = 0; v < num_vectors; v++){
             v8fp_t fp32_data = _local_data_sp[page_offset_vec + v];
@@ -80,6 +135,24 @@ void host_store_fp16(float* local_data,
     }
 }
 
+void host_add_bias_fp16(float* local_data,
+                        float16* host_bias,
+                        int num_rows,
+                        int row_size,
+                        int num_channels) {
+    VEC_ARRAY_2D(v8fp_t, _local_data, local_data, row_size);
+    int num_vectors = FRAC_CEIL(num_channels, VECTOR_SIZE);
+    bias_chan:
+    for (int v = 0; v < num_vectors; v++) {
+        v8ph_t bias_fp16;
+        hostLoad(&bias_fp16, host_bias + v * VECTOR_SIZE, sizeof(v8ph_t));
+        v8fp_t bias = _CVT_PH_PS_256(bias_fp16);
+        bias_row:
+        for (int r = 0; r < num_rows; r++)
+            _local_data[r][v] += bias;
+    }
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
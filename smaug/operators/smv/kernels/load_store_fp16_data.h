@@ -61,6 +61,30 @@ void host_store_fp16(float* local_data,
                      int local_offset,
                      int remote_offset);
 
+/** \ingroup AladdinKernels
+ *
+ * Adds a per-channel bias, stored as half-precision data on the host, to every
+ * row of a single-precision local buffer.
+ *
+ * The bias is read from the host one vector at a time and broadcast to all
+ * the rows, so it needs no scratchpad space of its own. This is used to apply
+ * a batch norm that has been folded into the weights of an operator.
+ *
+ * @param local_data Single-precision accelerator-local scratchpad.
+ * @param host_bias Half-precision host memory address of the bias, aligned
+ *        to the first channel of the rows. It must be padded with zeros to a
+ *        multiple of VECTOR_SIZE channels.
+ * @param num_rows Number of rows in local_data.
+ * @param row_size Number of elements per row in local_data, including the
+ *        alignment padding.
+ * @param num_channels Number of channels in each row to add the bias to.
+ */
+void host_add_bias_fp16(float* local_data,
+                        float16* host_bias,
+                        int num_rows,
+                        int row_size,
+                        int num_channels);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -1,4 +1,8 @@
+#include <cmath>
+#include <cstring>
+
 #include "catch.hpp"
+#include "fp16.h"
 #include "smaug/core/smaug_test.h"
 #include "smaug/operators/smv/kernels/load_store_fp16_data.h"
 
@@ -40,14 +44,55 @@ void doFp16StoreTest(int numElems) {
     verifyFp16Data(fp16Data);
 }
 
+uint32_t fp32Bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+void doFp16LoadBitsTest() {
+    // Every float16 value is converted exactly, including subnormals and
+    // infinities.
+    const int numElems = 65536;
+    std::vector<float16> fp16Data(numElems);
+    std::vector<float> fp32Data(numElems);
+    for (int i = 0; i < numElems; i++)
+        fp16Data[i] = i;
+    host_load_fp16(fp32Data.data(), fp16Data.data(), numElems, 0, 0);
+    for (int i = 0; i < numElems; i++) {
+        float expected = fp16_ieee_to_fp32_value(i);
+        if (std::isnan(expected))
+            REQUIRE(std::isnan(fp32Data[i]));
+        else
+            REQUIRE(fp32Bits(fp32Data[i]) == fp32Bits(expected));
+    }
+}
+
+void doFp16StoreBitsTest() {
+    // Values are rounded to the nearest float16, with ties to even.
+    std::vector<float> values = { 0.0f, -0.0f, 1.0f, 65504.0f, 65520.0f,
+                                  1e-8f, -3e-5f, 6.1e-5f, 1e9f, -1e9f,
+                                  1.0f + 1.0f / 2048, 1.0f + 3.0f / 2048,
+                                  INFINITY, -INFINITY };
+    for (int i = 0; values.size() < 4800; i++)
+        values.push_back(std::sin(i) * std::pow(2.0f, i % 40 - 20));
+    std::vector<float> fp32Data(values);
+    std::vector<float16> fp16Data(values.size());
+    host_store_fp16(fp32Data.data(), fp16Data.data(), values.size(), 0, 0);
+    for (int i = 0; i < values.size(); i++)
+        REQUIRE(fp16Data[i] == fp16_ieee_from_fp32_value(values[i]));
+}
+
 TEST_CASE_METHOD(SmaugTest, "float16 to float32 convert/load", "[smvfp16]") {
     SECTION("Transfer size smaller than 4K page") { doFp16LoadTest(192); }
     SECTION("Transfer size 4K page") { doFp16LoadTest(2048); }
     SECTION("Transfer size larger than 4K page") { doFp16LoadTest(4800); }
+    SECTION("Conversions are exact") { doFp16LoadBitsTest(); }
 }
 
 TEST_CASE_METHOD(SmaugTest, "float32 to float16 convert/store", "[smvfp16]") {
     SECTION("Transfer size smaller than 4K page") { doFp16StoreTest(192); }
     SECTION("Transfer size 4K page") { doFp16StoreTest(2048); }
     SECTION("Transfer size larger than 4K page") { doFp16StoreTest(4800); }
+    SECTION("Conversions round to nearest even") { doFp16StoreBitsTest(); }
 }
@@ -0,0 +1,245 @@
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/kernels/params.h"
+#include "smaug/operators/smv/kernels/load_store_fp16_data.h"
+#include "smaug/operators/smv/kernels/activation_functions_simd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Copies the outputs to the staging buffer they are sent to the host from.
+// host_store_fp16 converts its local data to fp16 in place, which would
+// destroy the outputs that the next timestep reads.
+ALWAYS_INLINE
+static inline void stage_lstm_outputs(v8fp_t* outputs,
+                                      v8fp_t* staging,
+                                      int size) {
+    stage_outputs:
+    for (int i = 0; i < size / VECTOR_SIZE; i++) {
+        staging[i] = outputs[i];
+    }
+}
+
+/** \ingroup AladdinKernels
+ *
+ * SMV implementation of one timestep of an LSTM cell, fused into a single
+ * kernel.
+ *
+ * The local buffers are laid out as follows:
+ *
+ * inputs:  [batch][units]  h_{t-1}, followed by
+ *          [batch][depth]  x_t.
+ * weights: [weights_rows][depth + units]  A neuron-wise tile of the packed
+ *          [W | U] kernels, whose rows are the units of the input, forget,
+ *          cell and output gates, with every gate padded to `units` rows.
+ * results: [batch][4 * units]  The gate pre-activations, followed by
+ *          [batch][units]      the cell state, and
+ *          [batch][units]      a staging buffer for the outputs.
+ *
+ * The gates are computed with the same 8-PE, 32-way MACC datapath as
+ * smv_matrix_multiply_transpose_nc_vec_fxp. They never leave the scratchpad:
+ * once the last weight tile has been multiplied, the activation functions are
+ * applied in place, the cell state is updated in place and the new outputs
+ * replace h_{t-1}. The outputs and the cell state therefore stay resident
+ * across invocations, and so do the weights if all of them fit in one tile.
+ *
+ * @param host_inputs Host buffer for x_t.
+ * @param host_weights Host buffer for the weight tile.
+ * @param host_initial_outputs Host buffer for h_0.
+ * @param host_initial_state Host buffer for c_0.
+ * @param host_sequence Host buffer for h_t in the output sequence.
+ * @param host_outputs Host buffer for the final outputs.
+ * @param host_state Host buffer for the final cell state.
+ * @param inputs Local buffer for h_{t-1} and x_t.
+ * @param weights Local buffer for the weights.
+ * @param results Local buffer for the gates, the cell state and the staged
+ *        outputs.
+ * @param batch Number of batches.
+ * @param depth Aligned depth of x_t.
+ * @param units Aligned number of units.
+ * @param weights_rows Number of rows in the weight tile, a multiple of
+ *        NUM_PE_INSTS.
+ * @param initial_strides Distances in elements between the batches of
+ *        host_initial_outputs and host_initial_state. Zero broadcasts them to
+ *        all the batches.
+ * @param gate_start The first gate computed by this weight tile.
+ * @param init_state Load the initial outputs and cell state.
+ * @param read_inputs Load x_t. Set to false for non-first weight tiles of a
+ *        timestep.
+ * @param read_weights Load the weight tile. Set to false if the weights are
+ *        still in the scratchpad from the last invocation.
+ * @param finish_cell Apply the activation functions and update the state.
+ *        Set to true for the last weight tile of a timestep.
+ * @param send_sequence Send h_t to host_sequence.
+ * @param send_outputs Send the final outputs and cell state to the host.
+ * @param act_function Activation function of the cell input and state.
+ * @param act_params Parameters for the activation function.
+ */
+HOST_SIMD_KERNEL
+void smv_lstm_cell_nc_vec_fxp(float16* host_inputs,
+                              float16* host_weights,
+                              float16* host_initial_outputs,
+                              float16* host_initial_state,
+                              float16* host_sequence,
+                              float16* host_outputs,
+                              float16* host_state,
+                              float* inputs,
+                              float* weights,
+                              float* results,
+                              int batch,
+                              int depth,
+                              int units,
+                              int weights_rows,
+                              int initial_strides[2],
+                              int gate_start,
+                              bool init_state,
+                              bool read_inputs,
+                              bool read_weights,
+                              bool finish_cell,
+                              bool send_sequence,
+                              bool send_outputs,
+                              activation_type act_function,
+                              activation_param_t act_params) {
+    int width = depth + units;
+    int depth_vec = depth / VECTOR_SIZE;
+    int width_vec = width / VECTOR_SIZE;
+    int units_vec = units / VECTOR_SIZE;
+    int gates_width = 4 * units;
+    int x_start = batch * units;
+    int state_start = batch * gates_width;
+    int staging_start = state_start + batch * units;
+    ASSERT(depth % VECTOR_SIZE == 0 && units % VECTOR_SIZE == 0 &&
+           "The depth and units must be multiples of VECTOR_SIZE!");
+    ASSERT(weights_rows % NUM_PE_INSTS == 0 &&
+           "The weight rows must be a multiple of NUM_PE_INSTS!");
+
+    // Load the initial state, x_t and the weights if needed. The rows of the
+    // initial state are loaded in order, as a load may overrun into the next
+    // row by up to a cacheline.
+    if (init_state) {
+        load_state:
+        for (int n = 0; n < batch; n++) {
+            host_load_fp16(inputs, host_initial_outputs, units, n * units,
+                           n * initial_strides[0]);
+            host_load_fp16(results, host_initial_state, units,
+                           state_start + n * units, n * initial_strides[1]);
+        }
+    }
+    if (read_inputs)
+        host_load_fp16(inputs, host_inputs, batch * depth, x_start, 0);
+    if (read_weights)
+        host_load_fp16(weights, host_weights, weights_rows * width, 0, 0);
+
+    v8fp_t zero = (v8fp_t){ 0, 0, 0, 0, 0, 0, 0, 0 };
+    float* x = inputs + x_start;
+    float* state = results + state_start;
+    float* staging = results + staging_start;
+    VEC_ARRAY_2D(v8fp_t, _outputs, inputs, units);
+    VEC_ARRAY_2D(v8fp_t, _x, x, depth);
+    VEC_ARRAY_2D(v8fp_t, _weights, weights, width);
+    VEC_ARRAY_2D(v8fp_t, _gates, results, gates_width);
+    VEC_ARRAY_2D(v8fp_t, _state, state, units);
+
+    gate_batch:
+    for (int n = 0; n < batch; n++) {
+        gate_row:
+        for (int row = 0; row < weights_rows; row += NUM_PE_INSTS) {
+            // As in the matrix multiply kernel, partial sums are kept in a
+            // scalar array to work around an Aladdin dependence analysis bug
+            // on vector InsertElement operations.
+            float partial_sums[NUM_PE_INSTS] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+            gate_col:
+            for (int col = 0; col < width_vec; col += NUM_MACC_INSTS) {
+                // The columns of the weights are x_t followed by h_{t-1}.
+                v8fp_t a_reg[NUM_MACC_INSTS];
+                a_reg_load:
+                for (int a_vec = 0; a_vec < NUM_MACC_INSTS; a_vec++) {
+                    int a_col = col + a_vec;
+                    a_reg[a_vec] = a_col < depth_vec
+                                           ? _x[n][a_col]
+                                           : a_col < width_vec
+                                                     ? _outputs[n][a_col -
+                                                                   depth_vec]
+                                                     : zero;
+                }
+
+                pe_insts:
+                for (int pe_id = 0; pe_id < NUM_PE_INSTS; pe_id++) {
+                    v8fp_t accum_vec_reg = zero;
+                    core_macc:
+                    for (int macc_idx = 0; macc_idx < NUM_MACC_INSTS;
+                         macc_idx++) {
+                        int b_col = col + macc_idx;
+                        v8fp_t b_reg = b_col >= width_vec
+                                               ? zero
+                                               : _weights[row + pe_id][b_col];
+                        accum_vec_reg += a_reg[macc_idx] * b_reg;
+                    }
+
+                    float accum_reg = 0;
+                    reduce:
+                    for (int vec_i = 0; vec_i < VECTOR_SIZE; vec_i++) {
+                        accum_reg += accum_vec_reg[vec_i];
+                    }
+                    partial_sums[pe_id] += accum_reg;
+                }
+            }
+
+            v8fp_t gates_reg;
+            copy_psums:
+            for (int i = 0; i < NUM_PE_INSTS; i++) {
+                gates_reg[i] = partial_sums[i];
+            }
+            _gates[n][(gate_start + row) / VECTOR_SIZE] = gates_reg;
+        }
+    }
+
+    if (finish_cell) {
+        cell_batch:
+        for (int n = 0; n < batch; n++) {
+            float* gates = results + n * gates_width;
+            // The input and forget gates are contiguous.
+            activation_fun_vec(gates, gates, 2 * units, SIGMOID, act_params);
+            activation_fun_vec(gates + 2 * units, gates + 2 * units, units,
+                               act_function, act_params);
+            activation_fun_vec(gates + 3 * units, gates + 3 * units, units,
+                               SIGMOID, act_params);
+
+            cell_state:
+            for (int i = 0; i < units_vec; i++) {
+                v8fp_t input_gate = _gates[n][i];
+                v8fp_t forget_gate = _gates[n][units_vec + i];
+                v8fp_t cell_input = _gates[n][2 * units_vec + i];
+                _state[n][i] =
+                        forget_gate * _state[n][i] + input_gate * cell_input;
+                _outputs[n][i] = _state[n][i];
+            }
+            activation_fun_vec(inputs + n * units, inputs + n * units, units,
+                               act_function, act_params);
+            cell_outputs:
+            for (int i = 0; i < units_vec; i++) {
+                _outputs[n][i] *= _gates[n][3 * units_vec + i];
+            }
+        }
+    }
+
+    // Store the results to the host memory if needed.
+    VEC_ARRAY_1D(v8fp_t, _all_outputs, inputs);
+    VEC_ARRAY_1D(v8fp_t, _staging, staging);
+    if (send_sequence) {
+        stage_lstm_outputs(_all_outputs, _staging, batch * units);
+        host_store_fp16(results, host_sequence, batch * units, staging_start,
+                        0);
+    }
+    if (send_outputs) {
+        stage_lstm_outputs(_all_outputs, _staging, batch * units);
+        host_store_fp16(results, host_outputs, batch * units, staging_start,
+                        0);
+        host_store_fp16(results, host_state, batch * units, state_start, 0);
+    }
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -10,6 +10,105 @@
 extern "C" {
 #endif
 
+#ifdef HOST_MICROKERNELS
+
+// The host microkernel multiplies a block of MM_BLOCK_A rows of a with
+// MM_BLOCK_B rows of b at a time, keeping all the partial sums of the block in
+// vector registers, so that every vector read from a or b is used more than
+// once.
+#define MM_BLOCK_A 2
+#define MM_BLOCK_B 4
+
+// Computes the dot products of num_a rows of a with num_b rows of b over
+// k_vecs vectors. This is inlined with constant block sizes for the full
+// blocks, so the accumulators stay in registers.
+static inline __attribute__((always_inline)) void
+matrix_multiply_block(v8fp_t* a_rows[MM_BLOCK_A],
+                      int num_a,
+                      v8fp_t* b_rows[MM_BLOCK_B],
+                      int num_b,
+                      int k_vecs,
+                      float sums[MM_BLOCK_A][MM_BLOCK_B]) {
+    const v8fp_t zero = (v8fp_t){ 0, 0, 0, 0, 0, 0, 0, 0 };
+    v8fp_t acc[MM_BLOCK_A][MM_BLOCK_B];
+    for (int i = 0; i < num_a; i++) {
+        for (int j = 0; j < num_b; j++)
+            acc[i][j] = zero;
+    }
+    for (int k = 0; k < k_vecs; k++) {
+        for (int i = 0; i < num_a; i++) {
+            v8fp_t a_vec = a_rows[i][k];
+            for (int j = 0; j < num_b; j++)
+                acc[i][j] += a_vec * b_rows[j][k];
+        }
+    }
+    for (int i = 0; i < num_a; i++) {
+        for (int j = 0; j < num_b; j++) {
+            float sum = 0;
+            for (int v = 0; v < VECTOR_SIZE; v++)
+                sum += acc[i][j][v];
+            sums[i][j] = sum;
+        }
+    }
+}
+
+// Computes the same results as the a_act/b_row/b_col loop nest of
+// smv_matrix_multiply_transpose_nc_vec_fxp without sampling. The rows of a
+// start from vector a_vec_start, and the strides are in elements.
+HOST_SIMD_KERNEL
+static void matrix_multiply_transpose_host(float* a,
+                                           float* b,
+                                           float* results,
+                                           int a_height,
+                                           int a_stride,
+                                           int a_vec_start,
+                                           int b_height,
+                                           int b_stride,
+                                           int k_vecs,
+                                           int results_stride,
+                                           int result_start,
+                                           bool accumulate) {
+    // The kernel writes whole vectors of results, so the neurons past the
+    // last row of b in the last vector are reset too.
+    int results_end = next_multiple(b_height, VECTOR_SIZE);
+    for (int i = 0; i < a_height; i += MM_BLOCK_A) {
+        int num_a = min2(MM_BLOCK_A, a_height - i);
+        v8fp_t* a_rows[MM_BLOCK_A];
+        for (int ii = 0; ii < num_a; ii++)
+            a_rows[ii] = (v8fp_t*)(a + (i + ii) * a_stride) + a_vec_start;
+        for (int j = 0; j < b_height; j += MM_BLOCK_B) {
+            int num_b = min2(MM_BLOCK_B, b_height - j);
+            v8fp_t* b_rows[MM_BLOCK_B];
+            for (int jj = 0; jj < num_b; jj++)
+                b_rows[jj] = (v8fp_t*)(b + (j + jj) * b_stride);
+            float sums[MM_BLOCK_A][MM_BLOCK_B];
+            if (num_a == MM_BLOCK_A && num_b == MM_BLOCK_B) {
+                matrix_multiply_block(
+                        a_rows, MM_BLOCK_A, b_rows, MM_BLOCK_B, k_vecs, sums);
+            } else {
+                matrix_multiply_block(
+                        a_rows, num_a, b_rows, num_b, k_vecs, sums);
+            }
+            for (int ii = 0; ii < num_a; ii++) {
+                float* row =
+                        results + (i + ii) * results_stride + result_start;
+                for (int jj = 0; jj < num_b; jj++)
+                    row[j + jj] = (accumulate ? row[j + jj] : 0) + sums[ii][jj];
+            }
+        }
+        if (!accumulate) {
+            for (int ii = 0; ii < num_a; ii++) {
+                float* row =
+                        results + (i + ii) * results_stride + result_start;
+                for (int j = b_height; j < results_end; j++)
+                    row[j] = 0;
+            }
+        }
+    }
+}
+
+#endif
+
 /** \ingroup AladdinKernels
  *
  * Matrix b after transposition:
@@ -26,12 +125,14 @@ extern "C" {
  *  assigned a row in in the transposed matrix. It continues across each row of
  *  b until the complete output pixel is finished (output stationary).
  *
- *  No biases are added.
+ *  A bias is added to the finished results only if host_bias is given.
  *
  * Args:
  * @param host_a Host buffer for a in NC.
  * @param host_b Host buffer for b in NC.
  * @param host_results Host results buffer in NC.
+ * @param host_bias Host buffer of the per-neuron bias of the results, or NULL
+ *        if the results have no bias.
  * @param a Local buffer for a in NC.
  * @param b Local buffer for b in NC.
  * @param results Local results buffer in NC.
@@ -56,9 +157,11 @@ extern "C" {
  * @param act_params Parameters for the activation function.
  * @param sampling Simulation samplng settings.
  */
+HOST_SIMD_KERNEL
 void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               float16* host_b,
                                               float16* host_results,
+                                              float16* host_bias,
                                               float* a,
                                               float* b,
                                               float* results,
@@ -113,6 +216,18 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
     }
     setSamplingFactor("b_col", b_col_total_iters * 1.0 / b_col_sample_iters);
 
+#ifdef HOST_MICROKERNELS
+    if (sampling->level < VeryHigh) {
+        // The activations of a past its end are zeros.
+        int k_vecs = max2(0, min2(b_width_vec,
+                                  a_width_vec - a_start / VECTOR_SIZE));
+        matrix_multiply_transpose_host(a, b, results, a_height, a_width + a_pad,
+                                       a_start / VECTOR_SIZE, b_height,
+                                       b_width + b_pad, k_vecs,
+                                       results_width + results_pad,
+                                       result_start, accumulate);
+    } else
+#endif
     a_act:
     for (int a_act = 0; a_act < a_height; a_act++) {
         b_row:
@@ -196,6 +311,12 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
             }
         }
     }
+    // The bias goes in once the results are finished, before the activation
+    // function.
+    if (host_bias && send_results) {
+        host_add_bias_fp16(results, host_bias, results_height,
+                           results_width + results_pad, results_width);
+    }
     // Only run activation functions when the results are finished.
     if (act_function != NO_ACTIVATION && send_results) {
         activation_fun_vec(
@@ -33,6 +33,7 @@ extern "C" {
  *        start from this one. Otherwise this should always be zero.
  * @param sampling Simulation samplng settings.
  */
+HOST_SIMD_KERNEL
 void smv_maxpooling_nhwc_vec_fxp(float16* host_inputs,
                                  float16* host_results,
                                  float* inputs,
@@ -163,6 +164,7 @@ void smv_maxpooling_nhwc_vec_fxp(float16* host_inputs,
  *        start from this one. Otherwise this should always be zero.
  * @param sampling Simulation samplng settings.
  */
+HOST_SIMD_KERNEL
 void smv_avgpooling_nhwc_vec_fxp(float16* host_inputs,
                                  float16* host_results,
                                  float* inputs,
@@ -17,6 +17,10 @@ void SmvAcceleratorPool::addFinishFlag(
 }
 
 void SmvAcceleratorPool::join(int accelIdx) {
+    if (useNativeAccelerators()) {
+        waitForNativeAccelerator(accelIdx);
+        return;
+    }
     if (finishFlags[accelIdx].empty())
         return;
 
@@ -28,6 +28,11 @@ namespace smaug {
  * }
  * pool.joinAll();
  * ```
+ *
+ * In native execution with more than one accelerator, every accelerator of the
+ * pool is backed by a host thread with its own scratchpads (see
+ * smv::accelSpads), and joining an accelerator waits on the futures of all the
+ * kernel invocations sent to it.
  */
 class SmvAcceleratorPool {
    public:
@@ -0,0 +1,185 @@
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_tiling.h"
+#include "smaug/operators/smv/smv_kernels.h"
+#include "smaug/operators/smv/smv_accel_pool.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+void SmvBatchMatMulOp::packB() {
+    Tensor* b = getInput(InputB);
+    int batch = getBatchSize();
+    int rows = getNumCols();
+    int depth = getReductionSize();
+    int bRows = b->getShape()[1];
+    int bStride = b->getShape().getStorageDim(2);
+    int width = packedB->getShape().getStorageDim(2);
+    const float16* src = b->data<float16>();
+    float16* packed = packedB->data<float16>();
+    // The padding of the rows is zero, so it doesn't contribute to the
+    // results, whatever the padding of A holds.
+    std::fill(packed, packed + packedB->getShape().storageSize(), 0);
+    for (int n = 0; n < batch; n++) {
+        const float16* srcMatrix = src + n * bRows * bStride;
+        float16* packedMatrix = packed + n * rows * width;
+        if (transposeB) {
+            for (int i = 0; i < rows; i++) {
+                std::copy(srcMatrix + i * bStride,
+                          srcMatrix + i * bStride + depth,
+                          packedMatrix + i * width);
+            }
+        } else {
+            for (int k = 0; k < depth; k++) {
+                for (int i = 0; i < rows; i++)
+                    packedMatrix[i * width + k] = srcMatrix[k * bStride + i];
+            }
+        }
+    }
+}
+
+// This function iterates the tiles of all the batches, and sends every output
+// tile to a single accelerator. The tile iteration is in the following order:
+// 1) N: batches.
+// 2) R: row-wise tiles of A and the outputs.
+// 3) C: column-wise tiles of the outputs, or row-wise tiles of B^T.
+void SmvBatchMatMulOp::runNRC(SmvTilePipeline& pipeline) {
+    TiledTensor& inputs = tiledTensors[InputTiles];
+    TiledTensor& weights = tiledTensors[WeightTiles];
+    TiledTensor& outputs = tiledTensors[OutputTiles];
+    int batch = getBatchSize();
+    int numRowTiles = inputs.getShape()[1];
+    int numColTiles = weights.getShape()[1];
+    auto inputIdx = inputs.startIndex();
+    auto weightIdx = weights.startIndex();
+    auto outputIdx = outputs.startIndex();
+    for (int i = 0; i < numAcceleratorsAvailable; i++) {
+        setArrayMemTypeIfSimulating(
+                smv::kInnerProductHw + i, "host_a", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kInnerProductHw + i, "host_b", getWeightsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kInnerProductHw + i, "host_results", getOutputsMemType());
+    }
+    SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
+    activation_param_t actParams = {};
+    int currAccelIdx = 0;
+    for (int N = 0; N < batch; N++) {
+        for (int R = 0; R < numRowTiles; R++) {
+            unsigned accel = smv::kInnerProductHw + currAccelIdx;
+            Tensor* inputTile =
+                    pipeline.getTileWithData(inputs, inputIdx(N, R, 0));
+            Tensor* outputTile = outputs[outputIdx(N, R, 0)];
+            const TensorShape& inputShape = inputTile->getShape();
+            const TensorShape& outputShape = outputTile->getShape();
+            mapArrayToAccel(accel, "host_a", inputTile->data<float16>(),
+                            inputShape.storageSize() * sizeof(float16));
+            mapArrayToAccel(accel, "host_results", outputTile->data<float16>(),
+                            outputShape.storageSize() * sizeof(float16));
+            int inputDims[2] = { inputShape[1], inputShape[2] };
+            int outputDims[2] = { outputShape[1], outputShape[2] };
+            // The column-wise tiles write their results to different offsets
+            // of the same output tile, which is only sent back to the host
+            // after the last one, so they run on the same accelerator.
+            int finishedCols = 0;
+            for (int C = 0; C < numColTiles; C++) {
+                Tensor* weightsTile =
+                        pipeline.getTileWithData(weights, weightIdx(N, C, 0));
+                const TensorShape& weightsShape = weightsTile->getShape();
+                mapArrayToAccel(accel, "host_b", weightsTile->data<float16>(),
+                                weightsShape.storageSize() * sizeof(float16));
+                int weightsDims[2] = { weightsShape[1], weightsShape[2] };
+                dout(1) << "Input: " << inputIdx(N, R, 0)
+                        << ", weights: " << weightIdx(N, C, 0)
+                        << ", output: " << outputIdx(N, R, 0) << "\n";
+                // The tile of A stays in the scratchpad for all the column
+                // tiles.
+                std::unique_ptr<volatile int> finishFlag = invokeKernelNoBlock(
+                        currAccelIdx, accel,
+                        smv_matrix_multiply_transpose_nc_vec_fxp,
+                        inputTile->data<float16>(),
+                        weightsTile->data<float16>(),
+                        outputTile->data<float16>(), nullptr,
+                        smv::accelSpads[currAccelIdx].spad0,
+                        smv::accelSpads[currAccelIdx].spad1,
+                        smv::accelSpads[currAccelIdx].spad2, inputDims,
+                        weightsDims, outputDims, inputShape.getPadding(2),
+                        weightsShape.getPadding(2), outputShape.getPadding(2),
+                        0, finishedCols, false, C == 0,
+                        C == numColTiles - 1, NO_ACTIVATION, actParams,
+                        &sampling);
+                accelPool.addFinishFlag(currAccelIdx, std::move(finishFlag));
+                finishedCols += weightsShape[1];
+            }
+            pipeline.writeBack(outputs, outputIdx(N, R, 0));
+            currAccelIdx = accelPool.getNextAvailableAccelerator(currAccelIdx);
+        }
+    }
+    // Before we leave, make sure all the accelerators have finished.
+    accelPool.joinAll();
+}
+
+void SmvBatchMatMulOp::tile() {
+    // Tiles A and the outputs row-wise and the packed B^T row-wise, each
+    // batch separately, so that every tile holds rows of a single matrix.
+    plan = smv::bmm::TilingOptimizer::doTiling(this);
+    if (!plan.isValid())
+        return;
+    int batch = getBatchSize();
+    int cols = getNumCols();
+    int depth = getReductionSize();
+    Tensor* a = getInput(InputA);
+    if (!packedB) {
+        packedB = new Tensor(name + "/packed_b",
+                             TensorShape({ batch, cols, depth },
+                                         DataLayout::NTC,
+                                         SmvBackend::Alignment));
+        packedB->allocateStorage<float16>();
+        workspace->addTensor(packedB);
+    }
+    tiledTensors[InputTiles] = generateTiledTensor(
+            a,
+            TensorShape({ 1, plan.rowTileSize, depth },
+                        a->getShape().getLayout(), SmvBackend::Alignment),
+            this);
+    tiledTensors[WeightTiles] = generateTiledTensor(
+            packedB,
+            TensorShape({ 1, plan.colTileSize, depth }, DataLayout::NTC,
+                        SmvBackend::Alignment),
+            this);
+    tiledTensors[OutputTiles] = generateTiledTensor(
+            getOutput(Outputs),
+            TensorShape({ 1, plan.rowTileSize, cols }, DataLayout::NTC,
+                        SmvBackend::Alignment),
+            this);
+}
+
+void SmvBatchMatMulOp::run() {
+    if (!plan.isValid()) {
+        dout(1) << "[" << name << "]: The matrices don't fit in the "
+                << "scratchpads, multiplying them on the host.\n";
+        BatchMatMulOp<SmvBackend>::run();
+        return;
+    }
+
+    SmvTilePipeline pipeline;
+    {
+        auto stats = gem5::ScopedStats(
+                stats::kTensorPrepStart, stats::kTensorPrepEnd);
+        packB();
+        pipeline.prepare(tiledTensors[InputTiles]);
+        pipeline.prepare(tiledTensors[WeightTiles]);
+    }
+
+    runNRC(pipeline);
+
+    {
+        auto stats = gem5::ScopedStats(
+                stats::kTensorFinalStart, stats::kTensorFinalEnd);
+        pipeline.finalize(tiledTensors[OutputTiles]);
+    }
+}
+
+}  // namespace smaug
@@ -0,0 +1,50 @@
+#ifndef _OPERATORS_SMV_SMV_BATCH_MAT_MUL_OP_H_
+#define _OPERATORS_SMV_SMV_BATCH_MAT_MUL_OP_H_
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/batch_mat_mul_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_tiling.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
+
+namespace smaug {
+
+/**
+ * Batched matrix multiply operator on SMV.
+ *
+ * The matrices of every batch are multiplied with the inner product kernel,
+ * which computes `C = A x B_transpose`, so the matrices of B are transposed
+ * once per run into a packed tensor. All the batches are tiled together and
+ * distributed over the accelerators, so the whole batch only pays for one
+ * operator.
+ *
+ * Matrices that don't fit in the scratchpads at all are multiplied on the host
+ * instead.
+ */
+class SmvBatchMatMulOp : public BatchMatMulOp<SmvBackend> {
+  public:
+    using BatchMatMulOp<SmvBackend>::BatchMatMulOp;
+    void tile() override;
+    void run() override;
+
+    const smv::bmm::TilingPlan& getTilingPlan() const { return plan; }
+
+  protected:
+   enum { InputTiles, WeightTiles, OutputTiles, kNumTiledTensors };
+
+   /**
+    * Copies the matrices of B into the packed tensor as [batch, n, k], with
+    * zeros in the padding of every row.
+    */
+   void packB();
+   void runNRC(SmvTilePipeline& pipeline);
+
+   smv::bmm::TilingPlan plan;
+   /** The transposed B, shaped [batch, n, k]. */
+   Tensor* packedB = nullptr;
+   std::array<TiledTensor, kNumTiledTensors> tiledTensors;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,125 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/batch_mat_mul_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_op.h"
+#include "smaug/operators/smv/smv_test_common.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class SmvBatchMatMulOpTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    /**
+     * Creates an SMV batched matrix multiply operator with random inputs, and
+     * the tensor of its outputs.
+     */
+    SmvBatchMatMulOp* createSmvBatchMatMulOp(
+            int batch, int m, int k, int n, bool transposeB) {
+        auto op = new SmvBatchMatMulOp("bmm", workspace());
+        op->setTransposeB(transposeB);
+        std::vector<std::vector<int>> dims = {
+            { batch, m, k }, transposeB ? std::vector<int>{ batch, n, k }
+                                        : std::vector<int>{ batch, k, n },
+        };
+        for (int i = 0; i < dims.size(); i++) {
+            Tensor* input = new Tensor(
+                    "input" + std::to_string(i),
+                    TensorShape(dims[i], DataLayout::NTC,
+                                SmvBackend::Alignment));
+            workspace()->addTensor(input);
+            op->setInput(input, i);
+        }
+        createAndFillTensorsWithData<float16>(op, fillTensorWithRandomData);
+        return op;
+    }
+
+    /**
+     * Runs the batched matrix multiply on the host with the same inputs as
+     * the given operator and returns the operator.
+     */
+    BatchMatMulOp<SmvBackend>* runOnHost(SmvBatchMatMulOp* smvOp) {
+        auto op = new BatchMatMulOp<SmvBackend>("host_bmm", workspace());
+        op->setTransposeB(smvOp->getTransposeB());
+        for (int i = 0; i < smvOp->getInputs().size(); i++)
+            op->setInput(smvOp->getInput(i), i);
+        op->createAllTensors();
+        allocateAllTensors<float16>(op);
+        op->run();
+        return op;
+    }
+
+    void verifyWithHost(SmvBatchMatMulOp* smvOp) {
+        smvOp->tile();
+        smvOp->run();
+        auto hostOp = runOnHost(smvOp);
+        verifyOutputs<float16>(smvOp->getOutput(0), hostOp->getOutput(0));
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(SmvBatchMatMulOpTest,
+                 "SMV batched matrix multiply",
+                 "[smvbmm]") {
+    SECTION("One row per batch, as in attention") {
+        auto op = createSmvBatchMatMulOp(4, 1, 8, 32, false);
+        verifyWithHost(op);
+        const smv::bmm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.isValid());
+        REQUIRE(plan.rowTileSize == 1);
+        REQUIRE(plan.colTileSize == 32);
+        REQUIRE(plan.numColTiles == 1);
+    }
+
+    SECTION("Transposed B with padded dimensions") {
+        auto op = createSmvBatchMatMulOp(3, 5, 20, 30, true);
+        verifyWithHost(op);
+        const smv::bmm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.rowTileSize == 5);
+        REQUIRE(plan.numColTiles == 1);
+    }
+
+    SECTION("B tiled column-wise") {
+        auto op = createSmvBatchMatMulOp(2, 3, 1024, 100, false);
+        verifyWithHost(op);
+        const smv::bmm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.colTileSize == 16);
+        REQUIRE(plan.numColTiles == 7);
+    }
+
+    SECTION("A tiled row-wise") {
+        auto op = createSmvBatchMatMulOp(2, 300, 64, 64, true);
+        verifyWithHost(op);
+        const smv::bmm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.rowTileSize == 255);
+        REQUIRE(plan.numColTiles == 1);
+    }
+
+    SECTION("Batches on multiple accelerators") {
+        numAcceleratorsAvailable = 2;
+        auto op = createSmvBatchMatMulOp(5, 2, 16, 24, false);
+        verifyWithHost(op);
+        REQUIRE(op->getTilingPlan().isValid());
+    }
+
+    SECTION("Tiling again reuses the packed B") {
+        auto op = createSmvBatchMatMulOp(2, 1, 8, 16, true);
+        op->tile();
+        Tensor* packedB = workspace()->getTensor("bmm/packed_b");
+        REQUIRE(packedB != nullptr);
+        verifyWithHost(op);
+        REQUIRE(workspace()->getTensor("bmm/packed_b") == packedB);
+    }
+
+    SECTION("Too deep a reduction runs on the host") {
+        auto op = createSmvBatchMatMulOp(1, 1, 4096, 4, false);
+        verifyWithHost(op);
+        REQUIRE(!op->getTilingPlan().isValid());
+    }
+}
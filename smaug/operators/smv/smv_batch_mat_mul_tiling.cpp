@@ -0,0 +1,57 @@
+#include <algorithm>
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_inner_product_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_op.h"
+#include "smaug/operators/smv/smv_batch_mat_mul_tiling.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+namespace smv {
+namespace bmm {
+
+std::ostream& operator<<(std::ostream& os, const TilingPlan& plan) {
+    os << "row tile: " << plan.rowTileSize
+       << ", column tile: " << plan.colTileSize
+       << ", column tiles: " << plan.numColTiles;
+    return os;
+}
+
+TilingPlan TilingOptimizer::doTiling(SmvBatchMatMulOp* op) {
+    Tensor* a = op->getInput(SmvBatchMatMulOp::InputA);
+    Tensor* outputs = op->getOutput(SmvBatchMatMulOp::Outputs);
+    int maxTileSize = SmvBackend::SpadSize() / a->getDataTypeSize();
+    int rows = op->getNumRows();
+    int cols = op->getNumCols();
+    int depth = a->getShape().getStorageDim(2);
+    int width = outputs->getShape().getStorageDim(2);
+
+    TilingPlan plan;
+    // A row of A takes depth elements of spad0 and a row of the results takes
+    // width elements of spad2. Loads and stores may overrun by up to one
+    // vector.
+    plan.rowTileSize = std::min(
+            rows,
+            (maxTileSize - SmvBackend::Alignment) / std::max(depth, width));
+    int maxCols = maxTileSize / depth / fc::kNumPEs * fc::kNumPEs;
+    if (maxCols > 0) {
+        // Balance the columns over the fewest tiles that fit. Every tile but
+        // the last one must be a multiple of kNumPEs wide, as the kernel
+        // writes its results one vector at a time.
+        int numTiles = FRAC_CEIL(cols, maxCols);
+        plan.colTileSize =
+                numTiles == 1 ? cols
+                              : FRAC_CEIL(FRAC_CEIL(cols, numTiles),
+                                          fc::kNumPEs) *
+                                        fc::kNumPEs;
+        plan.numColTiles = FRAC_CEIL(cols, plan.colTileSize);
+    }
+    dout(1) << "  Tiling plan chosen for " << op->getName() << ": " << plan
+            << "\n";
+    return plan;
+}
+
+}  // namespace bmm
+}  // namespace smv
+}  // namespace smaug
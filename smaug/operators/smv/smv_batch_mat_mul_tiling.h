@@ -0,0 +1,62 @@
+#ifndef _OPERATORS_SMV_SMV_BATCH_MAT_MUL_TILING_H_
+#define _OPERATORS_SMV_SMV_BATCH_MAT_MUL_TILING_H_
+
+#include <iostream>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor.h"
+
+namespace smaug {
+
+class SmvBatchMatMulOp;
+
+namespace smv {
+namespace bmm {
+
+/**
+ * Describes how SmvBatchMatMulOp splits the matrices of every batch over the
+ * scratchpads.
+ *
+ * The rows of A are in spad0, the rows of the transposed B in spad1 and the
+ * results in spad2, as in the inner product. The reduction dimension is never
+ * tiled.
+ */
+struct TilingPlan {
+    /** The number of rows of A and the results per tile. */
+    int rowTileSize = 0;
+    /** The number of columns of the results, or rows of B^T, per tile. */
+    int colTileSize = 0;
+    /** The number of column-wise tiles per batch. */
+    int numColTiles = 0;
+
+    bool isValid() const { return rowTileSize > 0 && colTileSize > 0; }
+};
+
+std::ostream& operator<<(std::ostream& os, const TilingPlan& plan);
+
+/**
+ * Tiling optimizer for the SMV batched matrix multiply.
+ */
+class TilingOptimizer {
+   public:
+    /**
+     * Determines the tiling plan of the batched matrix multiply.
+     *
+     * Every tile of A takes all the columns of the results, so it is read
+     * once and stays in the scratchpad while B^T is streamed through in the
+     * fewest tiles of a multiple of kNumPEs rows.
+     *
+     * @param op The SMV batched matrix multiply operator. All tensors must
+     * have been created with createAllTensors() prior to calling this
+     * function.
+     * @returns The tiling plan, which is invalid if a single row of A, a row
+     * of the results or kNumPEs rows of B^T don't fit in the scratchpads.
+     */
+    static TilingPlan doTiling(SmvBatchMatMulOp* op);
+};
+
+}  // namespace bmm
+}  // namespace smv
+}  // namespace smaug
+
+#endif
@@ -21,7 +21,8 @@ const int kVectorSize = 8;
 // 2) A: activation-wise tiles in the inputs/weights.
 void SmvBatchNormOp::runNA(TiledTensor& inputs,
                            TiledTensor& weights,
-                           TiledTensor& outputs) {
+                           TiledTensor& outputs,
+                           SmvTilePipeline& pipeline) {
     int inputNumTiles = inputs.getShape()[0];
     int inputActTiles = inputs.getShape()[1];
     int weightActTiles = weights.getShape()[1];
@@ -45,8 +46,10 @@ void SmvBatchNormOp::runNA(TiledTensor& inputs,
             dout(1) << "Input: " << inputIdx(N, iC)
                     << ", weight: " << weightIdx(0, wC)
                     << ", output: " << outputIdx(N, iC) << "\n";
-            Tensor* inputTile = inputs.getTileWithData(inputTileIdx);
-            Tensor* weightsTile = weights.getTileWithData(weightTileIdx);
+            Tensor* inputTile =
+                    pipeline.getTileWithData(inputs, inputTileIdx);
+            Tensor* weightsTile =
+                    pipeline.getTileWithData(weights, weightTileIdx);
             Tensor* outputTile = outputs[outputTileIdx];
             const TensorShape& inputShape = inputTile->getShape();
             const TensorShape& weightsShape = weightsTile->getShape();
@@ -76,6 +79,9 @@ void SmvBatchNormOp::runNA(TiledTensor& inputs,
                          smv::spad2, inputDims, weightsShape[1],
                          inputShape.getPadding(1), actStart, sendOutputs,
                          actInfo.function, actInfo.params);
+            // The output tile is finished with its last weight tile.
+            if (inputActTiles == weightActTiles || wC == weightActTiles - 1)
+                pipeline.writeBack(outputs, outputTileIdx);
 
             actOffset += weightsTile->getShape()[1];
             if (inputActTiles == weightActTiles) {
@@ -100,7 +106,8 @@ void SmvBatchNormOp::runNA(TiledTensor& inputs,
 // 4) C: channel-wise tiles in the inputs.
 void SmvBatchNormOp::runNHWC(TiledTensor& inputs,
                              TiledTensor& weights,
-                             TiledTensor& outputs) {
+                             TiledTensor& outputs,
+                             SmvTilePipeline& pipeline) {
     // Ordinarily, we don't need to tile the weights.
     assert(weights.size() == 1);
     int inputNumTiles = inputs.getShape()[0];
@@ -109,7 +116,7 @@ void SmvBatchNormOp::runNHWC(TiledTensor& inputs,
     int inputChanTiles = inputs.getShape()[3];
     auto inputIdx = inputs.startIndex();
     auto outputIdx = outputs.startIndex();
-    Tensor* weightTile = weights.getTileWithData(0);
+    Tensor* weightTile = pipeline.getTileWithData(weights, 0);
     const TensorShape& weightShape = weightTile->getShape();
     for (int i = 0; i < numAcceleratorsAvailable; i++) {
         mapArrayToAccel(smv::kBatchNormHw + i, "host_weights",
@@ -134,7 +141,8 @@ void SmvBatchNormOp::runNHWC(TiledTensor& inputs,
                     int outputTileIdx = outputIdx(N, H, W, C);
                     dout(1) << "Input: " << inputTileIdx << ", Weight: 0"
                             << ", output: " << outputTileIdx << "\n";
-                    Tensor* inputTile = inputs.getTileWithData(inputTileIdx);
+                    Tensor* inputTile =
+                            pipeline.getTileWithData(inputs, inputTileIdx);
                     Tensor* outputTile = outputs[outputTileIdx];
                     const TensorShape& inputShape = inputTile->getShape();
                     const TensorShape& outputShape = outputTile->getShape();
@@ -155,14 +163,18 @@ void SmvBatchNormOp::runNHWC(TiledTensor& inputs,
                                     smv_batch_norm_post_conv_nhwc_vec_fxp,
                                     inputTile->data<float16>(),
                                     weightTile->data<float16>(),
-                                    outputTile->data<float16>(), smv::spad0,
-                                    smv::spad1, smv::spad2, inputDims,
-                                    weightShape[1], inputShape.getPadding(3),
+                                    outputTile->data<float16>(),
+                                    smv::accelSpads[currAccelIdx].spad0,
+                                    smv::accelSpads[currAccelIdx].spad1,
+                                    smv::accelSpads[currAccelIdx].spad2,
+                                    inputDims, weightShape[1],
+                                    inputShape.getPadding(3),
                                     weightShape.getPadding(1), ifmapOffset,
                                     actInfo.function, actInfo.params,
                                     &sampling);
                     accelPool.addFinishFlag(
                             currAccelIdx, std::move(finishFlag));
+                    pipeline.writeBack(outputs, outputTileIdx);
                     ifmapOffset += inputShape[3];
                     currAccelIdx =
                             accelPool.getNextAvailableAccelerator(currAccelIdx);
@@ -198,27 +210,28 @@ void SmvBatchNormOp::run() {
     dout(2) << *gamma << "\n";
     dout(2) << *beta << "\n";
 
+    SmvTilePipeline pipeline;
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorPrepStart, stats::kTensorPrepEnd);
-        tiledTensors[0].copyDataToAllTiles();
-        tiledTensors[1].copyDataToAllTiles();
+        pipeline.prepare(tiledTensors[0]);
+        pipeline.prepare(tiledTensors[1]);
     }
 
     if (isPostConv) {
         assert(inputShape.getLayout() == DataLayout::NHWC);
         assert(outputShape.getLayout() == DataLayout::NHWC);
-        runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+        runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2], pipeline);
     } else {
         assert(inputShape.getLayout() == DataLayout::NC);
         assert(outputShape.getLayout() == DataLayout::NC);
-        runNA(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+        runNA(tiledTensors[0], tiledTensors[1], tiledTensors[2], pipeline);
     }
 
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorFinalStart, stats::kTensorFinalEnd);
-        tiledTensors[2].untile();
+        pipeline.finalize(tiledTensors[2]);
     }
 }
 
@@ -4,6 +4,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/batch_norm_op.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
 
 namespace smaug {
 
@@ -29,15 +30,25 @@ class SmvBatchNormOp : public BatchNormOp<SmvBackend> {
     using BatchNormOp<SmvBackend>::BatchNormOp;
     void tile() override;
     void run() override;
+    TiledTensor* getTiledInput(int index) override {
+        return index == Inputs ? &tiledTensors[0] : nullptr;
+    }
+    TiledTensor* getTiledOutput(int index) override {
+        return index == Outputs ? &tiledTensors[2] : nullptr;
+    }
 
   protected:
    /** Post-FC tile dispatcher. */
-   void runNA(TiledTensor& inputs, TiledTensor& weights, TiledTensor& outputs);
+   void runNA(TiledTensor& inputs,
+              TiledTensor& weights,
+              TiledTensor& outputs,
+              SmvTilePipeline& pipeline);
 
    /** Post-convolution tile dispatcher. */
    void runNHWC(TiledTensor& inputs,
                 TiledTensor& weights,
-                TiledTensor& outputs);
+                TiledTensor& outputs,
+                SmvTilePipeline& pipeline);
 
    std::array<TiledTensor, 3> tiledTensors;
 };
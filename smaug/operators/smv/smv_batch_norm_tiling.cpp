@@ -267,8 +267,10 @@ std::array<TiledTensor, 3> TilingOptimizer::doTiling(SmvBatchNormOp* op) {
     auto weights = concatTensors(
             { mean, variance, gamma, beta }, 0, op->getWorkspace());
     auto outputs = op->getOutput(SmvBatchNormOp::Outputs);
-    TilingConfig tileConfig =
-            TilingOptimizer::computeBasicTileShapes(inputs, weights, outputs);
+    TilingConfig tileConfig = getCachedTileShapes(op, {}, [&]() {
+        return TilingOptimizer::computeBasicTileShapes(
+                inputs, weights, outputs);
+    });
     TiledTensor tiledInputs =
             generateTiledTensor(inputs, tileConfig.inputs, op);
     // Copy data for the weight tiles since the data is read-only.
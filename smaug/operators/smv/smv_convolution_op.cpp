@@ -18,7 +18,8 @@ const int kNumMaccsPerPE = 32;
 
 void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                                TiledTensor& weights,
-                               TiledTensor& outputs) {
+                               TiledTensor& outputs,
+                               SmvTilePipeline& pipeline) {
     int inputIfmapTiles = inputs.getShape()[0];
     int inputRowTiles = inputs.getShape()[1];
     int inputChanTiles = inputs.getShape()[3];
@@ -36,6 +37,11 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
     int rightPad = inputPadding[3];
     unsigned accelId = useSystolicArrayWhenAvailable ? smv::kSystolicArrayHw
                                                      : smv::kConvolutionHw;
+    // A batch norm folded into the weights leaves a per-channel bias, which
+    // the kernel adds to every output tile before sending it back.
+    float16* bias = getBias() ? getBias()->data<float16>() : nullptr;
+    assert(!(bias && useSystolicArrayWhenAvailable) &&
+           "The systolic array does not support biases!");
     SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
     std::vector<int> lastReadInputTileIdx(numAcceleratorsAvailable, -1);
     std::vector<int> lastReadWeightTileIdx(numAcceleratorsAvailable, -1);
@@ -46,6 +52,10 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                 accelId + i, "host_weights", getWeightsMemType());
         setArrayMemTypeIfSimulating(
                 accelId + i, "host_results", getOutputsMemType());
+        if (bias) {
+            setArrayMemTypeIfSimulating(
+                    accelId + i, "host_bias", getWeightsMemType());
+        }
     }
     int currAccelIdx = 0;
     for (int N = 0; N < inputIfmapTiles; N++) {
@@ -82,6 +92,8 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
             // are needed to finish the weight tile.
             int numOutputInvocations =
                     needOutputIteration ? outputChanTiles : 1;
+            // The first output channel of the output tile.
+            int ofmapStart = 0;
             assert(numOutputInvocations > 1
                            ? weightOfmapTiles == 1
                            : weightOfmapTiles == outputChanTiles);
@@ -112,6 +124,13 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                             accelId + currAccelIdx, "host_results",
                             outputTile->data<float16>(),
                             outputShape.storageSize() * sizeof(float16));
+                    float16* outputBias = bias ? bias + ofmapStart : nullptr;
+                    if (outputBias) {
+                        mapArrayToAccel(accelId + currAccelIdx, "host_bias",
+                                        outputBias,
+                                        outputShape.getStorageDim(3) *
+                                                sizeof(float16));
+                    }
 
                     // The tiling optimizer will make sure that the weight tiles
                     // have the same channel dimension as the input tiles (so
@@ -128,10 +147,10 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                         dout(1) << "Input: " << inputTileIdx
                                 << ", weights: " << weightTileIdx
                                 << ", output: " << outputTileIdx << "\n";
-                        Tensor* inputTile =
-                                inputs.getTileWithData(inputTileIdx);
-                        Tensor* weightsTile =
-                                weights.getTileWithData(weightTileIdx);
+                        Tensor* inputTile = pipeline.getTileWithData(
+                                inputs, inputTileIdx);
+                        Tensor* weightsTile = pipeline.getTileWithData(
+                                weights, weightTileIdx);
                         const TensorShape& inputShape = inputTile->getShape();
                         const TensorShape& weightsShape =
                                 weightsTile->getShape();
@@ -201,9 +220,11 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                                     smv_conv3d_nhwc_vec_fxp,
                                     inputTile->data<float16>(),
                                     weightsTile->data<float16>(),
-                                    outputTile->data<float16>(), smv::spad0,
-                                    smv::spad1, smv::spad2, inputDims,
-                                    weightsDims, outputDims,
+                                    outputTile->data<float16>(), outputBias,
+                                    smv::accelSpads[currAccelIdx].spad0,
+                                    smv::accelSpads[currAccelIdx].spad1,
+                                    smv::accelSpads[currAccelIdx].spad2,
+                                    inputDims, weightsDims, outputDims,
                                     inputShape.getPadding(3),
                                     weightsShape.getPadding(3),
                                     outputShape.getPadding(3), inputHaloPad,
@@ -228,8 +249,10 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                                    "don't need channelwise tiling.");
                         }
                     }
+                    pipeline.writeBack(outputs, outputTileIdx);
                     if (needOutputIteration)
                         kernStart += outputShape[3];
+                    ofmapStart += outputShape[3];
                 }
                 currAccelIdx =
                         accelPool.getNextAvailableAccelerator(currAccelIdx);
@@ -297,12 +320,8 @@ void SmvConvolutionOp::tile() {
     // This function will tile (if necessary) the input/weight/output tensors
     // of the convolution operator into smaller tensor tiles so that each tile
     // can fit in the corresponding scratchpad of the accelerator.
-    // TODO: A lot of networks have back to back convolutional layers, it would
-    // be much more efficient not to retile in between them. That can be
-    // achieved by directly sending the output tiles to the next convolutional
-    // layer instead of merging them into a single output tensor first. It's
-    // sort of operator fusing that two back-to-back convolution operators are
-    // tiled only once.
+    // Back-to-back tiled layers don't merge the output tiles into a single
+    // tensor in between them; see fuseTiledOperators().
     tiledTensors = smaug::smv::conv::TilingOptimizer::doTiling(this);
 }
 
@@ -318,19 +337,20 @@ void SmvConvolutionOp::run() {
     assert(outputShape.getLayout() == DataLayout::NHWC);
     dout(2) << *kernels << "\n";
 
+    SmvTilePipeline pipeline;
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorPrepStart, stats::kTensorPrepEnd);
-        tiledTensors[0].copyDataToAllTiles();
-        tiledTensors[1].copyDataToAllTiles();
+        pipeline.prepare(tiledTensors[0]);
+        pipeline.prepare(tiledTensors[1]);
     }
 
-    runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2], pipeline);
 
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorFinalStart, stats::kTensorFinalEnd);
-        tiledTensors[2].untile();
+        pipeline.finalize(tiledTensors[2]);
     }
 }
 
@@ -4,6 +4,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/convolution_op.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
 
 namespace smaug {
 
@@ -29,6 +30,12 @@ class SmvConvolutionOp : public ConvolutionOp<SmvBackend> {
     using ConvolutionOp<SmvBackend>::ConvolutionOp;
     void tile() override;
     void run() override;
+    TiledTensor* getTiledInput(int index) override {
+        return index == Inputs ? &tiledTensors[0] : nullptr;
+    }
+    TiledTensor* getTiledOutput(int index) override {
+        return index == Outputs ? &tiledTensors[2] : nullptr;
+    }
     friend class smv::conv::TilingOptimizer;
 
   protected:
@@ -37,7 +44,8 @@ class SmvConvolutionOp : public ConvolutionOp<SmvBackend> {
     */
    void runNHWC(TiledTensor& inputs,
                 TiledTensor& weights,
-                TiledTensor& outputs);
+                TiledTensor& outputs,
+                SmvTilePipeline& pipeline);
    std::unique_ptr<volatile int> invokeSystolicArrayKernel(
            unsigned accelId,
            float16* inputs,
@@ -31,6 +31,10 @@ class SmvConvolutionOpTest : public SmaugTest {
         refConvOp->setStride(convOp->getRowStride(), convOp->getColStride());
         refConvOp->setInput(input32, 0);
         refConvOp->setInput(kernels32, 1);
+        if (convOp->getBias()) {
+            refConvOp->setBias(
+                    convertFp16ToFp32Tensor(convOp->getBias(), workspace()));
+        }
         refConvOp->createAllTensors();
         refConvOp->getOutput(0)->allocateStorage<float>();
         refConvOp->run();
@@ -81,10 +85,48 @@ class SmvConvolutionOpTest : public SmaugTest {
         auto refOutputs = getReferenceOutput(convOp);
         verifyOutputs<float16>(outputs, refOutputs);
     }
+
+    // Runs a convolution with the bias of a folded batch norm and a ReLU.
+    void doBiasTest(std::vector<int> inputDims, std::vector<int> kernelDims) {
+        auto convOp = new SmvConvolutionOp("conv", workspace());
+        convOp->setActivation(ActivationInfo(activation_type::RELU));
+        convOp->setStride(1, 1);
+        convOp->setPadding(SamePadding);
+        TensorShape inputShape(inputDims, NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("input", inputShape);
+        inputs->allocateStorage<float16>();
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(kernelDims[1], kernelDims[2], kernelDims[0]);
+        createAndFillTensorsWithData<float16>(convOp, fillTensorWithRandomData);
+        convOp->setBias(createRandomBiasTensor(kernelDims[0], workspace()));
+        convOp->tile();
+        convOp->run();
+        auto outputs = convOp->getOutput(0);
+        auto refOutputs = getReferenceOutput(convOp);
+        verifyOutputs<float16>(outputs, refOutputs);
+    }
 };
 
 }  // namespace smaug
 
+TEST_CASE_METHOD(SmvConvolutionOpTest,
+                 "SMV Tiled Convolution with a bias",
+                 "[smvconv]") {
+    SECTION("No tiling required") {
+        doBiasTest({ 1, 8, 8, 8 }, { 8, 3, 3, 8 });
+    }
+    SECTION("Weight tiles of non-multiples of 8 kernels") {
+        doBiasTest({ 1, 8, 8, 32 }, { 50, 3, 3, 32 });
+    }
+    SECTION("Inputs DimNH tiled, weights DimN tiled") {
+        doBiasTest({ 1, 32, 32, 32 }, { 128, 5, 5, 32 });
+    }
+    SECTION("Outputs need DimNC tiling") {
+        doBiasTest({ 1, 32, 32, 8 }, { 64, 3, 3, 8 });
+    }
+}
+
 TEST_CASE_METHOD(SmvConvolutionOpTest,
                  "SMV Tiled Convolution with fused activation",
                  "[smvconv]") {
@@ -340,3 +382,20 @@ TEST_CASE_METHOD(SmvConvolutionOpTest, "Stride size tests", "[smvconv]") {
         }
     }
 }
+
+TEST_CASE_METHOD(SmvConvolutionOpTest,
+                 "SMV Tiled Convolution on multiple accelerators",
+                 "[smvconv]") {
+    numAcceleratorsAvailable = 4;
+
+    SECTION("DimN tiled convolution") {
+        // The weight tiles will contain 56, 56 and 16 kernels respectively.
+        doTest({ 1, 8, 8, 32 }, { 128, 3, 3, 32 });
+    }
+    SECTION("Inputs DimNH tiled, weights DimN tiled") {
+        doTest({ 1, 32, 32, 32 }, { 128, 5, 5, 32 });
+    }
+    SECTION("Inputs DimNH tiled, weights DimNC tiled") {
+        doTest({ 1, 64, 16, 256 }, { 128, 4, 4, 256 });
+    }
+}
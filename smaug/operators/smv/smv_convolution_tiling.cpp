@@ -228,22 +228,83 @@ TilingConfig TilingOptimizer::computeBasicTileShapes(SmvConvolutionOp* op) {
                 break;
         }
     }
-    dout(2) << "  Number of possible tiling configs: " << fullConfigs.size()
-            << "\n";
-    for (auto& config : fullConfigs)
-        dout(2) << "    " << config << "\n";
-    auto maxIt = std::max_element(
-            fullConfigs.begin(),
-            fullConfigs.end(),
-            [](const TilingConfig& c1, const TilingConfig& c2) {
-                return c1.getTotalSize() < c2.getTotalSize();
-            });
-    assert(maxIt != fullConfigs.end() && "Failed to get best tiling config!");
-    // Fill in the tiling dims.
-    (*maxIt).inputTilingDims = inputTilingDims;
-    (*maxIt).weightTilingDims = weightTilingDims;
-    (*maxIt).outputTilingDims = outputTilingDims;
-    return *maxIt;
+    for (auto& config : fullConfigs) {
+        config.inputTilingDims = inputTilingDims;
+        config.weightTilingDims = weightTilingDims;
+        config.outputTilingDims = outputTilingDims;
+    }
+    return findCheapestConfig(fullConfigs, [op](const TilingConfig& config) {
+        return estimateCost(op, config);
+    });
+}
+
+TilingCost TilingOptimizer::estimateCost(SmvConvolutionOp* op,
+                                         const TilingConfig& config) {
+    const TensorShape& inputsShape = op->getInput(op->Inputs)->getShape();
+    const TensorShape& weightsShape = op->getInput(op->Kernels)->getShape();
+    const TensorShape& outputsShape = op->getOutput(op->Outputs)->getShape();
+    int inputIfmapTiles = FRAC_CEIL(inputsShape[0], config.inputs[0]);
+    int inputChanTiles = FRAC_CEIL(inputsShape[3], config.inputs[3]);
+    int weightOfmapTiles = FRAC_CEIL(weightsShape[0], config.weights[0]);
+    int weightChanTiles = FRAC_CEIL(weightsShape[3], config.weights[3]);
+    int outputChanTiles = FRAC_CEIL(outputsShape[3], config.outputs[3]);
+    // Neighboring rowwise input tiles share the halo rows that both of them
+    // need for the convolution, and there is an output rowwise tile for each
+    // of them.
+    int haloRows = std::max(op->getWeightRows() - op->getRowStride(), 0);
+    int outputRowTiles = 1;
+    if (config.inputs[1] < inputsShape[1]) {
+        outputRowTiles += FRAC_CEIL(inputsShape[1] - config.inputs[1],
+                                    config.inputs[1] - haloRows);
+    }
+    int64_t inputRows = inputsShape[1] + (outputRowTiles - 1) * haloRows;
+    // The tiles of a tensor have roughly the same size, so the bytes of a tile
+    // are taken as the average over all the tiles.
+    int64_t inputTileBytes =
+            inputsShape[0] * inputRows * inputsShape[2] *
+            getTiledStorageSize(inputsShape[3], config.inputs[3]) *
+            sizeof(float16) /
+            (inputIfmapTiles * outputRowTiles * inputChanTiles);
+    int64_t weightTileBytes =
+            (int64_t)weightsShape[0] * weightsShape[1] * weightsShape[2] *
+            getTiledStorageSize(weightsShape[3], config.weights[3]) *
+            sizeof(float16) / (weightOfmapTiles * weightChanTiles);
+    int64_t outputTileBytes =
+            (int64_t)outputsShape[0] * outputsShape[1] * outputsShape[2] *
+            getTiledStorageSize(outputsShape[3], config.outputs[3]) *
+            sizeof(float16) /
+            (inputIfmapTiles * outputRowTiles * outputChanTiles);
+    int64_t totalMacs = (int64_t)outputsShape.size() * weightsShape[1] *
+                        weightsShape[2] * weightsShape[3];
+
+    // This follows the tile iteration of SmvConvolutionOp::runNHWC().
+    TilingCostModel model(numAcceleratorsAvailable, kNumPEs * kNumMaccsPerPE);
+    int numOutputInvocations =
+            weightOfmapTiles < outputChanTiles ? outputChanTiles : 1;
+    int currAccelIdx = 0;
+    for (int N = 0; N < inputIfmapTiles; N++) {
+        for (int H = 0; H < outputRowTiles; H++) {
+            for (int W = 0; W < weightOfmapTiles; W++) {
+                for (int oC = 0; oC < numOutputInvocations; oC++) {
+                    int iC = 0, wC = 0;
+                    while (iC < inputChanTiles && wC < weightChanTiles) {
+                        int inputTileIdx =
+                                (N * outputRowTiles + H) * inputChanTiles + iC;
+                        int weightTileIdx = W * weightChanTiles + wC;
+                        model.invoke(currAccelIdx, inputTileIdx,
+                                     inputTileBytes, weightTileIdx,
+                                     weightTileBytes);
+                        if (inputChanTiles == weightChanTiles)
+                            iC++;
+                        wC++;
+                    }
+                    model.sendOutputs(outputTileBytes);
+                }
+                currAccelIdx = (currAccelIdx + 1) % numAcceleratorsAvailable;
+            }
+        }
+    }
+    return model.getCost(totalMacs);
 }
 
 TiledTensor TilingOptimizer::generateRowwiseOutputTiledTensor(
@@ -253,100 +314,29 @@ TiledTensor TilingOptimizer::generateRowwiseOutputTiledTensor(
         const TensorShape& maxOutputTileSize,
         Tensor* outputTensor,
         bool copyData) {
-    const TensorShape& inputShape = inputTiledTensor.getShape();
-    const TensorShape& weightsShape = weightsTiledTensor.getShape();
-    const TensorShape& outputShape = outputTensor->getShape();
-    int weightRows = op->getWeightRows();
-    int weightCols = op->getWeightCols();
-    bool samePadding = op->getPadding() == SamePadding;
-    // For even-sized filtered, FRAC_CEIL is needed to correctly handle padding.
-    std::vector<int> inputPadding = op->getInputPadding();
-    int topRowPad = inputPadding[0];
-    int bottomRowPad = inputPadding[1];
-    int leftColPad = inputPadding[2];
-    int rightColPad = inputPadding[3];
-    std::vector<int> numBlocksInDim{ inputShape[0], inputShape[1],
-                                     inputShape[2], weightsShape[0] };
-    // Due to stride > 1, there is a case where the last rowwise tile doesn't
-    // have enough rows for convolution. If so, we need to decrease the row
-    // dimension by 1 in the output tiled tensor.
-    int lastTileRows =
-            inputTiledTensor[inputTiledTensor.size() - 1]->getShape()[1];
-    if (lastTileRows + bottomRowPad < weightRows)
-        numBlocksInDim[1]--;
-    TiledTensor outputTiledTensor(
-            TensorShape(numBlocksInDim, inputShape.getLayout()), outputTensor);
-    const int ndims = outputShape.ndims();
-    std::vector<int> currentOrigin(ndims, 0);
-    auto inputIndex = inputTiledTensor.startIndex();
+    // Every weight tile produces one channelwise block of the outputs.
+    std::vector<int> outputChans;
     auto weightIndex = weightsTiledTensor.startIndex();
-    auto outputIndex = outputTiledTensor.startIndex();
-    for (int n = 0; n < numBlocksInDim[0]; n++) {
-        for (int h = 0; h < numBlocksInDim[1]; h++) {
-            for (int w = 0; w < numBlocksInDim[2]; w++) {
-                for (int c = 0; c < numBlocksInDim[3]; c++) {
-                    const Tensor* inputTile =
-                            inputTiledTensor[inputIndex(n, h, w, 0)];
-                    const Tensor* weightsTile =
-                            weightsTiledTensor[weightIndex(c, 0, 0, 0)];
-                    const TensorShape& inputTileShape = inputTile->getShape();
-
-                    // DimNH tiling only affects rows, not columns.
-                    int effInputRows = inputTileShape[1];
-                    if (h == 0)
-                        effInputRows += topRowPad;
-                    else if (h == numBlocksInDim[1] - 1)
-                        effInputRows += bottomRowPad;
-                    int effInputCols =
-                            inputTileShape[2] + leftColPad + rightColPad;
-                    int outputRows = op->computeOutputDim(effInputRows,
-                                                          weightRows,
-                                                          op->getRowStride(),
-                                                          ValidPadding);
-                    int outputCols = op->computeOutputDim(effInputCols,
-                                                          weightCols,
-                                                          op->getColStride(),
-                                                          ValidPadding);
-                    TensorShape outputTileShape(
-                            { inputTileShape[0], outputRows, outputCols,
-                              weightsTile->getShape()[0] },
-                            outputTensor->getShape().getLayout(),
-                            SmvBackend::Alignment);
-                    assert(outputTileShape.storageSize() <=
-                                   maxOutputTileSize.storageSize() &&
-                           "DimNH input tiling results in output tile sizes "
-                           "larger than the max tile size!");
-                    int oi = outputIndex(n, h, w, c);
-                    std::string tileName = op->getName() + ":" +
-                                           outputTensor->getName() +
-                                           "/tile:" + std::to_string((int)oi);
-                    Tensor* outputTile = new Tensor(tileName, outputTileShape);
-                    outputTile->allocateStorage(outputTensor->getDataType());
-                    outputTiledTensor.setTile(
-                            oi, currentOrigin, outputTile, copyData);
-                    for (int i = ndims - 1; i >= 0; i--) {
-                        currentOrigin[i] += outputTileShape[i];
-                        if (currentOrigin[i] >= outputShape[i])
-                            currentOrigin[i] = 0;
-                        else
-                            break;
-                    }
-                }
-            }
-        }
+    for (int c = 0; c < weightsTiledTensor.getShape()[0]; c++) {
+        outputChans.push_back(
+                weightsTiledTensor[weightIndex(c, 0, 0, 0)]->getShape()[0]);
     }
-    op->getWorkspace()->addTiledTensor(outputTiledTensor);
-    dout(1) << "  Tiled Tensor " << outputTensor->getName() << "(rowwise):\n"
-            << "    original tensor shape: " << outputTensor->getShape() << "\n"
-            << "    number of tiles: " << outputTiledTensor.size() << "\n";
-    return outputTiledTensor;
+    return generateRowwiseConvOutputTiledTensor(op,
+                                                inputTiledTensor,
+                                                outputChans,
+                                                maxOutputTileSize,
+                                                outputTensor,
+                                                copyData);
 }
 
 std::array<TiledTensor, 3> TilingOptimizer::doTiling(SmvConvolutionOp* op) {
     auto input = op->getInput(SmvConvolutionOp::Inputs);
     auto kernels = op->getInput(SmvConvolutionOp::Kernels);
     auto output = op->getOutput(SmvConvolutionOp::Outputs);
-    TilingConfig tileConfig = TilingOptimizer::computeBasicTileShapes(op);
+    TilingConfig tileConfig = getCachedTileShapes(
+            op,
+            { op->getRowStride(), op->getColStride(), op->getPadding() },
+            [op]() { return TilingOptimizer::computeBasicTileShapes(op); });
     TiledTensor tiledInputs =
             generateTiledTensorWithStrideAndPadding(input,
                                                     tileConfig.inputs,
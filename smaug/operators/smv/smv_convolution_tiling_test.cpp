@@ -486,18 +486,24 @@ TEST_CASE_METHOD(SmaugTest, "Kernel shape tests", "[smvtiling]") {
         convOp->createAllTensors();
         allocateAllTensors<float16>(convOp);
         TilingConfig config = TilingOptimizer::computeBasicTileShapes(convOp);
-        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 2, 64, 32 });
-        REQUIRE(config.weights.dims() == std::vector<int>{ 128, 2, 2, 32 });
-        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 2, 64, 128 });
+        // Taller input tiles need fewer weight tiles per output tile, but
+        // the weights are read once per rowwise tile, so this moves far less
+        // data than the 2-row tiles that use the largest weight tiles.
+        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 8, 64, 32 });
+        REQUIRE(config.weights.dims() == std::vector<int>{ 32, 2, 2, 32 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 8, 64, 32 });
 
         SECTION("Inputs and outputs tiled DimNH, weights tiled DimN") {
             fillTensorWithFixedData(inputs);
             TiledTensor inputTiles = generateInputTiles(convOp, config.inputs);
-            // Halo size 1: 0-1, 1-2, 2-3, ... 30-31, total 31 tiles.
-            REQUIRE(inputTiles.size() == 31);
+            // Halo size 1: 0-7, 7-14, 14-21, 21-28, 28-31, total 5 tiles.
+            REQUIRE(inputTiles.size() == 5);
             for (auto i = inputTiles.startIndex(); !i.end(); ++i) {
                 auto& testDims = inputTiles[i]->getShape().dims();
-                REQUIRE(testDims == std::vector<int>{ 1, 2, 64, 32 });
+                if (i < inputTiles.size() - 1)
+                    REQUIRE(testDims == std::vector<int>{ 1, 8, 64, 32 });
+                else
+                    REQUIRE(testDims == std::vector<int>{ 1, 4, 64, 32 });
                 verifyTensorWithFixedData(inputTiles[i], 0);
             }
 
@@ -505,7 +511,7 @@ TEST_CASE_METHOD(SmaugTest, "Kernel shape tests", "[smvtiling]") {
             fillTensorWithFixedData(weights);
             TiledTensor weightTiles = generateTiledTensor(
                     weights, config.weights, convOp, /* copy_data */ true);
-            REQUIRE(weightTiles.size() == 8);
+            REQUIRE(weightTiles.size() == 32);
             for (int i = 0; i < weightTiles.size(); ++i)
                 verifyTensorWithFixedData(weightTiles[0], 0);
 
@@ -515,26 +521,30 @@ TEST_CASE_METHOD(SmaugTest, "Kernel shape tests", "[smvtiling]") {
                     TilingOptimizer::generateRowwiseOutputTiledTensor(
                             convOp, inputTiles, weightTiles, config.outputs,
                             outputs, true);
-            // There are 31 tiles in the rowwise dimension and 8 in the output
+            // There are 5 tiles in the rowwise dimension and 32 in the output
             // channel dim.
-            REQUIRE(outputTiles.size() == 8 * 31);
-            for (int r = 0; r < 31; r++) {
-                for (int c = 0; c < 8; c++) {
-                    int idx = r * 8 + c;
+            REQUIRE(outputTiles.size() == 32 * 5);
+            for (int r = 0; r < 5; r++) {
+                for (int c = 0; c < 32; c++) {
+                    int idx = r * 32 + c;
                     auto& testDims = outputTiles[idx]->getShape().dims();
                     // Since we use same padding here, for this 2x2 kernel size,
                     // top padding is 1 and bottom padding is 0.
                     if (r == 0) {
-                        // Top tile. Top padding size 1. Input tile row size 2.
-                        // Output tile row size is 2 because of the zero-padded
+                        // Top tile. Top padding size 1. Input tile row size 8.
+                        // Output tile row size is 8 because of the zero-padded
                         // row at the top.
-                        REQUIRE(testDims == std::vector<int>{ 1, 2, 64, 128 });
-                    } else if (r < 31) {
-                        // Middle/bottom tiles. No top/bottom padding. Input
-                        // tile row size 2. Output tile row size 1.
-                        REQUIRE(testDims == std::vector<int>{ 1, 1, 64, 128 });
+                        REQUIRE(testDims == std::vector<int>{ 1, 8, 64, 32 });
+                    } else if (r < 4) {
+                        // Middle tiles. No top/bottom padding. Input tile row
+                        // size 8. Output tile row size 7.
+                        REQUIRE(testDims == std::vector<int>{ 1, 7, 64, 32 });
+                    } else {
+                        // Bottom tile. Input tile row size 4. Output tile row
+                        // size 3.
+                        REQUIRE(testDims == std::vector<int>{ 1, 3, 64, 32 });
                     }
-                    verifyTensorWithFixedData(outputTiles[idx], c * 128);
+                    verifyTensorWithFixedData(outputTiles[idx], c * 32);
                 }
             }
         }
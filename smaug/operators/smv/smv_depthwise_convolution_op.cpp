@@ -0,0 +1,181 @@
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_op.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_tiling.h"
+#include "smaug/operators/smv/smv_kernels.h"
+#include "smaug/operators/smv/smv_accel_pool.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+namespace smv {
+namespace dwconv {
+
+const int kVectorSize = 8;
+
+}  // namespace dwconv
+}  // namespace smv
+
+// This function iterates the tiles generated by the tiling optimizer and sends
+// the input/weight/output tile triplets to the hardware kernel. The tile
+// iteration is in the following order:
+// 1) N: batch-wise tiles in the inputs.
+// 2) H: rowwise tiles in the outputs.
+// 3) C: channelwise tiles in the inputs/weights/outputs.
+// Since there is no reduction across channels, every output tile is finished
+// by a single invocation, and all of them are distributed across the
+// accelerators.
+void SmvDepthwiseConvolutionOp::runNHWC(TiledTensor& inputs,
+                                        TiledTensor& weights,
+                                        TiledTensor& outputs,
+                                        SmvTilePipeline& pipeline) {
+    int inputIfmapTiles = inputs.getShape()[0];
+    int inputRowTiles = inputs.getShape()[1];
+    int inputChanTiles = inputs.getShape()[3];
+    int weightChanTiles = weights.getShape()[3];
+    int outputRowTiles = outputs.getShape()[1];
+    int outputChanTiles = outputs.getShape()[3];
+    assert(inputChanTiles == weightChanTiles &&
+           inputChanTiles == outputChanTiles &&
+           "The inputs, weights and outputs must have the same channelwise "
+           "tiles!");
+    auto inputIdx = inputs.startIndex();
+    auto weightIdx = weights.startIndex();
+    auto outputIdx = outputs.startIndex();
+    std::vector<int> inputPadding = getInputPadding();
+    int topPad = inputPadding[0];
+    int bottomPad = inputPadding[1];
+    int leftPad = inputPadding[2];
+    int rightPad = inputPadding[3];
+    SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
+    std::vector<int> lastReadInputTileIdx(numAcceleratorsAvailable, -1);
+    std::vector<int> lastReadWeightTileIdx(numAcceleratorsAvailable, -1);
+    for (int i = 0; i < numAcceleratorsAvailable; i++) {
+        setArrayMemTypeIfSimulating(
+                smv::kConvolutionHw + i, "host_inputs", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kConvolutionHw + i, "host_weights", getWeightsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kConvolutionHw + i, "host_results", getOutputsMemType());
+    }
+    int currAccelIdx = 0;
+    for (int N = 0; N < inputIfmapTiles; N++) {
+        for (int H = 0; H < outputRowTiles; H++) {
+            int currentTileTopPad = topPad;
+            int currentTileBottomPad = bottomPad;
+            if (inputRowTiles > 1) {
+                if (H == 0) {
+                    currentTileBottomPad = 0;
+                } else if (H == inputRowTiles - 1) {
+                    currentTileTopPad = 0;
+                } else {
+                    currentTileTopPad = 0;
+                    currentTileBottomPad = 0;
+                }
+            }
+            // This is used to specify the padding sizes on the boundaries of
+            // the 2D feature maps in an input tile.
+            int inputHaloPad[4] = { currentTileTopPad, currentTileBottomPad,
+                                    leftPad, rightPad };
+            for (int C = 0; C < inputChanTiles; C++) {
+                int inputTileIdx = inputIdx(N, H, 0, C);
+                int weightTileIdx = weightIdx(0, 0, 0, C);
+                int outputTileIdx = outputIdx(N, H, 0, C);
+                dout(1) << "Input: " << inputTileIdx
+                        << ", weights: " << weightTileIdx
+                        << ", output: " << outputTileIdx << "\n";
+                Tensor* inputTile =
+                        pipeline.getTileWithData(inputs, inputTileIdx);
+                Tensor* weightsTile =
+                        pipeline.getTileWithData(weights, weightTileIdx);
+                Tensor* outputTile = outputs[outputTileIdx];
+                const TensorShape& inputShape = inputTile->getShape();
+                const TensorShape& weightsShape = weightsTile->getShape();
+                const TensorShape& outputShape = outputTile->getShape();
+                mapArrayToAccel(smv::kConvolutionHw + currAccelIdx,
+                                "host_inputs", inputTile->data<float16>(),
+                                inputShape.storageSize() * sizeof(float16));
+                mapArrayToAccel(smv::kConvolutionHw + currAccelIdx,
+                                "host_weights", weightsTile->data<float16>(),
+                                weightsShape.storageSize() * sizeof(float16));
+                mapArrayToAccel(smv::kConvolutionHw + currAccelIdx,
+                                "host_results", outputTile->data<float16>(),
+                                outputShape.storageSize() * sizeof(float16));
+                int inputDims[4] = { inputShape[0], inputShape[1],
+                                     inputShape[2], inputShape[3] };
+                int weightsDims[4] = { weightsShape[0], weightsShape[1],
+                                       weightsShape[2], weightsShape[3] };
+                int outputDims[4] = { outputShape[0], outputShape[1],
+                                      outputShape[2], outputShape[3] };
+                // If this is a new input/weight tile, then we need to read it.
+                bool readInputs = false;
+                if (inputTileIdx != lastReadInputTileIdx[currAccelIdx]) {
+                    readInputs = true;
+                    lastReadInputTileIdx[currAccelIdx] = inputTileIdx;
+                }
+                bool readWeights = false;
+                if (weightTileIdx != lastReadWeightTileIdx[currAccelIdx]) {
+                    readWeights = true;
+                    lastReadWeightTileIdx[currAccelIdx] = weightTileIdx;
+                }
+                std::unique_ptr<volatile int> finishFlag = invokeKernelNoBlock(
+                        currAccelIdx, smv::kConvolutionHw + currAccelIdx,
+                        smv_depthwise_conv_nhwc_vec_fxp,
+                        inputTile->data<float16>(),
+                        weightsTile->data<float16>(),
+                        outputTile->data<float16>(),
+                        smv::accelSpads[currAccelIdx].spad0,
+                        smv::accelSpads[currAccelIdx].spad1,
+                        smv::accelSpads[currAccelIdx].spad2, inputDims,
+                        weightsDims, outputDims, inputShape.getPadding(3),
+                        weightsShape.getPadding(3), outputShape.getPadding(3),
+                        inputHaloPad, getRowStride(), getColStride(),
+                        readInputs, readWeights, actInfo.function,
+                        actInfo.params, &sampling);
+                accelPool.addFinishFlag(currAccelIdx, std::move(finishFlag));
+                pipeline.writeBack(outputs, outputTileIdx);
+                currAccelIdx =
+                        accelPool.getNextAvailableAccelerator(currAccelIdx);
+            }
+        }
+    }
+    // Before we leave, make sure all the accelerators have finished.
+    accelPool.joinAll();
+}
+
+void SmvDepthwiseConvolutionOp::tile() {
+    // This function will tile (if necessary) the input/weight/output tensors
+    // of the depthwise convolution operator into smaller tensor tiles so that
+    // each tile can fit in the corresponding scratchpad of the accelerator.
+    tiledTensors = smaug::smv::dwconv::TilingOptimizer::doTiling(this);
+}
+
+void SmvDepthwiseConvolutionOp::run() {
+    auto input = getInput(Inputs);
+    auto kernels = getInput(Kernels);
+    auto output = getOutput(Outputs);
+    const TensorShape& inputShape = input->getShape();
+    const TensorShape& kernelShape = kernels->getShape();
+    const TensorShape& outputShape = output->getShape();
+    assert(inputShape.getLayout() == DataLayout::NHWC);
+    assert(kernelShape.getLayout() == DataLayout::NHWC);
+    assert(outputShape.getLayout() == DataLayout::NHWC);
+    dout(2) << *kernels << "\n";
+
+    SmvTilePipeline pipeline;
+    {
+        auto stats = gem5::ScopedStats(
+                stats::kTensorPrepStart, stats::kTensorPrepEnd);
+        pipeline.prepare(tiledTensors[0]);
+        pipeline.prepare(tiledTensors[1]);
+    }
+
+    runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2], pipeline);
+
+    {
+        auto stats = gem5::ScopedStats(
+                stats::kTensorFinalStart, stats::kTensorFinalEnd);
+        pipeline.finalize(tiledTensors[2]);
+    }
+}
+
+}  // namespace smaug
@@ -0,0 +1,59 @@
+#ifndef _OPERATORS_SMV_SMV_DEPTHWISE_CONVOLUTION_OP_H_
+#define _OPERATORS_SMV_SMV_DEPTHWISE_CONVOLUTION_OP_H_
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/depthwise_convolution_op.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
+
+namespace smaug {
+
+namespace smv {
+/** Contains depthwise convolution implementations and tiling optimizers for
+ * SMV. */
+namespace dwconv {
+
+extern const int kVectorSize;
+
+class TilingOptimizer;
+
+}  // namespace dwconv
+}  // namespace smv
+
+/**
+ * SMV backend implementation of depthwise convolution.
+ *
+ * Every channel is convolved with its own filter, so unlike
+ * SmvConvolutionOp, no tile depends on another: the inputs, weights and
+ * outputs are tiled along the same channels, and every tile is an independent
+ * kernel invocation that can run on any accelerator.
+ */
+class SmvDepthwiseConvolutionOp
+        : public DepthwiseConvolutionOp<SmvBackend> {
+   public:
+    using DepthwiseConvolutionOp<SmvBackend>::DepthwiseConvolutionOp;
+    void tile() override;
+    void run() override;
+    TiledTensor* getTiledInput(int index) override {
+        return index == Inputs ? &tiledTensors[0] : nullptr;
+    }
+    TiledTensor* getTiledOutput(int index) override {
+        return index == Outputs ? &tiledTensors[2] : nullptr;
+    }
+    friend class smv::dwconv::TilingOptimizer;
+
+   protected:
+    /**
+     * Tiling scheduler for this operator.
+     */
+    void runNHWC(TiledTensor& inputs,
+                 TiledTensor& weights,
+                 TiledTensor& outputs,
+                 SmvTilePipeline& pipeline);
+
+    std::array<TiledTensor, 3> tiledTensors;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,135 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/operators/reorder_op.h"
+#include "smaug/operators/ref/ref_activation_fun_op.h"
+#include "smaug/operators/smv/smv_test_common.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_op.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_tiling.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class SmvDepthwiseConvolutionOpTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    Tensor* reorder(Tensor* tensor, DataLayout targetLayout) {
+        auto reorderOp = new ReorderOp<ReferenceBackend>(
+                tensor->getName() + "/reorder", workspace());
+        reorderOp->setTargetLayout(targetLayout);
+        reorderOp->setInput(tensor, 0);
+        reorderOp->createAllTensors();
+        reorderOp->getOutput(0)->allocateStorage<float>();
+        reorderOp->run();
+        return reorderOp->getOutput(0);
+    }
+
+    Tensor* getReferenceOutput(SmvDepthwiseConvolutionOp* convOp) {
+        auto input = convOp->getInput(0);
+        auto kernels = convOp->getInput(1);
+        auto input32 = convertFp16ToFp32Tensor(input, workspace());
+        auto kernels32 = convertFp16ToFp32Tensor(kernels, workspace());
+
+        // The reference depthwise convolution operator only supports NCHW.
+        auto refConvOp = new DepthwiseConvolutionOp<ReferenceBackend>(
+                "ref_conv", workspace());
+        refConvOp->setPadding(convOp->getPadding());
+        refConvOp->setWeightDims(
+                convOp->getWeightRows(), convOp->getWeightCols(), 1);
+        refConvOp->setStride(convOp->getRowStride(), convOp->getColStride());
+        refConvOp->setInput(reorder(input32, NCHW), 0);
+        refConvOp->setInput(reorder(kernels32, NCHW), 1);
+        refConvOp->createAllTensors();
+        refConvOp->getOutput(0)->allocateStorage<float>();
+        refConvOp->run();
+        Tensor* output = reorder(refConvOp->getOutput(0), NHWC);
+        // Nor does it fuse activation functions.
+        ActivationInfo actInfo = convOp->getActivation();
+        if (actInfo.function != NO_ACTIVATION) {
+            float* data = output->data<float>();
+            activation_fun(data, data, output->getShape().storageSize(),
+                           actInfo.function, actInfo.params);
+        }
+        return convertFp32ToFp16Tensor(output, workspace());
+    }
+
+    void doTest(std::vector<int> inputDims,
+                std::vector<int> kernelDims,
+                PaddingType padding = SamePadding,
+                std::vector<int> strides = { 1, 1 },
+                ActivationInfo actInfo = ActivationInfo()) {
+        auto convOp = new SmvDepthwiseConvolutionOp("conv", workspace());
+        convOp->setActivation(actInfo);
+        convOp->setStride(strides[0], strides[1]);
+        convOp->setPadding(padding);
+        TensorShape inputShape(inputDims, NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("input", inputShape);
+        inputs->allocateStorage<float16>();
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(kernelDims[0], kernelDims[1], 1);
+        createAndFillTensorsWithData<float16>(convOp, fillTensorWithRandomData);
+        convOp->tile();
+        convOp->run();
+        auto outputs = convOp->getOutput(0);
+        auto refOutputs = getReferenceOutput(convOp);
+        verifyOutputs<float16>(outputs, refOutputs);
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(SmvDepthwiseConvolutionOpTest,
+                 "SMV Tiled Depthwise Convolution",
+                 "[smvconv]") {
+    SECTION("No tiling required") {
+        SECTION("Same padding") { doTest({ 1, 8, 8, 8 }, { 3, 3 }); }
+        SECTION("Valid padding") {
+            doTest({ 1, 8, 8, 8 }, { 3, 3 }, ValidPadding);
+        }
+        SECTION("Channels not a multiple of the vector size") {
+            doTest({ 1, 8, 8, 13 }, { 3, 3 });
+        }
+    }
+    SECTION("DimN tiled depthwise convolution") {
+        doTest({ 2, 32, 32, 32 }, { 3, 3 });
+    }
+    SECTION("DimNC tiled depthwise convolution") {
+        SECTION("Same padding") { doTest({ 1, 32, 32, 64 }, { 3, 3 }); }
+        SECTION("Valid padding") {
+            doTest({ 1, 32, 32, 64 }, { 3, 3 }, ValidPadding);
+        }
+    }
+    SECTION("DimNH tiled depthwise convolution") {
+        SECTION("3x3 kernel size") { doTest({ 1, 96, 96, 8 }, { 3, 3 }); }
+        SECTION("5x5 kernel size") { doTest({ 1, 96, 96, 8 }, { 5, 5 }); }
+        SECTION("Valid padding") {
+            doTest({ 1, 96, 96, 8 }, { 3, 3 }, ValidPadding);
+        }
+        SECTION("Stride 2") {
+            doTest({ 1, 96, 96, 8 }, { 3, 3 }, SamePadding, { 2, 2 });
+            doTest({ 1, 96, 96, 8 }, { 3, 3 }, ValidPadding, { 2, 2 });
+        }
+    }
+    SECTION("DimNCH tiled depthwise convolution") {
+        doTest({ 1, 64, 256, 64 }, { 3, 3 });
+    }
+    SECTION("Fused activation") {
+        doTest({ 1, 32, 32, 64 }, { 3, 3 }, SamePadding, { 1, 1 },
+               ActivationInfo(activation_type::ELU));
+    }
+}
+
+TEST_CASE_METHOD(SmvDepthwiseConvolutionOpTest,
+                 "SMV Tiled Depthwise Convolution on multiple accelerators",
+                 "[smvconv]") {
+    numAcceleratorsAvailable = 4;
+    SECTION("DimNC tiling") { doTest({ 1, 32, 32, 64 }, { 3, 3 }); }
+    SECTION("DimNH tiling") {
+        doTest({ 1, 96, 96, 8 }, { 3, 3 }, SamePadding, { 2, 2 });
+    }
+    SECTION("DimNCH tiling") { doTest({ 1, 64, 256, 64 }, { 3, 3 }); }
+}
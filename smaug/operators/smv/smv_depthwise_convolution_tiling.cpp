@@ -0,0 +1,190 @@
+#include <algorithm>
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_op.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_tiling.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+namespace smv {
+namespace dwconv {
+
+std::array<TilingDims, 3> TilingOptimizer::determineBestTilingDims(
+        Tensor* inputs, Tensor* weights, int maxTileSize) {
+    // The weights follow the channelwise tiling of the inputs, and the
+    // outputs follow all the tiling of the inputs, so only the inputs have a
+    // choice.
+    TilingDims bestInputTilingDims =
+            findBestTilingDims(inputs->getShape(),
+                               maxTileSize,
+                               { 1, weights->getShape()[1],
+                                 inputs->getShape()[2], kVectorSize });
+    // If the weights don't fit in the scratchpad, which takes many channels
+    // with large filters, the inputs need to be tiled channelwise as well.
+    if (weights->getShape().storageSize() > maxTileSize &&
+        !needsCwiseTiling(bestInputTilingDims)) {
+        bestInputTilingDims =
+                needsHwiseTiling(bestInputTilingDims) ? DimNCH : DimNC;
+    }
+    TilingDims bestWeightTilingDims =
+            needsCwiseTiling(bestInputTilingDims) ? DimNC : None;
+    return { bestInputTilingDims, bestWeightTilingDims, bestInputTilingDims };
+}
+
+TilingConfig TilingOptimizer::computeBasicTileShapes(
+        SmvDepthwiseConvolutionOp* op) {
+    Tensor* inputs = op->getInput(op->Inputs);
+    Tensor* weights = op->getInput(op->Kernels);
+    Tensor* outputs = op->getOutput(op->Outputs);
+    int maxTileSize = SmvBackend::SpadSize() / inputs->getDataTypeSize();
+    std::array<TilingDims, 3> strategies =
+            determineBestTilingDims(inputs, weights, maxTileSize);
+    TilingDims inputTilingDims = strategies[0];
+    TilingDims weightTilingDims = strategies[1];
+    TilingDims outputTilingDims = strategies[2];
+
+    dout(2) << "  Tiling dimensions chosen:\n"
+            << "    input: " << inputTilingDims
+            << ", weight: " << weightTilingDims
+            << ", output: " << outputTilingDims << "\n";
+
+    TensorShape inputsShape = inputs->getShape();
+    TensorShape weightsShape = weights->getShape();
+    TensorShape outputsShape = outputs->getShape();
+
+    // There are three degrees of freedom: N (batch), H (rows) and C
+    // (channels). Enumerate all the input tile shapes that fit, and derive
+    // the weight and output tile shapes from each of them.
+    std::vector<TensorShape> inputConfigs;
+    if (inputTilingDims == DimN) {
+        std::vector<int> minShape = inputsShape.dims();
+        minShape[0] = 1;
+        enum4DTensorTilingConfigs(inputsShape,
+                                  maxTileSize,
+                                  minShape,
+                                  { 1, 1, 1, 1 },
+                                  inputConfigs);
+    } else if (inputTilingDims == DimNC) {
+        std::vector<int> minShape = inputsShape.dims();
+        minShape[0] = 1;
+        minShape[3] = kVectorSize;
+        enum4DTensorTilingConfigs(inputsShape,
+                                  maxTileSize,
+                                  minShape,
+                                  { 1, 1, 1, kVectorSize },
+                                  inputConfigs);
+    } else if (inputTilingDims == DimNH) {
+        std::vector<int> minShape = inputsShape.dims();
+        minShape[0] = 1;
+        minShape[1] = weightsShape[1];
+        enum4DTensorTilingConfigs(inputsShape,
+                                  maxTileSize,
+                                  minShape,
+                                  { 1, op->getRowStride(), 1, 1 },
+                                  inputConfigs);
+    } else if (inputTilingDims == DimNCH) {
+        std::vector<int> minShape = { 1, weightsShape[1], inputsShape[2],
+                                      kVectorSize };
+        std::vector<int> strides = { 1, op->getRowStride(), 1, kVectorSize };
+        enum4DTensorTilingConfigs(
+                inputsShape, maxTileSize, minShape, strides, inputConfigs);
+    } else {
+        inputConfigs.push_back(inputsShape);
+    }
+    assert(!inputConfigs.empty() && "No tiling configurations found!");
+
+    std::vector<TilingConfig> fullConfigs;
+    for (auto it = inputConfigs.begin(); it != inputConfigs.end(); ++it) {
+        TilingConfig config(*it, weightsShape, outputsShape);
+        if (needsCwiseTiling(inputTilingDims))
+            config.weights[3] = config.inputs[3];
+        config.outputs[0] = config.inputs[0];
+        config.outputs[3] = config.inputs[3];
+        if (needsHwiseTiling(outputTilingDims)) {
+            int padding = op->getPadding() == SamePadding
+                                  ? FRAC_CEIL(weightsShape[1] - 1, 2)
+                                  : 0;
+            config.outputs[1] = op->computeOutputDim(config.inputs[1],
+                                                     weightsShape[1],
+                                                     op->getRowStride(),
+                                                     padding);
+        }
+        if (config.weights.storageSize() <= maxTileSize &&
+            config.outputs.storageSize() <= maxTileSize) {
+            fullConfigs.push_back(config);
+        }
+    }
+    dout(2) << "  Number of possible tiling configs: " << fullConfigs.size()
+            << "\n";
+    for (auto& config : fullConfigs)
+        dout(2) << "    " << config << "\n";
+    auto maxIt = std::max_element(
+            fullConfigs.begin(),
+            fullConfigs.end(),
+            [](const TilingConfig& c1, const TilingConfig& c2) {
+                return c1.getTotalSize() < c2.getTotalSize();
+            });
+    assert(maxIt != fullConfigs.end() && "Failed to get best tiling config!");
+    // Fill in the tiling dims.
+    maxIt->inputTilingDims = inputTilingDims;
+    maxIt->weightTilingDims = weightTilingDims;
+    maxIt->outputTilingDims = outputTilingDims;
+    return *maxIt;
+}
+
+TiledTensor TilingOptimizer::generateRowwiseOutputTiledTensor(
+        SmvDepthwiseConvolutionOp* op,
+        const TiledTensor& inputTiledTensor,
+        const TensorShape& maxOutputTileSize,
+        Tensor* outputTensor,
+        bool copyData) {
+    // Every output channel is produced from the same input channel.
+    std::vector<int> outputChans;
+    auto inputIndex = inputTiledTensor.startIndex();
+    for (int c = 0; c < inputTiledTensor.getShape()[3]; c++) {
+        outputChans.push_back(
+                inputTiledTensor[inputIndex(0, 0, 0, c)]->getShape()[3]);
+    }
+    return generateRowwiseConvOutputTiledTensor(op,
+                                                inputTiledTensor,
+                                                outputChans,
+                                                maxOutputTileSize,
+                                                outputTensor,
+                                                copyData);
+}
+
+std::array<TiledTensor, 3> TilingOptimizer::doTiling(
+        SmvDepthwiseConvolutionOp* op) {
+    auto input = op->getInput(SmvDepthwiseConvolutionOp::Inputs);
+    auto kernels = op->getInput(SmvDepthwiseConvolutionOp::Kernels);
+    auto output = op->getOutput(SmvDepthwiseConvolutionOp::Outputs);
+    TilingConfig tileConfig = getCachedTileShapes(
+            op,
+            { op->getRowStride(), op->getColStride(), op->getPadding() },
+            [op]() { return TilingOptimizer::computeBasicTileShapes(op); });
+    TiledTensor tiledInputs =
+            generateTiledTensorWithStrideAndPadding(input,
+                                                    tileConfig.inputs,
+                                                    op,
+                                                    op->getWeightRows(),
+                                                    op->getWeightCols(),
+                                                    op->getRowStride(),
+                                                    op->getColStride(),
+                                                    op->getPadding());
+    // Copy data for the weight tiles since the data is read-only.
+    TiledTensor tiledWeights = generateTiledTensor(
+            kernels, tileConfig.weights, op, /* copyData */ true);
+    TiledTensor tiledOutputs;
+    if (needsHwiseTiling(tileConfig.outputTilingDims)) {
+        tiledOutputs = TilingOptimizer::generateRowwiseOutputTiledTensor(
+                op, tiledInputs, tileConfig.outputs, output, false);
+    } else {
+        tiledOutputs = generateTiledTensor(output, tileConfig.outputs, op);
+    }
+    return { tiledInputs, tiledWeights, tiledOutputs };
+}
+
+}  // namespace dwconv
+}  // namespace smv
+}  // namespace smaug
@@ -0,0 +1,73 @@
+#ifndef _OPERATORS_SMV_SMV_DEPTHWISE_CONVOLUTION_TILING_H_
+#define _OPERATORS_SMV_SMV_DEPTHWISE_CONVOLUTION_TILING_H_
+
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/smv/smv_tiling_common.h"
+#include "smaug/operators/smv/smv_tiling_base.h"
+
+namespace smaug {
+
+class SmvDepthwiseConvolutionOp;
+
+namespace smv {
+namespace dwconv {
+
+/**
+ * Tiling optimizer for SMV depthwise convolution kernel.
+ */
+class TilingOptimizer : public TilingOptimizerBase {
+   public:
+    static std::array<TiledTensor, 3> doTiling(SmvDepthwiseConvolutionOp* op);
+
+    /**
+     * Determine the best basic tiling shape for this depthwise convolution
+     * layer.
+     *
+     * Only the input tile shape is free: since every output channel only
+     * depends on the same input channel, the weight tiles take the channels of
+     * the input tiles, and the output tiles take the batch and channels of the
+     * input tiles as well as the rows that the input tile produces. The
+     * enumerated input tile shape that maximizes the total combined size of
+     * input, weight and output tiles is chosen as the best.
+     *
+     * Channels are enumerated in multiples of kVectorSize, and rows in
+     * multiples of the row stride.
+     *
+     * @param op The SMV depthwise convolution operator. All tensors must have
+     * been created with createAllTensors() prior to calling this function.
+     * @returns The TilingConfig that describes the best tiling shapes.
+     */
+    static TilingConfig computeBasicTileShapes(SmvDepthwiseConvolutionOp* op);
+
+    /**
+     * Generates the output tiles when the inputs are tiled rowwise. The first
+     * and last input tiles include the zero-padding, so their output tiles
+     * can have a different number of rows from the others.
+     */
+    static TiledTensor generateRowwiseOutputTiledTensor(
+            SmvDepthwiseConvolutionOp* op,
+            const TiledTensor& inputTiledTensor,
+            const TensorShape& maxOutputTileSize,
+            Tensor* outputTensor,
+            bool copyData = false);
+
+   protected:
+    /**
+     * Determine the best tiling dimensions for running depthwise convolution
+     * on SMV. The weights are tiled channelwise if and only if the inputs
+     * are, and the outputs are tiled along the same dimensions as the inputs.
+     *
+     * @returns A 3-element array of TilingDims enums (inputs, weights,
+     * outputs).
+     */
+    static std::array<TilingDims, 3> determineBestTilingDims(Tensor* inputs,
+                                                             Tensor* weights,
+                                                             int maxTileSize);
+};
+
+}  // namespace dwconv
+}  // namespace smv
+}  // namespace smaug
+
+#endif
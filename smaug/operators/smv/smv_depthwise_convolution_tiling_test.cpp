@@ -0,0 +1,108 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_op.h"
+#include "smaug/operators/smv/smv_depthwise_convolution_tiling.h"
+#include "smaug/operators/smv/smv_test_common.h"
+
+using namespace smaug;
+
+TEST_CASE_METHOD(SmaugTest,
+                 "SMV depthwise convolution tiling tests",
+                 "[smvtiling]") {
+    using namespace smaug::smv;
+    using namespace smaug::smv::dwconv;
+    auto convOp = new SmvDepthwiseConvolutionOp("conv", workspace());
+    convOp->setStride(1, 1);
+    convOp->setPadding(SamePadding);
+    convOp->setWeightDims(3, 3, 1);
+
+    SECTION("No tiling needed") {
+        TensorShape inputShape(
+                { 1, 8, 8, 8 }, DataLayout::NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(convOp);
+        REQUIRE(config.inputs == inputShape);
+        REQUIRE(config.weights.dims() == std::vector<int>{ 1, 3, 3, 8 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 8, 8, 8 });
+    }
+
+    SECTION("DimNC tiling") {
+        // Inputs, weights and outputs tiled into 4 channelwise tiles.
+        TensorShape inputShape(
+                { 1, 32, 32, 64 }, DataLayout::NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(convOp);
+        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 32, 32, 16 });
+        REQUIRE(config.weights.dims() == std::vector<int>{ 1, 3, 3, 16 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 32, 32, 16 });
+
+        SECTION("Generated tiles have correct shape and data") {
+            fillTensorWithFixedData(inputs);
+            auto tiledTensors = TilingOptimizer::doTiling(convOp);
+            REQUIRE(tiledTensors[0].size() == 4);
+            REQUIRE(tiledTensors[1].size() == 4);
+            REQUIRE(tiledTensors[2].size() == 4);
+            tiledTensors[0].copyDataToAllTiles();
+            for (auto i = tiledTensors[0].startIndex(); !i.end(); ++i) {
+                REQUIRE(tiledTensors[0][i]->getShape().dims() ==
+                        config.inputs.dims());
+                verifyTensorWithFixedData(tiledTensors[0][i], 16 * i);
+            }
+            for (auto i = tiledTensors[2].startIndex(); !i.end(); ++i) {
+                REQUIRE(tiledTensors[2][i]->getShape().dims() ==
+                        config.outputs.dims());
+            }
+        }
+    }
+
+    SECTION("DimNH tiling") {
+        TensorShape inputShape(
+                { 1, 96, 96, 8 }, DataLayout::NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(convOp);
+        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 21, 96, 8 });
+        REQUIRE(config.weights.dims() == std::vector<int>{ 1, 3, 3, 8 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 20, 96, 8 });
+
+        SECTION("Output tiles cover every output row once") {
+            auto tiledTensors = TilingOptimizer::doTiling(convOp);
+            REQUIRE(tiledTensors[1].size() == 1);
+            int outputRows = 0;
+            for (auto i = tiledTensors[2].startIndex(); !i.end(); ++i) {
+                const TensorShape& shape = tiledTensors[2][i]->getShape();
+                REQUIRE(shape.storageSize() <= config.outputs.storageSize());
+                outputRows += shape[1];
+            }
+            REQUIRE(tiledTensors[2].size() == tiledTensors[0].size());
+            REQUIRE(outputRows == 96);
+        }
+    }
+
+    SECTION("DimNCH tiling") {
+        TensorShape inputShape(
+                { 1, 64, 256, 64 }, DataLayout::NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(convOp);
+        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 8, 256, 8 });
+        REQUIRE(config.weights.dims() == std::vector<int>{ 1, 3, 3, 8 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 7, 256, 8 });
+    }
+}
@@ -41,7 +41,8 @@ void SmvEltwiseAddOp::runX(TiledTensor& inputs0,
         invokeKernel(smv::kEltwiseOpHw, smv_eltwise_add_nc_vec_fxp,
                      input0Tile->data<float16>(), input1Tile->data<float16>(),
                      outputTile->data<float16>(), smv::spad0, smv::spad1,
-                     smv::spad2, inputShape.storageSize());
+                     smv::spad2, inputShape.storageSize(), actInfo.function,
+                     actInfo.params);
     }
 }
 
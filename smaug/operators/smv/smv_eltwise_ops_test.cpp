@@ -17,7 +17,9 @@ class SmvEltwiseOpsTest : public SmaugTest {
     using SmaugTest::SmaugTest;
 
     // A reference operator is used to get the 'correct' output.
-    Tensor* getReferenceOutput(Operator* eltOp, OpType opType) {
+    Tensor* getReferenceOutput(Operator* eltOp,
+                               OpType opType,
+                               ActivationInfo actInfo) {
         auto inputs0 = eltOp->getInput(0);
         auto inputs1 = eltOp->getInput(1);
         auto inputs0Fp32 = convertFp16ToFp32Tensor(inputs0, workspace());
@@ -29,6 +31,8 @@ class SmvEltwiseOpsTest : public SmaugTest {
           case EltwiseAdd:
               refEltOp = new EltwiseAddOp<ReferenceBackend>(
                       "ref_eltwise_add", workspace());
+              dynamic_cast<EltwiseAddOp<ReferenceBackend>*>(refEltOp)
+                      ->setActivation(actInfo);
               boolOutput = false;
               break;
           case EltwiseMul:
@@ -68,12 +72,15 @@ class SmvEltwiseOpsTest : public SmaugTest {
             return convertFp32ToFp16Tensor(refEltOp->getOutput(0), workspace());
     }
 
-    void doSingleTest(const std::vector<int>& dims, OpType opType) {
+    void doSingleTest(const std::vector<int>& dims,
+                      OpType opType,
+                      ActivationInfo actInfo = ActivationInfo()) {
         Operator* eltOp;
         bool boolOutput = true;
         switch (opType) {
             case EltwiseAdd:
                 eltOp = new SmvEltwiseAddOp("eltwise_add", workspace());
+                dynamic_cast<SmvEltwiseAddOp*>(eltOp)->setActivation(actInfo);
                 boolOutput = false;
                 break;
             case EltwiseMul:
@@ -117,7 +124,7 @@ class SmvEltwiseOpsTest : public SmaugTest {
         eltOp->tile();
         eltOp->run();
         auto outputs = eltOp->getOutput(0);
-        auto refOutputs = getReferenceOutput(eltOp, opType);
+        auto refOutputs = getReferenceOutput(eltOp, opType, actInfo);
         if (boolOutput)
             verifyOutputs<bool>(outputs, refOutputs);
         else
@@ -148,3 +155,15 @@ TEST_CASE_METHOD(SmvEltwiseOpsTest, "SMV Tiled 2D Eltwise Ops", "[smveltops]") {
     SECTION("DimNC tiling") { doTest({ 1, 32768 }); }
 }
 
+TEST_CASE_METHOD(SmvEltwiseOpsTest,
+                 "SMV Eltwise Add with fused activation",
+                 "[smveltops]") {
+    SECTION("ReLU") {
+        doSingleTest({ 1, 8, 8, 8 }, EltwiseAdd,
+                     ActivationInfo(activation_type::RELU));
+    }
+    SECTION("ELU with DimNC tiling") {
+        doSingleTest({ 1, 32, 32, 32 }, EltwiseAdd,
+                     ActivationInfo(activation_type::ELU));
+    }
+}
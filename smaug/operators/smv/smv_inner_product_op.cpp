@@ -24,19 +24,23 @@ const int kNumMaccsPerPE = 32;
 // 3) A: activation-wise tiles in the inputs/weights.
 void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                                TiledTensor& weights,
-                               TiledTensor& outputs) {
-    // Ordinarily, we don't need to tile the outputs. If this fails, it means
-    // the inner product has uncommonly large outputs, let's add the output
-    // iteration when that happens.
-    assert(outputs.size() == 1 &&
-           "Inner product outputs tiling not implemented yet!");
+                               TiledTensor& outputs,
+                               SmvTilePipeline& pipeline) {
     int inputNumTiles = inputs.getShape()[0];
     int inputActTiles = inputs.getShape()[1];
     int weightActTiles = weights.getShape()[1];
     int weightNeuronTiles = weights.getShape()[0];
+    // The outputs are tiled like the batches of the inputs and the neurons of
+    // the weights, so every weight neuron tile has its own output tile.
+    assert(outputs.getShape()[0] == inputNumTiles &&
+           outputs.getShape()[1] == weightNeuronTiles &&
+           "Output tiles don't match the input and weight tiles!");
     auto inputIdx = inputs.startIndex();
     auto weightIdx = weights.startIndex();
     auto outputIdx = outputs.startIndex();
+    // A batch norm folded into the weights leaves a per-neuron bias, which the
+    // kernel adds to every output tile before sending it back.
+    float16* bias = getBias() ? getBias()->data<float16>() : nullptr;
     for (int i = 0; i < numAcceleratorsAvailable; i++) {
         setArrayMemTypeIfSimulating(
                 smv::kInnerProductHw + i, "host_a", getInputsMemType());
@@ -44,27 +48,35 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                 smv::kInnerProductHw + i, "host_b", getWeightsMemType());
         setArrayMemTypeIfSimulating(
                 smv::kInnerProductHw + i, "host_results", getOutputsMemType());
+        if (bias) {
+            setArrayMemTypeIfSimulating(
+                    smv::kInnerProductHw + i, "host_bias", getWeightsMemType());
+        }
     }
     SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
     std::vector<int> lastReadInputTileIdx(numAcceleratorsAvailable, -1);
     int currAccelIdx = 0;
     for (int N = 0; N < inputNumTiles; N++) {
-        // Usually we are constrained by weights whereas outputs can fit in the
-        // scratchpad. This keeps track of finished neurons and will be used by
-        // the kernel for correct offset in the outputs scratchpad.
-        int finishedNeurons = 0;
+        // The first neuron of the output tile.
+        int neuronStart = 0;
         for (int W = 0; W < weightNeuronTiles; W++) {
             // Up to this point, the loop nests do not have data dependency
             // among themselves, and therefore we can run them in parallel. The
             // loop nests beyond this level will need to run in serial, because
             // the input/weight channelwise tiles iteration accumulate results
             // to the same output tile.
-            int outputTileIdx = outputIdx(N, 0);
+            int outputTileIdx = outputIdx(N, W);
             Tensor* outputTile = outputs[outputTileIdx];
             const TensorShape& outputShape = outputTile->getShape();
             mapArrayToAccel(smv::kInnerProductHw + currAccelIdx, "host_results",
                             outputTile->data<float16>(),
                             outputShape.storageSize() * sizeof(float16));
+            float16* outputBias = bias ? bias + neuronStart : nullptr;
+            if (outputBias) {
+                mapArrayToAccel(smv::kInnerProductHw + currAccelIdx,
+                                "host_bias", outputBias,
+                                outputShape.getStorageDim(1) * sizeof(float16));
+            }
             int iC = 0, wC = 0;
             // This keeps track of the activation offset of the inputs.
             int actOffset = 0;
@@ -80,8 +92,10 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                 dout(1) << "Input: " << inputTileIdx
                         << ", weights: " << weightTileIdx
                         << ", output: " << outputTileIdx << "\n";
-                Tensor* inputTile = inputs.getTileWithData(inputTileIdx);
-                Tensor* weightsTile = weights.getTileWithData(weightTileIdx);
+                Tensor* inputTile =
+                        pipeline.getTileWithData(inputs, inputTileIdx);
+                Tensor* weightsTile =
+                        pipeline.getTileWithData(weights, weightTileIdx);
                 const TensorShape& inputShape = inputTile->getShape();
                 const TensorShape& weightsShape = weightsTile->getShape();
                 mapArrayToAccel(smv::kInnerProductHw + currAccelIdx, "host_a",
@@ -109,20 +123,21 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                     lastReadInputTileIdx[currAccelIdx] = inputTileIdx;
                 }
                 // We only need to send the results back to host memory in the
-                // very last invocation.
-                bool sendOutputs = (N == inputNumTiles - 1) &&
-                                   (W == weightNeuronTiles - 1) &&
-                                   (wC == weightActTiles - 1);
+                // last invocation of this output tile.
+                bool sendOutputs = wC == weightActTiles - 1;
 
                 std::unique_ptr<volatile int> finishFlag = invokeKernelNoBlock(
                         currAccelIdx, smv::kInnerProductHw + currAccelIdx,
                         smv_matrix_multiply_transpose_nc_vec_fxp,
                         inputTile->data<float16>(),
                         weightsTile->data<float16>(),
-                        outputTile->data<float16>(), smv::spad0, smv::spad1,
-                        smv::spad2, inputDims, weightsDims, outputDims,
+                        outputTile->data<float16>(), outputBias,
+                        smv::accelSpads[currAccelIdx].spad0,
+                        smv::accelSpads[currAccelIdx].spad1,
+                        smv::accelSpads[currAccelIdx].spad2, inputDims,
+                        weightsDims, outputDims,
                         inputShape.getPadding(1), weightsShape.getPadding(1),
-                        outputShape.getPadding(1), actStart, finishedNeurons,
+                        outputShape.getPadding(1), actStart, 0,
                         accumulate, readInputs, sendOutputs, actInfo.function,
                         actInfo.params, &sampling);
                 accelPool.addFinishFlag(currAccelIdx, std::move(finishFlag));
@@ -139,7 +154,8 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                                     "don't need activation-wise tiling.");
                 }
             }
-            finishedNeurons += weights[weightIdx(W, 0)]->getShape()[0];
+            pipeline.writeBack(outputs, outputTileIdx);
+            neuronStart += outputShape[1];
             currAccelIdx = accelPool.getNextAvailableAccelerator(currAccelIdx);
         }
     }
@@ -166,19 +182,20 @@ void SmvInnerProductOp::run() {
     assert(outputsShape.getLayout() == DataLayout::NC);
     dout(2) << *weights << "\n";
 
+    SmvTilePipeline pipeline;
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorPrepStart, stats::kTensorPrepEnd);
-        tiledTensors[0].copyDataToAllTiles();
-        tiledTensors[1].copyDataToAllTiles();
+        pipeline.prepare(tiledTensors[0]);
+        pipeline.prepare(tiledTensors[1]);
     }
 
-    runNWA(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    runNWA(tiledTensors[0], tiledTensors[1], tiledTensors[2], pipeline);
 
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorFinalStart, stats::kTensorFinalEnd);
-        tiledTensors[2].untile();
+        pipeline.finalize(tiledTensors[2]);
     }
 }
 
@@ -4,6 +4,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
 
 namespace smaug {
 
@@ -33,7 +34,10 @@ class SmvInnerProductOp : public InnerProductOp<SmvBackend> {
     friend class smv::fc::TilingOptimizer;
 
   protected:
-   void runNWA(TiledTensor& inputs, TiledTensor& weights, TiledTensor& outputs);
+   void runNWA(TiledTensor& inputs,
+               TiledTensor& weights,
+               TiledTensor& outputs,
+               SmvTilePipeline& pipeline);
 
    std::array<TiledTensor, 3> tiledTensors;
 };
@@ -28,6 +28,10 @@ class SmvInnerProductOpTest : public SmaugTest {
         refFcOp->setInput(input32, 0);
         refFcOp->setInput(weights32, 1);
         refFcOp->setNumOutputs(fcOp->getNumOutputs());
+        if (fcOp->getBias()) {
+            refFcOp->setBias(
+                    convertFp16ToFp32Tensor(fcOp->getBias(), workspace()));
+        }
         refFcOp->createAllTensors();
         refFcOp->getOutput(0)->allocateStorage<float>();
         refFcOp->run();
@@ -73,6 +77,26 @@ class SmvInnerProductOpTest : public SmaugTest {
         auto refOutputs = getReferenceOutput(fcOp);
         verifyOutputs<float16>(outputs, refOutputs);
     }
+
+    // Runs an inner product with the bias of a folded batch norm and a ReLU.
+    void doBiasTest(std::vector<int> inputDims, int numNeurons) {
+        auto fcOp = new SmvInnerProductOp("fc", workspace());
+        fcOp->setActivation(ActivationInfo(activation_type::RELU));
+        TensorShape inputShape(
+                inputDims, DataLayout::NC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("input", inputShape);
+        workspace()->addTensor(inputs);
+        fcOp->setInput(inputs, 0);
+        fcOp->setNumOutputs(numNeurons);
+        inputs->allocateStorage<float16>();
+        createAndFillTensorsWithData<float16>(fcOp, fillTensorWithRandomData);
+        fcOp->setBias(createRandomBiasTensor(numNeurons, workspace()));
+        fcOp->tile();
+        fcOp->run();
+        auto outputs = fcOp->getOutput(0);
+        auto refOutputs = getReferenceOutput(fcOp);
+        verifyOutputs<float16>(outputs, refOutputs);
+    }
 };
 
 }  // namespace smaug
@@ -98,6 +122,10 @@ TEST_CASE_METHOD(SmvInnerProductOpTest, "SMV tiled inner product", "[smvfc]") {
         // also tiled into 32 neuron-wise tiles.
         doTest({ 1, 32768 }, 256);
     }
+
+    SECTION("Batches and neurons that don't fill the register blocks") {
+        doTest({ 3, 72 }, 21);
+    }
 }
 
 TEST_CASE_METHOD(SmvInnerProductOpTest,
@@ -117,3 +145,31 @@ TEST_CASE_METHOD(SmvInnerProductOpTest,
         doFusionTest({ 1, 32768 }, 256);
     }
 }
+
+TEST_CASE_METHOD(SmvInnerProductOpTest,
+                 "SMV tiled inner product with a bias",
+                 "[smvfc]") {
+    SECTION("No tiling required") { doBiasTest({ 1, 256 }, 32); }
+
+    SECTION("DimNC tiling for weights, None for inputs") {
+        doBiasTest({ 1, 4096 }, 128);
+    }
+
+    SECTION("Batches and neurons that don't fill the register blocks") {
+        doBiasTest({ 3, 72 }, 21);
+    }
+}
+
+TEST_CASE_METHOD(SmvInnerProductOpTest,
+                 "SMV tiled inner product on multiple accelerators",
+                 "[smvfc]") {
+    numAcceleratorsAvailable = 4;
+
+    SECTION("DimNC tiling for weights, None for inputs") {
+        doTest({ 1, 4096 }, 128);
+    }
+
+    SECTION("DimNC tiling for weights and inputs") {
+        doTest({ 1, 32768 }, 256);
+    }
+}
@@ -177,37 +177,83 @@ TilingConfig TilingOptimizer::computeBasicTileShapes(SmvInnerProductOp* op) {
                 break;
         }
     }
-    dout(2) << "  Number of possible tiling configs: " << fullConfigs.size()
-            << "\n";
-    for (auto& config : fullConfigs)
-        dout(2) << "    " << config << "\n";
-    auto maxIt = std::max_element(
-            fullConfigs.begin(),
-            fullConfigs.end(),
-            [](const TilingConfig& c1, const TilingConfig& c2) {
-                return c1.getTotalSize() < c2.getTotalSize();
-            });
-    assert(maxIt != fullConfigs.end() && "Failed to get best tiling config!");
-    // Fill in the tiling dims.
-    maxIt->inputTilingDims = inputTilingDims;
-    maxIt->weightTilingDims = weightTilingDims;
-    maxIt->outputTilingDims = outputTilingDims;
-    return *maxIt;
+    for (auto& config : fullConfigs) {
+        config.inputTilingDims = inputTilingDims;
+        config.weightTilingDims = weightTilingDims;
+        config.outputTilingDims = outputTilingDims;
+    }
+    return findCheapestConfig(fullConfigs, [op](const TilingConfig& config) {
+        return estimateCost(op, config);
+    });
+}
+
+TilingCost TilingOptimizer::estimateCost(SmvInnerProductOp* op,
+                                         const TilingConfig& config) {
+    const TensorShape& inputsShape = op->getInput(op->Inputs)->getShape();
+    const TensorShape& weightsShape = op->getInput(op->Weights)->getShape();
+    const TensorShape& outputsShape = op->getOutput(op->Outputs)->getShape();
+    int inputNumTiles = FRAC_CEIL(inputsShape[0], config.inputs[0]);
+    int inputActTiles = FRAC_CEIL(inputsShape[1], config.inputs[1]);
+    int weightNeuronTiles = FRAC_CEIL(weightsShape[0], config.weights[0]);
+    int weightActTiles = FRAC_CEIL(weightsShape[1], config.weights[1]);
+    // The tiles of a tensor have roughly the same size, so the bytes of a tile
+    // are taken as the average over all the tiles.
+    int64_t inputTileBytes =
+            (int64_t)inputsShape[0] *
+            getTiledStorageSize(inputsShape[1], config.inputs[1]) *
+            sizeof(float16) / (inputNumTiles * inputActTiles);
+    int64_t weightTileBytes =
+            (int64_t)weightsShape[0] *
+            getTiledStorageSize(weightsShape[1], config.weights[1]) *
+            sizeof(float16) / (weightNeuronTiles * weightActTiles);
+    int64_t outputTileBytes =
+            (int64_t)outputsShape[0] *
+            getTiledStorageSize(outputsShape[1], config.weights[0]) *
+            sizeof(float16) / (inputNumTiles * weightNeuronTiles);
+    int64_t totalMacs = (int64_t)outputsShape.size() * weightsShape[1];
+
+    // This follows the tile iteration of SmvInnerProductOp::runNWA(). The
+    // kernel reads the weight tile in every invocation.
+    TilingCostModel model(numAcceleratorsAvailable, kNumPEs * kNumMaccsPerPE);
+    int currAccelIdx = 0;
+    for (int N = 0; N < inputNumTiles; N++) {
+        for (int W = 0; W < weightNeuronTiles; W++) {
+            int iC = 0, wC = 0;
+            while (iC < inputActTiles && wC < weightActTiles) {
+                model.invoke(currAccelIdx, N * inputActTiles + iC,
+                             inputTileBytes, W * weightActTiles + wC,
+                             weightTileBytes, /* readWeightsAlways */ true);
+                if (inputActTiles == weightActTiles)
+                    iC++;
+                wC++;
+            }
+            model.sendOutputs(outputTileBytes);
+            currAccelIdx = (currAccelIdx + 1) % numAcceleratorsAvailable;
+        }
+    }
+    return model.getCost(totalMacs);
 }
 
 std::array<TiledTensor, 3> TilingOptimizer::doTiling(SmvInnerProductOp* op) {
     auto input = op->getInput(SmvInnerProductOp::Inputs);
     auto kernels = op->getInput(SmvInnerProductOp::Weights);
     auto output = op->getOutput(SmvInnerProductOp::Outputs);
-    TilingConfig tileConfig = TilingOptimizer::computeBasicTileShapes(op);
+    TilingConfig tileConfig = getCachedTileShapes(op, {}, [op]() {
+        return TilingOptimizer::computeBasicTileShapes(op);
+    });
     TiledTensor tiledInputs =
             generateTiledTensor(input, tileConfig.inputs, op, /* copy_data*/ false);
     // Copy data for the weight tiles since the data is read-only.
     TiledTensor tiledWeights =
             generateTiledTensor(kernels, tileConfig.weights, op);
     tiledWeights.copyDataToAllTiles();
+    // Every weight neuron tile gets its own output tile, so that the neuron
+    // tiles can run on different accelerators, each sending back its own
+    // neurons.
+    TensorShape outputTileShape = tileConfig.outputs;
+    outputTileShape[1] = tileConfig.weights[0];
     TiledTensor tiledOutputs =
-            generateTiledTensor(output, tileConfig.outputs, op, /* copy_data */ false);
+            generateTiledTensor(output, outputTileShape, op, /* copy_data */ false);
     return { tiledInputs, tiledWeights, tiledOutputs };
 }
 
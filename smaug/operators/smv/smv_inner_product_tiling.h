@@ -28,8 +28,8 @@ class TilingOptimizer : public TilingOptimizerBase {
      * enumerate all possible basic tile shapes for inputs, weights, and
      * outputs. A **basic** shape is the shape that all but potentially the
      * last tile along a set of dimensions will use. This triplet of tile
-     * shapes defines a TilingConfig. The TilingConfig that maximizes the total
-     * combined size of input, weights, and output tiles is chosen as the best.
+     * shapes defines a TilingConfig. The TilingConfig with the lowest cost
+     * estimated by estimateCost() is chosen as the best.
      *
      * To limit the number of possibilities, we only enumerate each dimension
      * in certain increments. For example, input channels are only enumerated
@@ -46,6 +46,16 @@ class TilingOptimizer : public TilingOptimizerBase {
      */
     static TilingConfig computeBasicTileShapes(SmvInnerProductOp* op);
 
+    /**
+     * Estimate the cost of running this fc layer with the tiling config.
+     *
+     * The tiles are dispatched in the same order as SmvInnerProductOp does,
+     * so that an input tile reused by consecutive invocations on the same
+     * accelerator is only counted once.
+     */
+    static TilingCost estimateCost(SmvInnerProductOp* op,
+                                   const TilingConfig& config);
+
    protected:
     /**
      * Determine the best tiling dimensions for running inner product on SMV.
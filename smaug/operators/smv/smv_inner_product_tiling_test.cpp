@@ -125,32 +125,34 @@ TEST_CASE_METHOD(SmaugTest, "Basic tiling tests", "[smvtiling]") {
         fcOp->createAllTensors();
         allocateAllTensors<float16>(fcOp);
         TilingConfig config = TilingOptimizer::computeBasicTileShapes(fcOp);
-        // Inputs/weights tiled into 16 activation-wise tiles, weights further
-        // tiled into 32 neuron-wise tiles per activation-wise tile.
-        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 2048 });
-        REQUIRE(config.weights.dims() == std::vector<int>{ 8, 2048 });
+        // Inputs/weights tiled into 512 activation-wise tiles. Keeping all
+        // the neurons in one weight tile means every input tile is read only
+        // once, with the same number of invocations as tiling the weights
+        // neuron-wise.
+        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 64 });
+        REQUIRE(config.weights.dims() == std::vector<int>{ 256, 64 });
         REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 256 });
 
         SECTION("Generated tiles have correct shape and data") {
             fillTensorWithFixedData(inputs);
             TiledTensor inputTiles = generateTiledTensor(
                     inputs, config.inputs, fcOp, /* copy_data */ true);
-            REQUIRE(inputTiles.size() == 16);
+            REQUIRE(inputTiles.size() == 512);
             for (auto i = inputTiles.startIndex(); !i.end(); ++i) {
                 REQUIRE(inputTiles[i]->getShape().dims() ==
-                        std::vector<int>{ 1, 2048 });
-                verifyTensorWithFixedData(inputTiles[i], 2048 * i);
+                        std::vector<int>{ 1, 64 });
+                verifyTensorWithFixedData(inputTiles[i], 64 * i);
             }
 
             auto weights = fcOp->getInput(1);
             fillTensorWithFixedData(weights);
             TiledTensor weightTiles = generateTiledTensor(
                     weights, config.weights, fcOp, /* copy_data */ true);
-            REQUIRE(weightTiles.size() == 16 * 32);
+            REQUIRE(weightTiles.size() == 512);
             for (auto i = weightTiles.startIndex(); !i.end(); ++i) {
                 REQUIRE(weightTiles[i]->getShape().dims() ==
-                        std::vector<int>{ 8, 2048 });
-                verifyTensorWithFixedData(weightTiles[i], (i % 16) * 2048);
+                        std::vector<int>{ 256, 64 });
+                verifyTensorWithFixedData(weightTiles[i], 64 * i);
             }
 
             auto outputs = fcOp->getOutput(0);
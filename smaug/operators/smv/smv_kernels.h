@@ -10,6 +10,7 @@ extern "C" {
 void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              float16* host_weights,
                              float16* host_results,
+                             float16* host_bias,
                              float* inputs,
                              float* weights,
                              float* results,
@@ -32,9 +33,31 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              activation_param_t act_params,
                              SamplingInfo* sampling);
 
+void smv_depthwise_conv_nhwc_vec_fxp(float16* host_inputs,
+                                     float16* host_weights,
+                                     float16* host_results,
+                                     float* inputs,
+                                     float* weights,
+                                     float* results,
+                                     int inputs_dims[4],
+                                     int weights_dims[4],
+                                     int results_dims[4],
+                                     int inputs_align_pad,
+                                     int weights_pad,
+                                     int results_pad,
+                                     int inputs_halo_pad[4],
+                                     int row_stride,
+                                     int col_stride,
+                                     bool read_inputs,
+                                     bool read_weights,
+                                     activation_type act_function,
+                                     activation_param_t act_params,
+                                     SamplingInfo* sampling);
+
 void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               float16* host_b,
                                               float16* host_results,
+                                              float16* host_bias,
                                               float* a,
                                               float* b,
                                               float* results,
@@ -53,6 +76,31 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               activation_param_t act_params,
                                               SamplingInfo* sampling);
 
+void smv_lstm_cell_nc_vec_fxp(float16* host_inputs,
+                              float16* host_weights,
+                              float16* host_initial_outputs,
+                              float16* host_initial_state,
+                              float16* host_sequence,
+                              float16* host_outputs,
+                              float16* host_state,
+                              float* inputs,
+                              float* weights,
+                              float* results,
+                              int batch,
+                              int depth,
+                              int units,
+                              int weights_rows,
+                              int initial_strides[2],
+                              int gate_start,
+                              bool init_state,
+                              bool read_inputs,
+                              bool read_weights,
+                              bool finish_cell,
+                              bool send_sequence,
+                              bool send_outputs,
+                              activation_type act_function,
+                              activation_param_t act_params);
+
 void smv_maxpooling_nhwc_vec_fxp(float16* host_inputs,
                                  float16* host_results,
                                  float* inputs,
@@ -148,7 +196,9 @@ void smv_eltwise_add_nc_vec_fxp(float16* host_inputs0,
                                 float* inputs0,
                                 float* inputs1,
                                 float* results,
-                                int inputs_size);
+                                int inputs_size,
+                                activation_type act_function,
+                                activation_param_t act_params);
 
 void smv_eltwise_mul_nc_vec_fxp(float16* host_inputs0,
                                 float16* host_inputs1,
@@ -0,0 +1,257 @@
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_lstm_op.h"
+#include "smaug/operators/smv/smv_lstm_tiling.h"
+#include "smaug/operators/smv/smv_kernels.h"
+#include "smaug/operators/smv/smv_accel_pool.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+void SmvLstmOp::packWeights() {
+    Tensor* kernel = getInput(Kernel);
+    Tensor* recurrentKernel = getInput(RecurrentKernel);
+    if (packedKernelVersion == kernel->getDataVersion() &&
+        packedRecurrentKernelVersion == recurrentKernel->getDataVersion())
+        return;
+    int depth = getInput(Inputs)->getShape()[2];
+    int alignedDepth = getInput(Inputs)->getShape().getStorageDim(2);
+    int units = getNumUnits();
+    int alignedUnits = getOutput(Outputs)->getShape().getStorageDim(1);
+    int width = packedWeights->getShape()[1];
+    int wStride = kernel->getShape().getStorageDim(1);
+    int uStride = recurrentKernel->getShape().getStorageDim(1);
+    const float16* w = kernel->data<float16>();
+    const float16* u = recurrentKernel->data<float16>();
+    float16* packed = packedWeights->data<float16>();
+    // The padding rows and columns are zeros, so they don't contribute to the
+    // gates, whatever the padding of the cell inputs holds.
+    std::fill(packed, packed + packedWeights->getShape().storageSize(), 0);
+    for (int g = 0; g < 4; g++) {
+        for (int k = 0; k < units; k++) {
+            int src = g * units + k;
+            float16* row = packed + (g * alignedUnits + k) * width;
+            std::copy(w + src * wStride, w + src * wStride + depth, row);
+            std::copy(u + src * uStride, u + src * uStride + units,
+                      row + alignedDepth);
+        }
+    }
+    packedKernelVersion = kernel->getDataVersion();
+    packedRecurrentKernelVersion = recurrentKernel->getDataVersion();
+    packedWeights->bumpDataVersion();
+}
+
+// This function iterates the batch tiles, and for each of them runs all the
+// timesteps on the same accelerator. The tile iteration is in the following
+// order:
+// 1) N: batch-wise tiles of the inputs.
+// 2) T: timesteps, from the last one if the timesteps go backwards.
+// 3) W: neuron-wise tiles of the packed weights.
+void SmvLstmOp::runNTW(SmvTilePipeline& pipeline) {
+    TiledTensor& inputs = tiledTensors[InputTiles];
+    TiledTensor& weights = tiledTensors[WeightTiles];
+    TiledTensor& initialOutputs = tiledTensors[InitialOutputTiles];
+    TiledTensor& initialState = tiledTensors[InitialStateTiles];
+    TiledTensor& outputs = tiledTensors[OutputTiles];
+    TiledTensor& state = tiledTensors[StateTiles];
+    TiledTensor& sequence = tiledTensors[SequenceTiles];
+    bool returnSequences = getReturnSequences();
+    int timesteps = getInput(Inputs)->getShape()[1];
+    int units = getOutput(Outputs)->getShape().getStorageDim(1);
+    // An initial state with a batch of 1 is broadcast to all the batches.
+    int initialStrides[2] = {
+        getInput(InitialOutputs)->getShape()[0] == 1 ? 0 : units,
+        getInput(InitialState)->getShape()[0] == 1 ? 0 : units,
+    };
+    for (int i = 0; i < numAcceleratorsAvailable; i++) {
+        unsigned accel = smv::kInnerProductHw + i;
+        setArrayMemTypeIfSimulating(accel, "host_inputs", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                accel, "host_weights", getWeightsMemType());
+        setArrayMemTypeIfSimulating(
+                accel, "host_initial_outputs", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                accel, "host_initial_state", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                accel, "host_sequence", getOutputsMemType());
+        setArrayMemTypeIfSimulating(
+                accel, "host_outputs", getOutputsMemType());
+        setArrayMemTypeIfSimulating(accel, "host_state", getOutputsMemType());
+    }
+    SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
+    // If the weights are not tiled, this keeps them stationary in the
+    // scratchpad of every accelerator for all the timesteps and batch tiles.
+    std::vector<int> lastReadWeightTileIdx(numAcceleratorsAvailable, -1);
+    auto inputIdx = inputs.startIndex();
+    auto sequenceIdx = sequence.startIndex();
+    int currAccelIdx = 0;
+    for (int N = 0; N < outputs.size(); N++) {
+        unsigned accel = smv::kInnerProductHw + currAccelIdx;
+        Tensor* initialOutputsTile = pipeline.getTileWithData(
+                initialOutputs, initialOutputs.size() == 1 ? 0 : N);
+        Tensor* initialStateTile = pipeline.getTileWithData(
+                initialState, initialState.size() == 1 ? 0 : N);
+        Tensor* outputTile = outputs[N];
+        Tensor* stateTile = state[N];
+        int batch = outputTile->getShape()[0];
+        int stateSize = outputTile->getShape().storageSize() * sizeof(float16);
+        mapArrayToAccel(accel, "host_initial_outputs",
+                        initialOutputsTile->data<float16>(),
+                        initialOutputsTile->getShape().storageSize() *
+                                sizeof(float16));
+        mapArrayToAccel(accel, "host_initial_state",
+                        initialStateTile->data<float16>(),
+                        initialStateTile->getShape().storageSize() *
+                                sizeof(float16));
+        mapArrayToAccel(accel, "host_outputs", outputTile->data<float16>(),
+                        stateSize);
+        mapArrayToAccel(
+                accel, "host_state", stateTile->data<float16>(), stateSize);
+        for (int step = 0; step < timesteps; step++) {
+            // The timestep of the inputs and the sequence this step runs.
+            int t = goBackwards ? timesteps - 1 - step : step;
+            Tensor* inputTile =
+                    pipeline.getTileWithData(inputs, inputIdx(N, t, 0));
+            const TensorShape& inputShape = inputTile->getShape();
+            mapArrayToAccel(accel, "host_inputs", inputTile->data<float16>(),
+                            inputShape.storageSize() * sizeof(float16));
+            Tensor* sequenceTile = nullptr;
+            if (returnSequences) {
+                sequenceTile = sequence[sequenceIdx(N, t, 0)];
+                mapArrayToAccel(accel, "host_sequence",
+                                sequenceTile->data<float16>(), stateSize);
+            }
+            for (int W = 0; W < weights.size(); W++) {
+                Tensor* weightsTile = pipeline.getTileWithData(weights, W);
+                const TensorShape& weightsShape = weightsTile->getShape();
+                mapArrayToAccel(accel, "host_weights",
+                                weightsTile->data<float16>(),
+                                weightsShape.storageSize() * sizeof(float16));
+                dout(1) << "Input: " << inputIdx(N, t, 0)
+                        << ", weights: " << W << ", output: " << N << "\n";
+                // If this is a new weight tile, then we need to read it.
+                bool readWeights = false;
+                if (lastReadWeightTileIdx[currAccelIdx] != W) {
+                    readWeights = true;
+                    lastReadWeightTileIdx[currAccelIdx] = W;
+                }
+                // The cell is only finished after the last weight tile, and
+                // the final outputs are sent after the last timestep.
+                bool finishCell = W == weights.size() - 1;
+                bool sendOutputs = finishCell && step == timesteps - 1;
+                std::unique_ptr<volatile int> finishFlag = invokeKernelNoBlock(
+                        currAccelIdx, accel, smv_lstm_cell_nc_vec_fxp,
+                        inputTile->data<float16>(),
+                        weightsTile->data<float16>(),
+                        initialOutputsTile->data<float16>(),
+                        initialStateTile->data<float16>(),
+                        sequenceTile ? sequenceTile->data<float16>() : nullptr,
+                        outputTile->data<float16>(),
+                        stateTile->data<float16>(),
+                        smv::accelSpads[currAccelIdx].spad0,
+                        smv::accelSpads[currAccelIdx].spad1,
+                        smv::accelSpads[currAccelIdx].spad2, batch,
+                        inputShape.getStorageDim(2), units, weightsShape[0],
+                        initialStrides, W * plan.weightTileRows,
+                        step == 0 && W == 0, W == 0, readWeights, finishCell,
+                        finishCell && returnSequences, sendOutputs,
+                        actInfo.function, actInfo.params);
+                accelPool.addFinishFlag(currAccelIdx, std::move(finishFlag));
+            }
+            if (returnSequences)
+                pipeline.writeBack(sequence, sequenceIdx(N, t, 0));
+        }
+        pipeline.writeBack(outputs, N);
+        pipeline.writeBack(state, N);
+        currAccelIdx = accelPool.getNextAvailableAccelerator(currAccelIdx);
+    }
+    // Before we leave, make sure all the accelerators have finished.
+    accelPool.joinAll();
+}
+
+void SmvLstmOp::tile() {
+    // Tiles the tensors of the LSTM into batch tiles, one per timestep for the
+    // inputs and the sequence, and the packed weights into neuron-wise tiles.
+    plan = smv::lstm::TilingOptimizer::doTiling(this);
+    if (!plan.isValid())
+        return;
+    Tensor* inputs = getInput(Inputs);
+    int depth = inputs->getShape()[2];
+    int units = getNumUnits();
+    int alignedUnits = getOutput(Outputs)->getShape().getStorageDim(1);
+    int width = inputs->getShape().getStorageDim(2) + alignedUnits;
+    int batch = plan.batchTileSize;
+    if (!packedWeights) {
+        packedWeights = new Tensor(
+                name + "/packed_weights",
+                TensorShape({ 4 * alignedUnits, width }, DataLayout::NC,
+                            SmvBackend::Alignment));
+        packedWeights->allocateStorage<float16>();
+        workspace->addTensor(packedWeights);
+    }
+    tiledTensors[InputTiles] = generateTiledTensor(
+            inputs,
+            TensorShape({ batch, 1, depth }, DataLayout::NTC,
+                        SmvBackend::Alignment),
+            this);
+    tiledTensors[WeightTiles] = generateTiledTensor(
+            packedWeights,
+            TensorShape({ plan.weightTileRows, width }, DataLayout::NC,
+                        SmvBackend::Alignment),
+            this);
+    TensorShape stateTileShape(
+            { batch, units }, DataLayout::NC, SmvBackend::Alignment);
+    // A broadcast initial state is not tiled.
+    auto tileInitialState = [&](Tensor* tensor) {
+        const TensorShape& shape = tensor->getShape();
+        return generateTiledTensor(
+                tensor, shape[0] == 1 ? shape : stateTileShape, this);
+    };
+    tiledTensors[InitialOutputTiles] =
+            tileInitialState(getInput(InitialOutputs));
+    tiledTensors[InitialStateTiles] = tileInitialState(getInput(InitialState));
+    tiledTensors[OutputTiles] =
+            generateTiledTensor(getOutput(Outputs), stateTileShape, this);
+    tiledTensors[StateTiles] =
+            generateTiledTensor(getOutput(State), stateTileShape, this);
+    if (getReturnSequences()) {
+        tiledTensors[SequenceTiles] = generateTiledTensor(
+                getOutput(Sequence),
+                TensorShape({ batch, 1, units }, DataLayout::NTC,
+                            SmvBackend::Alignment),
+                this);
+    }
+}
+
+void SmvLstmOp::run() {
+    assert(getInput(Inputs)->getShape().getLayout() == DataLayout::NTC);
+    if (!plan.isValid()) {
+        dout(1) << "[" << name << "]: The cell doesn't fit in the "
+                << "scratchpads, running it on the host.\n";
+        LstmOp<SmvBackend>::run();
+        return;
+    }
+
+    SmvTilePipeline pipeline;
+    {
+        auto stats = gem5::ScopedStats(
+                stats::kTensorPrepStart, stats::kTensorPrepEnd);
+        packWeights();
+        for (int i = InputTiles; i <= InitialStateTiles; i++)
+            pipeline.prepare(tiledTensors[i]);
+    }
+
+    runNTW(pipeline);
+
+    {
+        auto stats = gem5::ScopedStats(
+                stats::kTensorFinalStart, stats::kTensorFinalEnd);
+        pipeline.finalize(tiledTensors[OutputTiles]);
+        pipeline.finalize(tiledTensors[StateTiles]);
+        if (getReturnSequences())
+            pipeline.finalize(tiledTensors[SequenceTiles]);
+    }
+}
+
+}  // namespace smaug
@@ -0,0 +1,63 @@
+#ifndef _OPERATORS_SMV_SMV_LSTM_OP_H_
+#define _OPERATORS_SMV_SMV_LSTM_OP_H_
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/lstm_op.h"
+#include "smaug/operators/smv/smv_lstm_tiling.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
+
+namespace smaug {
+
+/**
+ * LSTM operator on SMV.
+ *
+ * Every timestep of the cell is a single invocation of a fused kernel, which
+ * computes the gates with the inner product datapath and applies the
+ * activation functions and the state update without leaving the scratchpads.
+ * The outputs and the cell state stay in the scratchpads across timesteps, so
+ * only x_t is sent to the accelerator per timestep. If all the weights fit in
+ * the scratchpad, they are also only read once.
+ *
+ * Layers that don't fit in the scratchpads at all run on the host instead.
+ */
+class SmvLstmOp : public LstmOp<SmvBackend> {
+  public:
+    using LstmOp<SmvBackend>::LstmOp;
+    void tile() override;
+    void run() override;
+
+    const smv::lstm::TilingPlan& getTilingPlan() const { return plan; }
+
+  protected:
+   enum {
+       InputTiles,
+       WeightTiles,
+       InitialOutputTiles,
+       InitialStateTiles,
+       OutputTiles,
+       StateTiles,
+       SequenceTiles,
+       kNumTiledTensors
+   };
+
+   /**
+    * Packs the input and recurrent kernels into the [W | U] rows read by the
+    * kernel. Every gate is padded to the aligned number of units. The weights
+    * are only repacked if they have changed since the last run.
+    */
+   void packWeights();
+   void runNTW(SmvTilePipeline& pipeline);
+
+   smv::lstm::TilingPlan plan;
+   /** The packed weights, shaped [4 * aligned units, depth + units]. */
+   Tensor* packedWeights = nullptr;
+   /** Data versions of the kernels the packed weights were built from. */
+   int packedKernelVersion = -1;
+   int packedRecurrentKernelVersion = -1;
+   std::array<TiledTensor, kNumTiledTensors> tiledTensors;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,142 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/lstm_op.h"
+#include "smaug/operators/smv/smv_lstm_op.h"
+#include "smaug/operators/smv/smv_test_common.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class SmvLstmOpTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    /**
+     * Creates an SMV LSTM operator with random inputs and weights, and the
+     * tensors of its outputs.
+     */
+    SmvLstmOp* createSmvLstmOp(int batch,
+                               int timesteps,
+                               int depth,
+                               int units,
+                               int stateBatch) {
+        auto op = new SmvLstmOp("lstm", workspace());
+        std::vector<std::vector<int>> dims = {
+            { batch, timesteps, depth }, { 4 * units, depth },
+            { 4 * units, units },        { stateBatch, units },
+            { stateBatch, units },
+        };
+        for (int i = 0; i < dims.size(); i++) {
+            DataLayout layout = i == 0 ? DataLayout::NTC : DataLayout::NC;
+            Tensor* input = new Tensor(
+                    "input" + std::to_string(i),
+                    TensorShape(dims[i], layout, SmvBackend::Alignment));
+            workspace()->addTensor(input);
+            op->setInput(input, i);
+        }
+        op->setReturnSequences(true);
+        createAndFillTensorsWithData<float16>(op, fillTensorWithRandomData);
+        return op;
+    }
+
+    /**
+     * Runs the LSTM on the host with the same inputs as the given operator
+     * and returns the operator.
+     */
+    LstmOp<SmvBackend>* runOnHost(SmvLstmOp* smvOp) {
+        auto op = new LstmOp<SmvBackend>("host_lstm", workspace());
+        for (int i = 0; i < smvOp->getInputs().size(); i++)
+            op->setInput(smvOp->getInput(i), i);
+        op->setReturnSequences(true);
+        op->setGoBackwards(smvOp->getGoBackwards());
+        op->createAllTensors();
+        allocateAllTensors<float16>(op);
+        op->run();
+        return op;
+    }
+
+    void verifyWithHost(SmvLstmOp* smvOp) {
+        smvOp->tile();
+        smvOp->run();
+        auto hostOp = runOnHost(smvOp);
+        for (int i = 0; i < hostOp->getOutputs().size(); i++) {
+            verifyOutputs<float16>(
+                    smvOp->getOutput(i), hostOp->getOutput(i));
+        }
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(SmvLstmOpTest, "SMV LSTM", "[smvlstm]") {
+    SECTION("Weights stay in the scratchpad across timesteps") {
+        auto op = createSmvLstmOp(2, 4, 12, 4, 2);
+        verifyWithHost(op);
+        const smv::lstm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.isValid());
+        REQUIRE(plan.keepsWeightsResident());
+        REQUIRE(plan.weightTileRows == 32);
+        REQUIRE(plan.batchTileSize == 2);
+    }
+
+    SECTION("Weights tiled neuron-wise with a broadcast initial state") {
+        auto op = createSmvLstmOp(3, 3, 120, 100, 1);
+        verifyWithHost(op);
+        const smv::lstm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.numWeightTiles == 6);
+        REQUIRE(plan.weightTileRows == 72);
+        REQUIRE(plan.batchTileSize == 3);
+    }
+
+    SECTION("Batches tiled with tiled weights") {
+        auto op = createSmvLstmOp(20, 2, 256, 256, 20);
+        verifyWithHost(op);
+        const smv::lstm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.batchTileSize == 10);
+        REQUIRE(plan.numWeightTiles == 32);
+    }
+
+    SECTION("Timesteps going backwards with tiled weights") {
+        auto op = createSmvLstmOp(3, 3, 120, 100, 1);
+        op->setGoBackwards(true);
+        verifyWithHost(op);
+        REQUIRE(op->getTilingPlan().numWeightTiles == 6);
+    }
+
+    SECTION("Batch tiles on multiple accelerators") {
+        numAcceleratorsAvailable = 2;
+        auto op = createSmvLstmOp(400, 2, 64, 16, 1);
+        verifyWithHost(op);
+        // Three batch tiles, which keep the weights on both accelerators.
+        const smv::lstm::TilingPlan& plan = op->getTilingPlan();
+        REQUIRE(plan.batchTileSize == 170);
+        REQUIRE(plan.keepsWeightsResident());
+    }
+
+    SECTION("Weights are only repacked when they change") {
+        auto op = createSmvLstmOp(2, 2, 16, 8, 2);
+        verifyWithHost(op);
+        Tensor* packedWeights = workspace()->getTensor("lstm/packed_weights");
+        REQUIRE(packedWeights != nullptr);
+        int packedVersion = packedWeights->getDataVersion();
+        op->run();
+        REQUIRE(packedWeights->getDataVersion() == packedVersion);
+        // New weights must be packed again by the next run.
+        Tensor* kernel = op->getInput(LstmOp<SmvBackend>::Kernel);
+        fillTensorWithRandomData(kernel);
+        kernel->bumpDataVersion();
+        verifyWithHost(op);
+        REQUIRE(workspace()->getTensor("lstm/packed_weights") == packedWeights);
+        REQUIRE(packedWeights->getDataVersion() == packedVersion + 1);
+    }
+
+    SECTION("Too large a cell runs on the host") {
+        auto op = createSmvLstmOp(1, 2, 16384, 4, 1);
+        verifyWithHost(op);
+        REQUIRE(!op->getTilingPlan().isValid());
+    }
+}
@@ -0,0 +1,55 @@
+#include <algorithm>
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_inner_product_op.h"
+#include "smaug/operators/smv/smv_lstm_op.h"
+#include "smaug/operators/smv/smv_lstm_tiling.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+namespace smv {
+namespace lstm {
+
+std::ostream& operator<<(std::ostream& os, const TilingPlan& plan) {
+    os << "batch tile: " << plan.batchTileSize
+       << ", weight tile rows: " << plan.weightTileRows
+       << ", weight tiles: " << plan.numWeightTiles;
+    return os;
+}
+
+TilingPlan TilingOptimizer::doTiling(SmvLstmOp* op) {
+    Tensor* inputs = op->getInput(SmvLstmOp::Inputs);
+    Tensor* outputs = op->getOutput(SmvLstmOp::Outputs);
+    int maxTileSize = SmvBackend::SpadSize() / inputs->getDataTypeSize();
+    int batch = inputs->getShape()[0];
+    int depth = inputs->getShape().getStorageDim(2);
+    int units = outputs->getShape().getStorageDim(1);
+    int width = depth + units;
+    int gateRows = 4 * units;
+
+    TilingPlan plan;
+    // The cell inputs of a batch take width elements of spad0, and its gates,
+    // cell state and staged outputs take 6 * units elements of spad2. Loads
+    // and stores of the batches may overrun by up to one vector.
+    plan.batchTileSize = std::min(
+            batch,
+            (maxTileSize - SmvBackend::Alignment) /
+                    std::max(width, 6 * units));
+    int maxWeightRows = maxTileSize / width / fc::kNumPEs * fc::kNumPEs;
+    if (maxWeightRows > 0) {
+        // Balance the rows over the fewest weight tiles that fit.
+        int numTiles = FRAC_CEIL(gateRows, maxWeightRows);
+        plan.weightTileRows =
+                FRAC_CEIL(FRAC_CEIL(gateRows, numTiles), fc::kNumPEs) *
+                fc::kNumPEs;
+        plan.numWeightTiles = FRAC_CEIL(gateRows, plan.weightTileRows);
+    }
+    dout(1) << "  Tiling plan chosen for " << op->getName() << ": " << plan
+            << "\n";
+    return plan;
+}
+
+}  // namespace lstm
+}  // namespace smv
+}  // namespace smaug
@@ -0,0 +1,70 @@
+#ifndef _OPERATORS_SMV_SMV_LSTM_TILING_H_
+#define _OPERATORS_SMV_SMV_LSTM_TILING_H_
+
+#include <iostream>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/tensor.h"
+
+namespace smaug {
+
+class SmvLstmOp;
+
+namespace smv {
+namespace lstm {
+
+/**
+ * Describes how SmvLstmOp splits an LSTM layer over the scratchpads.
+ *
+ * The cell inputs (h_{t-1} and x_t) of a batch tile are in spad0, the packed
+ * [W | U] weights in spad1, and the gates, the cell state and the staged
+ * outputs in spad2. Batch tiles are independent sequences, so each of them
+ * runs all the timesteps on the same accelerator without going back to the
+ * host.
+ */
+struct TilingPlan {
+    /** The number of batches per batch tile. Zero if the layer doesn't fit. */
+    int batchTileSize = 0;
+    /** The number of packed weight rows per weight tile. */
+    int weightTileRows = 0;
+    /** The number of neuron-wise weight tiles per timestep. */
+    int numWeightTiles = 0;
+
+    bool isValid() const { return batchTileSize > 0 && weightTileRows > 0; }
+    /**
+     * Returns true if all the weights fit in the scratchpad at once, so they
+     * are only read once per accelerator for all the timesteps.
+     */
+    bool keepsWeightsResident() const { return numWeightTiles == 1; }
+};
+
+std::ostream& operator<<(std::ostream& os, const TilingPlan& plan);
+
+/**
+ * Tiling optimizer for the SMV LSTM kernel.
+ */
+class TilingOptimizer {
+   public:
+    /**
+     * Determines the tiling plan of the LSTM layer.
+     *
+     * The weights are the largest tensor and the only one that is used by
+     * every batch in every timestep, so the plan first tries to keep all of
+     * them in the scratchpad. Otherwise, they are split neuron-wise into the
+     * fewest tiles of a multiple of kNumPEs rows, which are then read once
+     * per timestep. The batches are tiled independently of the weights, as
+     * they use different scratchpads.
+     *
+     * @param op The SMV LSTM operator. All tensors must have been created
+     * with createAllTensors() prior to calling this function.
+     * @returns The tiling plan, which is invalid if even a single batch or
+     * kNumPEs weight rows don't fit in the scratchpads.
+     */
+    static TilingPlan doTiling(SmvLstmOp* op);
+};
+
+}  // namespace lstm
+}  // namespace smv
+}  // namespace smaug
+
+#endif
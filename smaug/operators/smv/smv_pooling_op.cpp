@@ -3,6 +3,7 @@
 #include "smaug/operators/smv/smv_pooling_op.h"
 #include "smaug/operators/smv/smv_pooling_tiling.h"
 #include "smaug/operators/smv/smv_kernels.h"
+#include "smaug/operators/smv/smv_accel_pool.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -21,7 +22,9 @@ const int kVectorSize = 8;
 // 2) H: Rowwise tiles in the inputs.
 // 3) W: column-wise tiles in the inputs.
 // 4) C: Channelwise tiles in the inputs/weights.
-void SmvPoolingOp::runNHWC(TiledTensor& inputs, TiledTensor& outputs) {
+void SmvPoolingOp::runNHWC(TiledTensor& inputs,
+                           TiledTensor& outputs,
+                           SmvTilePipeline& pipeline) {
     int inputIfmapTiles = inputs.getShape()[0];
     int inputRowTiles = inputs.getShape()[1];
     int inputColTiles = inputs.getShape()[2];
@@ -29,13 +32,21 @@ void SmvPoolingOp::runNHWC(TiledTensor& inputs, TiledTensor& outputs) {
     int outputChanTiles = outputs.getShape()[3];
     auto inputIdx = inputs.startIndex();
     auto outputIdx = outputs.startIndex();
-    setArrayMemTypeIfSimulating(
-            smv::kPoolingHw, "host_inputs", getInputsMemType());
-    setArrayMemTypeIfSimulating(
-            smv::kPoolingHw, "host_results", getOutputsMemType());
+    SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
+    for (int i = 0; i < numAcceleratorsAvailable; i++) {
+        setArrayMemTypeIfSimulating(
+                smv::kPoolingHw + i, "host_inputs", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kPoolingHw + i, "host_results", getOutputsMemType());
+    }
+    int currAccelIdx = 0;
     for (int N = 0; N < inputIfmapTiles; N++) {
         for (int H = 0; H < inputRowTiles; H++) {
             for (int W = 0; W < inputColTiles; W++) {
+                // The loop nests up to this point are independent of each
+                // other, so they are distributed across the accelerators. The
+                // channelwise tiles below may produce the same output tile, so
+                // they run in serial on the same accelerator.
                 int iC = 0, oC = 0;
                 // This keeps track of the channel offset of the outputs.
                 int ofmapOffset = 0;
@@ -48,15 +59,16 @@ void SmvPoolingOp::runNHWC(TiledTensor& inputs, TiledTensor& outputs) {
                     // tile.
                     dout(1) << "Input: " << inputTileIdx
                             << ", output: " << outputTileIdx << "\n";
-                    Tensor* inputTile = inputs.getTileWithData(inputTileIdx);
+                    Tensor* inputTile =
+                            pipeline.getTileWithData(inputs, inputTileIdx);
                     Tensor* outputTile = outputs[outputTileIdx];
                     const TensorShape& inputShape = inputTile->getShape();
                     const TensorShape& outputShape = outputTile->getShape();
-                    mapArrayToAccel(smv::kPoolingHw, "host_inputs",
-                                    inputTile->data<float16>(),
+                    mapArrayToAccel(smv::kPoolingHw + currAccelIdx,
+                                    "host_inputs", inputTile->data<float16>(),
                                     inputShape.storageSize() * sizeof(float16));
                     mapArrayToAccel(
-                            smv::kPoolingHw, "host_results",
+                            smv::kPoolingHw + currAccelIdx, "host_results",
                             outputTile->data<float16>(),
                             outputShape.storageSize() * sizeof(float16));
                     int inputDims[4] = { inputShape[0], inputShape[1],
@@ -70,16 +82,31 @@ void SmvPoolingOp::runNHWC(TiledTensor& inputs, TiledTensor& outputs) {
                     // from.
                     int ofmapStart = (iC == oC) ? 0 : ofmapOffset;
 
-                    invokeKernel(
-                            smv::kPoolingHw,
-                            opType == MaxPooling ? smv_maxpooling_nhwc_vec_fxp
-                                                 : smv_avgpooling_nhwc_vec_fxp,
-                            inputTile->data<float16>(),
-                            outputTile->data<float16>(), smv::spad0, smv::spad1,
-                            inputDims, outputDims, inputShape.getPadding(3),
-                            outputShape.getPadding(3), getPoolingSize().first,
-                            getPoolingSize().second, getPoolingStride().first,
-                            getPoolingStride().second, ofmapStart, &sampling);
+                    std::unique_ptr<volatile int> finishFlag =
+                            invokeKernelNoBlock(
+                                    currAccelIdx,
+                                    smv::kPoolingHw + currAccelIdx,
+                                    opType == MaxPooling
+                                            ? smv_maxpooling_nhwc_vec_fxp
+                                            : smv_avgpooling_nhwc_vec_fxp,
+                                    inputTile->data<float16>(),
+                                    outputTile->data<float16>(),
+                                    smv::accelSpads[currAccelIdx].spad0,
+                                    smv::accelSpads[currAccelIdx].spad1,
+                                    inputDims, outputDims,
+                                    inputShape.getPadding(3),
+                                    outputShape.getPadding(3),
+                                    getPoolingSize().first,
+                                    getPoolingSize().second,
+                                    getPoolingStride().first,
+                                    getPoolingStride().second, ofmapStart,
+                                    &sampling);
+                    accelPool.addFinishFlag(
+                            currAccelIdx, std::move(finishFlag));
+                    // The output tile is finished with its last input tile.
+                    if (inputChanTiles == outputChanTiles ||
+                        iC == inputChanTiles - 1)
+                        pipeline.writeBack(outputs, outputTileIdx);
 
                     ofmapOffset += inputTile->getShape()[3];
                     if (inputChanTiles == outputChanTiles) {
@@ -94,9 +121,13 @@ void SmvPoolingOp::runNHWC(TiledTensor& inputs, TiledTensor& outputs) {
                                "need channelwise tiling.");
                     }
                 }
+                currAccelIdx =
+                        accelPool.getNextAvailableAccelerator(currAccelIdx);
             }
         }
     }
+    // Before we leave, make sure all the accelerators have finished.
+    accelPool.joinAll();
 }
 
 void SmvPoolingOp::tile() {
@@ -114,18 +145,19 @@ void SmvPoolingOp::run() {
     assert(inputShape.getLayout() == DataLayout::NHWC);
     assert(outputShape.getLayout() == DataLayout::NHWC);
 
+    SmvTilePipeline pipeline;
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorPrepStart, stats::kTensorPrepEnd);
-        tiledTensors[0].copyDataToAllTiles();
+        pipeline.prepare(tiledTensors[0]);
     }
 
-    runNHWC(tiledTensors[0], tiledTensors[1]);
+    runNHWC(tiledTensors[0], tiledTensors[1], pipeline);
 
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorFinalStart, stats::kTensorFinalEnd);
-        tiledTensors[1].untile();
+        pipeline.finalize(tiledTensors[1]);
     }
 }
 
@@ -4,6 +4,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/pooling_op.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
 
 namespace smaug {
 
@@ -25,10 +26,18 @@ class SmvPoolingOp : public PoolingOp<SmvBackend> {
     using PoolingOp<SmvBackend>::PoolingOp;
     void tile() override;
     void run() override;
+    TiledTensor* getTiledInput(int index) override {
+        return index == Inputs ? &tiledTensors[0] : nullptr;
+    }
+    TiledTensor* getTiledOutput(int index) override {
+        return index == Outputs ? &tiledTensors[1] : nullptr;
+    }
     friend class smv::pool::TilingOptimizer;
 
    protected:
-    void runNHWC(TiledTensor& inputs, TiledTensor& outputs);
+    void runNHWC(TiledTensor& inputs,
+                 TiledTensor& outputs,
+                 SmvTilePipeline& pipeline);
 
     std::array<TiledTensor, 2> tiledTensors;
 };
@@ -125,3 +125,18 @@ TEST_CASE_METHOD(SmvPoolingOpTest, "SMV Tiled Pooling", "[smvpool]") {
     }
 }
 
+
+TEST_CASE_METHOD(SmvPoolingOpTest,
+                 "SMV Tiled Pooling on multiple accelerators",
+                 "[smvpool]") {
+    numAcceleratorsAvailable = 4;
+    auto poolOp = new SmvMaxPoolingOp("pool", workspace());
+    poolOp->setPoolingSize(2, 2);
+    poolOp->setPoolingStride(2, 2);
+
+    SECTION("DimNH tiling") { doTest(poolOp, { 1, 68, 68, 32 }); }
+    SECTION("DimNHW tiling") { doTest(poolOp, { 1, 512, 512, 32 }); }
+    SECTION("DimNC tiling on inputs, None for outputs") {
+        doTest(poolOp, { 1, 32, 32, 32 });
+    }
+}
@@ -177,10 +177,13 @@ TilingConfig TilingOptimizer::computeBasicTileShapes(SmvPoolingOp* op) {
 std::array<TiledTensor, 2> TilingOptimizer::doTiling(SmvPoolingOp* op) {
     auto input = op->getInput(SmvPoolingOp::Inputs);
     auto output = op->getOutput(SmvPoolingOp::Outputs);
-    TilingConfig tileConfig = TilingOptimizer::computeBasicTileShapes(op);
     int poolRowSize, poolColSize, poolRowStride, poolColStride;
     std::tie(poolRowSize, poolColSize) = op->getPoolingSize();
     std::tie(poolRowStride, poolColStride) = op->getPoolingStride();
+    TilingConfig tileConfig = getCachedTileShapes(
+            op,
+            { poolRowSize, poolColSize, poolRowStride, poolColStride },
+            [op]() { return TilingOptimizer::computeBasicTileShapes(op); });
     TiledTensor tiledInputs =
             generateTiledTensorWithStrideAndPadding(input,
                                                     tileConfig.inputs,
@@ -19,6 +19,12 @@ void fillTensorWithRandomData(Tensor* tensor) {
         dataPtr[i] = fp16(normalDist(generator));
 }
 
+void fillFloatTensorWithRandomData(Tensor* tensor) {
+    float* dataPtr = tensor->data<float>();
+    for (int i = 0; i < tensor->getShape().storageSize(); i++)
+        dataPtr[i] = normalDist(generator);
+}
+
 void fillTensorWithFixedData(Tensor* tensor) {
     const TensorShape& shape = tensor->getShape();
     // Each dimension C is initialized to a different constant value.
@@ -47,4 +53,15 @@ void verifyTensorWithFixedData(Tensor* tensor, int valueOffset) {
     }
 }
 
+Tensor* createRandomBiasTensor(int numChannels, Workspace* workspace) {
+    TensorShape shape(
+            { 1, numChannels }, DataLayout::NC, SmvBackend::Alignment);
+    Tensor* bias = new Tensor("bias", shape);
+    float16* dataPtr = bias->allocateStorage<float16>();
+    for (int i = 0; i < shape.storageSize(); i++)
+        dataPtr[i] = fp16(i < numChannels ? normalDist(generator) : 0);
+    workspace->addTensor(bias);
+    return bias;
+}
+
 }  // namespace smaug
@@ -1,4 +1,5 @@
 #include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
 
 namespace smaug {
 
@@ -9,6 +10,12 @@ namespace smaug {
 /** This fills the Tensor with normally distributed random values. */
 void fillTensorWithRandomData(Tensor* tensor);
 
+/**
+ * This fills a float32 Tensor, including its padding, with normally
+ * distributed random values.
+ */
+void fillFloatTensorWithRandomData(Tensor* tensor);
+
 /** 
  * This fills the Tensor with a fixed data pattern.
  *
@@ -24,4 +31,11 @@ void fillTensorWithFixedData(Tensor* tensor);
  */
 void verifyTensorWithFixedData(Tensor* tensor, int valueOffset);
 
+/**
+ * Creates a per-channel bias Tensor of shape {1, numChannels} with random
+ * values, like the one left by a batch norm folded into a convolution or inner
+ * product. The alignment padding is zero.
+ */
+Tensor* createRandomBiasTensor(int numChannels, Workspace* workspace);
+
 }  // namespace smaug
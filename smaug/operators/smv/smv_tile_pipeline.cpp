@@ -0,0 +1,74 @@
+#include "smaug/core/globals.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
+
+namespace smaug {
+
+SmvTilePipeline::SmvTilePipeline() : pool(nullptr), asyncWriteBack(false) {
+    if (pipelineTiles && !runningInSimulation && !fastForwardMode) {
+        pool = dynamic_cast<WorkStealingThreadPool*>(threadPool);
+        // Kernels on native accelerators return before they finish, so we
+        // can't tell when an output tile is done until they are joined.
+        asyncWriteBack = pool && !useNativeAccelerators();
+    }
+}
+
+void SmvTilePipeline::prepare(TiledTensor& tensor) {
+    if (!pool)
+        tensor.copyDataToAllTiles();
+}
+
+Tensor* SmvTilePipeline::getTileWithData(TiledTensor& tensor, int index) {
+    if (!pool)
+        return tensor.getTileWithData(index);
+    wait(TileKey(&tensor, index));
+    Tensor* tile = tensor.getTileWithData(index);
+    // Tiles are mostly used in the order of their indices, so the next one is
+    // the one to prefetch. This only leaves one tile in flight per tensor.
+    // There is nothing to prefetch after the last tile.
+    int next = index + 1;
+    TileKey nextKey(&tensor, next);
+    if (next < tensor.size() && pending.find(nextKey) == pending.end()) {
+        runInBackground(nextKey, [&tensor, next]() {
+            tensor.getTileWithData(next);
+        });
+    }
+    return tile;
+}
+
+void SmvTilePipeline::writeBack(TiledTensor& tensor, int index) {
+    if (!asyncWriteBack)
+        return;
+    TileKey key(&tensor, index);
+    wait(key);
+    runInBackground(key, [&tensor, index]() { tensor.untile(index); });
+}
+
+void SmvTilePipeline::finalize(TiledTensor& tensor) {
+    drain();
+    if (!asyncWriteBack)
+        tensor.untile();
+}
+
+void SmvTilePipeline::runInBackground(const TileKey& key,
+                                      std::function<void()> copy) {
+    std::unique_ptr<TaskGroup> group(new TaskGroup(pool));
+    group->run(std::move(copy));
+    pending[key] = std::move(group);
+}
+
+void SmvTilePipeline::wait(const TileKey& key) {
+    auto it = pending.find(key);
+    if (it == pending.end())
+        return;
+    it->second->wait();
+    pending.erase(it);
+}
+
+void SmvTilePipeline::drain() {
+    for (auto& copy : pending)
+        copy.second->wait();
+    pending.clear();
+}
+
+}  // namespace smaug
@@ -0,0 +1,99 @@
+#ifndef _OPERATORS_SMV_SMV_TILE_PIPELINE_H_
+#define _OPERATORS_SMV_SMV_TILE_PIPELINE_H_
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "smaug/core/tensor.h"
+#include "smaug/utility/thread_pool.h"
+
+namespace smaug {
+
+/**
+ * Overlaps copying data into and out of the tiles of an SMV operator with the
+ * kernels that compute on them.
+ *
+ * Without pipelining, an operator copies the data of all its input tiles
+ * before running any kernel, and gathers all its output tiles after the last
+ * one. With pipelining, getting a tile with getTileWithData() starts copying
+ * the data of the next tile of the same TiledTensor on the thread pool, so
+ * that it is ready by the time the kernels reach it, and finished output tiles
+ * are gathered into the original tensor in the background with writeBack().
+ * Every tile has its own storage, so the tile being computed on and the one
+ * being filled never share a buffer.
+ *
+ * Pipelining is enabled by pipelineTiles in native execution with a thread
+ * pool. Output tiles are only gathered in the background if the kernels run
+ * synchronously, i.e. not on multiple native accelerators. Whatever is not
+ * done in the background is done by prepare() and finalize() as before.
+ *
+ * To use:
+ *
+ * ```c
+ * SmvTilePipeline pipeline;
+ * pipeline.prepare(inputs);
+ * for (int i = 0; i < inputs.size(); i++) {
+ *     Tensor* inputTile = pipeline.getTileWithData(inputs, i);
+ *     invokeKernel(...);
+ *     pipeline.writeBack(outputs, i);
+ * }
+ * pipeline.finalize(outputs);
+ * ```
+ */
+class SmvTilePipeline {
+   public:
+    SmvTilePipeline();
+    /**
+     * Waits for the copies still in flight without rethrowing their errors,
+     * as the operator may already be unwinding from an exception.
+     */
+    ~SmvTilePipeline() { pending.clear(); }
+
+    /**
+     * Copies the data of all the tiles from the original tensor, unless they
+     * are copied in the background.
+     */
+    void prepare(TiledTensor& tensor);
+
+    /**
+     * Returns the tile at the index with its data, waiting for it if it is
+     * being copied in the background. This starts copying the next tile.
+     */
+    Tensor* getTileWithData(TiledTensor& tensor, int index);
+
+    /**
+     * Starts gathering the tile at the index into the original tensor. All
+     * the kernels writing to the tile must have been invoked.
+     */
+    void writeBack(TiledTensor& tensor, int index);
+
+    /**
+     * Waits for the tiles being copied in the background, and then gathers
+     * the tiles that were not written back.
+     */
+    void finalize(TiledTensor& tensor);
+
+   protected:
+    typedef std::pair<TiledTensor*, int> TileKey;
+
+    /** Runs the copy of the tile on the thread pool. */
+    void runInBackground(const TileKey& key, std::function<void()> copy);
+
+    /** Waits until the background copy of the tile is done, if any. */
+    void wait(const TileKey& key);
+
+    /** Waits until all the background copies are done. */
+    void drain();
+
+    /** The thread pool the copies run on, or null if not pipelining. */
+    WorkStealingThreadPool* pool;
+    /** True if finished output tiles are gathered in the background. */
+    bool asyncWriteBack;
+    /** The background copies in flight. */
+    std::map<TileKey, std::unique_ptr<TaskGroup>> pending;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,126 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_test_common.h"
+#include "smaug/operators/smv/smv_tile_pipeline.h"
+#include "smaug/utility/thread_pool.h"
+
+using namespace smaug;
+
+namespace smaug {
+
+class SmvTilePipelineTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    Tensor* createTensor(const std::string& name,
+                         const std::vector<int>& dims) {
+        TensorShape shape(dims, NHWC, SmvBackend::Alignment);
+        Tensor* tensor = new Tensor(name, shape);
+        tensor->allocateStorage<float16>();
+        workspace()->addTensor(tensor);
+        return tensor;
+    }
+
+    SmvConvolutionOp* createConvOp(const std::string& name, Tensor* inputs) {
+        auto convOp = new SmvConvolutionOp(name, workspace());
+        convOp->setStride(1, 1);
+        convOp->setPadding(SamePadding);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(3, 3, 128);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        return convOp;
+    }
+
+    /** Turns on pipelining with a thread pool for the rest of the test. */
+    void enablePipelining() {
+        pool.initThreadPool();
+        threadPool = &pool;
+        pipelineTiles = true;
+        fastForwardMode = false;
+    }
+
+    ~SmvTilePipelineTest() {
+        threadPool = nullptr;
+        pipelineTiles = false;
+        fastForwardMode = true;
+    }
+
+   protected:
+    WorkStealingThreadPool pool{ 2 };
+};
+
+/** A pipeline that runs arbitrary functions as background copies. */
+class TestTilePipeline : public SmvTilePipeline {
+   public:
+    void copyInBackground(std::function<void()> copy) {
+        runInBackground(TileKey(nullptr, 0), copy);
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(SmvTilePipelineTest, "Tile pipelining", "[smvtiling]") {
+    SECTION("Tiles are prefetched and written back in the background") {
+        enablePipelining();
+        Tensor* inputs = createTensor("inputs", { 1, 16, 8, 32 });
+        Tensor* outputs = createTensor("outputs", { 1, 16, 8, 32 });
+        fillTensorWithFixedData(inputs);
+        // The tiled tensors are owned by the workspace of an operator.
+        auto op = new SmvConvolutionOp("conv", workspace());
+        TensorShape tileShape({ 1, 2, 8, 32 }, NHWC, SmvBackend::Alignment);
+        TiledTensor inputTiles = generateTiledTensor(inputs, tileShape, op);
+        TiledTensor outputTiles = generateTiledTensor(outputs, tileShape, op);
+        REQUIRE(inputTiles.size() == 8);
+
+        SmvTilePipeline pipeline;
+        pipeline.prepare(inputTiles);
+        for (int i = 0; i < inputTiles.size(); i++) {
+            Tensor* inputTile = pipeline.getTileWithData(inputTiles, i);
+            verifyTensorWithFixedData(inputTile, 0);
+            Tensor* outputTile = outputTiles[i];
+            memcpy(outputTile->data<float16>(), inputTile->data<float16>(),
+                   outputTile->getShape().storageSize() * sizeof(float16));
+            pipeline.writeBack(outputTiles, i);
+        }
+        pipeline.finalize(outputTiles);
+        verifyTensorWithFixedData(outputs, 0);
+    }
+
+    SECTION("Pipelined operators produce the same outputs") {
+        Tensor* inputs = createTensor("inputs", { 1, 32, 32, 32 });
+        fillTensorWithRandomData(inputs);
+        auto convOp = createConvOp("conv", inputs);
+        fillTensorWithRandomData(convOp->getInput(1));
+        convOp->tile();
+        convOp->run();
+
+        enablePipelining();
+        auto pipelinedOp = createConvOp("pipelined_conv", inputs);
+        memcpy(pipelinedOp->getInput(1)->data<float16>(),
+               convOp->getInput(1)->data<float16>(),
+               convOp->getInput(1)->getShape().storageSize() *
+                       sizeof(float16));
+        pipelinedOp->tile();
+        REQUIRE(pipelinedOp->getTiledInput(0)->size() > 1);
+        pipelinedOp->run();
+        verifyOutputs<float16>(pipelinedOp->getOutput(0), convOp->getOutput(0));
+    }
+
+    SECTION("Destroying a pipeline doesn't rethrow failed copies") {
+        enablePipelining();
+        REQUIRE_NOTHROW([]() {
+            TestTilePipeline pipeline;
+            pipeline.copyInBackground(
+                    []() { throw std::runtime_error("copy failed"); });
+        }());
+    }
+}
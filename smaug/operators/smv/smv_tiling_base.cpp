@@ -1,6 +1,7 @@
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor_utils.h"
 #include "smaug/operators/common.h"
+#include "smaug/operators/convolution_op.h"
 #include "smaug/operators/smv/smv_tiling_base.h"
 #include "smaug/utility/debug_stream.h"
 
@@ -53,6 +54,43 @@ TilingDims TilingOptimizerBase::findBestTilingDims(
     exit(1);
 }
 
+static bool isCheaper(const TilingConfig& config0,
+                      const TilingCost& cost0,
+                      const TilingConfig& config1,
+                      const TilingCost& cost1) {
+    if (cost0.getCycles() != cost1.getCycles())
+        return cost0.getCycles() < cost1.getCycles();
+    if (cost0.getTotalBytes() != cost1.getTotalBytes())
+        return cost0.getTotalBytes() < cost1.getTotalBytes();
+    return config0.getTotalSize() > config1.getTotalSize();
+}
+
+int TilingOptimizerBase::pickCheapestConfig(
+        const std::vector<TilingConfig>& configs,
+        const std::vector<TilingCost>& costs) {
+    dout(2) << "  Number of possible tiling configs: " << configs.size()
+            << "\n";
+    int cheapest = 0;
+    int largest = 0;
+    for (int i = 0; i < configs.size(); i++) {
+        dout(2) << "    " << configs[i] << "\n      " << costs[i] << "\n";
+        if (isCheaper(configs[i], costs[i], configs[cheapest], costs[cheapest]))
+            cheapest = i;
+        if (configs[i].getTotalSize() > configs[largest].getTotalSize())
+            largest = i;
+    }
+    dout(1) << "  Chose tiling config " << configs[cheapest]
+            << "\n    out of " << configs.size()
+            << " configs for the lowest estimated cost:\n      "
+            << costs[cheapest] << "\n";
+    if (largest != cheapest) {
+        dout(1) << "    The config with the largest tiles, "
+                << configs[largest] << ", would cost:\n      "
+                << costs[largest] << "\n";
+    }
+    return cheapest;
+}
+
 void TilingOptimizerBase::enum2DTensorTilingConfigs(
         TensorShape shape,
         int maxTileSize,
@@ -117,5 +155,92 @@ void TilingOptimizerBase::enum4DTensorTilingConfigs(
     }
 }
 
+TiledTensor TilingOptimizerBase::generateRowwiseConvOutputTiledTensor(
+        ConvolutionOp<SmvBackend>* op,
+        const TiledTensor& inputTiledTensor,
+        const std::vector<int>& outputChans,
+        const TensorShape& maxOutputTileSize,
+        Tensor* outputTensor,
+        bool copyData) {
+    const TensorShape& inputShape = inputTiledTensor.getShape();
+    const TensorShape& outputShape = outputTensor->getShape();
+    int weightRows = op->getWeightRows();
+    int weightCols = op->getWeightCols();
+    // For even-sized filtered, FRAC_CEIL is needed to correctly handle padding.
+    std::vector<int> inputPadding = op->getInputPadding();
+    int topRowPad = inputPadding[0];
+    int bottomRowPad = inputPadding[1];
+    int leftColPad = inputPadding[2];
+    int rightColPad = inputPadding[3];
+    std::vector<int> numBlocksInDim{ inputShape[0], inputShape[1],
+                                     inputShape[2],
+                                     static_cast<int>(outputChans.size()) };
+    // Due to stride > 1, there is a case where the last rowwise tile doesn't
+    // have enough rows for convolution. If so, we need to decrease the row
+    // dimension by 1 in the output tiled tensor.
+    int lastTileRows =
+            inputTiledTensor[inputTiledTensor.size() - 1]->getShape()[1];
+    if (lastTileRows + bottomRowPad < weightRows)
+        numBlocksInDim[1]--;
+    TiledTensor outputTiledTensor(
+            TensorShape(numBlocksInDim, inputShape.getLayout()), outputTensor);
+    const int ndims = outputShape.ndims();
+    std::vector<int> currentOrigin(ndims, 0);
+    auto inputIndex = inputTiledTensor.startIndex();
+    auto outputIndex = outputTiledTensor.startIndex();
+    for (int n = 0; n < numBlocksInDim[0]; n++) {
+        for (int h = 0; h < numBlocksInDim[1]; h++) {
+            for (int w = 0; w < numBlocksInDim[2]; w++) {
+                for (int c = 0; c < numBlocksInDim[3]; c++) {
+                    const Tensor* inputTile =
+                            inputTiledTensor[inputIndex(n, h, w, 0)];
+                    const TensorShape& inputTileShape = inputTile->getShape();
+
+                    // Rowwise tiling only affects rows, not columns.
+                    int effInputRows = inputTileShape[1];
+                    if (h == 0)
+                        effInputRows += topRowPad;
+                    else if (h == numBlocksInDim[1] - 1)
+                        effInputRows += bottomRowPad;
+                    int effInputCols =
+                            inputTileShape[2] + leftColPad + rightColPad;
+                    // The padding is already counted in the effective
+                    // input, so the tile is convolved without any.
+                    int outputRows = (effInputRows - weightRows) /
+                                             op->getRowStride() +
+                                     1;
+                    int outputCols = (effInputCols - weightCols) /
+                                             op->getColStride() +
+                                     1;
+                    TensorShape outputTileShape(
+                            { inputTileShape[0], outputRows, outputCols,
+                              outputChans[c] },
+                            outputTensor->getShape().getLayout(),
+                            SmvBackend::Alignment);
+                    assert(outputTileShape.storageSize() <=
+                                   maxOutputTileSize.storageSize() &&
+                           "Rowwise input tiling results in output tile sizes "
+                           "larger than the max tile size!");
+                    int oi = outputIndex(n, h, w, c);
+                    setTileRegion(outputTiledTensor, oi, currentOrigin,
+                                  outputTileShape, copyData);
+                    for (int i = ndims - 1; i >= 0; i--) {
+                        currentOrigin[i] += outputTileShape[i];
+                        if (currentOrigin[i] >= outputShape[i])
+                            currentOrigin[i] = 0;
+                        else
+                            break;
+                    }
+                }
+            }
+        }
+    }
+    op->getWorkspace()->addTiledTensor(outputTiledTensor);
+    dout(1) << "  Tiled Tensor " << outputTensor->getName() << "(rowwise):\n"
+            << "    original tensor shape: " << outputTensor->getShape() << "\n"
+            << "    number of tiles: " << outputTiledTensor.size() << "\n";
+    return outputTiledTensor;
+}
+
 }  // namespace smv
 }  // namespace smaug
@@ -4,12 +4,68 @@
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
 #include "smaug/operators/smv/smv_tiling_common.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
+#include "smaug/operators/smv/smv_tiling_cost.h"
 
 namespace smaug {
+
+template <typename Backend> class ConvolutionOp;
+
 namespace smv {
 
 class TilingOptimizerBase {
    protected:
+    /**
+     * Returns the basic tile shapes of the operator from the tilingPlanCache.
+     * On a miss, they are searched for with computeFn and then cached.
+     *
+     * @param op The operator to tile.
+     * @param params Parameters of the operator that affect its tiling, other
+     * than the shapes of its tensors.
+     * @param computeFn Searches for the basic tile shapes.
+     */
+    template <typename ComputeFn>
+    static TilingConfig getCachedTileShapes(Operator* op,
+                                            const std::vector<int>& params,
+                                            ComputeFn computeFn) {
+        std::string key = TilingPlanCache::getKey(op, params);
+        TilingConfig config;
+        if (tilingPlanCache.find(key, &config))
+            return config;
+        config = computeFn();
+        tilingPlanCache.insert(key, config);
+        return config;
+    }
+
+    /**
+     * Returns the tiling config with the lowest estimated cost.
+     *
+     * Configs with the same estimated cycles are ranked by the bytes they
+     * move and then by the total size of their tiles. The reasons for the
+     * choice are reported at debug level 1, and the costs of all the configs
+     * at debug level 2.
+     *
+     * @param configs The enumerated tiling configs, with their tiling dims
+     * filled in.
+     * @param costFn Estimates the TilingCost of a tiling config.
+     */
+    template <typename CostFn>
+    static TilingConfig findCheapestConfig(
+            const std::vector<TilingConfig>& configs, CostFn costFn) {
+        assert(!configs.empty() && "No tiling configurations found!");
+        std::vector<TilingCost> costs;
+        costs.reserve(configs.size());
+        for (const TilingConfig& config : configs)
+            costs.push_back(costFn(config));
+        return configs[pickCheapestConfig(configs, costs)];
+    }
+
+    /**
+     * Returns the index of the cheapest one of the scored tiling configs and
+     * reports why it is chosen.
+     */
+    static int pickCheapestConfig(const std::vector<TilingConfig>& configs,
+                                  const std::vector<TilingCost>& costs);
 
     /**
      * Find the best set of dimensions to tile a given tensor shape.
@@ -66,6 +122,28 @@ class TilingOptimizerBase {
                                           const std::vector<int>& minShape,
                                           const std::vector<int>& strides,
                                           std::vector<TensorShape>& configs);
+
+    /**
+     * Generates the output tiles of a convolution whose inputs are tiled
+     * rowwise. The first and last input tiles include the zero-padding, so
+     * their output tiles can have a different number of rows from the
+     * others.
+     *
+     * @param op The convolution operator.
+     * @param inputTiledTensor The rowwise tiled inputs.
+     * @param outputChans The number of channels of each channelwise block of
+     * output tiles.
+     * @param maxOutputTileSize The largest output tile the kernel supports.
+     * @param outputTensor The output Tensor to tile.
+     * @param copyData Whether to copy the data of the output Tensor.
+     */
+    static TiledTensor generateRowwiseConvOutputTiledTensor(
+            ConvolutionOp<SmvBackend>* op,
+            const TiledTensor& inputTiledTensor,
+            const std::vector<int>& outputChans,
+            const TensorShape& maxOutputTileSize,
+            Tensor* outputTensor,
+            bool copyData);
 };
 
 }  // namespace smv
@@ -0,0 +1,158 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/types.pb.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+namespace smv {
+
+TilingPlanCache tilingPlanCache;
+
+// The first line of a plan file. Bump the version whenever the format or the
+// tiling optimizers change, so that stale plans are dropped.
+static const std::string kPlanFileHeader = "smaug-tiling-plans 2";
+
+static void writeShape(std::ostream& os, const TensorShape& shape) {
+    os << shape.getLayout() << " " << shape.getAlignment() << " "
+       << shape.ndims();
+    for (int dim : shape.dims())
+        os << " " << dim;
+}
+
+static bool readShape(std::istream& is, TensorShape* shape) {
+    int layout, alignment, ndims;
+    if (!(is >> layout >> alignment >> ndims) || ndims < 0)
+        return false;
+    std::vector<int> dims(ndims);
+    for (int i = 0; i < ndims; i++) {
+        if (!(is >> dims[i]))
+            return false;
+    }
+    *shape = ndims == 0 ? TensorShape()
+                        : TensorShape(dims, (DataLayout)layout, alignment);
+    return true;
+}
+
+static void writeTensors(std::ostream& os,
+                         const std::vector<TensorBase*>& tensors) {
+    for (auto tensor : tensors) {
+        if (!tensor) {
+            os << "[]";
+            continue;
+        }
+        const TensorShape& shape = tensor->getShape();
+        os << "[" << DataType_Name(tensor->getDataType()) << " "
+           << DataLayout_Name(shape.getLayout()) << " "
+           << shape.getAlignment();
+        for (int dim : shape.dims())
+            os << " " << dim;
+        os << "]";
+    }
+}
+
+std::string TilingPlanCache::getKey(Operator* op,
+                                    const std::vector<int>& params) {
+    std::ostringstream key;
+    key << OpType_Name(op->getOpType()) << " inputs:";
+    writeTensors(key, op->getInputs());
+    key << " outputs:";
+    writeTensors(key, op->getOutputs());
+    key << " params:";
+    for (int param : params)
+        key << " " << param;
+    key << " spad: " << SmvBackend::SpadSize()
+        << " accels: " << numAcceleratorsAvailable;
+    return key.str();
+}
+
+bool TilingPlanCache::find(const std::string& key,
+                           TilingConfig* config) const {
+    auto it = plans.find(key);
+    if (it == plans.end())
+        return false;
+    *config = it->second;
+    return true;
+}
+
+void TilingPlanCache::insert(const std::string& key,
+                             const TilingConfig& config) {
+    plans[key] = config;
+    dirty = true;
+}
+
+void TilingPlanCache::setFile(const std::string& _path) {
+    path = _path;
+    std::ifstream file(path);
+    if (!file.is_open())
+        return;
+    std::string line;
+    if (!std::getline(file, line) || line != kPlanFileHeader) {
+        std::cerr << path << " is not a tiling plan file of this version of "
+                     "SMAUG. It will be overwritten.\n";
+        return;
+    }
+    // Every plan is a line of the key, a tab, and then the input, weight and
+    // output tiling dims and shapes separated by spaces.
+    int numLoaded = 0;
+    while (std::getline(file, line)) {
+        size_t keyEnd = line.find('\t');
+        if (keyEnd == std::string::npos)
+            continue;
+        std::istringstream value(line.substr(keyEnd + 1));
+        int inputDims, weightDims, outputDims;
+        TilingConfig config;
+        if (!(value >> inputDims >> weightDims >> outputDims) ||
+            !readShape(value, &config.inputs) ||
+            !readShape(value, &config.weights) ||
+            !readShape(value, &config.outputs)) {
+            std::cerr << "Ignoring a malformed tiling plan in " << path
+                      << ".\n";
+            continue;
+        }
+        config.inputTilingDims = (TilingDims)inputDims;
+        config.weightTilingDims = (TilingDims)weightDims;
+        config.outputTilingDims = (TilingDims)outputDims;
+        plans[line.substr(0, keyEnd)] = config;
+        numLoaded++;
+    }
+    dout(0) << "Loaded " << numLoaded << " tiling plans from " << path
+            << ".\n";
+}
+
+void TilingPlanCache::flush() {
+    if (path.empty() || !dirty)
+        return;
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write the tiling plans to " << path << "!\n";
+        return;
+    }
+    file << kPlanFileHeader << "\n";
+    for (auto& plan : plans) {
+        const TilingConfig& config = plan.second;
+        file << plan.first << "\t" << (int)config.inputTilingDims << " "
+             << (int)config.weightTilingDims << " "
+             << (int)config.outputTilingDims << " ";
+        writeShape(file, config.inputs);
+        file << " ";
+        writeShape(file, config.weights);
+        file << " ";
+        writeShape(file, config.outputs);
+        file << "\n";
+    }
+    dirty = false;
+}
+
+void TilingPlanCache::clear() {
+    plans.clear();
+    dirty = false;
+}
+
+}  // namespace smv
+}  // namespace smaug
@@ -0,0 +1,74 @@
+#ifndef _OPERATORS_SMV_SMV_TILING_CACHE_H_
+#define _OPERATORS_SMV_SMV_TILING_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "smaug/core/operator.h"
+#include "smaug/operators/smv/smv_tiling_common.h"
+
+namespace smaug {
+namespace smv {
+
+/**
+ * TilingPlanCache remembers the basic tile shapes that the tiling optimizers
+ * chose for each kind of operator, so that they are only searched for once.
+ *
+ * A plan is keyed by everything the search depends on: the operator type,
+ * the shapes and data types of its inputs and outputs, the operator
+ * parameters that affect tiling (e.g. strides and padding), the scratchpad
+ * size, and the number of accelerators the tiling cost is estimated for.
+ * Operators with identical keys, such as the repeated layers of a network,
+ * share one plan, and changing a layer only invalidates the plan of that
+ * layer.
+ *
+ * Plans can be persisted in a file, so that later runs of the same model skip
+ * the search entirely.
+ */
+class TilingPlanCache {
+   public:
+    /**
+     * Returns the cache key of the operator.
+     *
+     * @param op The operator to tile. All its tensors must have been created.
+     * @param params Parameters of the operator that affect its tiling.
+     */
+    static std::string getKey(Operator* op,
+                              const std::vector<int>& params = {});
+
+    /**
+     * Looks up the plan of the key. Returns true and sets config if found.
+     */
+    bool find(const std::string& key, TilingConfig* config) const;
+
+    /** Adds the plan of the key to the cache. */
+    void insert(const std::string& key, const TilingConfig& config);
+
+    /**
+     * Loads the plans saved in the file, if it exists. New plans are written
+     * back to it by flush().
+     */
+    void setFile(const std::string& path);
+
+    /** Writes the plans to the file if any have been added since loading. */
+    void flush();
+
+    void clear();
+    int size() const { return plans.size(); }
+
+   protected:
+    std::map<std::string, TilingConfig> plans;
+    /** The file to persist the plans in. Empty if none. */
+    std::string path;
+    /** True if there are plans that haven't been written to the file. */
+    bool dirty = false;
+};
+
+/** The tiling plans of all the SMV operators. */
+extern TilingPlanCache tilingPlanCache;
+
+}  // namespace smv
+}  // namespace smaug
+
+#endif
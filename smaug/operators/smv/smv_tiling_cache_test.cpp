@@ -0,0 +1,112 @@
+#include <cstdio>
+#include <fstream>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_convolution_tiling.h"
+#include "smaug/operators/smv/smv_test_common.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
+
+using namespace smaug;
+using namespace smaug::smv;
+
+namespace smaug {
+
+class SmvTilingCacheTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    SmvConvolutionOp* createConvOp(const std::string& name,
+                                   const std::vector<int>& inputDims,
+                                   int numOfmaps,
+                                   int stride = 1) {
+        auto convOp = new SmvConvolutionOp(name, workspace());
+        convOp->setStride(stride, stride);
+        convOp->setPadding(SamePadding);
+        TensorShape inputShape(inputDims, NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor(name + "/input", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(3, 3, numOfmaps);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        return convOp;
+    }
+
+    void verifyConfig(const TilingConfig& config,
+                      const TilingConfig& expected) {
+        REQUIRE(config.inputs.dims() == expected.inputs.dims());
+        REQUIRE(config.weights.dims() == expected.weights.dims());
+        REQUIRE(config.outputs.dims() == expected.outputs.dims());
+        REQUIRE(config.inputs.storageSize() == expected.inputs.storageSize());
+        REQUIRE(config.inputTilingDims == expected.inputTilingDims);
+        REQUIRE(config.weightTilingDims == expected.weightTilingDims);
+        REQUIRE(config.outputTilingDims == expected.outputTilingDims);
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(SmvTilingCacheTest, "Tiling plan cache", "[smvtiling]") {
+    tilingPlanCache.clear();
+    auto convOp = createConvOp("conv0", { 1, 32, 32, 32 }, 64);
+    TilingConfig expected =
+            conv::TilingOptimizer::computeBasicTileShapes(convOp);
+
+    SECTION("Operators with the same shapes share a plan") {
+        convOp->tile();
+        REQUIRE(tilingPlanCache.size() == 1);
+        auto otherConvOp = createConvOp("conv1", { 1, 32, 32, 32 }, 64);
+        otherConvOp->tile();
+        REQUIRE(tilingPlanCache.size() == 1);
+        std::string key =
+                TilingPlanCache::getKey(otherConvOp, { 1, 1, SamePadding });
+        TilingConfig config;
+        REQUIRE(tilingPlanCache.find(key, &config));
+        verifyConfig(config, expected);
+        REQUIRE(otherConvOp->getTiledInput(0)->size() ==
+                convOp->getTiledInput(0)->size());
+    }
+
+    SECTION("Changing a layer changes only its key") {
+        std::string key = TilingPlanCache::getKey(convOp, { 1, 1 });
+        REQUIRE(key == TilingPlanCache::getKey(
+                               createConvOp("conv1", { 1, 32, 32, 32 }, 64),
+                               { 1, 1 }));
+        REQUIRE(key != TilingPlanCache::getKey(convOp, { 2, 2 }));
+        REQUIRE(key != TilingPlanCache::getKey(
+                               createConvOp("conv2", { 1, 32, 32, 32 }, 32),
+                               { 1, 1 }));
+        REQUIRE(key != TilingPlanCache::getKey(
+                               createConvOp("conv3", { 1, 16, 32, 32 }, 64),
+                               { 1, 1 }));
+    }
+
+    SECTION("Plans are persisted in a file") {
+        const std::string path = "smv_tiling_cache_test_plans.txt";
+        std::remove(path.c_str());
+        std::string key = TilingPlanCache::getKey(convOp);
+        TilingPlanCache cache;
+        cache.setFile(path);
+        cache.insert(key, expected);
+        cache.flush();
+
+        TilingPlanCache loadedCache;
+        loadedCache.setFile(path);
+        REQUIRE(loadedCache.size() == 1);
+        TilingConfig config;
+        REQUIRE(loadedCache.find(key, &config));
+        verifyConfig(config, expected);
+
+        SECTION("Plan files of other versions are ignored") {
+            std::ofstream(path) << "smaug-tiling-plans 0\n";
+            TilingPlanCache staleCache;
+            staleCache.setFile(path);
+            REQUIRE(staleCache.size() == 0);
+        }
+        std::remove(path.c_str());
+    }
+}
@@ -41,9 +41,9 @@ struct TilingConfig {
     TensorShape inputs;
     TensorShape weights;
     TensorShape outputs;
-    TilingDims inputTilingDims;
-    TilingDims weightTilingDims;
-    TilingDims outputTilingDims;
+    TilingDims inputTilingDims = None;
+    TilingDims weightTilingDims = None;
+    TilingDims outputTilingDims = None;
 };
 
 std::ostream& operator<<(std::ostream& os, const TilingDims& dims);
@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/smv/smv_tiling_cost.h"
+#include "smaug/utility/utils.h"
+
+namespace smaug {
+namespace smv {
+
+// Rough figures of the SMV system. Only their ratios matter for comparing
+// tiling configs.
+//
+// The bytes the host memory bus moves per cycle.
+static const double kDmaBytesPerCycle = 16;
+// The fixed cost of an invocation: accelerator setup, DMA latency and the
+// flush/invalidate of the host buffers.
+static const int kInvocationCycles = 1000;
+
+double TilingCost::getCycles() const {
+    return getTotalBytes() / kDmaBytesPerCycle +
+           (double)maxAccelInvocations * kInvocationCycles +
+           maxAccelComputeCycles;
+}
+
+std::ostream& operator<<(std::ostream& os, const TilingCost& cost) {
+    os << "inputs: " << cost.inputBytes << "B, weights: " << cost.weightBytes
+       << "B, outputs: " << cost.outputBytes << "B, invocations: "
+       << cost.invocations << " (max " << cost.maxAccelInvocations
+       << " per accelerator), est. cycles: " << (int64_t)cost.getCycles();
+    return os;
+}
+
+TilingCostModel::TilingCostModel(int numAccels, int _macsPerCycle)
+        : macsPerCycle(_macsPerCycle), lastReadInputTileIdx(numAccels, -1),
+          lastReadWeightTileIdx(numAccels, -1), accelInvocations(numAccels, 0) {
+}
+
+void TilingCostModel::invoke(int accelIdx,
+                             int inputTileIdx,
+                             int64_t inputTileBytes,
+                             int weightTileIdx,
+                             int64_t weightTileBytes,
+                             bool readWeightsAlways) {
+    if (inputTileIdx != lastReadInputTileIdx[accelIdx]) {
+        cost.inputBytes += inputTileBytes;
+        lastReadInputTileIdx[accelIdx] = inputTileIdx;
+    }
+    if (readWeightsAlways || weightTileIdx != lastReadWeightTileIdx[accelIdx]) {
+        cost.weightBytes += weightTileBytes;
+        lastReadWeightTileIdx[accelIdx] = weightTileIdx;
+    }
+    cost.invocations++;
+    accelInvocations[accelIdx]++;
+}
+
+void TilingCostModel::sendOutputs(int64_t outputTileBytes) {
+    cost.outputBytes += outputTileBytes;
+}
+
+TilingCost TilingCostModel::getCost(int64_t totalMacs) const {
+    TilingCost result = cost;
+    result.maxAccelInvocations = *std::max_element(accelInvocations.begin(),
+                                                   accelInvocations.end());
+    if (result.invocations > 0) {
+        result.maxAccelComputeCycles = totalMacs *
+                                       result.maxAccelInvocations /
+                                       result.invocations / macsPerCycle;
+    }
+    return result;
+}
+
+int getTiledStorageSize(int size, int tileSize) {
+    int numFullTiles = size / tileSize;
+    int lastTileSize = size % tileSize;
+    int storageSize = numFullTiles * (tileSize + calc_padding(
+                                                         tileSize,
+                                                         SmvBackend::Alignment));
+    if (lastTileSize > 0) {
+        storageSize += lastTileSize +
+                       calc_padding(lastTileSize, SmvBackend::Alignment);
+    }
+    return storageSize;
+}
+
+}  // namespace smv
+}  // namespace smaug
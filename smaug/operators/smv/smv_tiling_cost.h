@@ -0,0 +1,100 @@
+#ifndef _OPERATORS_SMV_SMV_TILING_COST_H_
+#define _OPERATORS_SMV_SMV_TILING_COST_H_
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace smaug {
+namespace smv {
+
+/**
+ * TilingCost is an analytical estimate of running an operator on the SMV
+ * accelerators with a particular TilingConfig.
+ */
+struct TilingCost {
+    /** Bytes of input, weight and output tiles moved by DMA. */
+    int64_t inputBytes = 0;
+    int64_t weightBytes = 0;
+    int64_t outputBytes = 0;
+    /** The total number of kernel invocations. */
+    int invocations = 0;
+    /** The number of invocations dispatched to the busiest accelerator. */
+    int maxAccelInvocations = 0;
+    /** The compute cycles of the busiest accelerator. */
+    int64_t maxAccelComputeCycles = 0;
+
+    int64_t getTotalBytes() const {
+        return inputBytes + weightBytes + outputBytes;
+    }
+
+    /**
+     * Returns the estimated number of cycles. All DMA traffic goes over the
+     * shared host memory bus, whereas the invocation overhead and compute of
+     * the accelerators overlap, so only the busiest accelerator counts.
+     */
+    double getCycles() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const TilingCost& cost);
+
+/**
+ * TilingCostModel computes the TilingCost of a TilingConfig by replaying the
+ * tile dispatch loops of an operator without touching any data.
+ *
+ * Like the operators, it remembers the last input and weight tiles each
+ * accelerator has read, so that tiles that stay in the scratchpads across
+ * invocations are only counted once.
+ */
+class TilingCostModel {
+   public:
+    /**
+     * @param numAccels The number of accelerators the tiles are dispatched
+     * to.
+     * @param macsPerCycle The MACs an accelerator does per cycle.
+     */
+    TilingCostModel(int numAccels, int macsPerCycle);
+
+    /**
+     * Records an invocation on the accelerator that uses the given input and
+     * weight tiles.
+     *
+     * @param readWeightsAlways True if the kernel reads the weight tile even
+     * if it's already in the scratchpad.
+     */
+    void invoke(int accelIdx,
+                int inputTileIdx,
+                int64_t inputTileBytes,
+                int weightTileIdx,
+                int64_t weightTileBytes,
+                bool readWeightsAlways = false);
+
+    /** Records an output tile being sent back to the host. */
+    void sendOutputs(int64_t outputTileBytes);
+
+    /**
+     * Returns the cost of the invocations recorded so far.
+     *
+     * @param totalMacs The MACs of the whole operator. They are assumed to be
+     * evenly spread over the invocations.
+     */
+    TilingCost getCost(int64_t totalMacs) const;
+
+   protected:
+    int macsPerCycle;
+    TilingCost cost;
+    std::vector<int> lastReadInputTileIdx;
+    std::vector<int> lastReadWeightTileIdx;
+    std::vector<int> accelInvocations;
+};
+
+/**
+ * Returns the number of elements a dimension takes in storage when it is split
+ * into tiles of tileSize, each of them padded to the SMV alignment.
+ */
+int getTiledStorageSize(int size, int tileSize);
+
+}  // namespace smv
+}  // namespace smaug
+
+#endif
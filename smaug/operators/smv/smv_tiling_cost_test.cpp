@@ -0,0 +1,156 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_convolution_tiling.h"
+#include "smaug/operators/smv/smv_inner_product_op.h"
+#include "smaug/operators/smv/smv_inner_product_tiling.h"
+#include "smaug/operators/smv/smv_test_common.h"
+#include "smaug/operators/smv/smv_tiling_cost.h"
+
+using namespace smaug;
+using namespace smaug::smv;
+
+namespace smaug {
+
+class SmvTilingCostTest : public SmaugTest {
+   public:
+    using SmaugTest::SmaugTest;
+
+    SmvConvolutionOp* createConvOp(const std::vector<int>& inputDims,
+                                   int weightRows,
+                                   int numOfmaps) {
+        auto convOp = new SmvConvolutionOp("conv", workspace());
+        convOp->setStride(1, 1);
+        convOp->setPadding(SamePadding);
+        TensorShape inputShape(inputDims, NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(weightRows, weightRows, numOfmaps);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        return convOp;
+    }
+
+    TilingConfig makeConfig(const std::vector<int>& inputs,
+                            const std::vector<int>& weights,
+                            const std::vector<int>& outputs,
+                            DataLayout layout = NHWC) {
+        return TilingConfig(
+                TensorShape(inputs, layout, SmvBackend::Alignment),
+                TensorShape(weights, layout, SmvBackend::Alignment),
+                TensorShape(outputs, layout, SmvBackend::Alignment));
+    }
+};
+
+}  // namespace smaug
+
+TEST_CASE_METHOD(SmvTilingCostTest, "Tiling cost model", "[smvtiling]") {
+    SECTION("Tiled storage sizes are padded per tile") {
+        REQUIRE(getTiledStorageSize(64, 32) == 64);
+        REQUIRE(getTiledStorageSize(36, 32) == 40);
+        REQUIRE(getTiledStorageSize(30, 10) == 48);
+    }
+
+    SECTION("Input tiles stay in the scratchpad across weight tiles") {
+        auto convOp = createConvOp({ 1, 16, 16, 32 }, 3, 64);
+        // One input tile and four weight tiles: the input tile is read once.
+        TilingCost cost = conv::TilingOptimizer::estimateCost(
+                convOp, makeConfig({ 1, 16, 16, 32 },
+                                   { 16, 3, 3, 32 },
+                                   { 1, 16, 16, 16 }));
+        REQUIRE(cost.invocations == 4);
+        REQUIRE(cost.inputBytes == 16 * 16 * 32 * sizeof(float16));
+        REQUIRE(cost.weightBytes == 64 * 3 * 3 * 32 * sizeof(float16));
+        REQUIRE(cost.outputBytes == 16 * 16 * 64 * sizeof(float16));
+    }
+
+    SECTION("Weight tiles are read again for every rowwise tile") {
+        auto convOp = createConvOp({ 1, 32, 64, 32 }, 2, 1024);
+        TilingCost shortTiles = conv::TilingOptimizer::estimateCost(
+                convOp, makeConfig({ 1, 2, 64, 32 },
+                                   { 128, 2, 2, 32 },
+                                   { 1, 2, 64, 128 }));
+        TilingCost tallTiles = conv::TilingOptimizer::estimateCost(
+                convOp, makeConfig({ 1, 8, 64, 32 },
+                                   { 32, 2, 2, 32 },
+                                   { 1, 8, 64, 32 }));
+        REQUIRE(shortTiles.weightBytes ==
+                31 * 1024 * 2 * 2 * 32 * sizeof(float16));
+        REQUIRE(tallTiles.weightBytes ==
+                5 * 1024 * 2 * 2 * 32 * sizeof(float16));
+        REQUIRE(tallTiles.getTotalBytes() * 2 < shortTiles.getTotalBytes());
+        REQUIRE(tallTiles.getCycles() < shortTiles.getCycles());
+
+        // The optimizer picks the cheaper one.
+        TilingConfig config =
+                conv::TilingOptimizer::computeBasicTileShapes(convOp);
+        TilingCost chosen = conv::TilingOptimizer::estimateCost(convOp, config);
+        REQUIRE(chosen.getCycles() <= tallTiles.getCycles());
+    }
+
+    SECTION("Invocations are balanced across accelerators") {
+        auto convOp = createConvOp({ 1, 16, 16, 32 }, 3, 64);
+        TilingConfig config = makeConfig(
+                { 1, 16, 16, 32 }, { 16, 3, 3, 32 }, { 1, 16, 16, 16 });
+        TilingCost oneAccel =
+                conv::TilingOptimizer::estimateCost(convOp, config);
+        numAcceleratorsAvailable = 2;
+        TilingCost twoAccels =
+                conv::TilingOptimizer::estimateCost(convOp, config);
+        numAcceleratorsAvailable = 1;
+        REQUIRE(oneAccel.maxAccelInvocations == 4);
+        REQUIRE(twoAccels.maxAccelInvocations == 2);
+        REQUIRE(twoAccels.maxAccelComputeCycles * 2 ==
+                oneAccel.maxAccelComputeCycles);
+        // Each accelerator reads the input tile into its own scratchpad.
+        REQUIRE(twoAccels.inputBytes == 2 * oneAccel.inputBytes);
+    }
+
+    SECTION("Inner product weights are read in every invocation") {
+        auto fcOp = new SmvInnerProductOp("fc", workspace());
+        TensorShape inputShape({ 1, 32768 }, NC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        fcOp->setInput(inputs, 0);
+        fcOp->setNumOutputs(256);
+        fcOp->createAllTensors();
+        allocateAllTensors<float16>(fcOp);
+        TilingCost neuronTiles = fc::TilingOptimizer::estimateCost(
+                fcOp,
+                makeConfig({ 1, 2048 }, { 8, 2048 }, { 1, 256 }, NC));
+        TilingCost actTiles = fc::TilingOptimizer::estimateCost(
+                fcOp, makeConfig({ 1, 64 }, { 256, 64 }, { 1, 256 }, NC));
+        REQUIRE(neuronTiles.invocations == actTiles.invocations);
+        REQUIRE(neuronTiles.weightBytes == actTiles.weightBytes);
+        // The input tiles are read again for every neuronwise weight tile.
+        REQUIRE(neuronTiles.inputBytes == 32 * 32768 * sizeof(float16));
+        REQUIRE(actTiles.inputBytes == 32768 * sizeof(float16));
+    }
+
+    SECTION("Inner product neuron tiles are spread over the accelerators") {
+        auto fcOp = new SmvInnerProductOp("fc", workspace());
+        TensorShape inputShape({ 1, 4096 }, NC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        fcOp->setInput(inputs, 0);
+        fcOp->setNumOutputs(128);
+        fcOp->createAllTensors();
+        allocateAllTensors<float16>(fcOp);
+        TilingConfig config =
+                makeConfig({ 1, 4096 }, { 8, 4096 }, { 1, 128 }, NC);
+        TilingCost oneAccel = fc::TilingOptimizer::estimateCost(fcOp, config);
+        numAcceleratorsAvailable = 4;
+        TilingCost fourAccels =
+                fc::TilingOptimizer::estimateCost(fcOp, config);
+        numAcceleratorsAvailable = 1;
+        REQUIRE(oneAccel.maxAccelInvocations == 16);
+        REQUIRE(fourAccels.maxAccelInvocations == 4);
+        // Every neuron tile sends back only its own outputs.
+        REQUIRE(fourAccels.outputBytes == 128 * sizeof(float16));
+        REQUIRE(oneAccel.outputBytes == fourAccels.outputBytes);
+    }
+}
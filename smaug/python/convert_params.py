@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+
+"""Converts a model parameters protobuf to a parameter archive.
+
+A parameter archive is a flat binary file that SMAUG maps into memory, so the
+parameter tensors use its data in place instead of parsing and copying it out
+of a `TensorDataArray` protobuf. The format is documented in
+smaug/core/param_archive.h. SMAUG accepts either kind of parameters file.
+
+Tensors without data are left out of the archive. SMAUG creates a tensor that
+is missing from an archive the same way as one without data in a protobuf.
+
+Usage:
+  python convert_params.py model_params.pb model_params.bin
+"""
+
+import argparse
+import array
+import struct
+
+from smaug.core import types_pb2
+from smaug.core import tensor_pb2
+
+_MAGIC = b"SMAUGPRM"
+_VERSION = 1
+# Tensor data is aligned to a cacheline.
+_ALIGNMENT = 64
+_HEADER_FORMAT = "<8sIIII"
+_ENTRY_FORMAT = "<QQQIi"
+
+# The array typecode of each repeated field of a `TensorData`, by data type.
+# Each half_data element packs two float16 values.
+_FIELDS = [
+    (types_pb2.Float16, "half_data", "i"),
+    (types_pb2.Float32, "float_data", "f"),
+    (types_pb2.Float64, "double_data", "d"),
+    (types_pb2.Int32, "int_data", "i"),
+    (types_pb2.Int64, "int64_data", "q"),
+    (types_pb2.Bool, "bool_data", "B"),
+]
+
+def _get_raw_data(tensor_data):
+  """Return a tuple of (data type, raw bytes) of a `TensorData`.
+
+  Returns None if the `TensorData` has no data.
+  """
+  if len(tensor_data.raw_data) > 0:
+    return tensor_data.data_type, tensor_data.raw_data
+  for data_type, field, typecode in _FIELDS:
+    values = getattr(tensor_data, field)
+    if len(values) > 0:
+      return data_type, array.array(typecode, values).tobytes()
+  return None
+
+def _align(offset):
+  return (offset + _ALIGNMENT - 1) // _ALIGNMENT * _ALIGNMENT
+
+def write_param_archive(tensor_data_array, archive_name):
+  """Write a `TensorDataArray` to a parameter archive.
+
+  Args:
+    tensor_data_array: The `TensorDataArray` to write.
+    archive_name: Name of the output archive file.
+  """
+  tensors = []
+  for tensor_data in tensor_data_array.data_array:
+    raw_data = _get_raw_data(tensor_data)
+    if raw_data is not None:
+      tensors.append((tensor_data.name.encode(), raw_data[0], raw_data[1]))
+
+  header_size = struct.calcsize(_HEADER_FORMAT)
+  entry_size = struct.calcsize(_ENTRY_FORMAT)
+  name_offset = header_size + entry_size * len(tensors)
+  data_offset = _align(name_offset + sum(len(t[0]) for t in tensors))
+  entries = []
+  for name, data_type, data in tensors:
+    entries.append(
+        struct.pack(
+            _ENTRY_FORMAT, name_offset, data_offset, len(data), len(name),
+            data_type))
+    name_offset += len(name)
+    data_offset = _align(data_offset + len(data))
+
+  with open(archive_name, "wb") as f:
+    f.write(
+        struct.pack(
+            _HEADER_FORMAT, _MAGIC, _VERSION, len(tensors), _ALIGNMENT, 0))
+    for entry in entries:
+      f.write(entry)
+    for name, _, _ in tensors:
+      f.write(name)
+    for _, _, data in tensors:
+      f.write(b"\0" * (_align(f.tell()) - f.tell()))
+      f.write(data)
+
+def convert_params(params_name, archive_name):
+  """Convert a model parameters protobuf to a parameter archive.
+
+  Args:
+    params_name: Name of the `TensorDataArray` protobuf file.
+    archive_name: Name of the output archive file.
+  """
+  tensor_data_array = tensor_pb2.TensorDataArray()
+  with open(params_name, "rb") as f:
+    tensor_data_array.ParseFromString(f.read())
+  write_param_archive(tensor_data_array, archive_name)
+
+if __name__ == "__main__":
+  parser = argparse.ArgumentParser(
+      description="Convert a model parameters protobuf to a parameter "
+      "archive.")
+  parser.add_argument("params", help="The model parameters protobuf.")
+  parser.add_argument("archive", help="The output parameter archive.")
+  args = parser.parse_args()
+  convert_params(args.params, args.archive)
@@ -0,0 +1,72 @@
+#!/usr/bin/env python
+
+"""Tests for python/convert_params.py."""
+
+import os
+import struct
+import tempfile
+import unittest
+import numpy as np
+
+from smaug.core import types_pb2
+from smaug.core import tensor_pb2
+from smaug.python.convert_params import write_param_archive
+
+def read_param_archive(archive_name):
+  """Return a dict of tensor name to (data type, offset, raw bytes) and the
+  alignment of an archive."""
+  with open(archive_name, "rb") as f:
+    content = f.read()
+  magic, version, num_entries, alignment, _ = struct.unpack_from(
+      "<8sIIII", content)
+  assert magic == b"SMAUGPRM" and version == 1
+  tensors = {}
+  for i in range(num_entries):
+    name_offset, data_offset, data_size, name_length, data_type = (
+        struct.unpack_from("<QQQIi", content, 24 + 32 * i))
+    name = content[name_offset:name_offset + name_length].decode()
+    tensors[name] = (data_type, data_offset,
+                     content[data_offset:data_offset + data_size])
+  return tensors, alignment
+
+class ConvertParamsTest(unittest.TestCase):
+  def test_param_archive(self):
+    x_data = np.random.rand(2, 3).astype(np.float32)
+    # Float16 data is packed two elements per int32.
+    y_data = np.random.rand(6).astype(np.float16)
+    tensor_data_array = tensor_pb2.TensorDataArray()
+    x = tensor_data_array.data_array.add(name="x")
+    x.float_data.extend(x_data.flatten().tolist())
+    y = tensor_data_array.data_array.add(name="y")
+    y.half_data.extend(y_data.view(np.int32).tolist())
+    # Tensors exported from a graph have raw data.
+    w_data = np.arange(5, dtype=np.int64)
+    w = tensor_data_array.data_array.add(
+        name="w", data_type=types_pb2.Int64, raw_data=w_data.tobytes())
+    # Tensors without data are left out.
+    tensor_data_array.data_array.add(name="z")
+    with tempfile.TemporaryDirectory() as tmp_dir:
+      archive_name = os.path.join(tmp_dir, "params.bin")
+      write_param_archive(tensor_data_array, archive_name)
+      tensors, alignment = read_param_archive(archive_name)
+    self.assertEqual(set(tensors.keys()), {x.name, y.name, w.name})
+
+    data_type, offset, data = tensors[x.name]
+    self.assertEqual(data_type, types_pb2.Float32)
+    self.assertEqual(offset % alignment, 0)
+    self.assertEqual(np.frombuffer(data, np.float32).tolist(),
+                     x_data.flatten().tolist())
+
+    data_type, offset, data = tensors[y.name]
+    self.assertEqual(data_type, types_pb2.Float16)
+    self.assertEqual(offset % alignment, 0)
+    self.assertEqual(np.frombuffer(data, np.float16).tolist(),
+                     y_data.tolist())
+
+    data_type, offset, data = tensors[w.name]
+    self.assertEqual(data_type, types_pb2.Int64)
+    self.assertEqual(offset % alignment, 0)
+    self.assertEqual(np.frombuffer(data, np.int64).tolist(), w_data.tolist())
+
+if __name__ == "__main__":
+  unittest.main()
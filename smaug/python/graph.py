@@ -20,6 +20,8 @@ class Graph:
     self._backend = backend
     self._mem_policy = mem_policy
     self._nodes = []
+    # Maps the name of every node in this graph to the node.
+    self._node_index = {}
     self._node_names = {}
     self._alignment = global_vars.backend_alignment[self._backend]
     # Layout transformation is enabled by default.
@@ -56,11 +58,12 @@ class Graph:
   def merge(self, other):
     """Merge another graph into this."""
     for node in other.get_nodes():
-      if self.get_node(node.name) is not None:
+      if node.name in self._node_index:
         raise ValueError(
             "The graph to be merged contains a node with the same name as one "
             "in the current graph. Possibly merging a graph more than once?")
-    self.get_nodes().extend(other.get_nodes())
+    for node in other.get_nodes():
+      self._add_node(node)
 
   def add_node(
       self, name, op, input_tensors, output_tensors_dims,
@@ -85,14 +88,16 @@ class Graph:
     """
     name = self.create_unique_name(name)
     node = Node(name, op, params)
-    self._nodes.append(node)
+    self._add_node(node)
 
     # Add every input tensor to the node.
     for i,tensor in enumerate(input_tensors):
       if tensor.name == None:
         tensor.name = node.name + "/input%d" % i
       node.add_input(tensor)
-      tensor.targets.append(node)
+      # A node is a target of a tensor once, however many inputs read it.
+      if node not in tensor.targets:
+        tensor.targets.append(node)
 
     # Create the output tensor (with the node as its source), and add it to the
     # node.
@@ -118,13 +123,18 @@ class Graph:
     Returns:
       A `Node` if we find the node or None is returned.
     """
-    for node in self._nodes:
-      if node.name == node_name:
-        return node
+    node = self._node_index.get(node_name)
+    if node is not None:
+      return node
     if recursive and self._parent_graph is not None:
       return self._parent_graph.get_node(node_name, True)
     return None
 
+  def _add_node(self, node):
+    """Append a node to the graph and index it by its name."""
+    self._nodes.append(node)
+    self._node_index[node.name] = node
+
   def get_nodes(self):
     """Return nodes in the graph."""
     return self._nodes
@@ -234,6 +244,20 @@ class Graph:
             "alignment(%d)" % t.shape.alignment)
       print("-----------------------------------------------------------------")
 
+def index_node_protos(graph_proto):
+  """Index the `NodeProto`s of a `GraphProto` by their names.
+
+  Use this instead of repeated `get_node_proto()` calls to look up many nodes
+  of the same `GraphProto`. The index is not updated if the proto changes.
+
+  Args:
+    graph_proto: A `GraphProto`.
+
+  Returns:
+    A dict from node names to `NodeProto`s.
+  """
+  return {node_proto.name: node_proto for node_proto in graph_proto.nodes}
+
 def get_node_proto(graph_proto, node_name):
   """Get a `NodeProto` from `GraphProto` by node name.
 
@@ -65,11 +65,21 @@ class Node:
   def update_input(self, tensor, index):
     """Update the `index`th input with `tensor`.
 
+    The targets of the old and new input tensors are updated as well, so that
+    the children of their source nodes stay correct. The node stays a target
+    of the old tensor if another of its inputs still reads it.
+
     Args:
       tensor: A `Tensor` representing the new input.
       index: The input index.
     """
+    old_tensor = self._inputs[index]
     self._inputs[index] = tensor
+    if (self in old_tensor.targets and
+        not any(t is old_tensor for t in self._inputs)):
+      old_tensor.targets.remove(self)
+    if self not in tensor.targets:
+      tensor.targets.append(self)
 
   def get_parents(self):
     """Get the parents of the node.
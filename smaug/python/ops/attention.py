@@ -48,23 +48,17 @@ class AttentionBase:
     alignment = self._compute_alignment(query)
 
     # Compute context vector (aka attention). Context is the inner product of
-    # alignments and keys along the time dimension. The shape of context is
+    # alignments and memory along the time dimension, computed for all the
+    # batches by a single batched matrix multiply. The shape of context is
     # [batch, depth].
-    # alignment_batches is shaped [1, time] * batch.
-    alignment_batches = array_ops.split(
-        alignment, self.batch_size, axis=0, name=self.name + "split")
-    # [batch, time, depth] -> [batch, depth, time] -> [depth, time] * batch.
-    values = array_ops.unstack(
-        array_ops.reorder(self.memory, types_pb2.NCT), 0,
-        name=self.name + "unstack")
-    context = []
-    for i in range(self.batch_size):
-      # Every mat_mul produces a tensor shaped [1, depth].
-      context.append(
-          nn_ops.mat_mul(
-              alignment_batches[i], values[i], name=self.name + "mm"))
-    # context shaped [batch, depth].
-    context = array_ops.concat(context, 0, name=self.name + "concat")
+    # [batch, time] -> [batch, 1, time].
+    alignment = array_ops.expand_dims(
+        alignment, 1, name=self.name + "expand")
+    # [batch, 1, time] x [batch, time, depth] -> [batch, 1, depth].
+    context = nn_ops.batch_mat_mul(
+        alignment, self.memory, name=self.name + "bmm")
+    # [batch, 1, depth] -> [batch, depth].
+    context = array_ops.squeeze(context, 1, name=self.name + "squeeze")
 
     return context
 
@@ -96,6 +96,26 @@ class ControlFlowOpsTest(SmaugTest):
           lambda: func_false(y, z))
     self.runAndValidate(graph, expected_res.tensor_data)
 
+  def test_cond_op_switch_children(self):
+    with Graph(name=self.graph_name, backend=self.backend) as graph:
+      x0 = Tensor(
+          data_layout=types_pb2.N, tensor_data=np.array([2], dtype=self.dtype))
+      x1 = Tensor(
+          data_layout=types_pb2.N, tensor_data=np.array([5], dtype=self.dtype))
+      y = Tensor(
+          data_layout=types_pb2.N, tensor_data=np.array([10], dtype=self.dtype))
+      y = data_op.input_data(y, name="y")
+      control_flow_ops.cond(
+          math_ops.less(x0, x1), lambda: math_ops.add(y, y, name="add"),
+          lambda: math_ops.mul(y, y, name="mul"))
+    # The branches read y through switch nodes, one per input of each branch,
+    # so the branch nodes are no longer children of y.
+    self.assertEqual(
+        graph.get_node("y").get_children(),
+        ["switch", "switch_1", "switch_2", "switch_3"])
+    self.assertEqual(graph.get_node("switch").get_children(), ["add"])
+    self.assertEqual(graph.get_node("switch_2").get_children(), ["mul"])
+
   def test_use_nested_op_result(self):
     def func_true(a, b):
       minus_one = Tensor(
@@ -193,3 +193,37 @@ def mat_mul(
       input_tensors=[input_tensor, weight_tensor],
       output_tensors_dims=[output_tensor_dims],
       output_tensor_layout=types_pb2.NC, params=params)[0]
+
+def batch_mat_mul(tensor_a, tensor_b, transpose_b=False, name="batch_mat_mul"):
+  """Multiply the matrices of two batches, one pair of matrices per batch.
+
+  All the batches are computed by a single operator, instead of one
+  `mat_mul` per batch.
+
+  Args:
+    tensor_a: A 3D `Tensor` shaped [batch, m, k].
+    tensor_b: A 3D `Tensor` shaped [batch, k, n], or [batch, n, k] if
+      `transpose_b` is True.
+    transpose_b: If True, the matrices of `tensor_b` are transposed before
+      the multiplication.
+    name: Operator name (optional).
+
+  Returns:
+    A tensor shaped [batch, m, n] in NTC layout.
+  """
+  dims_a = tensor_a.shape.dims
+  dims_b = tensor_b.shape.dims
+  if len(dims_a) != 3 or len(dims_b) != 3:
+    raise ValueError("batch_mat_mul requires 3D tensors.")
+  k_idx, n_idx = (2, 1) if transpose_b else (1, 2)
+  if dims_a[0] != dims_b[0] or dims_a[2] != dims_b[k_idx]:
+    raise ValueError(
+        "Tensors shaped %s and %s can't be batch multiplied." %
+        (list(dims_a), list(dims_b)))
+  params = node_pb2.Params()
+  params.batch_mat_mul_params.transpose_b = transpose_b
+  return common.add_node(
+      name=name, op=types_pb2.BatchMatMul,
+      input_tensors=[tensor_a, tensor_b],
+      output_tensors_dims=[[dims_a[0], dims_a[1], dims_b[n_idx]]],
+      output_tensor_layout=types_pb2.NTC, params=params)[0]
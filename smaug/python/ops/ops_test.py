@@ -5,7 +5,7 @@
 import unittest
 import numpy as np
 
-from smaug.python.graph import Graph, get_node_proto
+from smaug.python.graph import Graph, index_node_protos
 from smaug.python.tensor import Tensor
 from smaug.python.ops import data_op
 from smaug.python.ops import activation_ops
@@ -46,7 +46,7 @@ class OperatorTest:
       assert False, "Other layouts not expected here!"
 
   def get_node(self, name):
-    return get_node_proto(self.test_graph, name)
+    return self.test_nodes.get(name)
 
   def build_test_sequential_graph(self, backend):
     """Create a sequential model."""
@@ -104,6 +104,7 @@ class OperatorTest:
       out0, out1, out2, out3 = array_ops.unstack(out, 1, "unstack")
 
     self.test_graph, _ = graph.to_proto()
+    self.test_nodes = index_node_protos(self.test_graph)
     self.backend = backend
     self.alignment = global_vars.backend_alignment[backend]
 
@@ -164,6 +165,7 @@ class OperatorTest:
           "mul1")
 
     self.test_graph, _ = graph.to_proto()
+    self.test_nodes = index_node_protos(self.test_graph)
     self.backend = backend
     self.alignment = global_vars.backend_alignment[
         self.test_graph.backend]
@@ -1,7 +1,9 @@
 import numpy as np
 
+from smaug.core import node_pb2
 from smaug.core import types_pb2
 from smaug.python.tensor import Tensor
+from smaug.python.ops import common
 from smaug.python.ops import nn_ops
 from smaug.python.ops import math_ops
 from smaug.python.ops import array_ops
@@ -22,6 +24,7 @@ class LSTM:
     self.name = name + ":"
     self.kernel, self.recurrent_kernel = weight_tensors
     self.prepare_states()
+    self.activation_name = activation
     self.activation = activation_ops.get_activation_op(activation)
     self.activation_params = activation_params
 
@@ -38,16 +41,15 @@ class LSTM:
         name=self.name + "/c", data_layout=types_pb2.NC, tensor_data=np.zeros(
             (1, num_units), dtype=data_type))
 
-  def _concat_output_steps(self, outputs):
-    outputs_expand = []
-    for o in outputs:
-      # output is shaped [batch, depth], expand it with the time dimension.
-      outputs_expand.append(expand_dims(o, 1, name=self.name + "expand_dims"))
-    return concat(outputs_expand, 1, name=self.name + "concat")
-
-  def __call__(self, input_tensor, concat_output=False):
+  def __call__(
+      self, input_tensor, concat_output=False, return_sequences=True,
+      go_backwards=False):
     """Invoke this cell repeatedly until finishing inputs.
 
+    The timesteps are looped over by a single LSTM operator, instead of being
+    unrolled into the graph, so the size of the graph and the memory used by
+    the cell don't grow with the number of timesteps.
+
     Args:
       input_tensor: Input tensor of shape [batch, time, depth] (aka NTC layout)
         or a series of tensors shaped [batch, depth] (aka NC layout)
@@ -55,30 +57,46 @@ class LSTM:
       concat_output: If true, the output for each timestep will be concatenated
         into a single tensor, otherwise a list of output tensors will be
         returned.
+      return_sequences: If false, only the output of the last timestep is
+        returned, and the outputs of the other timesteps are not kept.
+      go_backwards: If true, the timesteps are processed from the last one to
+        the first. The outputs stay in the order of the input timesteps.
 
     Returns:
       Output contains two parts:
       1) Output tensor of shape [batch, time, depth] or
-        [batch, depth] * time if not concatenated.
+        [batch, depth] * time if not concatenated, or [batch, depth] if
+        sequences are not returned.
       2) The final state of the LSTM.
     """
-    num_steps = 0
-    if not isinstance(input_tensor, list):
-      input_steps = array_ops.unstack(
-          input_tensor, 1, name=self.name + "unstack")
-      num_steps = input_tensor.shape.dims[1]
-    else:
-      input_steps = input_tensor
-      num_steps = len(input_steps)
-    state = self.c
-    output_steps = []
-    # Unroll the timesteps.
-    for i in range(num_steps):
-      output, state = self.step(input_steps[i], i)
-      output_steps.append(output)
+    if isinstance(input_tensor, list):
+      input_tensor = _concat_steps(input_tensor, self.name)
+    if self.kernel.shape.layout != types_pb2.NC:
+      raise ValueError("The LSTM kernels must be in NC layout.")
+    batch, num_steps = input_tensor.shape.dims[:2]
+    num_units = self.recurrent_kernel.shape.dims[1]
+    output_dims = [[batch, num_units], [batch, num_units]]
+    if return_sequences:
+      output_dims.append([batch, num_steps, num_units])
+    params = node_pb2.Params()
+    params.act_params.CopyFrom(
+        activation_ops.to_proto(
+            self.activation_name, self.activation_params or None))
+    params.lstm_params.go_backwards = go_backwards
+    outputs = common.add_node(
+        name=self.name + "loop", op=types_pb2.Lstm,
+        input_tensors=[
+            input_tensor, self.kernel, self.recurrent_kernel, self.h, self.c
+        ], output_tensors_dims=output_dims,
+        output_tensor_layout=types_pb2.NC, params=params)
+    self.h, self.c = outputs[:2]
+    if not return_sequences:
+      return self.h, self.c
+    sequence = outputs[2]
+    sequence.shape.layout = types_pb2.NTC
     if concat_output:
-      return self._concat_output_steps(output_steps), state
-    return output_steps, state
+      return sequence, self.c
+    return array_ops.unstack(sequence, 1, name=self.name + "unstack"), self.c
 
   def step(self, input_tensor, timestep):
     """Invoke this cell for a single timestep.
@@ -118,6 +136,15 @@ class LSTM:
     self.h = h
     return self.h, self.c
 
+def _concat_steps(steps, name):
+  """Concatenate a series of [batch, depth] tensors into one NTC tensor."""
+  steps_expand = []
+  for step in steps:
+    # Each step is shaped [batch, depth], expand it with the time dimension.
+    steps_expand.append(
+        array_ops.expand_dims(step, 1, name=name + "expand_dims"))
+  return array_ops.concat(steps_expand, 1, name=name + "concat")
+
 class BidirectionalLSTM:
   def __init__(
       self, fwd_weight_tensors, bwd_weight_tensors, activation="tanh",
@@ -144,6 +171,12 @@ class BidirectionalLSTM:
   def __call__(self, input_tensor, concat_output=False):
     """ Invoke the bidirectional LSTM layer.
 
+    The forward and backward LSTMs each loop over all the timesteps in a
+    single operator, the backward one starting from the last timestep. The
+    output of each step concatenates the outputs of the two LSTMs at that
+    step, so the backward half of the first output comes from the last input
+    timestep.
+
     Args:
       See in the LSTM class.
 
@@ -154,20 +187,18 @@ class BidirectionalLSTM:
       2) Final state of the forward LSTM.
       3) Final state of the backward LSTM.
     """
+    if isinstance(input_tensor, list):
+      input_tensor = _concat_steps(input_tensor, self.name)
     fwd_outputs, fwd_state = self.fwd_lstm(input_tensor)
-    # Reverse the time dimension of the input for the backward LSTM.
-    input_bwd = input_tensor
-    if isinstance(input_bwd, list):
-      input_bwd.reverse()
-    else:
-      input_bwd = array_ops.unstack(input_bwd, 1)
-      input_bwd.reverse()
-    bwd_outputs, bwd_state = self.bwd_lstm(input_bwd)
+    bwd_outputs, bwd_state = self.bwd_lstm(input_tensor, go_backwards=True)
+    # The backward outputs are in the order of the input timesteps, so reverse
+    # them to pair each one with the forward output of the same step.
+    bwd_outputs.reverse()
     outputs = []
     for i in range(len(fwd_outputs)):
       outputs.append(
           array_ops.concat([fwd_outputs[i], bwd_outputs[i]], 1,
                            name=self.name + "concat"))
     if concat_output:
-      return self._concat_output_steps(outputs), fwd_state, bwd_state
+      return _concat_steps(outputs, self.name), fwd_state, bwd_state
     return outputs, fwd_state, bwd_state
@@ -75,6 +75,28 @@ class LSTMTest(SmaugTest):
 
     self.runAndValidate(graph, tf_output)
 
+  def test_lstm_is_not_unrolled(self):
+    # The size of the graph doesn't depend on the number of timesteps.
+    dtype = global_vars.backend_datatype[self.backend]
+    num_nodes = []
+    for timesteps in [4, 64]:
+      w = Tensor(
+          data_layout=types_pb2.NC,
+          tensor_data=np.random.rand(64, 16).astype(dtype))
+      u = Tensor(
+          data_layout=types_pb2.NC,
+          tensor_data=np.random.rand(64, 16).astype(dtype))
+      inputs_tensor = Tensor(
+          data_layout=types_pb2.NTC,
+          tensor_data=np.random.rand(1, timesteps, 16).astype(dtype))
+      with Graph(name=self.graph_name, backend=self.backend) as graph:
+        inputs = input_data(inputs_tensor)
+        sg_lstm = LSTM([w, u])
+        output, state = sg_lstm(inputs, return_sequences=False)
+      self.assertEqual(output.shape.dims, [1, 16])
+      num_nodes.append(len(graph.get_nodes()))
+    self.assertEqual(num_nodes[0], num_nodes[1])
+
   def test_bidirectional_lstm(self):
     # Build and run an BidirectionalLSTM layer in TF.
     tf.keras.backend.set_floatx(
@@ -95,5 +117,28 @@ class LSTMTest(SmaugTest):
 
     self.runAndValidate(graph, tf_output)
 
+  def test_bidirectional_lstm_is_not_unrolled(self):
+    dtype = global_vars.backend_datatype[self.backend]
+    num_lstms = []
+    for timesteps in [4, 64]:
+      weights = [
+          Tensor(
+              data_layout=types_pb2.NC,
+              tensor_data=np.random.rand(64, 16).astype(dtype))
+          for _ in range(4)
+      ]
+      inputs_tensor = Tensor(
+          data_layout=types_pb2.NTC,
+          tensor_data=np.random.rand(1, timesteps, 16).astype(dtype))
+      with Graph(name=self.graph_name, backend=self.backend) as graph:
+        inputs = input_data(inputs_tensor)
+        sg_bilstm = BidirectionalLSTM(weights[:2], weights[2:])
+        output, _, _ = sg_bilstm(inputs, concat_output=True)
+      self.assertEqual(output.shape.dims, [1, timesteps, 32])
+      num_lstms.append(
+          len([n for n in graph.get_nodes() if n.op == types_pb2.Lstm]))
+    # Each direction runs as a single looping operator.
+    self.assertEqual(num_lstms, [2, 2])
+
 if __name__ == "__main__":
   unittest.main()
@@ -85,5 +85,34 @@ class TestUniqueName(unittest.TestCase):
             "add_2": ["add", "add_1"]
         })
 
+  def test_get_node_in_parent_graph(self):
+    with Graph(parent_graph_name, backend) as parent_graph:
+      z = math_ops.add(x, y, name="add")
+      with Graph(child_graph_name, backend) as child_graph:
+        w = math_ops.add(z, z, name="add_1")
+        self.assertIsNone(child_graph.get_node("add"))
+        self.assertIs(child_graph.get_node("add", recursive=True), z.source)
+        self.assertIs(child_graph.get_node("add_1"), w.source)
+    self.assertIs(parent_graph.get_node("add_1"), w.source)
+
+  def test_merge_graph_twice(self):
+    with Graph(parent_graph_name, backend) as parent_graph:
+      with Graph(child_graph_name, backend) as child_graph:
+        z = math_ops.add(x, y, name="add")
+      with self.assertRaises(ValueError):
+        parent_graph.merge(child_graph)
+
+  def test_update_input_read_twice(self):
+    with Graph(parent_graph_name, backend) as parent_graph:
+      z = math_ops.add(x, y, name="add")
+      w = math_ops.add(z, z, name="add_1")
+    self.assertEqual(z.source.get_children(), ["add_1"])
+    w.source.update_input(x, 0)
+    # The second input of add_1 still reads z.
+    self.assertEqual(z.source.get_children(), ["add_1"])
+    w.source.update_input(x, 1)
+    self.assertEqual(z.source.get_children(), [])
+    self.assertEqual(w.source.get_parents(), [])
+
 if __name__ == "__main__":
   unittest.main()
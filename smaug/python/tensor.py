@@ -132,34 +132,11 @@ class Tensor:
     tensor_proto.data_type = self._data_type
     tensor_proto.data_format = self._data_format
     if self._tensor_data is not None and tensor_data_array is not None:
-
-      # Since Protobuf doesn't support float16 data type, we pack two float16
-      # elements into one int32.
-      if self._data_type == types_pb2.Float16:
-        # Numpy.view comes in handy here. Note that it won't work if
-        # tensor_data's last dimension is of odd size. To solve that, we
-        # flatten the tensor data, and if the flattened list is still of
-        # odd size, we pad a zero at the end of the list. When we later
-        # deserialize the tensor data, we know the correct shape of the
-        # tensor, and the padded zero will be discarded.
-        self._tensor_data = self._tensor_data.flatten()
-        if self._tensor_data.size % 2 != 0:
-          self._tensor_data = np.append(self._tensor_data, np.float16(0))
-        self._tensor_data = self._tensor_data.view(np.int32)
-
-      # Serialize the data into the proto.
+      # Serialize the data into the proto as raw bytes straight from the numpy
+      # buffer, which avoids creating a Python object per element.
       tensor_data_proto = tensor_data_array.data_array.add()
       tensor_data_proto.name = tensor_proto.name
-      data_list = [x for x in np.nditer(self._tensor_data)]
-      if self._data_type == types_pb2.Float16:
-        tensor_data_proto.half_data.extend(data_list)
-      elif self._data_type == types_pb2.Float32:
-        tensor_data_proto.float_data.extend(data_list)
-      elif self._data_type == types_pb2.Float64:
-        tensor_data_proto.double_data.extend(data_list)
-      elif self._data_type == types_pb2.Int32:
-        tensor_data_proto.int_data.extend(data_list)
-      elif self._data_type == types_pb2.Int64:
-        tensor_data_proto.int64_data.extend(data_list)
-      elif self._data_type == types_pb2.Bool:
-        tensor_data_proto.bool_data.extend(data_list)
+      tensor_data_proto.data_type = self._data_type
+      tensor_data_proto.raw_data = np.ascontiguousarray(
+          self._tensor_data,
+          dtype=self._tensor_data.dtype.newbyteorder("<")).tobytes()
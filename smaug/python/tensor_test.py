@@ -12,16 +12,23 @@ from smaug.python.ops.data_op import input_data
 from smaug.core import types_pb2
 
 class TensorTestBase(unittest.TestCase):
-  def assertEqualFP16(self, packed_fp16_data, unpacked_fp16_data):
-    """Test equality between packed and unpacked float16 lists.
+  def assertTensorData(self, tensor_data_proto, data_type, expected_data):
+    """Test that a tensor data proto holds the expected data as raw bytes.
 
     Args:
-      packed_fp16_data: A list of int32 values, each of which represents two
-        packed float16 elements. The zeroth index fp16 value is in the lower
-        16 bytes.
-      unpacked_data: A numpy array of float16 values.
+      tensor_data_proto: A `TensorData` proto.
+      data_type: The expected SMAUG data type.
+      expected_data: A numpy array of the expected values, in storage order.
     """
-    self.assertEqual(packed_fp16_data, list(unpacked_fp16_data.view(np.int32)))
+    self.assertEqual(tensor_data_proto.data_type, data_type)
+    self.assertEqual(
+        list(np.frombuffer(tensor_data_proto.raw_data, expected_data.dtype)),
+        list(expected_data.flatten()))
+    self.assertEqual(len(tensor_data_proto.half_data), 0)
+    self.assertEqual(len(tensor_data_proto.float_data), 0)
+    self.assertEqual(len(tensor_data_proto.double_data), 0)
+    self.assertEqual(len(tensor_data_proto.int_data), 0)
+    self.assertEqual(len(tensor_data_proto.int64_data), 0)
 
 class TensorBasicTest(TensorTestBase):
   def test_attr_reference(self):
@@ -39,11 +46,7 @@ class TensorBasicTest(TensorTestBase):
     self.assertEqual(node.input_tensors[0].shape.alignment, 0)
     tensor_data_proto = get_tensor_data(
         tensor_data_array, node.input_tensors[0].name)
-    self.assertEqual(tensor_data_proto.float_data, list(tensor_data.flatten()))
-    self.assertEqual(len(tensor_data_proto.half_data), 0)
-    self.assertEqual(len(tensor_data_proto.double_data), 0)
-    self.assertEqual(len(tensor_data_proto.int_data), 0)
-    self.assertEqual(len(tensor_data_proto.int64_data), 0)
+    self.assertTensorData(tensor_data_proto, types_pb2.Float32, tensor_data)
 
   def test_attr_smv_no_padding(self):
     """Test tensor attributes with SMV backend. No padding is required."""
@@ -60,11 +63,7 @@ class TensorBasicTest(TensorTestBase):
     self.assertEqual(node.input_tensors[0].shape.alignment, 8)
     tensor_data_proto = get_tensor_data(
         tensor_data_array, node.input_tensors[0].name)
-    self.assertEqualFP16(tensor_data_proto.half_data, tensor_data.flatten())
-    self.assertEqual(len(tensor_data_proto.float_data), 0)
-    self.assertEqual(len(tensor_data_proto.double_data), 0)
-    self.assertEqual(len(tensor_data_proto.int_data), 0)
-    self.assertEqual(len(tensor_data_proto.int64_data), 0)
+    self.assertTensorData(tensor_data_proto, types_pb2.Float16, tensor_data)
 
   def test_attr_smv_padding(self):
     """Test tensor attributes with SMV backend. Additional padding required."""
@@ -82,19 +81,15 @@ class TensorBasicTest(TensorTestBase):
     self.assertEqual(node.input_tensors[0].shape.alignment, 8)
     tensor_data_proto = get_tensor_data(
         tensor_data_array, node.input_tensors[0].name)
-    self.assertEqualFP16(
-        tensor_data_proto.half_data,
+    self.assertTensorData(
+        tensor_data_proto, types_pb2.Float16,
         np.array(
             [1.1, 2.2, 3.3, 4.4, 0, 0, 0, 0, 5.5, 6.6, 7.7, 8.8, 0, 0, 0, 0],
             dtype=np.float16))
-    self.assertEqual(len(tensor_data_proto.float_data), 0)
-    self.assertEqual(len(tensor_data_proto.double_data), 0)
-    self.assertEqual(len(tensor_data_proto.int_data), 0)
-    self.assertEqual(len(tensor_data_proto.int64_data), 0)
 
 class FP16Test(TensorTestBase):
   def test_fp16_even(self):
-    """Test float16 packing when tensor's last dimension is of even size"""
+    """Test float16 data when tensor's last dimension is of even size"""
     tensor_data = np.random.rand(4, 2).astype(np.float16)
     with Graph("test_graph", "Reference") as test_graph:
       input_tensor = Tensor(tensor_data=tensor_data)
@@ -104,10 +99,10 @@ class FP16Test(TensorTestBase):
     self.assertEqual(node.input_tensors[0].data_type, types_pb2.Float16)
     tensor_data_proto = get_tensor_data(
         tensor_data_array, node.input_tensors[0].name)
-    self.assertEqualFP16(tensor_data_proto.half_data, tensor_data.flatten())
+    self.assertTensorData(tensor_data_proto, types_pb2.Float16, tensor_data)
 
   def test_fp16_odd(self):
-    """Test float16 packing when tensor's last dimension is of odd size"""
+    """Test float16 data when tensor's last dimension is of odd size"""
     tensor_data = np.random.rand(4, 3).astype(np.float16)
     with Graph("test_graph", "Reference") as test_graph:
       input_tensor = Tensor(tensor_data=tensor_data)
@@ -117,12 +112,13 @@ class FP16Test(TensorTestBase):
     self.assertEqual(node.input_tensors[0].data_type, types_pb2.Float16)
     tensor_data_proto = get_tensor_data(
         tensor_data_array, node.input_tensors[0].name)
-    self.assertEqualFP16(tensor_data_proto.half_data, tensor_data.flatten())
+    self.assertTensorData(tensor_data_proto, types_pb2.Float16, tensor_data)
 
   def test_fp16_odd_odd(self):
-    """Test float16 packing when tensor's last dimension is of odd size.
+    """Test float16 data when tensor's last dimension is of odd size.
 
-    This tests the case when the flattened tensor is still of odd size.
+    This tests the case when the flattened tensor is still of odd size, which
+    needs no padding in raw data.
     """
     tensor_data = np.random.rand(3, 3).astype(np.float16)
     with Graph("test_graph", "Reference") as test_graph:
@@ -133,8 +129,7 @@ class FP16Test(TensorTestBase):
     self.assertEqual(node.input_tensors[0].data_type, types_pb2.Float16)
     tensor_data_proto = get_tensor_data(
         tensor_data_array, node.input_tensors[0].name)
-    self.assertEqualFP16(tensor_data_proto.half_data,
-                         np.append(tensor_data.flatten(), np.float16(0)))
+    self.assertTensorData(tensor_data_proto, types_pb2.Float16, tensor_data)
 
 if __name__ == "__main__":
   unittest.main()
@@ -1,13 +1,17 @@
+#include <algorithm>
 #include <fstream>
 #include <string>
+#include <thread>
 
 #include <boost/program_options.hpp>
 
 #include "core/backend.h"
 #include "core/globals.h"
+#include "core/inference_server.h"
 #include "core/scheduler.h"
 #include "core/network_builder.h"
 #include "operators/common.h"
+#include "operators/smv/smv_tiling_cache.h"
 #include "utility/debug_stream.h"
 #include "utility/utils.h"
 #include "utility/thread_pool.h"
@@ -28,7 +32,15 @@ int main(int argc, char* argv[]) {
     sampling.num_sample_iterations = 1;
     numAcceleratorsAvailable = 1;
     int numThreads = -1;
+    std::string schedulerType = "serial";
+    int numSchedulerThreads = std::thread::hardware_concurrency();
     useSystolicArrayWhenAvailable = false;
+    pipelineTiles = false;
+    bool serve = false;
+    std::string serveSocket;
+    std::string serveInput = "data";
+    int maxBatchDelayUs = 0;
+    std::string tilingPlanFile;
     po::options_description options(
             "SMAUG Usage:  ./smaug model_topo.pbtxt model_params.pb [options]");
     // clang-format off
@@ -67,16 +79,48 @@ int main(int argc, char* argv[]) {
         ("num-threads",
          po::value(&numThreads)->implicit_value(1),
          "Number of threads in the thread pool.")
+        ("scheduler",
+         po::value(&schedulerType)->implicit_value("serial"),
+         "Set the operator scheduling policy. There are two options: serial "
+         "and parallel. The parallel scheduler runs independent operators of "
+         "the network concurrently and is only supported in native "
+         "execution. By default, operators are scheduled serially.")
+        ("num-scheduler-threads",
+         po::value(&numSchedulerThreads),
+         "Number of threads used by the parallel scheduler. By default, this "
+         "is the number of host CPUs.")
+        ("tiling-plans", po::value(&tilingPlanFile),
+         "Load the tiling plans of the operators from this file, and save "
+         "new ones to it, so that later runs of models with the same layers "
+         "skip searching for them.")
         ("use-systolic-array",
          po::value(&useSystolicArrayWhenAvailable)->implicit_value(true),
-         "If the backend contains a systolic array, use it whenever possible.");
+         "If the backend contains a systolic array, use it whenever possible.")
+        ("pipeline-tiles", po::value(&pipelineTiles)->implicit_value(true),
+         "Overlap copying data into and out of the tiles of SMV operators "
+         "with their kernels. Requires --num-threads and native execution.")
+        ("serve", po::value(&serve)->implicit_value(true),
+         "Load the network once and run it on each request read from stdin, "
+         "writing the responses to stdout. A request is a serialized "
+         "TensorProto of the input, prefixed by its size as a uint32. All "
+         "other output goes to stderr.")
+        ("serve-socket", po::value(&serveSocket),
+         "Serve requests from the clients of a Unix domain socket bound to "
+         "this path instead of stdin.")
+        ("serve-input", po::value(&serveInput),
+         "Name of the data operator whose output the requests are written "
+         "to. By default, this is 'data'.")
+        ("max-batch-delay", po::value(&maxBatchDelayUs),
+         "In serving mode, how long in microseconds to wait for more "
+         "requests to fill a batch. By default, requests are run as soon as "
+         "the network is idle.");
     // clang-format on
 
     po::options_description hidden;
     hidden.add_options()("model-topo-file", po::value(&modelTopo),
                          "Model topology protobuf file");
     hidden.add_options()("model-params-file", po::value(&modelParams),
-                         "Model parameters protobuf file");
+                         "Model parameters protobuf or parameter archive file");
     po::options_description all, visible;
     all.add(options).add(hidden);
     visible.add(options);
@@ -105,6 +149,9 @@ int main(int argc, char* argv[]) {
         std::cout << "The model protobuf files must be specified!\n";
         exit(1);
     }
+    // In serving mode, stdout carries the responses.
+    if (serve && serveSocket.empty())
+        std::cout.rdbuf(std::cerr.rdbuf());
     initDebugStream(debugLevel);
 
     std::cout << "Model topology file: " << modelTopo << "\n";
@@ -142,11 +189,38 @@ int main(int argc, char* argv[]) {
                      "by 1.\n";
     }
 
+    if (schedulerType != "serial" && schedulerType != "parallel") {
+        std::cout << "Doesn't support the specified scheduler: "
+                  << schedulerType << "\n";
+        exit(1);
+    }
+    if (schedulerType == "parallel") {
+        if (runningInSimulation) {
+            std::cout << "The parallel scheduler is not supported in gem5 "
+                         "simulation!\n";
+            exit(1);
+        }
+        numSchedulerThreads = std::max(numSchedulerThreads, 1);
+        std::cout << "Using the parallel scheduler, number of threads: "
+                  << numSchedulerThreads << ".\n";
+    }
+
     if (numThreads != -1) {
         std::cout << "Using a thread pool, size: " << numThreads << ".\n";
-        threadPool = new ThreadPool(numThreads);
+        if (runningInSimulation)
+            threadPool = new Gem5ThreadPool(numThreads);
+        else
+            threadPool = new WorkStealingThreadPool(numThreads);
+    }
+    if (pipelineTiles && (runningInSimulation || !threadPool)) {
+        std::cerr << "Pipelining tiles requires a thread pool in native "
+                     "execution. Ignoring --pipeline-tiles.\n";
+        pipelineTiles = false;
     }
 
+    if (!tilingPlanFile.empty())
+        smv::tilingPlanCache.setFile(tilingPlanFile);
+
     Workspace* workspace = new Workspace();
     Network* network =
             buildNetwork(modelTopo, modelParams, sampling, workspace);
@@ -159,10 +233,44 @@ int main(int argc, char* argv[]) {
     if (!network->validate())
         return -1;
 
-    Scheduler scheduler(network, workspace);
-    Tensor* output = scheduler.runNetwork();
+    Scheduler* scheduler;
+    if (schedulerType == "parallel") {
+        scheduler =
+                new ParallelScheduler(network, workspace, numSchedulerThreads);
+    } else {
+        scheduler = new Scheduler(network, workspace);
+    }
+    Operator* inputOp = nullptr;
+    if (serve || !serveSocket.empty()) {
+        auto inputIt = network->getOperators().find(serveInput);
+        if (inputIt != network->getOperators().end())
+            inputOp = inputIt->second;
+        if (!inputOp || inputOp->getOpType() != Data) {
+            std::cout << "The network has no data operator named "
+                      << serveInput << "!\n";
+            exit(1);
+        }
+    }
+    // Save the tiling plans that were searched for while tiling the network,
+    // so that the next runs can skip the search. This is still part of the
+    // fast-forwarded setup, which prepareNetwork() ends.
+    scheduler->tileNetwork();
+    smv::tilingPlanCache.flush();
+    scheduler->prepareNetwork();
+    Tensor* output = nullptr;
+    if (inputOp) {
+        InferenceServer server(
+                network, scheduler, inputOp->getOutput(0), maxBatchDelayUs);
+        if (serveSocket.empty())
+            server.serveStream(STDIN_FILENO, STDOUT_FILENO);
+        else
+            server.serveSocket(serveSocket);
+        std::cout << "Served " << server.getNumRuns() << " batches.\n";
+    } else {
+        output = scheduler->runNetwork();
+    }
 
-    if (!lastOutputFile.empty()) {
+    if (output && !lastOutputFile.empty()) {
         if (lastOutputFile == "stdout") {
             std::cout << "Final network output:\n" << *output << "\n";
         } else if (lastOutputFile == "proto") {
@@ -183,6 +291,7 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    delete scheduler;
     if (threadPool)
         delete threadPool;
 
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 #include "smaug/utility/thread_pool.h"
 #include "smaug/utility/utils.h"
 #include "smaug/core/globals.h"
@@ -5,9 +9,9 @@
 
 namespace smaug {
 
-ThreadPool::ThreadPool(int nthreads) : workers(nthreads) {}
+Gem5ThreadPool::Gem5ThreadPool(int nthreads) : workers(nthreads) {}
 
-ThreadPool::~ThreadPool() {
+Gem5ThreadPool::~Gem5ThreadPool() {
     // Shutdown the thread pool and free all resources.
     for (int i = 0; i < workers.size(); i++) {
         WorkerThread* worker = &workers[i];
@@ -26,7 +30,7 @@ ThreadPool::~ThreadPool() {
     }
 }
 
-void* ThreadPool::workerLoop(void* args) {
+void* Gem5ThreadPool::workerLoop(void* args) {
     ThreadInitArgs* initArgs = reinterpret_cast<ThreadInitArgs*>(args);
     WorkerThread* worker = initArgs->worker;
     // Notify the main thread about this thread's cpuid. This can only be done
@@ -63,13 +67,13 @@ void* ThreadPool::workerLoop(void* args) {
     pthread_exit(NULL);
 }
 
-void ThreadPool::initThreadPool() {
+void Gem5ThreadPool::initThreadPool() {
     // Initialize the CPU ID for each worker thread.
     for (int i = 0; i < workers.size(); i++) {
         WorkerThread* worker = &workers[i];
         ThreadInitArgs initArgs(worker);
         pthread_create(
-                &worker->thread, NULL, &ThreadPool::workerLoop, &initArgs);
+                &worker->thread, NULL, &Gem5ThreadPool::workerLoop, &initArgs);
 
         // Fill in the CPU ID of the worker thread.
         pthread_mutex_lock(&initArgs.cpuidMutex);
@@ -82,7 +86,7 @@ void ThreadPool::initThreadPool() {
     }
 }
 
-int ThreadPool::dispatchThread(WorkerThreadFunc func, void* args) {
+int Gem5ThreadPool::dispatchThread(WorkerThreadFunc func, void* args) {
     for (int i = 0; i < workers.size(); i++) {
         WorkerThread* worker = &workers[i];
         pthread_mutex_lock(&worker->statusMutex);
@@ -100,7 +104,7 @@ int ThreadPool::dispatchThread(WorkerThreadFunc func, void* args) {
     return -1;
 }
 
-void ThreadPool::joinThreadPool() {
+void Gem5ThreadPool::joinThreadPool() {
     // There is no need to call wakeCpu here. If the CPU is quiesced, then
     // it cannot possibly be running anything, so its status will be Idle, and
     // this will move on to the next CPU.
@@ -113,4 +117,198 @@ void ThreadPool::joinThreadPool() {
     }
 }
 
+namespace {
+
+/** The arguments of a chunk of Gem5ThreadPool::parallelFor. */
+struct ParallelForArgs {
+    const std::function<void(int, int)>* fn;
+    int start;
+    int end;
+};
+
+void* parallelForWorker(void* _args) {
+    auto args = reinterpret_cast<ParallelForArgs*>(_args);
+    (*args->fn)(args->start, args->end);
+    return nullptr;
+}
+
+/** The pool and worker index of the calling thread, if it is a worker. */
+thread_local const WorkStealingThreadPool* currentPool = nullptr;
+thread_local int currentWorker = -1;
+
+}  // namespace
+
+void Gem5ThreadPool::parallelFor(int begin,
+                                 int end,
+                                 int grain,
+                                 const std::function<void(int, int)>& fn) {
+    int numIters = end - begin;
+    if (numIters <= 0)
+        return;
+    int numChunks = std::min<int>(
+            workers.size(), std::ceil(numIters * 1.0 / std::max(grain, 1)));
+    int chunkSize = std::ceil(numIters * 1.0 / numChunks);
+    std::vector<ParallelForArgs> args;
+    for (int start = begin; start < end; start += chunkSize)
+        args.push_back({ &fn, start, std::min(start + chunkSize, end) });
+    for (auto& chunkArgs : args) {
+        int cpuid = dispatchThread(parallelForWorker, (void*)&chunkArgs);
+        assert(cpuid != -1 && "Failed to dispatch thread!");
+    }
+    joinThreadPool();
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(int nthreads)
+        : numWorkers(nthreads), numQueuedTasks(0), nextQueue(0), exit(false) {
+    for (int i = 0; i < numWorkers; i++)
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        exit = true;
+    }
+    sleepCond.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void WorkStealingThreadPool::initThreadPool() {
+    assert(threads.empty() && "The thread pool is already initialized!");
+    for (int i = 0; i < numWorkers; i++)
+        threads.emplace_back(&WorkStealingThreadPool::workerLoop, this, i);
+}
+
+int WorkStealingThreadPool::currentWorkerIdx() const {
+    return currentPool == this ? currentWorker : -1;
+}
+
+void WorkStealingThreadPool::schedule(Task task) {
+    int workerIdx = currentWorkerIdx();
+    // Tasks created by a worker go to its own deque, so they are likely to
+    // run on the same CPU; the others are spread over all the workers.
+    int queueIdx = workerIdx != -1 ? workerIdx : nextQueue++ % numWorkers;
+    WorkerQueue* queue = queues[queueIdx].get();
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(std::move(task));
+    }
+    {
+        // Update the count under the sleep lock, so that a worker that is
+        // about to sleep cannot miss the notification.
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        numQueuedTasks++;
+    }
+    sleepCond.notify_one();
+}
+
+bool WorkStealingThreadPool::popTask(int workerIdx, Task& task) {
+    if (numQueuedTasks == 0)
+        return false;
+    // Look at the worker's own deque first, and then steal from the others.
+    int first = workerIdx != -1 ? workerIdx : 0;
+    for (int i = 0; i < numWorkers; i++) {
+        int queueIdx = (first + i) % numWorkers;
+        WorkerQueue* queue = queues[queueIdx].get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->tasks.empty())
+            continue;
+        if (queueIdx == workerIdx) {
+            task = std::move(queue->tasks.back());
+            queue->tasks.pop_back();
+        } else {
+            task = std::move(queue->tasks.front());
+            queue->tasks.pop_front();
+        }
+        numQueuedTasks--;
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingThreadPool::runPendingTask() {
+    Task task;
+    if (!popTask(currentWorkerIdx(), task))
+        return false;
+    task();
+    return true;
+}
+
+void WorkStealingThreadPool::workerLoop(int workerIdx) {
+    currentPool = this;
+    currentWorker = workerIdx;
+    while (true) {
+        Task task;
+        if (popTask(workerIdx, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCond.wait(lock, [this]() { return exit || numQueuedTasks > 0; });
+        if (exit)
+            break;
+    }
+}
+
+void WorkStealingThreadPool::parallelFor(
+        int begin,
+        int end,
+        int grain,
+        const std::function<void(int, int)>& fn) {
+    grain = std::max(grain, 1);
+    if (end - begin <= grain) {
+        if (end > begin)
+            fn(begin, end);
+        return;
+    }
+    TaskGroup group(this);
+    for (int start = begin; start < end; start += grain) {
+        int chunkEnd = std::min(start + grain, end);
+        group.run([&fn, start, chunkEnd]() { fn(start, chunkEnd); });
+    }
+    group.wait();
+}
+
+void TaskGroup::run(std::function<void()> func) {
+    numPending++;
+    pool->schedule([this, func]() {
+        std::exception_ptr taskError;
+        try {
+            func();
+        } catch (...) {
+            taskError = std::current_exception();
+        }
+        // Decrement under the lock: wait() acquires it before returning, so
+        // the group cannot be destroyed while we are still using it.
+        std::lock_guard<std::mutex> lock(mutex);
+        if (taskError && !error)
+            error = taskError;
+        if (--numPending == 0)
+            doneCond.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    waitForTasks();
+    std::exception_ptr taskError;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(taskError, error);
+    }
+    if (taskError)
+        std::rethrow_exception(taskError);
+}
+
+void TaskGroup::waitForTasks() {
+    while (numPending > 0 && pool->runPendingTask()) {
+    }
+    // Nothing is left to run here, so the remaining tasks of the group are
+    // running on other threads. Those threads run any tasks they create
+    // themselves while waiting for them, so sleep until the last task of the
+    // group wakes us up.
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCond.wait(lock, [this]() { return numPending == 0; });
+}
+
 }  // namespace smaug
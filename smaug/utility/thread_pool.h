@@ -2,10 +2,59 @@
 #define _UTILITY_THREAD_POOL_H_
 
 #include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace smaug {
 
+/**
+ * The interface of the user-space thread pools used by SMAUG to run
+ * multithreaded tasks.
+ *
+ * There are two implementations, selected by how SMAUG is run: Gem5ThreadPool
+ * is used in gem5 simulation, and WorkStealingThreadPool in native execution.
+ */
+class ThreadPool {
+   public:
+    virtual ~ThreadPool() {}
+
+    /** Returns the number of worker threads. */
+    virtual int size() const = 0;
+
+    /**
+     * Initialize the thread pool.
+     *
+     * Initialization must be postponed until after fast-forwarding is
+     * finished, or we will get incorrect CPU IDs.
+     *
+     * This can only be called once; any subsequent call will assert fail.
+     */
+    virtual void initThreadPool() = 0;
+
+    /**
+     * Runs fn(start, end) over chunks of [begin, end) on the thread pool and
+     * waits until all the chunks are done.
+     *
+     * @param begin The first index of the range.
+     * @param end One past the last index of the range.
+     * @param grain The minimum number of indices in a chunk.
+     * @param fn The function run on every chunk [start, end).
+     */
+    virtual void parallelFor(int begin,
+                             int end,
+                             int grain,
+                             const std::function<void(int, int)>& fn) = 0;
+};
+
 /**
  * A user-space cooperatve thread pool implementation designed for gem5 in SE
  * mode.
@@ -20,34 +69,37 @@ namespace smaug {
  * implementation quiesces all inactive CPUs and wakes them up only when there
  * is work to do. This is done via magic gem5 instructions.
  */
-class ThreadPool {
+class Gem5ThreadPool : public ThreadPool {
    public:
     /**
-     * Create a ThreadPool with N threads.
+     * Create a Gem5ThreadPool with N threads.
      *
      * The simulation must be created with at least N+1 CPUs, since we need one
      * CPU to run the main thread.
      */
-    ThreadPool(int nthreads);
-    ~ThreadPool();
+    Gem5ThreadPool(int nthreads);
+    ~Gem5ThreadPool();
 
     /** Function signature for any work to be executed on a worker thread. */
     typedef void* (*WorkerThreadFunc)(void*);
 
-    /** Returns the number of worker threads. */
-    int size() const { return workers.size(); }
+    int size() const override { return workers.size(); }
+
+    void initThreadPool() override;
 
     /**
-     * Initialize the thread pool.
-     *
-     * Initialization must be postponed until after fast-forwarding is
-     * finished, or we will get incorrect CPU IDs.
-     *
-     * This can only be called once; any subsequent call will assert fail.
+     * Splits the range into at most one chunk per worker thread, since every
+     * worker can only hold one piece of work at a time.
      */
-    void initThreadPool();
+    void parallelFor(int begin,
+                     int end,
+                     int grain,
+                     const std::function<void(int, int)>& fn) override;
 
-    /** Dispatch the function to a worker in the thread pool. */
+    /**
+     * Dispatch the function to a worker in the thread pool. Returns the index
+     * of the worker, or -1 if all the workers are busy.
+     */
     int dispatchThread(WorkerThreadFunc func, void* args);
 
     /** Wait for all threads in the pool to finish work. */
@@ -120,6 +172,140 @@ class ThreadPool {
     std::vector<WorkerThread> workers;
 };
 
+/**
+ * A work-stealing thread pool for native execution.
+ *
+ * Every worker thread owns a deque of tasks. A worker pushes and pops the
+ * tasks it creates at the back of its own deque, and when that runs dry, it
+ * steals from the front of the other workers' deques. Tasks submitted from
+ * threads outside of the pool are distributed over the workers' deques in a
+ * round-robin fashion. Any number of tasks can be outstanding, and a thread
+ * waiting for a TaskGroup runs pending tasks instead of blocking, so tasks can
+ * themselves use the pool (e.g. nested parallelFor calls).
+ */
+class WorkStealingThreadPool : public ThreadPool {
+   public:
+    /** A unit of work run by the thread pool. */
+    typedef std::function<void()> Task;
+
+    WorkStealingThreadPool(int nthreads);
+    ~WorkStealingThreadPool();
+
+    int size() const override { return numWorkers; }
+
+    void initThreadPool() override;
+
+    /** Splits the range into chunks of grain indices, run as separate tasks. */
+    void parallelFor(int begin,
+                     int end,
+                     int grain,
+                     const std::function<void(int, int)>& fn) override;
+
+    /**
+     * Submits a function to the thread pool and returns a future holding its
+     * result.
+     *
+     * Waiting on the future from within a task blocks the worker; use a
+     * TaskGroup for work that tasks wait on.
+     */
+    template <typename Func>
+    std::future<typename std::result_of<Func()>::type> submit(Func func) {
+        typedef typename std::result_of<Func()>::type Result;
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+                std::move(func));
+        auto future = task->get_future();
+        schedule([task]() { (*task)(); });
+        return future;
+    }
+
+    /** Adds a task to the thread pool. */
+    void schedule(Task task);
+
+    /**
+     * Runs one pending task on the calling thread, if there is any. Returns
+     * true if a task was run.
+     */
+    bool runPendingTask();
+
+   protected:
+    /** The task deque of a worker thread. */
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /** The main event loop executed by all worker threads. */
+    void workerLoop(int workerIdx);
+
+    /**
+     * Pops a task from the back of the deque of worker workerIdx, or steals
+     * one from the front of another worker's deque. Pass -1 as the worker
+     * index from threads that don't belong to the pool.
+     */
+    bool popTask(int workerIdx, Task& task);
+
+    /** Returns the index of the calling worker thread, or -1. */
+    int currentWorkerIdx() const;
+
+    /** Number of worker threads. */
+    int numWorkers;
+    /** The task deques, one for each worker thread. */
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    /** Worker threads. */
+    std::vector<std::thread> threads;
+    /** Number of tasks sitting in the deques. */
+    std::atomic<int> numQueuedTasks;
+    /** Picks the deque of the next task submitted from outside of the pool. */
+    std::atomic<unsigned> nextQueue;
+    /** Idle workers sleep on sleepCond until there are tasks or we exit. */
+    std::mutex sleepMutex;
+    std::condition_variable sleepCond;
+    bool exit;
+};
+
+/**
+ * A group of tasks that can be waited on together.
+ *
+ * To use:
+ *
+ * ```c
+ * TaskGroup group(pool);
+ * for (int i = 0; i < n; i++)
+ *     group.run([i]() { work(i); });
+ * group.wait();
+ * ```
+ */
+class TaskGroup {
+   public:
+    TaskGroup(WorkStealingThreadPool* _pool) : pool(_pool), numPending(0) {}
+    ~TaskGroup() { waitForTasks(); }
+
+    /** Runs the function as a task of this group. */
+    void run(std::function<void()> func);
+
+    /**
+     * Waits until all the tasks of this group are finished. While waiting,
+     * the calling thread helps by running pending tasks of the pool.
+     *
+     * If any task threw an exception, the first one is rethrown here once all
+     * the tasks are finished.
+     */
+    void wait();
+
+   protected:
+    /** Waits for the tasks of this group without rethrowing their errors. */
+    void waitForTasks();
+
+    WorkStealingThreadPool* pool;
+    /** Number of tasks of this group that have not finished. */
+    std::atomic<int> numPending;
+    /** The first exception thrown by a task of this group, if any. */
+    std::exception_ptr error;
+    /** Signaled when the last task of the group finishes. */
+    std::mutex mutex;
+    std::condition_variable doneCond;
+};
+
 }  // namespace smaug
 
 #endif
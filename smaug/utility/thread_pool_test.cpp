@@ -0,0 +1,98 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+#include "smaug/core/globals.h"
+#include "smaug/utility/thread_pool.h"
+
+using namespace smaug;
+
+// Runs a parallelFor over [0, size) and checks that every index is visited
+// exactly once.
+void verifyParallelFor(ThreadPool* pool, int size, int grain) {
+    std::vector<std::atomic<int>> visits(size);
+    for (auto& count : visits)
+        count = 0;
+    // Catch2 assertions are not thread-safe, so only count in the workers.
+    pool->parallelFor(0, size, grain, [&](int start, int end) {
+        for (int i = start; i < end; i++)
+            visits[i]++;
+    });
+    for (int i = 0; i < size; i++)
+        REQUIRE(visits[i] == 1);
+}
+
+TEST_CASE("Work-stealing thread pool", "[threadpool]") {
+    runningInSimulation = false;
+    WorkStealingThreadPool pool(4);
+    pool.initThreadPool();
+
+    SECTION("parallelFor visits every index once") {
+        verifyParallelFor(&pool, 1, 1);
+        verifyParallelFor(&pool, 1000, 1);
+        verifyParallelFor(&pool, 1000, 7);
+        verifyParallelFor(&pool, 1000, 5000);
+    }
+
+    SECTION("Nested parallelFor") {
+        std::atomic<int> sum(0);
+        pool.parallelFor(0, 16, 1, [&](int start, int end) {
+            for (int i = start; i < end; i++) {
+                pool.parallelFor(0, 100, 3, [&](int s, int e) {
+                    for (int j = s; j < e; j++)
+                        sum += j;
+                });
+            }
+        });
+        REQUIRE(sum == 16 * 4950);
+    }
+
+    SECTION("Futures of submitted tasks") {
+        std::vector<std::future<int>> futures;
+        for (int i = 0; i < 100; i++)
+            futures.push_back(pool.submit([i]() { return i * i; }));
+        for (int i = 0; i < 100; i++)
+            REQUIRE(futures[i].get() == i * i);
+    }
+
+    SECTION("Task groups") {
+        std::atomic<int> count(0);
+        TaskGroup group(&pool);
+        for (int i = 0; i < 500; i++)
+            group.run([&]() { count++; });
+        group.wait();
+        REQUIRE(count == 500);
+    }
+
+    SECTION("Exceptions thrown by task groups are passed to the waiter") {
+        std::atomic<int> count(0);
+        TaskGroup group(&pool);
+        for (int i = 0; i < 100; i++) {
+            group.run([&, i]() {
+                count++;
+                if (i == 50)
+                    throw std::runtime_error("task failed");
+            });
+        }
+        REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+        // The other tasks still ran, and the group can be reused.
+        REQUIRE(count == 100);
+        group.run([&]() { count++; });
+        group.wait();
+        REQUIRE(count == 101);
+    }
+}
+
+TEST_CASE("gem5 thread pool", "[threadpool]") {
+    runningInSimulation = false;
+    Gem5ThreadPool pool(4);
+    pool.initThreadPool();
+
+    SECTION("parallelFor visits every index once") {
+        verifyParallelFor(&pool, 1, 1);
+        verifyParallelFor(&pool, 3, 1);
+        verifyParallelFor(&pool, 1000, 1);
+        verifyParallelFor(&pool, 1000, 300);
+    }
+}
@@ -16,6 +16,8 @@ void* malloc_aligned(size_t size, bool zeroOut) {
     return ptr;
 }
 
+bool isCachelineMultiple(size_t size) { return size % CACHELINE_SIZE == 0; }
+
 std::string dataLayoutToStr(DataLayout layout) {
     switch (layout) {
         case DataLayout::NCHW:
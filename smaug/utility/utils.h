@@ -63,6 +63,9 @@ std::array<T, sizeof...(Args) + 1> variadicToArray(T i, Args... elems) {
  */
 void* malloc_aligned(size_t size, bool zeroOut = false);
 
+/** Returns true if size bytes span a whole number of cachelines. */
+bool isCachelineMultiple(size_t size);
+
 /**
  * Return the difference between value and the next multiple of alignment.
  */